@@ -31,7 +31,8 @@
 
 #include "ns3/ipv4-address.h"
 #include "ns3/simulator.h"
-#include <vector>
+#include "ns3/sgi-hashmap.h"
+#include <map>
 
 namespace ns3
 {
@@ -41,6 +42,9 @@ namespace aodv
  * \ingroup aodv
  * 
  * \brief Unique packets identification cache used for simple duplicate detection.
+ *
+ * The IDs are hashed, and ordered by expiration time in a second index,
+ * so that neither IsDuplicate () nor Purge () scan the whole cache.
  */
 class IdCache
 {
@@ -65,18 +69,24 @@ private:
     Ipv4Address m_context;
     /// The id
     uint32_t m_id;
-    /// When record will expire
-    Time m_expire;
+    bool operator== (const UniqueId & o) const
+    {
+      return m_context == o.m_context && m_id == o.m_id;
+    }
   };
-  struct IsExpired
+  struct UniqueIdHash
   {
-    bool operator() (const struct UniqueId & u) const
+    size_t operator() (const UniqueId & u) const
     {
-      return (u.m_expire < Simulator::Now ());
+      return Ipv4AddressHash () (u.m_context) ^ (u.m_id * 2654435761U);
     }
   };
-  /// Already seen IDs
-  std::vector<UniqueId> m_idCache;
+  /// IDs ordered by expiration time
+  typedef std::multimap<Time, UniqueId> ExpiryIndex;
+  /// Already seen IDs and their position in m_expiry
+  sgi::hash_map<UniqueId, ExpiryIndex::iterator, UniqueIdHash> m_idCache;
+  /// When the IDs will expire
+  ExpiryIndex m_expiry;
   /// Default lifetime for ID records
   Time m_lifetime;
 };
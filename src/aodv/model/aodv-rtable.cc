@@ -205,14 +205,13 @@ RoutingTable::LookupRoute (Ipv4Address id, RoutingTableEntry & rt)
       NS_LOG_LOGIC ("Route to " << id << " not found; m_ipv4AddressEntry is empty");
       return false;
     }
-  std::map<Ipv4Address, RoutingTableEntry>::const_iterator i =
-    m_ipv4AddressEntry.find (id);
+  Entries::const_iterator i = m_ipv4AddressEntry.find (id);
   if (i == m_ipv4AddressEntry.end ())
     {
       NS_LOG_LOGIC ("Route to " << id << " not found");
       return false;
     }
-  rt = i->second;
+  rt = i->second.route;
   NS_LOG_LOGIC ("Route to " << id << " found");
   return true;
 }
@@ -235,8 +234,10 @@ RoutingTable::DeleteRoute (Ipv4Address dst)
 {
   NS_LOG_FUNCTION (this << dst);
   Purge ();
-  if (m_ipv4AddressEntry.erase (dst) != 0)
+  Entries::iterator i = m_ipv4AddressEntry.find (dst);
+  if (i != m_ipv4AddressEntry.end ())
     {
+      Erase (i);
       NS_LOG_LOGIC ("Route deletion to " << dst << " successful");
       return true;
     }
@@ -251,8 +252,14 @@ RoutingTable::AddRoute (RoutingTableEntry & rt)
   Purge ();
   if (rt.GetFlag () != IN_SEARCH)
     rt.SetRreqCnt (0);
-  std::pair<std::map<Ipv4Address, RoutingTableEntry>::iterator, bool> result =
-    m_ipv4AddressEntry.insert (std::make_pair (rt.GetDestination (), rt));
+  std::pair<Entries::iterator, bool> result =
+    m_ipv4AddressEntry.insert (std::make_pair (rt.GetDestination (), Entry (rt)));
+  if (result.second)
+    {
+      result.first->second.expiry = m_expiry.end ();
+      m_expired.insert (rt.GetDestination ());
+      Reindex (result.first);
+    }
   return result.second;
 }
 
@@ -260,19 +267,19 @@ bool
 RoutingTable::Update (RoutingTableEntry & rt)
 {
   NS_LOG_FUNCTION (this);
-  std::map<Ipv4Address, RoutingTableEntry>::iterator i =
-    m_ipv4AddressEntry.find (rt.GetDestination ());
+  Entries::iterator i = m_ipv4AddressEntry.find (rt.GetDestination ());
   if (i == m_ipv4AddressEntry.end ())
     {
       NS_LOG_LOGIC ("Route update to " << rt.GetDestination () << " fails; not found");
       return false;
     }
-  i->second = rt;
-  if (i->second.GetFlag () != IN_SEARCH)
+  i->second.route = rt;
+  if (i->second.route.GetFlag () != IN_SEARCH)
     {
       NS_LOG_LOGIC ("Route update to " << rt.GetDestination () << " set RreqCnt to 0");
-      i->second.SetRreqCnt (0);
+      i->second.route.SetRreqCnt (0);
     }
+  Reindex (i);
   return true;
 }
 
@@ -280,15 +287,14 @@ bool
 RoutingTable::SetEntryState (Ipv4Address id, RouteFlags state)
 {
   NS_LOG_FUNCTION (this);
-  std::map<Ipv4Address, RoutingTableEntry>::iterator i =
-    m_ipv4AddressEntry.find (id);
+  Entries::iterator i = m_ipv4AddressEntry.find (id);
   if (i == m_ipv4AddressEntry.end ())
     {
       NS_LOG_LOGIC ("Route set entry state to " << id << " fails; not found");
       return false;
     }
-  i->second.SetFlag (state);
-  i->second.SetRreqCnt (0);
+  i->second.route.SetFlag (state);
+  i->second.route.SetRreqCnt (0);
   NS_LOG_LOGIC ("Route set entry state to " << id << ": new state is " << state);
   return true;
 }
@@ -299,13 +305,13 @@ RoutingTable::GetListOfDestinationWithNextHop (Ipv4Address nextHop, std::map<Ipv
   NS_LOG_FUNCTION (this);
   Purge ();
   unreachable.clear ();
-  for (std::map<Ipv4Address, RoutingTableEntry>::const_iterator i =
-         m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end (); ++i)
+  for (Entries::const_iterator i = m_ipv4AddressEntry.begin ();
+       i != m_ipv4AddressEntry.end (); ++i)
     {
-      if (i->second.GetNextHop () == nextHop)
+      if (i->second.route.GetNextHop () == nextHop)
         {
-          NS_LOG_LOGIC ("Unreachable insert " << i->first << " " << i->second.GetSeqNo ());
-          unreachable.insert (std::make_pair (i->first, i->second.GetSeqNo ()));
+          NS_LOG_LOGIC ("Unreachable insert " << i->first << " " << i->second.route.GetSeqNo ());
+          unreachable.insert (std::make_pair (i->first, i->second.route.GetSeqNo ()));
         }
     }
 }
@@ -315,17 +321,15 @@ RoutingTable::InvalidateRoutesWithDst (const std::map<Ipv4Address, uint32_t> & u
 {
   NS_LOG_FUNCTION (this);
   Purge ();
-  for (std::map<Ipv4Address, RoutingTableEntry>::iterator i =
-         m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end (); ++i)
+  for (std::map<Ipv4Address, uint32_t>::const_iterator j =
+         unreachable.begin (); j != unreachable.end (); ++j)
     {
-      for (std::map<Ipv4Address, uint32_t>::const_iterator j =
-             unreachable.begin (); j != unreachable.end (); ++j)
+      Entries::iterator i = m_ipv4AddressEntry.find (j->first);
+      if (i != m_ipv4AddressEntry.end () && i->second.route.GetFlag () == VALID)
         {
-          if ((i->first == j->first) && (i->second.GetFlag () == VALID))
-            {
-              NS_LOG_LOGIC ("Invalidate route with destination address " << i->first);
-              i->second.Invalidate (m_badLinkLifetime);
-            }
+          NS_LOG_LOGIC ("Invalidate route with destination address " << i->first);
+          i->second.route.Invalidate (m_badLinkLifetime);
+          Reindex (i);
         }
     }
 }
@@ -336,49 +340,88 @@ RoutingTable::DeleteAllRoutesFromInterface (Ipv4InterfaceAddress iface)
   NS_LOG_FUNCTION (this);
   if (m_ipv4AddressEntry.empty ())
     return;
-  for (std::map<Ipv4Address, RoutingTableEntry>::iterator i =
-         m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end ();)
+  for (Entries::iterator i = m_ipv4AddressEntry.begin ();
+       i != m_ipv4AddressEntry.end ();)
     {
-      if (i->second.GetInterface () == iface)
+      if (i->second.route.GetInterface () == iface)
         {
-          std::map<Ipv4Address, RoutingTableEntry>::iterator tmp = i;
+          Entries::iterator tmp = i;
           ++i;
-          m_ipv4AddressEntry.erase (tmp);
+          Erase (tmp);
         }
       else
         ++i;
     }
 }
 
+void
+RoutingTable::Clear ()
+{
+  NS_LOG_FUNCTION (this);
+  m_ipv4AddressEntry.clear ();
+  m_expiry.clear ();
+  m_expired.clear ();
+}
+
+void
+RoutingTable::Reindex (Entries::iterator i)
+{
+  if (i->second.expiry == m_expiry.end ())
+    {
+      m_expired.erase (i->first);
+    }
+  else
+    {
+      m_expiry.erase (i->second.expiry);
+    }
+  i->second.expiry = m_expiry.insert (std::make_pair (i->second.route.GetLifeTime () + Simulator::Now (), i->first));
+}
+
+void
+RoutingTable::Erase (Entries::iterator i)
+{
+  if (i->second.expiry == m_expiry.end ())
+    {
+      m_expired.erase (i->first);
+    }
+  else
+    {
+      m_expiry.erase (i->second.expiry);
+    }
+  m_ipv4AddressEntry.erase (i);
+}
+
 void
 RoutingTable::Purge ()
 {
   NS_LOG_FUNCTION (this);
   if (m_ipv4AddressEntry.empty ())
     return;
-  for (std::map<Ipv4Address, RoutingTableEntry>::iterator i =
-         m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end ();)
+  // Move the entries whose lifetime is over out of the expiry index,
+  // then handle all expired entries: the IN_SEARCH ones stay there
+  // until their state or their lifetime changes.
+  Time now = Simulator::Now ();
+  while (!m_expiry.empty () && m_expiry.begin ()->first < now)
     {
-      if (i->second.GetLifeTime () < Seconds (0))
+      Entries::iterator i = m_ipv4AddressEntry.find (m_expiry.begin ()->second);
+      NS_ASSERT (i != m_ipv4AddressEntry.end ());
+      m_expiry.erase (m_expiry.begin ());
+      i->second.expiry = m_expiry.end ();
+      m_expired.insert (i->first);
+    }
+  for (std::set<Ipv4Address>::iterator j = m_expired.begin (); j != m_expired.end ();)
+    {
+      Entries::iterator i = m_ipv4AddressEntry.find (*j);
+      ++j;
+      if (i->second.route.GetFlag () == INVALID)
         {
-          if (i->second.GetFlag () == INVALID)
-            {
-              std::map<Ipv4Address, RoutingTableEntry>::iterator tmp = i;
-              ++i;
-              m_ipv4AddressEntry.erase (tmp);
-            }
-          else if (i->second.GetFlag () == VALID)
-            {
-              NS_LOG_LOGIC ("Invalidate route with destination address " << i->first);
-              i->second.Invalidate (m_badLinkLifetime);
-              ++i;
-            }
-          else
-            ++i;
+          Erase (i);
         }
-      else 
+      else if (i->second.route.GetFlag () == VALID)
         {
-          ++i;
+          NS_LOG_LOGIC ("Invalidate route with destination address " << i->first);
+          i->second.route.Invalidate (m_badLinkLifetime);
+          Reindex (i);
         }
     }
 }
@@ -420,16 +463,15 @@ bool
 RoutingTable::MarkLinkAsUnidirectional (Ipv4Address neighbor, Time blacklistTimeout)
 {
   NS_LOG_FUNCTION (this << neighbor << blacklistTimeout.GetSeconds ());
-  std::map<Ipv4Address, RoutingTableEntry>::iterator i =
-    m_ipv4AddressEntry.find (neighbor);
+  Entries::iterator i = m_ipv4AddressEntry.find (neighbor);
   if (i == m_ipv4AddressEntry.end ())
     {
       NS_LOG_LOGIC ("Mark link unidirectional to  " << neighbor << " fails; not found");
       return false;
     }
-  i->second.SetUnidirectional (true);
-  i->second.SetBalcklistTimeout (blacklistTimeout);
-  i->second.SetRreqCnt (0);
+  i->second.route.SetUnidirectional (true);
+  i->second.route.SetBalcklistTimeout (blacklistTimeout);
+  i->second.route.SetRreqCnt (0);
   NS_LOG_LOGIC ("Set link to " << neighbor << " to unidirectional");
   return true;
 }
@@ -437,7 +479,12 @@ RoutingTable::MarkLinkAsUnidirectional (Ipv4Address neighbor, Time blacklistTime
 void
 RoutingTable::Print (Ptr<OutputStreamWrapper> stream) const
 {
-  std::map<Ipv4Address, RoutingTableEntry> table = m_ipv4AddressEntry;
+  std::map<Ipv4Address, RoutingTableEntry> table;
+  for (Entries::const_iterator i = m_ipv4AddressEntry.begin ();
+       i != m_ipv4AddressEntry.end (); ++i)
+    {
+      table.insert (std::make_pair (i->first, i->second.route));
+    }
   Purge (table);
   *stream->GetStream () << "\nAODV Routing table\n"
                         << "Destination\tGateway\t\tInterface\tFlag\tExpire\t\tHops\n";
@@ -31,12 +31,14 @@
 #include <stdint.h>
 #include <cassert>
 #include <map>
+#include <set>
 #include <sys/types.h>
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/timer.h"
 #include "ns3/net-device.h"
 #include "ns3/output-stream-wrapper.h"
+#include "ns3/sgi-hashmap.h"
 
 namespace ns3 {
 namespace aodv {
@@ -184,6 +186,10 @@ private:
 /**
  * \ingroup aodv
  * \brief The Routing table used by AODV protocol
+ *
+ * The entries are hashed by destination address, and ordered by
+ * expiration time in a second index, so that Purge () only visits the
+ * entries whose lifetime is over instead of the whole table.
  */
 class RoutingTable
 {
@@ -233,7 +239,7 @@ public:
   /// Delete all route from interface with address iface
   void DeleteAllRoutesFromInterface (Ipv4InterfaceAddress iface);
   /// Delete all entries from routing table
-  void Clear () { m_ipv4AddressEntry.clear (); }
+  void Clear ();
   /// Delete all outdated entries and invalidate valid entry if Lifetime is expired
   void Purge ();
   /** Mark entry as unidirectional (e.g. add this neighbor to "blacklist" for blacklistTimeout period)
@@ -246,7 +252,29 @@ public:
   void Print (Ptr<OutputStreamWrapper> stream) const;
 
 private:
-  std::map<Ipv4Address, RoutingTableEntry> m_ipv4AddressEntry;
+  /// Entries ordered by expiration time
+  typedef std::multimap<Time, Ipv4Address> ExpiryIndex;
+  /// A routing table entry and its position in the expiry index
+  struct Entry
+  {
+    Entry (RoutingTableEntry const & r) : route (r) {}
+    /// The routing table entry
+    RoutingTableEntry route;
+    /// Position in m_expiry, or m_expiry.end () if the entry is in m_expired
+    ExpiryIndex::iterator expiry;
+  };
+  typedef sgi::hash_map<Ipv4Address, Entry, Ipv4AddressHash> Entries;
+
+  /// Index the entry at its current expiration time
+  void Reindex (Entries::iterator i);
+  /// Erase the entry and its index
+  void Erase (Entries::iterator i);
+
+  Entries m_ipv4AddressEntry;
+  /// Entries which are not expired yet
+  ExpiryIndex m_expiry;
+  /// Expired entries kept in the table because they are IN_SEARCH
+  std::set<Ipv4Address> m_expired;
   /// Deletion time for invalid routes
   Time m_badLinkLifetime;
   /// const version of Purge, for use by Print() method
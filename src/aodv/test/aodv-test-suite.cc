@@ -516,6 +516,22 @@ struct AodvRtableTest : public TestCase
     NS_TEST_EXPECT_MSG_EQ (rt.GetFlag (), INVALID, "trivial");
     NS_TEST_EXPECT_MSG_EQ (rtable.DeleteRoute (Ipv4Address ("1.2.3.4")), true, "trivial");
     NS_TEST_EXPECT_MSG_EQ (rtable.DeleteRoute (Ipv4Address ("1.2.3.4")), false, "trivial");
+    // expired entries in search stay until their state changes
+    RoutingTableEntry rt5 (/*output device*/ dev, /*dst*/ Ipv4Address ("6.6.6.6"), /*validSeqNo*/ false, /*seqNo*/ 0,
+                                             /*interface*/ iface, /*hop*/ 15, /*next hop*/ Ipv4Address ("1.1.1.1"), /*lifetime*/ Seconds (-1));
+    rt5.SetFlag (IN_SEARCH);
+    NS_TEST_EXPECT_MSG_EQ (rtable.AddRoute (rt5), true, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (rtable.LookupRoute (Ipv4Address ("6.6.6.6"), rt), true, "expired entry in search is kept");
+    NS_TEST_EXPECT_MSG_EQ (rt.GetFlag (), IN_SEARCH, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (rtable.SetEntryState (Ipv4Address ("6.6.6.6"), VALID), true, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (rtable.LookupRoute (Ipv4Address ("6.6.6.6"), rt), true, "expired valid entry is invalidated");
+    NS_TEST_EXPECT_MSG_EQ (rt.GetFlag (), INVALID, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (rt.GetLifeTime (), Seconds (1), "invalidated for the bad link lifetime");
+    rt.SetLifeTime (Seconds (-1));
+    NS_TEST_EXPECT_MSG_EQ (rtable.Update (rt), true, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (rtable.LookupRoute (Ipv4Address ("6.6.6.6"), rt), false, "expired invalid entry is deleted");
+    rtable.Clear ();
+    NS_TEST_EXPECT_MSG_EQ (rtable.LookupRoute (Ipv4Address ("4.3.2.1"), rt), false, "trivial");
     Simulator::Destroy ();
   }
 };
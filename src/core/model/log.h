@@ -120,6 +120,28 @@ void LogComponentDisableAll (enum LogLevel level);
  * environment variable.
  */
 #define NS_LOG_COMPONENT_DEFINE(name)                           \
+  NS_LOG_COMPONENT_DEFINE_MASK (name, ns3::LOG_LEVEL_ALL)
+
+/**
+ * \ingroup logging
+ * \param name a string
+ * \param mask the log levels which can be enabled for this component
+ *
+ * Define a Log component with a specific name, like
+ * NS_LOG_COMPONENT_DEFINE, whose messages are compiled out for the
+ * levels which are not in the mask: they cannot be enabled at run time,
+ * and they cost nothing, not even the check of the level, once the
+ * compiler has folded the constant mask. This is useful to keep the
+ * detailed messages of a busy function out of the build while
+ * keeping its warnings and errors. For example,
+ * \code
+ * NS_LOG_COMPONENT_DEFINE_MASK ("MyComponent", ns3::LOG_LEVEL_INFO);
+ * \endcode
+ * keeps the error, warning, debug and info messages of the component,
+ * and drops its function and logic messages.
+ */
+#define NS_LOG_COMPONENT_DEFINE_MASK(name, mask)                \
+  static const int32_t g_logMask = (mask);                      \
   static ns3::LogComponent g_log = ns3::LogComponent (name)
 
 #define NS_LOG_APPEND_TIME_PREFIX                               \
@@ -216,7 +238,7 @@ void LogComponentDisableAll (enum LogLevel level);
 #define NS_LOG(level, msg)                                      \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (level))                              \
+      if ((g_logMask & (level)) && g_log.IsEnabled (level))     \
         {                                                       \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
@@ -275,7 +297,8 @@ void LogComponentDisableAll (enum LogLevel level);
 #define NS_LOG_FUNCTION_NOARGS()                                \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
+      if ((g_logMask & ns3::LOG_FUNCTION)                       \
+          && g_log.IsEnabled (ns3::LOG_FUNCTION))               \
         {                                                       \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
@@ -311,7 +334,8 @@ void LogComponentDisableAll (enum LogLevel level);
 #define NS_LOG_FUNCTION(parameters)                             \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
+      if ((g_logMask & ns3::LOG_FUNCTION)                       \
+          && g_log.IsEnabled (ns3::LOG_FUNCTION))               \
         {                                                       \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
@@ -21,7 +21,7 @@
 #ifndef TRACED_CALLBACK_H
 #define TRACED_CALLBACK_H
 
-#include <list>
+#include <vector>
 #include "callback.h"
 
 namespace ns3 {
@@ -35,6 +35,10 @@ namespace ns3 {
  * it forwards calls to a chain of ns3::Callback. TracedCallback::Connect adds a ns3::Callback
  * at the end of the chain of callbacks. TracedCallback::Disconnect removes a ns3::Callback from
  * the chain of callbacks.
+ *
+ * The first callback of the chain is stored inline, and the others in a
+ * vector, so that a TracedCallback with zero or one callback never
+ * allocates memory and can be fired without walking a list.
  */
 template<typename T1 = empty, typename T2 = empty, 
          typename T3 = empty, typename T4 = empty,
@@ -78,6 +82,13 @@ public:
    * of the TracedCallback::Connect method.
    */
   void Disconnect (const CallbackBase & callback, std::string path);
+  /**
+   * \returns true if no callback is connected to this TracedCallback.
+   *
+   * Firing an empty TracedCallback does nothing, so the callers whose
+   * arguments are costly to build can test this method to skip them.
+   */
+  bool IsEmpty (void) const;
   void operator() (void) const;
   void operator() (T1 a1) const;
   void operator() (T1 a1, T2 a2) const;
@@ -89,8 +100,12 @@ public:
   void operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) const;
 
 private:
-  typedef std::list<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
-  CallbackList m_callbackList;
+  typedef Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> CallbackType;
+  typedef std::vector<CallbackType> CallbackVector;
+  /// the first callback of the chain, null if the chain is empty
+  CallbackType m_first;
+  /// the following callbacks of the chain
+  CallbackVector m_others;
 };
 
 } // namespace ns3
@@ -104,7 +119,8 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::TracedCallback ()
-  : m_callbackList () 
+  : m_first (),
+    m_others ()
 {
 }
 template<typename T1, typename T2,
@@ -114,9 +130,16 @@ template<typename T1, typename T2,
 void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::ConnectWithoutContext (const CallbackBase & callback)
 {
-  Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> cb;
+  CallbackType cb;
   cb.Assign (callback);
-  m_callbackList.push_back (cb);
+  if (m_first.IsNull ())
+    {
+      m_first = cb;
+    }
+  else
+    {
+      m_others.push_back (cb);
+    }
 }
 template<typename T1, typename T2,
          typename T3, typename T4,
@@ -127,8 +150,15 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Connect (const CallbackBase & callback,
 {
   Callback<void,std::string,T1,T2,T3,T4,T5,T6,T7,T8> cb;
   cb.Assign (callback);
-  Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
-  m_callbackList.push_back (realCb);
+  CallbackType realCb = cb.Bind (path);
+  if (m_first.IsNull ())
+    {
+      m_first = realCb;
+    }
+  else
+    {
+      m_others.push_back (realCb);
+    }
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -137,18 +167,30 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::DisconnectWithoutContext (const CallbackBase & callback)
 {
-  for (typename CallbackList::iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); /* empty */)
+  for (typename CallbackVector::iterator i = m_others.begin ();
+       i != m_others.end (); /* empty */)
     {
       if ((*i).IsEqual (callback))
         {
-          i = m_callbackList.erase (i);
+          i = m_others.erase (i);
         }
       else
         {
           i++;
         }
     }
+  if (!m_first.IsNull () && m_first.IsEqual (callback))
+    {
+      if (m_others.empty ())
+        {
+          m_first.Nullify ();
+        }
+      else
+        {
+          m_first = m_others.front ();
+          m_others.erase (m_others.begin ());
+        }
+    }
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -159,9 +201,18 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Disconnect (const CallbackBase & callba
 {
   Callback<void,std::string,T1,T2,T3,T4,T5,T6,T7,T8> cb;
   cb.Assign (callback);
-  Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
+  CallbackType realCb = cb.Bind (path);
   DisconnectWithoutContext (realCb);
 }
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+bool
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::IsEmpty (void) const
+{
+  return m_first.IsNull ();
+}
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
@@ -169,10 +220,14 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (void) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull ())
     {
-      (*i)();
+      return;
+    }
+  m_first ();
+  for (typename CallbackVector::size_type i = 0; i < m_others.size (); i++)
+    {
+      m_others[i] ();
     }
 }
 template<typename T1, typename T2, 
@@ -182,10 +237,14 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull ())
     {
-      (*i)(a1);
+      return;
+    }
+  m_first (a1);
+  for (typename CallbackVector::size_type i = 0; i < m_others.size (); i++)
+    {
+      m_others[i] (a1);
     }
 }
 template<typename T1, typename T2, 
@@ -195,10 +254,14 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull ())
+    {
+      return;
+    }
+  m_first (a1, a2);
+  for (typename CallbackVector::size_type i = 0; i < m_others.size (); i++)
     {
-      (*i)(a1, a2);
+      m_others[i] (a1, a2);
     }
 }
 template<typename T1, typename T2, 
@@ -208,10 +271,14 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull ())
+    {
+      return;
+    }
+  m_first (a1, a2, a3);
+  for (typename CallbackVector::size_type i = 0; i < m_others.size (); i++)
     {
-      (*i)(a1, a2, a3);
+      m_others[i] (a1, a2, a3);
     }
 }
 template<typename T1, typename T2, 
@@ -221,10 +288,14 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull ())
     {
-      (*i)(a1, a2, a3, a4);
+      return;
+    }
+  m_first (a1, a2, a3, a4);
+  for (typename CallbackVector::size_type i = 0; i < m_others.size (); i++)
+    {
+      m_others[i] (a1, a2, a3, a4);
     }
 }
 template<typename T1, typename T2, 
@@ -234,10 +305,14 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull ())
     {
-      (*i)(a1, a2, a3, a4, a5);
+      return;
+    }
+  m_first (a1, a2, a3, a4, a5);
+  for (typename CallbackVector::size_type i = 0; i < m_others.size (); i++)
+    {
+      m_others[i] (a1, a2, a3, a4, a5);
     }
 }
 template<typename T1, typename T2, 
@@ -247,10 +322,14 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull ())
+    {
+      return;
+    }
+  m_first (a1, a2, a3, a4, a5, a6);
+  for (typename CallbackVector::size_type i = 0; i < m_others.size (); i++)
     {
-      (*i)(a1, a2, a3, a4, a5, a6);
+      m_others[i] (a1, a2, a3, a4, a5, a6);
     }
 }
 template<typename T1, typename T2, 
@@ -260,10 +339,14 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull ())
+    {
+      return;
+    }
+  m_first (a1, a2, a3, a4, a5, a6, a7);
+  for (typename CallbackVector::size_type i = 0; i < m_others.size (); i++)
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7);
+      m_others[i] (a1, a2, a3, a4, a5, a6, a7);
     }
 }
 template<typename T1, typename T2, 
@@ -273,10 +356,14 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull ())
+    {
+      return;
+    }
+  m_first (a1, a2, a3, a4, a5, a6, a7, a8);
+  for (typename CallbackVector::size_type i = 0; i < m_others.size (); i++)
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7, a8);
+      m_others[i] (a1, a2, a3, a4, a5, a6, a7, a8);
     }
 }
 
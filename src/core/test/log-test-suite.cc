@@ -0,0 +1,100 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include <sstream>
+#include <string>
+
+// only the error and warning messages of this component are compiled in
+NS_LOG_COMPONENT_DEFINE_MASK ("LogTestMasked", ns3::LOG_LEVEL_WARN);
+
+using namespace ns3;
+
+class LogMaskTestCase : public TestCase
+{
+public:
+  LogMaskTestCase ();
+  virtual ~LogMaskTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  std::string Evaluate (std::string message);
+
+  uint32_t m_evaluated;
+};
+
+LogMaskTestCase::LogMaskTestCase ()
+  : TestCase ("Check that the levels out of the mask of a log component are compiled out")
+{
+}
+
+std::string
+LogMaskTestCase::Evaluate (std::string message)
+{
+  m_evaluated++;
+  return message;
+}
+
+void
+LogMaskTestCase::DoRun (void)
+{
+  m_evaluated = 0;
+  LogComponentEnable ("LogTestMasked", LOG_LEVEL_ALL);
+
+  std::ostringstream oss;
+  std::streambuf *clogBuf = std::clog.rdbuf (oss.rdbuf ());
+  NS_LOG_ERROR (Evaluate ("error message"));
+  NS_LOG_WARN (Evaluate ("warning message"));
+  NS_LOG_DEBUG (Evaluate ("debug message"));
+  NS_LOG_INFO (Evaluate ("info message"));
+  NS_LOG_FUNCTION (Evaluate ("function message"));
+  NS_LOG_LOGIC (Evaluate ("logic message"));
+  std::clog.rdbuf (clogBuf);
+
+  LogComponentDisable ("LogTestMasked", LOG_LEVEL_ALL);
+
+  std::string output = oss.str ();
+  NS_TEST_ASSERT_MSG_EQ ((output.find ("debug message") == std::string::npos), true, "Debug message not masked");
+  NS_TEST_ASSERT_MSG_EQ ((output.find ("info message") == std::string::npos), true, "Info message not masked");
+  NS_TEST_ASSERT_MSG_EQ ((output.find ("function message") == std::string::npos), true, "Function message not masked");
+  NS_TEST_ASSERT_MSG_EQ ((output.find ("logic message") == std::string::npos), true, "Logic message not masked");
+#ifdef NS3_LOG_ENABLE
+  NS_TEST_ASSERT_MSG_EQ ((output.find ("error message") != std::string::npos), true, "Error message not logged");
+  NS_TEST_ASSERT_MSG_EQ ((output.find ("warning message") != std::string::npos), true, "Warning message not logged");
+  NS_TEST_ASSERT_MSG_EQ (m_evaluated, 2, "The arguments of the masked messages were evaluated");
+#else /* NS3_LOG_ENABLE */
+  NS_TEST_ASSERT_MSG_EQ (output, "", "Message logged with the logs compiled out");
+  NS_TEST_ASSERT_MSG_EQ (m_evaluated, 0, "The arguments of the compiled out messages were evaluated");
+#endif /* NS3_LOG_ENABLE */
+}
+
+class LogTestSuite : public TestSuite
+{
+public:
+  LogTestSuite ();
+};
+
+LogTestSuite::LogTestSuite ()
+  : TestSuite ("log", UNIT)
+{
+  AddTestCase (new LogMaskTestCase, TestCase::QUICK);
+}
+
+static LogTestSuite logTestSuite;
@@ -18,6 +18,8 @@
 
 #include "ns3/test.h"
 #include "ns3/traced-callback.h"
+#include <string>
+#include <vector>
 
 using namespace ns3;
 
@@ -108,6 +110,82 @@ BasicTracedCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_two, true, "Callback CbTwo not called");
 }
 
+class ChainTracedCallbackTestCase : public TestCase
+{
+public:
+  ChainTracedCallbackTestCase ();
+  virtual ~ChainTracedCallbackTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  void Cb (uint8_t a, double b);
+  void CbContext (std::string context, uint8_t a, double b);
+
+  std::vector<uint32_t> m_calls;
+};
+
+ChainTracedCallbackTestCase::ChainTracedCallbackTestCase ()
+  : TestCase ("Check the order of the chain of callbacks when connecting and disconnecting")
+{
+}
+
+void
+ChainTracedCallbackTestCase::Cb (uint8_t a, double b)
+{
+  m_calls.push_back (a);
+}
+
+void
+ChainTracedCallbackTestCase::CbContext (std::string context, uint8_t a, double b)
+{
+  m_calls.push_back (a + context.size ());
+}
+
+void
+ChainTracedCallbackTestCase::DoRun (void)
+{
+  TracedCallback<uint8_t, double> trace;
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), true, "New TracedCallback not empty");
+  trace (1, 2);
+
+  //
+  // Chain four callbacks: the first one is the plain method, and each
+  // of the others adds the length of its context to the first argument,
+  // so that the order of the calls can be checked.
+  //
+  trace.ConnectWithoutContext (MakeCallback (&ChainTracedCallbackTestCase::Cb, this));
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), false, "TracedCallback with one callback is empty");
+  trace.Connect (MakeCallback (&ChainTracedCallbackTestCase::CbContext, this), "a");
+  trace.Connect (MakeCallback (&ChainTracedCallbackTestCase::CbContext, this), "aa");
+  trace.Connect (MakeCallback (&ChainTracedCallbackTestCase::CbContext, this), "aaa");
+  m_calls.clear ();
+  trace (1, 2);
+  NS_TEST_ASSERT_MSG_EQ (m_calls.size (), 4, "Not all callbacks called");
+  for (uint32_t i = 0; i < m_calls.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_calls[i], 1 + i, "Callbacks called out of order");
+    }
+
+  //
+  // Disconnecting the first callback must keep the order of the others.
+  //
+  trace.DisconnectWithoutContext (MakeCallback (&ChainTracedCallbackTestCase::Cb, this));
+  trace.Disconnect (MakeCallback (&ChainTracedCallbackTestCase::CbContext, this), "aa");
+  m_calls.clear ();
+  trace (1, 2);
+  NS_TEST_ASSERT_MSG_EQ (m_calls.size (), 2, "Disconnected callbacks called");
+  NS_TEST_ASSERT_MSG_EQ (m_calls[0], 2, "Callbacks called out of order");
+  NS_TEST_ASSERT_MSG_EQ (m_calls[1], 4, "Callbacks called out of order");
+
+  trace.Disconnect (MakeCallback (&ChainTracedCallbackTestCase::CbContext, this), "a");
+  trace.Disconnect (MakeCallback (&ChainTracedCallbackTestCase::CbContext, this), "aaa");
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), true, "TracedCallback not empty after disconnecting all the callbacks");
+  m_calls.clear ();
+  trace (1, 2);
+  NS_TEST_ASSERT_MSG_EQ (m_calls.size (), 0, "Disconnected callbacks called");
+}
+
 class TracedCallbackTestSuite : public TestSuite
 {
 public:
@@ -118,6 +196,7 @@ TracedCallbackTestSuite::TracedCallbackTestSuite ()
   : TestSuite ("traced-callback", UNIT)
 {
   AddTestCase (new BasicTracedCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new ChainTracedCallbackTestCase, TestCase::QUICK);
 }
 
 static TracedCallbackTestSuite tracedCallbackTestSuite;
@@ -144,8 +144,11 @@ TypeId RouteCache::GetTypeId ()
 
 RouteCache::RouteCache ()
   : m_vector (0),
+    m_maxCacheLen (64),
+    m_maxLinkCacheLen (1024),
     m_maxEntriesEachDst (3),
     m_isLinkCache (false),
+    m_bestRoutesValid (true),
     m_ntimer (Timer::CANCEL_ON_DESTROY),
     m_delay (MilliSeconds (100))
 {
@@ -176,7 +179,7 @@ bool
 RouteCache::UpdateRouteEntry (Ipv4Address dst)
 {
   NS_LOG_FUNCTION (this << dst);
-  std::map<Ipv4Address, std::list<RouteCacheEntry> >::const_iterator i =
+  std::map<Ipv4Address, std::list<RouteCacheEntry> >::iterator i =
     m_sortedRoutes.find (dst);
   if (i == m_sortedRoutes.end ())
     {
@@ -185,19 +188,13 @@ RouteCache::UpdateRouteEntry (Ipv4Address dst)
     }
   else
     {
-      std::list<RouteCacheEntry> rtVector = i->second;
+      std::list<RouteCacheEntry> & rtVector = i->second;
       RouteCacheEntry successEntry = rtVector.front ();
       successEntry.SetExpireTime (RouteCacheTimeout);
       rtVector.pop_front ();
       rtVector.push_back (successEntry);
-      rtVector.sort (CompareRoutesExpire);      // sort the route vector first
-      m_sortedRoutes.erase (dst);               // erase the entry first
-      /*
-       * Save the new route cache along with the destination address in map
-       */
-      std::pair<std::map<Ipv4Address, std::list<RouteCacheEntry> >::iterator, bool> result =
-        m_sortedRoutes.insert (std::make_pair (dst, rtVector));
-      return result.second;
+      rtVector.sort (CompareRoutesExpire);      // sort the route vector
+      return true;
     }
   return false;
 }
@@ -225,7 +222,7 @@ RouteCache::LookupRoute (Ipv4Address id, RouteCacheEntry & rt)
           for (std::map<Ipv4Address, std::list<RouteCacheEntry> >::const_iterator j =
                  m_sortedRoutes.begin (); j != m_sortedRoutes.end (); ++j)
             {
-              std::list<RouteCacheEntry> rtVector = j->second; // The route cache vector linked with destination address
+              const std::list<RouteCacheEntry> & rtVector = j->second; // The route cache vector linked with destination address
               /*
                * Loop through the possibly multiple routes within the route vector
                */
@@ -278,9 +275,8 @@ RouteCache::LookupRoute (Ipv4Address id, RouteCacheEntry & rt)
       /*
        * We have a direct route to the destination address
        */
-      std::list<RouteCacheEntry> rtVector = m->second;
-      rt = rtVector.front ();  // use the first entry in the route vector
-      NS_LOG_LOGIC ("Route to " << id << " with route size " << rtVector.size ());
+      rt = m->second.front ();  // use the first entry in the route vector
+      NS_LOG_LOGIC ("Route to " << id << " with route size " << m->second.size ());
       return true;
     }
 }
@@ -315,114 +311,58 @@ void
 RouteCache::RebuildBestRouteTable (Ipv4Address source)
 {
   NS_LOG_FUNCTION (this << source);
-  /**
-   * \brief The followings are initialize-single-source
-   */
-  // @d shortest-path estimate
-  std::map<Ipv4Address, uint32_t> d;
-  // @pre preceeding node
-  std::map<Ipv4Address, Ipv4Address> pre;
-  for (std::map<Ipv4Address, std::map<Ipv4Address, uint32_t> >::iterator i = m_netGraph.begin (); i != m_netGraph.end (); ++i)
+  m_bestRoutesSource = source;
+  m_bestRoutesValid = true;
+  uint32_t n = m_graphNodes.size ();
+  // the nodes which are not reached have themselves as previous node
+  m_bestRoutesPrevious.resize (n);
+  for (uint32_t i = 0; i < n; i++)
     {
-      if (i->second.find (source) != i->second.end ())
-        {
-          d[i->first] = i->second[source];
-          pre[i->first] = source;
-        }
-      else
-        {
-          d[i->first] = MAXWEIGHT;
-          pre[i->first] = Ipv4Address ("255.255.255.255");
-        }
+      m_bestRoutesPrevious[i] = i;
     }
-  d[source] = 0;
-  /**
-   * \brief The followings are core of dijskra algorithm
+  sgi::hash_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator s = m_graphIndex.find (source);
+  if (s == m_graphIndex.end ())
+    {
+      NS_LOG_LOGIC ("The source is not in the network graph");
+      return;
+    }
+  /*
+   * Every link has the same weight, so a breadth-first search visits the nodes by increasing
+   * distance. The hops and the stability of the link to the previous node are kept for each
+   * node reached, to select the link with the longest expected lifetime when a node can be
+   * reached by several routes of the least hops, and then the previous node with the highest
+   * address.
    */
-  // the node set which shortest distance has been calculated, if true calculated
-  std::map<Ipv4Address, bool> s;
-  double temp = MAXWEIGHT;
-  Ipv4Address tempip = Ipv4Address ("255.255.255.255");
-  for (uint32_t i = 0; i < m_netGraph.size (); i++)
+  std::vector<uint32_t> hops (n, 0);
+  std::vector<Time> stability (n);
+  std::vector<uint32_t> queue;
+  queue.reserve (n);
+  queue.push_back (s->second);
+  for (uint32_t head = 0; head < queue.size (); head++)
     {
-      temp = MAXWEIGHT;
-      for (std::map<Ipv4Address,uint32_t>::const_iterator j = d.begin (); j != d.end (); ++j)
+      uint32_t u = queue[head];
+      for (std::vector<GraphEdge>::const_iterator k = m_netGraph[u].begin (); k != m_netGraph[u].end (); ++k)
         {
-          Ipv4Address ip = j->first;
-          if (s.find (ip) == s.end ())
+          uint32_t v = k->node;
+          if (v == s->second)
             {
-              /*
-               * \brief The followings are for comparison
-               */
-              if (j->second <= temp)
-                {
-                  temp = j->second;
-                  tempip = ip;
-                }
-            }
-        }
-      if (!tempip.IsBroadcast ())
-        {
-          s[tempip] = true;
-          for (std::map<Ipv4Address, uint32_t>::const_iterator k = m_netGraph[tempip].begin (); k != m_netGraph[tempip].end (); ++k)
-            {
-              if (s.find (k->first) == s.end () && d[k->first] > d[tempip] + k->second)
-                {
-                  d[k->first] = d[tempip] + k->second;
-                  pre[k->first] = tempip;
-                }
-              /*
-               *  Selects the shortest-length route that has the longest expected lifetime
-               *  (highest minimum timeout of any link in the route)
-               *  For the computation overhead and complexity
-               *  Here I just implement kind of greedy strategy to select link with the longest expected lifetime when there is two options
-               */
-              else if (d[k->first] == d[tempip] + k->second)
-                {
-                  std::map<Link, LinkStab>::iterator oldlink = m_linkCache.find (Link (k->first, pre[k->first]));
-                  std::map<Link, LinkStab>::iterator newlink = m_linkCache.find (Link (k->first, tempip));
-                  if (oldlink != m_linkCache.end () && newlink != m_linkCache.end ())
-                    {
-                      if (oldlink->second.GetLinkStability () < newlink->second.GetLinkStability ())
-                        {
-                          NS_LOG_INFO ("Select the link with longest expected lifetime");
-                          d[k->first] = d[tempip] + k->second;
-                          pre[k->first] = tempip;
-                        }
-                    }
-                  else
-                    {
-                      NS_LOG_INFO ("Link Stability Info Corrupt");
-                    }
-                }
+              continue;
             }
-        }
-    }
-  // clean the best route table
-  m_bestRoutesTable_link.clear ();
-  for (std::map<Ipv4Address, Ipv4Address>::iterator i = pre.begin (); i != pre.end (); ++i)
-    {
-      // loop for all vertexes
-      RouteCacheEntry::IP_VECTOR route;
-      Ipv4Address iptemp = i->first;
-
-      if (!i->second.IsBroadcast () && iptemp != source)
-        {
-          while (iptemp != source)
+          if (m_bestRoutesPrevious[v] == v)
             {
-              route.push_back (iptemp);
-              iptemp = pre[iptemp];
+              m_bestRoutesPrevious[v] = u;
+              hops[v] = hops[u] + 1;
+              stability[v] = k->stability;
+              queue.push_back (v);
             }
-          route.push_back (source);
-          // Reverse the route
-          RouteCacheEntry::IP_VECTOR reverseroute;
-          for (RouteCacheEntry::IP_VECTOR::reverse_iterator j = route.rbegin (); j != route.rend (); ++j)
+          else if (hops[v] == hops[u] + 1
+                   && (stability[v] < k->stability
+                       || (stability[v] == k->stability && m_graphNodes[m_bestRoutesPrevious[v]] < m_graphNodes[u])))
             {
-              reverseroute.push_back (*j);
+              NS_LOG_INFO ("Select the link with longest expected lifetime");
+              m_bestRoutesPrevious[v] = u;
+              stability[v] = k->stability;
             }
-          NS_LOG_LOGIC ("Add newly calculated best routes");
-          PrintVector (reverseroute);
-          m_bestRoutesTable_link[i->first] = reverseroute;
         }
     }
 }
@@ -433,30 +373,32 @@ RouteCache::LookupRoute_Link (Ipv4Address id, RouteCacheEntry & rt)
   NS_LOG_FUNCTION (this << id);
   /// We need to purge the link node cache
   PurgeLinkNode ();
-  std::map<Ipv4Address, RouteCacheEntry::IP_VECTOR>::const_iterator i = m_bestRoutesTable_link.find (id);
-  if (i == m_bestRoutesTable_link.end ())
+  if (!m_bestRoutesValid)
+    {
+      RebuildBestRouteTable (m_bestRoutesSource);
+    }
+  sgi::hash_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator i = m_graphIndex.find (id);
+  if (i == m_graphIndex.end () || m_bestRoutesPrevious[i->second] == i->second)
     {
       NS_LOG_INFO ("No route find to " << id);
       return false;
     }
-  else
+  RouteCacheEntry::IP_VECTOR route;
+  for (uint32_t node = i->second; node != m_bestRoutesPrevious[node]; node = m_bestRoutesPrevious[node])
     {
-      if (i->second.size () < 2)
-        {
-          NS_LOG_LOGIC ("Route to " << id << " error");
-          return false;
-        }
-
-      RouteCacheEntry newEntry; // Create the route entry
-      newEntry.SetVector (i->second);
-      newEntry.SetDestination (id);
-      newEntry.SetExpireTime (RouteCacheTimeout);
-      NS_LOG_INFO ("Route to " << id << " found with the length " << i->second.size ());
-      rt = newEntry;
-      std::vector<Ipv4Address> path = rt.GetVector ();
-      PrintVector (path);
-      return true;
+      route.push_back (m_graphNodes[node]);
     }
+  route.push_back (m_bestRoutesSource);
+  std::reverse (route.begin (), route.end ());
+
+  RouteCacheEntry newEntry; // Create the route entry
+  newEntry.SetVector (route);
+  newEntry.SetDestination (id);
+  newEntry.SetExpireTime (RouteCacheTimeout);
+  NS_LOG_INFO ("Route to " << id << " found with the length " << route.size ());
+  rt = newEntry;
+  PrintVector (route);
+  return true;
 }
 
 void
@@ -498,15 +440,65 @@ void
 RouteCache::UpdateNetGraph ()
 {
   NS_LOG_FUNCTION (this);
-  m_netGraph.clear ();
+  m_graphIndex.clear ();
+  m_graphNodes.clear ();
+  // keep the edge arrays to reuse their memory
+  for (std::vector<std::vector<GraphEdge> >::iterator i = m_netGraph.begin (); i != m_netGraph.end (); ++i)
+    {
+      i->clear ();
+    }
   for (std::map<Link, LinkStab>::iterator i = m_linkCache.begin (); i != m_linkCache.end (); ++i)
     {
-      // Here the weight is set as 1
-      // May need to set different weight for different link here later TODO
-      uint32_t weight = 1;
-      m_netGraph[i->first.m_low][i->first.m_high] = weight;
-      m_netGraph[i->first.m_high][i->first.m_low] = weight;
+      // Here the weight of every link is 1
+      uint32_t low = GetGraphNode (i->first.m_low);
+      uint32_t high = GetGraphNode (i->first.m_high);
+      GraphEdge edge;
+      edge.stability = i->second.GetLinkStability ();
+      edge.node = high;
+      m_netGraph[low].push_back (edge);
+      edge.node = low;
+      m_netGraph[high].push_back (edge);
     }
+  m_bestRoutesValid = false;
+}
+
+uint32_t
+RouteCache::GetGraphNode (Ipv4Address node)
+{
+  std::pair<sgi::hash_map<Ipv4Address, uint32_t, Ipv4AddressHash>::iterator, bool> result =
+    m_graphIndex.insert (std::make_pair (node, m_graphNodes.size ()));
+  if (result.second)
+    {
+      m_graphNodes.push_back (node);
+      if (m_netGraph.size () < m_graphNodes.size ())
+        {
+          m_netGraph.push_back (std::vector<GraphEdge> ());
+        }
+    }
+  return result.first->second;
+}
+
+void
+RouteCache::AddLink (Link link, LinkStab stab)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_linkCache.find (link) == m_linkCache.end () && !m_linkCache.empty ()
+      && m_linkCache.size () >= m_maxLinkCacheLen)
+    {
+      // The link cache is full, remove the link which expires first
+      std::map<Link, LinkStab>::iterator oldest = m_linkCache.begin ();
+      for (std::map<Link, LinkStab>::iterator i = m_linkCache.begin (); i != m_linkCache.end (); ++i)
+        {
+          if (i->second.GetLinkStability () < oldest->second.GetLinkStability ())
+            {
+              oldest = i;
+            }
+        }
+      NS_LOG_DEBUG ("The link cache is full, remove a link");
+      oldest->first.Print ();
+      m_linkCache.erase (oldest);
+    }
+  m_linkCache[link] = stab;
 }
 
 bool
@@ -594,14 +586,15 @@ RouteCache::AddRoute_Link (RouteCacheEntry::IP_VECTOR nodelist, Ipv4Address sour
           /// Set the link stability as the m)minLifeTime, default is 1 second
           stab.SetLinkStability (m_minLifeTime);
         }
-      m_linkCache[link] = stab;
+      AddLink (link, stab);
       NS_LOG_DEBUG ("Add a new link");
       link.Print ();
       NS_LOG_DEBUG ("Link Info");
       stab.Print ();
     }
+  // The best routes are only computed when they are looked up
   UpdateNetGraph ();
-  RebuildBestRouteTable (source);
+  m_bestRoutesSource = source;
   return true;
 }
 
@@ -656,28 +649,24 @@ RouteCache::AddRoute (RouteCacheEntry & rt)
 {
   NS_LOG_FUNCTION (this);
   Purge ();
-  std::list<RouteCacheEntry> rtVector;   // Declare the route cache entry vector
   Ipv4Address dst = rt.GetDestination ();
-  std::vector<Ipv4Address> route = rt.GetVector ();
 
   NS_LOG_DEBUG ("The route destination we have " << dst);
-  std::map<Ipv4Address, std::list<RouteCacheEntry> >::const_iterator i =
+  std::map<Ipv4Address, std::list<RouteCacheEntry> >::iterator i =
     m_sortedRoutes.find (dst);
 
   if (i == m_sortedRoutes.end ())
     {
-      rtVector.push_back (rt);
-      m_sortedRoutes.erase (dst);   // Erase the route entries for dst first
       /**
        * Save the new route cache along with the destination address in map
        */
-      std::pair<std::map<Ipv4Address, std::list<RouteCacheEntry> >::iterator, bool> result =
-        m_sortedRoutes.insert (std::make_pair (dst, rtVector));
-      return result.second;
+      m_sortedRoutes[dst].push_back (rt);
+      LimitPathCache ();
+      return true;
     }
   else
     {
-      rtVector = i->second;
+      std::list<RouteCacheEntry> & rtVector = i->second;
       NS_LOG_DEBUG ("The existing route size " << rtVector.size () << " for destination address " << dst);
       /**
        * \brief Drop the most aged packet when buffer reaches to max
@@ -705,13 +694,8 @@ RouteCache::AddRoute (RouteCacheEntry & rt)
                                              << rtVector.back ().GetExpireTime ().GetSeconds ());
               NS_LOG_DEBUG ("The first hop" << rtVector.front ().GetVector ().size () << " The second hop "
                                             << rtVector.back ().GetVector ().size ());
-              m_sortedRoutes.erase (dst);               // erase the route entries for dst first
-              /**
-               * Save the new route cache along with the destination address in map
-               */
-              std::pair<std::map<Ipv4Address, std::list<RouteCacheEntry> >::iterator, bool> result =
-                m_sortedRoutes.insert (std::make_pair (dst, rtVector));
-              return result.second;
+              LimitPathCache ();
+              return true;
             }
           else
             {
@@ -722,16 +706,46 @@ RouteCache::AddRoute (RouteCacheEntry & rt)
   return false;
 }
 
+void
+RouteCache::LimitPathCache ()
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t size = 0;
+  for (std::map<Ipv4Address, std::list<RouteCacheEntry> >::const_iterator i =
+         m_sortedRoutes.begin (); i != m_sortedRoutes.end (); ++i)
+    {
+      size += i->second.size ();
+    }
+  while (size > m_maxCacheLen)
+    {
+      // The last entry of each destination expires first, remove the one which expires first of all
+      std::map<Ipv4Address, std::list<RouteCacheEntry> >::iterator oldest = m_sortedRoutes.end ();
+      for (std::map<Ipv4Address, std::list<RouteCacheEntry> >::iterator i =
+             m_sortedRoutes.begin (); i != m_sortedRoutes.end (); ++i)
+        {
+          if (!i->second.empty () && (oldest == m_sortedRoutes.end ()
+                                      || i->second.back ().GetExpireTime () < oldest->second.back ().GetExpireTime ()))
+            {
+              oldest = i;
+            }
+        }
+      NS_LOG_DEBUG ("The route cache is full, remove a route to " << oldest->first);
+      RemoveLastEntry (oldest->second);
+      if (oldest->second.empty ())
+        {
+          m_sortedRoutes.erase (oldest);
+        }
+      size--;
+    }
+}
+
 bool RouteCache::FindSameRoute (RouteCacheEntry & rt, std::list<RouteCacheEntry> & rtVector)
 {
   NS_LOG_FUNCTION (this);
+  RouteCacheEntry::IP_VECTOR newVector = rt.GetVector ();
   for (std::list<RouteCacheEntry>::iterator i = rtVector.begin (); i != rtVector.end (); ++i)
     {
-      // return the first route in the route vector
-      RouteCacheEntry::IP_VECTOR routeVector = i->GetVector ();
-      RouteCacheEntry::IP_VECTOR newVector = rt.GetVector ();
-
-      if (routeVector == newVector)
+      if (i->GetVector () == newVector)
         {
           NS_LOG_DEBUG ("Found same routes in the route cache with the vector size "
                         << rt.GetDestination () << " " << rtVector.size ());
@@ -741,14 +755,13 @@ bool RouteCache::FindSameRoute (RouteCacheEntry & rt, std::list<RouteCacheEntry>
             {
               i->SetExpireTime (rt.GetExpireTime ());
             }
-          m_sortedRoutes.erase (rt.GetDestination ()); // erase the entry first
           rtVector.sort (CompareRoutesExpire);  // sort the route vector first
           /*
-           * Save the new route cache along with the destination address in map
+           * Save the new route cache along with the destination address in map, unless
+           * rtVector is already the one of the map
            */
-          std::pair<std::map<Ipv4Address, std::list<RouteCacheEntry> >::iterator, bool> result =
-            m_sortedRoutes.insert (std::make_pair (rt.GetDestination (), rtVector));
-          return result.second;
+          m_sortedRoutes[rt.GetDestination ()] = rtVector;
+          return true;
         }
     }
   return false;
@@ -809,7 +822,7 @@ RouteCache::DeleteAllRoutesIncludeLink (Ipv4Address errorSrc, Ipv4Address unreac
           DecStability (i->first);
         }
       UpdateNetGraph ();
-      RebuildBestRouteTable (node);
+      m_bestRoutesSource = node;
     }
   else
     {
@@ -974,52 +987,35 @@ RouteCache::Purge ()
     {
       // Loop of route cache entry with the route size
       std::map<Ipv4Address, std::list<RouteCacheEntry> >::iterator itmp = i;
+      ++i;
       /*
        * The route cache entry vector
        */
-      Ipv4Address dst = i->first;
-      std::list<RouteCacheEntry> rtVector = i->second;
+      Ipv4Address dst = itmp->first;
+      std::list<RouteCacheEntry> & rtVector = itmp->second;
       NS_LOG_DEBUG ("The route vector size of 1 " << dst << " " << rtVector.size ());
-      if (rtVector.size ())
+      for (std::list<RouteCacheEntry>::iterator j = rtVector.begin (); j != rtVector.end (); )
         {
-          for (std::list<RouteCacheEntry>::iterator j = rtVector.begin (); j != rtVector.end (); )
-            {
-              NS_LOG_DEBUG ("The expire time of every entry with expire time " << j->GetExpireTime ());
-              /*
-               * First verify if the route has expired or not
-               */
-              if (j->GetExpireTime () <= Seconds (0))
-                {
-                  /*
-                   * When the expire time has passed, erase the certain route
-                   */
-                  NS_LOG_DEBUG ("Erase the expired route for " << dst << " with expire time " << j->GetExpireTime ());
-                  j = rtVector.erase (j);
-                }
-              else
-                {
-                  ++j;
-                }
-            }
-          NS_LOG_DEBUG ("The route vector size of 2 " << dst << " " << rtVector.size ());
-          if (rtVector.size ())
+          NS_LOG_DEBUG ("The expire time of every entry with expire time " << j->GetExpireTime ());
+          /*
+           * First verify if the route has expired or not
+           */
+          if (j->GetExpireTime () <= Seconds (0))
             {
-              ++i;
-              m_sortedRoutes.erase (itmp); // erase the entry first
               /*
-               * Save the new route cache along with the destination address in map
+               * When the expire time has passed, erase the certain route
                */
-              m_sortedRoutes.insert (std::make_pair (dst, rtVector));
+              NS_LOG_DEBUG ("Erase the expired route for " << dst << " with expire time " << j->GetExpireTime ());
+              j = rtVector.erase (j);
             }
           else
             {
-              ++i;
-              m_sortedRoutes.erase (itmp);
+              ++j;
             }
         }
-      else
+      NS_LOG_DEBUG ("The route vector size of 2 " << dst << " " << rtVector.size ());
+      if (rtVector.empty ())
         {
-          ++i;
           m_sortedRoutes.erase (itmp);
         }
     }
@@ -54,6 +54,7 @@
 #include "ns3/callback.h"
 #include "ns3/wifi-mac-header.h"
 #include "ns3/arp-cache.h"
+#include "ns3/sgi-hashmap.h"
 #include "dsr-option-header.h"
 
 namespace ns3 {
@@ -357,6 +358,14 @@ public:
   {
     m_maxCacheLen = len;
   }
+  uint32_t GetMaxLinkCacheLen () const
+  {
+    return m_maxLinkCacheLen;
+  }
+  void SetMaxLinkCacheLen (uint32_t len)
+  {
+    m_maxLinkCacheLen = len;
+  }
   Time GetCacheTimeout () const
   {
     return RouteCacheTimeout;
@@ -576,7 +585,8 @@ public:
 private:
   RouteCache & operator= (RouteCache const &);
   RouteCacheEntry::IP_VECTOR m_vector;                  ///< The route vector to save the ip addresses for intermediate nodes.
-  uint32_t m_maxCacheLen;                               ///< The maximum number of packets that we allow a routing protocol to buffer.
+  uint32_t m_maxCacheLen;                               ///< The maximum number of route entries in the path cache.
+  uint32_t m_maxLinkCacheLen;                           ///< The maximum number of links in the link cache.
   Time     RouteCacheTimeout;                           ///< The maximum period of time that dsr is allowed to for an unused route.
   Time     m_badLinkLifetime;                           ///< The time for which the neighboring node is put into the blacklist.
   /**
@@ -609,13 +619,30 @@ private:
    */
   #define MAXWEIGHT 0xFFFF;
   /**
-   * Current network graph state for this node, double is weight, which is calculated by the node information
-   * and link information, any time some changes of link cache and node cache
-   * change the weight and then recompute the best choice for each node
+   * An edge of the network graph: the index of the neighbor node and the
+   * stability of the link to it when the graph was built.
    */
-  std::map<Ipv4Address, std::map<Ipv4Address, uint32_t> > m_netGraph;
-
-  std::map<Ipv4Address, RouteCacheEntry::IP_VECTOR> m_bestRoutesTable_link;     ///< for link route cache
+  struct GraphEdge
+  {
+    uint32_t node;
+    Time stability;
+  };
+  /**
+   * Current network graph state for this node, built from the link cache by UpdateNetGraph.
+   * The nodes are numbered in the order in which they appear in the links, and each of them
+   * has the array of its edges. Every link has the same weight, so the best routes are those
+   * with the least hops.
+   */
+  sgi::hash_map<Ipv4Address, uint32_t, Ipv4AddressHash> m_graphIndex;          ///< The index of each node of the graph
+  std::vector<Ipv4Address> m_graphNodes;                                        ///< The address of each node of the graph
+  std::vector<std::vector<GraphEdge> > m_netGraph;                              ///< The edges of each node of the graph
+  /**
+   * The best routes from m_bestRoutesSource, as the previous node of each node on its best route.
+   * They are only computed by RebuildBestRouteTable when a route is looked up after the graph changed.
+   */
+  std::vector<uint32_t> m_bestRoutesPrevious;
+  Ipv4Address m_bestRoutesSource;                                               ///< The source of the best routes
+  bool m_bestRoutesValid;                                                       ///< Whether the best routes match the graph
   std::map<Link, LinkStab> m_linkCache;                                         ///< The data structure to store link info
   std::map<Ipv4Address, NodeStab> m_nodeCache;                                  ///< The data structure to store node info
   /**
@@ -634,18 +661,33 @@ private:
    * \param node the ip address of the node we want to decrease stability
    */
   bool DecStability (Ipv4Address node);
+  /**
+   * \brief get the index of a node of the network graph, adding the node if needed
+   * \param node the ip address of the node
+   */
+  uint32_t GetGraphNode (Ipv4Address node);
+  /**
+   * \brief add a link to the link cache, removing the least stable link if the cache is full
+   * \param link the link to add
+   * \param stab the stability of the link
+   */
+  void AddLink (Link link, LinkStab stab);
+  /**
+   * \brief remove the entries which expire first until the path cache has room for a new entry
+   */
+  void LimitPathCache ();
 
 public:
   /**
-   * \brief dijsktra algorithm to get the best route from m_netGraph and update the m_bestRoutesTable_link
-   * \when current graph information has changed
    * \param The type of the cache
    */
   void SetCacheType (std::string type);
   bool IsLinkCache ();
   bool AddRoute_Link (RouteCacheEntry::IP_VECTOR nodelist, Ipv4Address node);
   /**
-   *  \brief USE MAXWEIGHT TO REPRESENT MAX; USE BROADCAST ADDRESS TO REPRESENT NULL PRECEEDING ADDRESS
+   *  \brief breadth-first search of m_netGraph to get the best route to every node, which updates
+   *  m_bestRoutesPrevious. Among the routes with the least hops, the link with the longest
+   *  expected lifetime is selected at each hop.
    *  \param The source address the routes based on
    */
   void RebuildBestRouteTable (Ipv4Address source);
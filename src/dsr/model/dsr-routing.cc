@@ -142,6 +142,10 @@ TypeId DsrRouting::GetTypeId ()
                    UintegerValue (64),
                    MakeUintegerAccessor (&DsrRouting::m_maxCacheLen),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxLinkCacheLen","Maximum number of links that can be stored in the link cache.",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&DsrRouting::m_maxLinkCacheLen),
+                   MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("RouteCacheTimeout","Maximum time the route cache can be queued in route cache.",
                    TimeValue (Seconds (300)),
                    MakeTimeAccessor (&DsrRouting::m_maxCacheTime),
@@ -411,6 +415,7 @@ void DsrRouting::Start ()
               routeCache->SetCacheType (m_cacheType);
               routeCache->SetSubRoute (m_subRoute);
               routeCache->SetMaxCacheLen (m_maxCacheLen);
+              routeCache->SetMaxLinkCacheLen (m_maxLinkCacheLen);
               routeCache->SetCacheTimeout (m_maxCacheTime);
               routeCache->SetMaxEntriesEachDst (m_maxEntriesEachDst);
               // Parameters for link cache
@@ -453,9 +458,11 @@ void DsrRouting::Start ()
 
 void DsrRouting::ConnectCallbacks ()
 {
-  // Connect the callbacks
-  Config::Connect ("NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyRxEnd",
-                   MakeCallback (&DsrRouting::NotifyDataReceipt, this));
+  // Connect the callbacks of this node only, NotifyDataReceipt ignores
+  // the packets received by the other nodes
+  std::ostringstream oss;
+  oss << "NodeList/" << m_node->GetId () << "/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyRxEnd";
+  Config::Connect (oss.str (), MakeCallback (&DsrRouting::NotifyDataReceipt, this));
 }
 
 void DsrRouting::NotifyDataReceipt (std::string context, Ptr<const Packet> p)
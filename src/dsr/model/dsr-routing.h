@@ -626,6 +626,8 @@ private:
 
   uint32_t m_maxCacheLen;                               ///< Max # of cache entries for route cache
 
+  uint32_t m_maxLinkCacheLen;                           ///< Max # of links for link cache
+
   Time   m_maxCacheTime;                                ///< Max time for caching the route cache entry
 
   Time  m_maxRreqTime;                                  ///< Max time for caching the route request entry
@@ -384,6 +384,110 @@ DsrCacheEntryTest::DoRun ()
   NS_TEST_EXPECT_MSG_EQ (rcache->DeleteRoute (Ipv4Address ("1.1.1.1")), false, "trivial");
 }
 // -----------------------------------------------------------------------------
+// / Unit test for DSR link cache and path cache
+class DsrLinkCacheTest : public TestCase
+{
+public:
+  DsrLinkCacheTest ();
+  ~DsrLinkCacheTest ();
+  virtual void
+  DoRun (void);
+  Ptr<dsr::RouteCache> CreateLinkCache ();
+  std::vector<Ipv4Address> Route (const char *a, const char *b, const char *c = 0, const char *d = 0, const char *e = 0);
+};
+DsrLinkCacheTest::DsrLinkCacheTest ()
+  : TestCase ("DSR link cache")
+{
+}
+DsrLinkCacheTest::~DsrLinkCacheTest ()
+{
+}
+Ptr<dsr::RouteCache>
+DsrLinkCacheTest::CreateLinkCache ()
+{
+  Ptr<dsr::RouteCache> rcache = CreateObject<dsr::RouteCache> ();
+  rcache->SetCacheType ("LinkCache");
+  rcache->SetCacheTimeout (Seconds (300));
+  rcache->SetInitStability (Seconds (25));
+  rcache->SetMinLifeTime (Seconds (1));
+  rcache->SetUseExtends (Seconds (120));
+  rcache->SetStabilityIncrFactor (4);
+  rcache->SetStabilityDecrFactor (2);
+  return rcache;
+}
+std::vector<Ipv4Address>
+DsrLinkCacheTest::Route (const char *a, const char *b, const char *c, const char *d, const char *e)
+{
+  const char *nodes[] = { a, b, c, d, e };
+  std::vector<Ipv4Address> route;
+  for (uint32_t i = 0; i < 5 && nodes[i] != 0; i++)
+    {
+      route.push_back (Ipv4Address (nodes[i]));
+    }
+  return route;
+}
+void
+DsrLinkCacheTest::DoRun ()
+{
+  Ipv4Address source ("10.0.0.1");
+  Ptr<dsr::RouteCache> rcache = CreateLinkCache ();
+  dsr::RouteCacheEntry entry;
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (Ipv4Address ("10.0.0.5"), entry), false, "Empty link cache");
+
+  rcache->AddRoute_Link (Route ("10.0.0.1", "10.0.0.2", "10.0.0.3", "10.0.0.4", "10.0.0.5"), source);
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (Ipv4Address ("10.0.0.5"), entry), true, "No route to 10.0.0.5");
+  NS_TEST_EXPECT_MSG_EQ (entry.GetVector ().size (), 5, "Wrong route to 10.0.0.5");
+  rcache->AddRoute_Link (Route ("10.0.0.1", "10.0.0.6", "10.0.0.7", "10.0.0.5"), source);
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (Ipv4Address ("10.0.0.5"), entry), true, "No route to 10.0.0.5");
+  NS_TEST_EXPECT_MSG_EQ ((entry.GetVector () == Route ("10.0.0.1", "10.0.0.6", "10.0.0.7", "10.0.0.5")), true, "Not the shortest route to 10.0.0.5");
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (Ipv4Address ("10.0.0.4"), entry), true, "No route to 10.0.0.4");
+  NS_TEST_EXPECT_MSG_EQ ((entry.GetVector () == Route ("10.0.0.1", "10.0.0.2", "10.0.0.3", "10.0.0.4")), true, "Not the shortest route to 10.0.0.4");
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (source, entry), false, "Route to the source itself");
+
+  // a broken link is removed from the routes
+  rcache->DeleteAllRoutesIncludeLink (Ipv4Address ("10.0.0.7"), Ipv4Address ("10.0.0.5"), source);
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (Ipv4Address ("10.0.0.5"), entry), true, "No route to 10.0.0.5");
+  NS_TEST_EXPECT_MSG_EQ (entry.GetVector ().size (), 5, "Route to 10.0.0.5 through a broken link");
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (Ipv4Address ("10.0.0.7"), entry), true, "No route to 10.0.0.7");
+
+  // among the shortest routes, the one with the most stable links is selected
+  rcache->AddRoute_Link (Route ("10.0.0.1", "10.0.0.8", "10.0.0.10"), source);
+  rcache->AddRoute_Link (Route ("10.0.0.1", "10.0.0.9", "10.0.0.10"), source);
+  rcache->UseExtends (Route ("10.0.0.1", "10.0.0.9", "10.0.0.10"));
+  rcache->AddRoute_Link (Route ("10.0.0.1", "10.0.0.2"), source);
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (Ipv4Address ("10.0.0.10"), entry), true, "No route to 10.0.0.10");
+  NS_TEST_EXPECT_MSG_EQ (entry.GetVector ()[1], Ipv4Address ("10.0.0.9"), "Not the most stable route to 10.0.0.10");
+  rcache->UseExtends (Route ("10.0.0.1", "10.0.0.8"));
+  rcache->AddRoute_Link (Route ("10.0.0.1", "10.0.0.2"), source);
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (Ipv4Address ("10.0.0.10"), entry), true, "No route to 10.0.0.10");
+  NS_TEST_EXPECT_MSG_EQ (entry.GetVector ()[1], Ipv4Address ("10.0.0.9"), "Not the most stable route to 10.0.0.10");
+
+  // a full link cache removes the link which expires first
+  rcache = CreateLinkCache ();
+  rcache->SetMaxLinkCacheLen (3);
+  rcache->AddRoute_Link (Route ("10.0.0.1", "10.0.0.2", "10.0.0.3", "10.0.0.4"), source);
+  rcache->UseExtends (Route ("10.0.0.1", "10.0.0.2", "10.0.0.3"));
+  rcache->AddRoute_Link (Route ("10.0.0.1", "10.0.0.5"), source);
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (Ipv4Address ("10.0.0.5"), entry), true, "No route to 10.0.0.5");
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (Ipv4Address ("10.0.0.3"), entry), true, "No route to 10.0.0.3");
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (Ipv4Address ("10.0.0.4"), entry), false, "The least stable link was kept");
+
+  // a full path cache removes the route which expires first
+  rcache = CreateObject<dsr::RouteCache> ();
+  rcache->SetCacheType ("PathCache");
+  rcache->SetMaxCacheLen (2);
+  dsr::RouteCacheEntry entry1 (Route ("10.0.0.1", "10.0.0.2"), Ipv4Address ("10.0.0.2"), Seconds (10));
+  dsr::RouteCacheEntry entry2 (Route ("10.0.0.1", "10.0.0.3"), Ipv4Address ("10.0.0.3"), Seconds (30));
+  dsr::RouteCacheEntry entry3 (Route ("10.0.0.1", "10.0.0.4"), Ipv4Address ("10.0.0.4"), Seconds (20));
+  NS_TEST_EXPECT_MSG_EQ (rcache->AddRoute (entry1), true, "Could not add a route to 10.0.0.2");
+  NS_TEST_EXPECT_MSG_EQ (rcache->AddRoute (entry2), true, "Could not add a route to 10.0.0.3");
+  NS_TEST_EXPECT_MSG_EQ (rcache->AddRoute (entry2), true, "Could not add the same route to 10.0.0.3");
+  NS_TEST_EXPECT_MSG_EQ (rcache->AddRoute (entry3), true, "Could not add a route to 10.0.0.4");
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (Ipv4Address ("10.0.0.2"), entry), false, "The oldest route was kept");
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (Ipv4Address ("10.0.0.3"), entry), true, "No route to 10.0.0.3");
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (Ipv4Address ("10.0.0.4"), entry), true, "No route to 10.0.0.4");
+}
+// -----------------------------------------------------------------------------
 // / Unit test for Send Buffer
 class DsrSendBuffTest : public TestCase
 {
@@ -516,6 +620,7 @@ public:
     AddTestCase (new DsrAckReqHeaderTest, TestCase::QUICK);
     AddTestCase (new DsrAckHeaderTest, TestCase::QUICK);
     AddTestCase (new DsrCacheEntryTest, TestCase::QUICK);
+    AddTestCase (new DsrLinkCacheTest, TestCase::QUICK);
     AddTestCase (new DsrSendBuffTest, TestCase::QUICK);
   }
 } g_dsrTestSuite;
@@ -22,8 +22,10 @@
 #include "ns3/log.h"
 #include "ns3/assert.h"
 #include "ns3/double.h"
+#include "ns3/boolean.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/simulator.h"
+#include <cmath>
 
 NS_LOG_COMPONENT_DEFINE ("BasicEnergySource");
 
@@ -55,6 +57,13 @@ BasicEnergySource::GetTypeId (void)
                    MakeTimeAccessor (&BasicEnergySource::SetEnergyUpdateInterval,
                                      &BasicEnergySource::GetEnergyUpdateInterval),
                    MakeTimeChecker ())
+    .AddAttribute ("LazyEnergyUpdate",
+                   "Compute the remaining energy on demand instead of periodically, "
+                   "and only schedule the periodic update which finds the energy depleted.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&BasicEnergySource::SetLazyEnergyUpdate,
+                                        &BasicEnergySource::GetLazyEnergyUpdate),
+                   MakeBooleanChecker ())
     .AddTraceSource ("RemainingEnergy",
                      "Remaining energy at BasicEnergySource.",
                      MakeTraceSourceAccessor (&BasicEnergySource::m_remainingEnergyJ))
@@ -63,6 +72,7 @@ BasicEnergySource::GetTypeId (void)
 }
 
 BasicEnergySource::BasicEnergySource ()
+  : m_lazyEnergyUpdate (false)
 {
   NS_LOG_FUNCTION (this);
   m_lastUpdateTime = Seconds (0.0);
@@ -103,6 +113,20 @@ BasicEnergySource::GetEnergyUpdateInterval (void) const
   return m_energyUpdateInterval;
 }
 
+void
+BasicEnergySource::SetLazyEnergyUpdate (bool lazy)
+{
+  NS_LOG_FUNCTION (this << lazy);
+  m_lazyEnergyUpdate = lazy;
+}
+
+bool
+BasicEnergySource::GetLazyEnergyUpdate (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_lazyEnergyUpdate;
+}
+
 double
 BasicEnergySource::GetSupplyVoltage (void) const
 {
@@ -159,6 +183,18 @@ BasicEnergySource::UpdateEnergySource (void)
 
   m_lastUpdateTime = Simulator::Now ();
 
+  if (m_lazyEnergyUpdate)
+    {
+      // the device models update the energy source before their current
+      // changes, so predict the depletion once the current event is over.
+      if (!m_depletionEvent.IsRunning ())
+        {
+          m_depletionEvent = Simulator::ScheduleNow (&BasicEnergySource::ScheduleEnergyDepletion,
+                                                     this);
+        }
+      return;
+    }
+
   m_energyUpdateEvent = Simulator::Schedule (m_energyUpdateInterval,
                                              &BasicEnergySource::UpdateEnergySource,
                                              this);
@@ -191,6 +227,48 @@ BasicEnergySource::HandleEnergyDrainedEvent (void)
   m_remainingEnergyJ = 0; // energy never goes below 0
 }
 
+void
+BasicEnergySource::ScheduleEnergyDepletion (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_energyUpdateEvent.Cancel ();
+  double powerW = CalculateTotalCurrent () * m_supplyVoltageV;
+  if (!(powerW > 0))
+    {
+      return; // never depleted
+    }
+  // the periodic updates happen every m_energyUpdateInterval after the last
+  // update; find the first one at which the remaining energy is depleted.
+  Time delay;
+  if (m_energyUpdateInterval.IsStrictlyPositive ())
+    {
+      double periods = std::ceil (m_remainingEnergyJ / (powerW * m_energyUpdateInterval.GetSeconds ()));
+      double maxPeriods = (Simulator::GetMaximumSimulationTime () - m_lastUpdateTime).GetTimeStep ()
+        / (double) m_energyUpdateInterval.GetTimeStep ();
+      if (periods >= maxPeriods)
+        {
+          return; // not depleted before the end of time
+        }
+      delay = TimeStep ((uint64_t) periods * m_energyUpdateInterval.GetTimeStep ());
+    }
+  else
+    {
+      delay = Seconds (m_remainingEnergyJ / powerW);
+    }
+  m_energyUpdateEvent = Simulator::Schedule (delay, &BasicEnergySource::HandleEnergyDepletion,
+                                             this);
+}
+
+void
+BasicEnergySource::HandleEnergyDepletion (void)
+{
+  NS_LOG_FUNCTION (this);
+  // the current has not changed since the prediction, and the remaining
+  // energy is depleted but for rounding errors.
+  CalculateRemainingEnergy ();
+  HandleEnergyDrainedEvent ();
+}
+
 void
 BasicEnergySource::CalculateRemainingEnergy (void)
 {
@@ -33,6 +33,10 @@ namespace ns3 {
  * BasicEnergySource decreases/increases remaining energy stored in itself in
  * linearly.
  *
+ * By default, the remaining energy is updated periodically. If the
+ * "LazyEnergyUpdate" attribute is true, it is only computed when it is
+ * requested or when the current drawn changes, and the only scheduled event
+ * is the periodic update at which the energy would be depleted.
  */
 class BasicEnergySource : public EnergySource
 {
@@ -102,6 +106,17 @@ public:
    */
   Time GetEnergyUpdateInterval (void) const;
 
+  /**
+   * \param lazy Whether the remaining energy is computed on demand instead of
+   * periodically.
+   */
+  void SetLazyEnergyUpdate (bool lazy);
+
+  /**
+   * \returns Whether the remaining energy is computed on demand.
+   */
+  bool GetLazyEnergyUpdate (void) const;
+
 
 private:
   /// Defined in ns3::Object
@@ -127,6 +142,19 @@ private:
    */
   void CalculateRemainingEnergy (void);
 
+  /**
+   * Schedules the energy update at which the remaining energy will be
+   * depleted with the current drawn now, when the remaining energy is
+   * computed on demand. The update happens at the same time as the periodic
+   * update which would find the energy depleted.
+   */
+  void ScheduleEnergyDepletion (void);
+
+  /**
+   * Handles the predicted depletion of the remaining energy.
+   */
+  void HandleEnergyDepletion (void);
+
 private:
   double m_initialEnergyJ;                // initial energy, in Joules
   double m_supplyVoltageV;                // supply voltage, in Volts
@@ -134,6 +162,8 @@ private:
   EventId m_energyUpdateEvent;            // energy update event
   Time m_lastUpdateTime;                  // last update time
   Time m_energyUpdateInterval;            // energy update interval
+  bool m_lazyEnergyUpdate;                // compute remaining energy on demand
+  EventId m_depletionEvent;               // prediction of the depletion time
 
 };
 
@@ -22,6 +22,7 @@
 #include "ns3/log.h"
 #include "ns3/assert.h"
 #include "ns3/double.h"
+#include "ns3/boolean.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/simulator.h"
 
@@ -97,6 +98,13 @@ LiIonEnergySource::GetTypeId (void)
                    MakeTimeAccessor (&LiIonEnergySource::SetEnergyUpdateInterval,
                                      &LiIonEnergySource::GetEnergyUpdateInterval),
                    MakeTimeChecker ())
+    .AddAttribute ("LazyEnergyUpdate",
+                   "Replay the periodic energy updates on demand instead of scheduling them, "
+                   "and only schedule the updates which may find the energy depleted.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&LiIonEnergySource::SetLazyEnergyUpdate,
+                                        &LiIonEnergySource::GetLazyEnergyUpdate),
+                   MakeBooleanChecker ())
     .AddTraceSource ("RemainingEnergy",
                      "Remaining energy at BasicEnergySource.",
                      MakeTraceSourceAccessor (&LiIonEnergySource::m_remainingEnergyJ))
@@ -106,7 +114,8 @@ LiIonEnergySource::GetTypeId (void)
 
 LiIonEnergySource::LiIonEnergySource ()
   : m_drainedCapacity (0.0),
-    m_lastUpdateTime (Seconds (0.0))
+    m_lastUpdateTime (Seconds (0.0)),
+    m_lazyEnergyUpdate (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -162,6 +171,20 @@ LiIonEnergySource::GetEnergyUpdateInterval (void) const
   return m_energyUpdateInterval;
 }
 
+void
+LiIonEnergySource::SetLazyEnergyUpdate (bool lazy)
+{
+  NS_LOG_FUNCTION (this << lazy);
+  m_lazyEnergyUpdate = lazy;
+}
+
+bool
+LiIonEnergySource::GetLazyEnergyUpdate (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_lazyEnergyUpdate;
+}
+
 double
 LiIonEnergySource::GetRemainingEnergy (void)
 {
@@ -217,6 +240,11 @@ LiIonEnergySource::UpdateEnergySource (void)
 
   m_energyUpdateEvent.Cancel ();
 
+  if (m_lazyEnergyUpdate && !ReplayEnergyUpdates ())
+    {
+      return;
+    }
+
   CalculateRemainingEnergy ();
 
   if (m_remainingEnergyJ <= 0)
@@ -227,6 +255,18 @@ LiIonEnergySource::UpdateEnergySource (void)
 
   m_lastUpdateTime = Simulator::Now ();
 
+  if (m_lazyEnergyUpdate)
+    {
+      // the device models update the energy source before their current
+      // changes, so predict the depletion once the current event is over.
+      if (!m_depletionEvent.IsRunning ())
+        {
+          m_depletionEvent = Simulator::ScheduleNow (&LiIonEnergySource::ScheduleEnergyDepletion,
+                                                     this);
+        }
+      return;
+    }
+
   m_energyUpdateEvent = Simulator::Schedule (m_energyUpdateInterval,
                                              &LiIonEnergySource::UpdateEnergySource,
                                              this);
@@ -247,6 +287,10 @@ LiIonEnergySource::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
   // calculate remaining energy at the end of simulation
+  if (m_lazyEnergyUpdate)
+    {
+      ReplayEnergyUpdates ();
+    }
   CalculateRemainingEnergy ();
   BreakDeviceEnergyModelRefCycle ();  // break reference cycle
 }
@@ -267,8 +311,14 @@ void
 LiIonEnergySource::CalculateRemainingEnergy (void)
 {
   NS_LOG_FUNCTION (this);
+  CalculateRemainingEnergy (Simulator::Now () - m_lastUpdateTime);
+}
+
+void
+LiIonEnergySource::CalculateRemainingEnergy (Time duration)
+{
+  NS_LOG_FUNCTION (this << duration);
   double totalCurrentA = CalculateTotalCurrent ();
-  Time duration = Simulator::Now () - m_lastUpdateTime;
   NS_ASSERT (duration.GetSeconds () >= 0);
   // energy = current * voltage * time
   double energyToDecreaseJ = totalCurrentA * m_supplyVoltageV * duration.GetSeconds ();
@@ -279,6 +329,53 @@ LiIonEnergySource::CalculateRemainingEnergy (void)
   NS_LOG_DEBUG ("LiIonEnergySource:Remaining energy = " << m_remainingEnergyJ);
 }
 
+bool
+LiIonEnergySource::ReplayEnergyUpdates (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_energyUpdateInterval.IsStrictlyPositive ())
+    {
+      return true;
+    }
+  // the current drawn has not changed since the last energy update.
+  while (Simulator::Now () - m_lastUpdateTime >= m_energyUpdateInterval)
+    {
+      CalculateRemainingEnergy (m_energyUpdateInterval);
+      if (m_remainingEnergyJ <= 0)
+        {
+          HandleEnergyDrainedEvent ();
+          return false;
+        }
+      m_lastUpdateTime += m_energyUpdateInterval;
+    }
+  return true;
+}
+
+void
+LiIonEnergySource::ScheduleEnergyDepletion (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_energyUpdateEvent.Cancel ();
+  double powerW = CalculateTotalCurrent () * m_supplyVoltageV;
+  if (!(powerW > 0) || !m_energyUpdateInterval.IsStrictlyPositive ())
+    {
+      return; // never depleted, or only updated on demand
+    }
+  // the energy drained by each periodic update decreases with the cell
+  // voltage, so the energy cannot be depleted before this update, which
+  // replays the previous ones and predicts the depletion again.
+  double periods = std::ceil (m_remainingEnergyJ / (powerW * m_energyUpdateInterval.GetSeconds ()));
+  double maxPeriods = (Simulator::GetMaximumSimulationTime () - m_lastUpdateTime).GetTimeStep ()
+    / (double) m_energyUpdateInterval.GetTimeStep ();
+  if (periods >= maxPeriods)
+    {
+      return; // not depleted before the end of time
+    }
+  m_energyUpdateEvent = Simulator::Schedule (TimeStep ((uint64_t) periods * m_energyUpdateInterval.GetTimeStep ()),
+                                             &LiIonEnergySource::UpdateEnergySource,
+                                             this);
+}
+
 double
 LiIonEnergySource::GetVoltage (double i) const
 {
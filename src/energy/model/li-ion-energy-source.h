@@ -44,6 +44,12 @@ namespace ns3 {
  * If the actual voltage of the cell goes below the minimum threshold voltage, the
  * cell is considered depleted and the energy drained event fired up.
  *
+ * By default, the discharge curve is evaluated by periodic energy updates. If
+ * the "LazyEnergyUpdate" attribute is true, the periodic updates are replayed
+ * without events when the remaining energy is requested or the current drawn
+ * changes, and the only scheduled updates are those predicted to find the
+ * energy depleted.
+ *
  *
  * The model requires several parameters to approximates the discharge curves:
  * - IntialCellVoltage, maximum voltage of the fully charged cell
@@ -150,6 +156,17 @@ public:
    * \returns The interval between each energy update.
    */
   Time GetEnergyUpdateInterval (void) const;
+
+  /**
+   * \param lazy Whether the periodic energy updates are replayed on demand
+   * instead of being scheduled.
+   */
+  void SetLazyEnergyUpdate (bool lazy);
+
+  /**
+   * \returns Whether the periodic energy updates are replayed on demand.
+   */
+  bool GetLazyEnergyUpdate (void) const;
 private:
   void DoInitialize (void);
   void DoDispose (void);
@@ -171,6 +188,29 @@ private:
    */
   void CalculateRemainingEnergy (void);
 
+  /**
+   * \param duration Time since the last energy update.
+   *
+   * Calculates remaining energy, as above, for the given time duration.
+   */
+  void CalculateRemainingEnergy (Time duration);
+
+  /**
+   * Replays the periodic energy updates which happened since the last energy
+   * update, when they are not scheduled.
+   *
+   * \returns false if the energy got depleted.
+   */
+  bool ReplayEnergyUpdates (void);
+
+  /**
+   * Schedules the first periodic energy update which may find the energy
+   * depleted with the current drawn now, when the periodic energy updates are
+   * replayed on demand. As the cell voltage decreases, this update happens at
+   * or before the depletion.
+   */
+  void ScheduleEnergyDepletion (void);
+
   /**
    *  \param current the actual discharge current value.
    *
@@ -188,6 +228,8 @@ private:
   EventId m_energyUpdateEvent;            // energy update event
   Time m_lastUpdateTime;                  // last update time
   Time m_energyUpdateInterval;            // energy update interval
+  bool m_lazyEnergyUpdate;                // replay periodic updates on demand
+  EventId m_depletionEvent;               // prediction of the depletion time
   double m_eFull;                         // initial voltage of the cell, in Volts
   double m_eNom;                          // nominal voltage of the cell, in Volts
   double m_eExp;                          // cell voltage at the end of the exponential zone, in Volts
@@ -20,6 +20,7 @@
 
 #include "ns3/basic-energy-source.h"
 #include "ns3/wifi-radio-energy-model.h"
+#include "ns3/simple-device-energy-model.h"
 #include "ns3/basic-energy-source-helper.h"
 #include "ns3/wifi-radio-energy-model-helper.h"
 #include "ns3/energy-source-container.h"
@@ -31,6 +32,7 @@
 #include "ns3/double.h"
 #include "ns3/config.h"
 #include "ns3/string.h"
+#include "ns3/boolean.h"
 #include "ns3/yans-wifi-helper.h"
 #include "ns3/nqos-wifi-mac-helper.h"
 #include <cmath>
@@ -366,6 +368,124 @@ BasicEnergyDepletionTest::DepletionTestCase (double simTimeS,
 
 // -------------------------------------------------------------------------- //
 
+/**
+ * Test case of the lazy energy updates of BasicEnergySource against the
+ * periodic ones.
+ */
+class BasicEnergyLazyUpdateTest : public TestCase
+{
+public:
+  BasicEnergyLazyUpdateTest ();
+  virtual ~BasicEnergyLazyUpdateTest ();
+
+private:
+  void DoRun (void);
+
+  /**
+   * \param oldValue Previous remaining energy, in Joules.
+   * \param newValue New remaining energy, in Joules.
+   *
+   * Records the time at which the remaining energy is depleted.
+   */
+  void RemainingEnergy (double oldValue, double newValue);
+
+  /**
+   * \param source Energy source to query.
+   *
+   * Records the remaining energy of the source.
+   */
+  void Query (Ptr<BasicEnergySource> source);
+
+  /**
+   * \param lazy Whether the energy updates are lazy.
+   *
+   * Draws several currents from a source, queries its remaining energy and
+   * runs it until depletion.
+   */
+  void Run (bool lazy);
+
+private:
+  std::vector<double> m_remainingEnergyJ; // remaining energy at each query
+  Time m_depletionTime;                   // time of the depletion
+};
+
+BasicEnergyLazyUpdateTest::BasicEnergyLazyUpdateTest ()
+  : TestCase ("Basic energy model lazy energy update test case")
+{
+}
+
+BasicEnergyLazyUpdateTest::~BasicEnergyLazyUpdateTest ()
+{
+}
+
+void
+BasicEnergyLazyUpdateTest::RemainingEnergy (double oldValue, double newValue)
+{
+  if (newValue <= 0 && m_depletionTime.IsZero ())
+    {
+      m_depletionTime = Simulator::Now ();
+    }
+}
+
+void
+BasicEnergyLazyUpdateTest::Query (Ptr<BasicEnergySource> source)
+{
+  m_remainingEnergyJ.push_back (source->GetRemainingEnergy ());
+}
+
+void
+BasicEnergyLazyUpdateTest::Run (bool lazy)
+{
+  m_remainingEnergyJ.clear ();
+  m_depletionTime = Seconds (0);
+
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<BasicEnergySource> source = CreateObject<BasicEnergySource> ();
+  source->SetAttribute ("BasicEnergySourceInitialEnergyJ", DoubleValue (100.0));
+  source->SetAttribute ("BasicEnergySupplyVoltageV", DoubleValue (3.0));
+  source->SetAttribute ("PeriodicEnergyUpdateInterval", TimeValue (Seconds (1.0)));
+  source->SetAttribute ("LazyEnergyUpdate", BooleanValue (lazy));
+  source->TraceConnectWithoutContext ("RemainingEnergy",
+                                      MakeCallback (&BasicEnergyLazyUpdateTest::RemainingEnergy, this));
+  source->SetNode (node);
+  node->AggregateObject (source);
+  Ptr<SimpleDeviceEnergyModel> model = CreateObject<SimpleDeviceEnergyModel> ();
+  model->SetEnergySource (source);
+  source->AppendDeviceEnergyModel (model);
+
+  // 3 W, then 6 W from 10.3 seconds, with queries which move the periodic
+  // updates.
+  Simulator::Schedule (Seconds (0.0), &SimpleDeviceEnergyModel::SetCurrentA, model, 1.0);
+  Simulator::Schedule (Seconds (4.5), &BasicEnergyLazyUpdateTest::Query, this, source);
+  Simulator::Schedule (Seconds (10.3), &SimpleDeviceEnergyModel::SetCurrentA, model, 2.0);
+  Simulator::Schedule (Seconds (15.7), &BasicEnergyLazyUpdateTest::Query, this, source);
+  Simulator::Stop (Seconds (30.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+BasicEnergyLazyUpdateTest::DoRun (void)
+{
+  Run (false);
+  std::vector<double> remainingEnergyJ = m_remainingEnergyJ;
+  Time depletionTime = m_depletionTime;
+  // 69.1 J are left at 10.3 seconds and 36.7 J at 15.7 seconds, which the
+  // seventh update after the query finds depleted.
+  NS_TEST_ASSERT_MSG_EQ (depletionTime, Seconds (22.7), "Incorrect depletion time!");
+
+  Run (true);
+  NS_TEST_ASSERT_MSG_EQ (m_remainingEnergyJ.size (), remainingEnergyJ.size (), "Missing queries!");
+  for (uint32_t i = 0; i < m_remainingEnergyJ.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ_TOL (m_remainingEnergyJ[i], remainingEnergyJ[i], 1.0e-12,
+                                 "Incorrect remaining energy at query " << i << "!");
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_depletionTime, depletionTime, "Incorrect lazy depletion time!");
+}
+
+// -------------------------------------------------------------------------- //
+
 /**
  * Unit test suite for energy model. Although the test suite involves 2 modules
  * it is still considered a unit test. Because a DeviceEnergyModel cannot live
@@ -382,6 +502,7 @@ BasicEnergyModelTestSuite::BasicEnergyModelTestSuite ()
 {
   AddTestCase (new BasicEnergyUpdateTest, TestCase::QUICK);
   AddTestCase (new BasicEnergyDepletionTest, TestCase::QUICK);
+  AddTestCase (new BasicEnergyLazyUpdateTest, TestCase::QUICK);
 }
 
 // create an instance of the test suite
@@ -24,6 +24,9 @@
 #include "ns3/li-ion-energy-source.h"
 #include "ns3/node.h"
 #include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include <vector>
 
 namespace ns3 {
 
@@ -32,17 +35,19 @@ NS_LOG_COMPONENT_DEFINE ("LiIonEnergySourceTestSuite");
 class LiIonEnergyTestCase : public TestCase
 {
 public:
-  LiIonEnergyTestCase ();
+  LiIonEnergyTestCase (bool lazy);
   ~LiIonEnergyTestCase ();
 
   void DoRun (void);
 
   double m_simTime;
+  bool m_lazy;
   Ptr<Node> m_node;
 };
 
-LiIonEnergyTestCase::LiIonEnergyTestCase ()
-  : TestCase ("Li-Ion energy source test case")
+LiIonEnergyTestCase::LiIonEnergyTestCase (bool lazy)
+  : TestCase (lazy ? "Li-Ion energy source test case with lazy energy updates" : "Li-Ion energy source test case"),
+    m_lazy (lazy)
 {
 }
 
@@ -58,6 +63,7 @@ LiIonEnergyTestCase::DoRun ()
 
   Ptr<SimpleDeviceEnergyModel> sem = CreateObject<SimpleDeviceEnergyModel> ();
   Ptr<LiIonEnergySource> es = CreateObject<LiIonEnergySource> ();
+  es->SetAttribute ("LazyEnergyUpdate", BooleanValue (m_lazy));
 
   es->SetNode (m_node);
   sem->SetEnergySource (es);
@@ -78,6 +84,94 @@ LiIonEnergyTestCase::DoRun ()
                              "Incorrect consumed energy!");
 }
 
+/**
+ * Compares the lazy energy updates of LiIonEnergySource with the periodic
+ * ones, which they replay.
+ */
+class LiIonLazyUpdateTestCase : public TestCase
+{
+public:
+  LiIonLazyUpdateTestCase ();
+
+  void DoRun (void);
+  void RemainingEnergy (double oldValue, double newValue);
+  void Query (Ptr<LiIonEnergySource> es);
+  void Run (bool lazy);
+
+  std::vector<double> m_remainingEnergy;
+  std::vector<double> m_voltage;
+  Time m_depletionTime;
+};
+
+LiIonLazyUpdateTestCase::LiIonLazyUpdateTestCase ()
+  : TestCase ("Li-Ion energy source lazy energy update test case")
+{
+}
+
+void
+LiIonLazyUpdateTestCase::RemainingEnergy (double oldValue, double newValue)
+{
+  if (newValue <= 0 && m_depletionTime.IsZero ())
+    {
+      m_depletionTime = Simulator::Now ();
+    }
+}
+
+void
+LiIonLazyUpdateTestCase::Query (Ptr<LiIonEnergySource> es)
+{
+  m_remainingEnergy.push_back (es->GetRemainingEnergy ());
+  m_voltage.push_back (es->GetSupplyVoltage ());
+}
+
+void
+LiIonLazyUpdateTestCase::Run (bool lazy)
+{
+  m_remainingEnergy.clear ();
+  m_voltage.clear ();
+  m_depletionTime = Seconds (0);
+
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<SimpleDeviceEnergyModel> sem = CreateObject<SimpleDeviceEnergyModel> ();
+  Ptr<LiIonEnergySource> es = CreateObject<LiIonEnergySource> ();
+  es->SetAttribute ("LiIonEnergySourceInitialEnergyJ", DoubleValue (5000.0));
+  es->SetAttribute ("LazyEnergyUpdate", BooleanValue (lazy));
+  es->TraceConnectWithoutContext ("RemainingEnergy",
+                                  MakeCallback (&LiIonLazyUpdateTestCase::RemainingEnergy, this));
+
+  es->SetNode (node);
+  sem->SetEnergySource (es);
+  es->AppendDeviceEnergyModel (sem);
+  node->AggregateObject (es);
+
+  Simulator::Schedule (Seconds (0.0), &SimpleDeviceEnergyModel::SetCurrentA, sem, 1.0);
+  Simulator::Schedule (Seconds (100.5), &LiIonLazyUpdateTestCase::Query, this, es);
+  Simulator::Schedule (Seconds (200.25), &SimpleDeviceEnergyModel::SetCurrentA, sem, 2.33);
+  Simulator::Schedule (Seconds (300.0), &LiIonLazyUpdateTestCase::Query, this, es);
+  Simulator::Stop (Seconds (2000));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+LiIonLazyUpdateTestCase::DoRun ()
+{
+  Run (false);
+  std::vector<double> remainingEnergy = m_remainingEnergy;
+  std::vector<double> voltage = m_voltage;
+  Time depletionTime = m_depletionTime;
+  NS_TEST_ASSERT_MSG_EQ (depletionTime.IsZero (), false, "Energy not depleted!");
+
+  Run (true);
+  NS_TEST_ASSERT_MSG_EQ (m_remainingEnergy.size (), remainingEnergy.size (), "Missing queries!");
+  for (uint32_t i = 0; i < m_remainingEnergy.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_remainingEnergy[i], remainingEnergy[i], "Incorrect remaining energy at query " << i);
+      NS_TEST_ASSERT_MSG_EQ (m_voltage[i], voltage[i], "Incorrect voltage at query " << i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_depletionTime, depletionTime, "Incorrect depletion time!");
+}
+
 class LiIonEnergySourceTestSuite : public TestSuite
 {
 public:
@@ -87,7 +181,9 @@ public:
 LiIonEnergySourceTestSuite::LiIonEnergySourceTestSuite ()
   : TestSuite ("li-ion-energy-source", UNIT)
 {
-  AddTestCase (new LiIonEnergyTestCase, TestCase::QUICK);
+  AddTestCase (new LiIonEnergyTestCase (false), TestCase::QUICK);
+  AddTestCase (new LiIonEnergyTestCase (true), TestCase::QUICK);
+  AddTestCase (new LiIonLazyUpdateTestCase, TestCase::QUICK);
 }
 
 // create an instance of the test suite
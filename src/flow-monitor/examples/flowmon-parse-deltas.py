@@ -0,0 +1,110 @@
+from __future__ import division
+import sys
+import csv
+
+# Reads the file written by FlowMonitor::EnablePeriodicCsvExport, or by
+# FlowMonitor::SerializeDeltasToCsvStream, and prints the totals of each
+# flow.  With the --intervals option, also prints the bitrate received by
+# each flow during each export interval.  The interval is read from the
+# comment line that starts the file written by EnablePeriodicCsvExport;
+# for a file without it, give the interval with --interval=SECONDS.
+
+class Flow(object):
+    __slots__ = ['flowId', 'txBytes', 'rxBytes', 'txPackets', 'rxPackets',
+                 'lostPackets', 'timesForwarded', 'delaySum', 'jitterSum',
+                 'intervals']
+    def __init__(self, flowId):
+        self.flowId = flowId
+        self.txBytes = 0
+        self.rxBytes = 0
+        self.txPackets = 0
+        self.rxPackets = 0
+        self.lostPackets = 0
+        self.timesForwarded = 0
+        self.delaySum = 0
+        self.jitterSum = 0
+        self.intervals = [] # (time in nanoseconds, rxBytes)
+
+    def add(self, row):
+        self.txBytes += int(row['txBytes'])
+        self.rxBytes += int(row['rxBytes'])
+        self.txPackets += int(row['txPackets'])
+        self.rxPackets += int(row['rxPackets'])
+        self.lostPackets += int(row['lostPackets'])
+        self.timesForwarded += int(row['timesForwarded'])
+        self.delaySum += int(row['delaySumNs'])
+        self.jitterSum += int(row['jitterSumNs'])
+        time = int(row['timeNs'])
+        # the last write, when the simulator is destroyed, may happen at
+        # the same time as a periodic one
+        if self.intervals and self.intervals[-1][0] == time:
+            self.intervals[-1] = (time, self.intervals[-1][1] + int(row['rxBytes']))
+        else:
+            self.intervals.append((time, int(row['rxBytes'])))
+
+
+def main(argv):
+    show_intervals = False
+    start = 0
+    interval = None
+    files = []
+    for arg in argv[1:]:
+        if arg == '--intervals':
+            show_intervals = True
+        elif arg.startswith('--interval='):
+            interval = int(round(float(arg[len('--interval='):]) * 1e9))
+        else:
+            files.append(arg)
+    if len(files) != 1:
+        sys.stderr.write("usage: %s [--intervals] [--interval=SECONDS] FILE\n" % argv[0])
+        return 1
+
+    flows = {}
+    with open(files[0]) as file_obj:
+        # the comment line written by EnablePeriodicCsvExport, e.g.
+        # "# startNs=0,intervalNs=1000000000"
+        lines = iter(file_obj)
+        for line in lines:
+            if not line.startswith('#'):
+                break
+            fields = dict(field.split('=', 1) for field in line[1:].strip().split(','))
+            start = int(fields.get('startNs', start))
+            if interval is None and 'intervalNs' in fields:
+                interval = int(fields['intervalNs'])
+        else:
+            line = ''
+        for row in csv.DictReader([line] + list(lines)):
+            flowId = int(row['flowId'])
+            if flowId not in flows:
+                flows[flowId] = Flow(flowId)
+            flows[flowId].add(row)
+
+    if show_intervals and not interval:
+        sys.stderr.write("%s: the file does not give the export interval, use --interval=SECONDS\n" % argv[0])
+        return 1
+
+    for flowId in sorted(flows):
+        flow = flows[flowId]
+        print("FlowID: %i" % flow.flowId)
+        print("\tTX packets: %i (%i bytes)" % (flow.txPackets, flow.txBytes))
+        print("\tRX packets: %i (%i bytes)" % (flow.rxPackets, flow.rxBytes))
+        if flow.rxPackets:
+            print("\tMean Delay: %.2f ms" % (flow.delaySum / flow.rxPackets * 1e-6,))
+            print("\tMean Hop Count: %.2f" % (flow.timesForwarded / flow.rxPackets + 1,))
+        if flow.rxPackets + flow.lostPackets:
+            print("\tPacket Loss Ratio: %.2f %%" % (flow.lostPackets / (flow.rxPackets + flow.lostPackets) * 100,))
+        if show_intervals:
+            # the writes happen every interval from the start, and once
+            # more when the simulator is destroyed, so a line covers the
+            # time since the previous interval boundary; the line written
+            # when the export starts covers an unknown time and is skipped
+            for time, rxBytes in flow.intervals:
+                if time <= start:
+                    continue
+                begin = start + ((time - start - 1) // interval) * interval
+                print("\t%.3f s: RX bitrate %.2f kbit/s" % (time * 1e-9, rxBytes * 8 / ((time - begin) * 1e-9) * 1e-3))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
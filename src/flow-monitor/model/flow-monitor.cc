@@ -22,6 +22,7 @@
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/double.h"
+#include "ns3/uinteger.h"
 #include <fstream>
 #include <sstream>
 
@@ -29,6 +30,8 @@
 
 #define PERIODIC_CHECK_INTERVAL (Seconds (1))
 
+#define NO_TRACKED_PACKET (0xffffffff)
+
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("FlowMonitor");
@@ -47,6 +50,11 @@ FlowMonitor::GetTypeId (void)
                    TimeValue (Seconds (10.0)),
                    MakeTimeAccessor (&FlowMonitor::m_maxPerHopDelay),
                    MakeTimeChecker ())
+    .AddAttribute ("MaxTrackedPackets", ("The maximum number of packets in flight that are tracked, 0 for no limit.  "
+                                         "When the limit is reached, the packet seen least recently is considered lost."),
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&FlowMonitor::m_maxTrackedPackets),
+                   MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("StartTime", ("The time when the monitoring starts."),
                    TimeValue (Seconds (0.0)),
                    MakeTimeAccessor (&FlowMonitor::Start),
@@ -82,7 +90,10 @@ FlowMonitor::GetInstanceTypeId (void) const
 }
 
 FlowMonitor::FlowMonitor ()
-  : m_enabled (false)
+  : m_freeTracked (NO_TRACKED_PACKET),
+    m_oldestTracked (NO_TRACKED_PACKET),
+    m_newestTracked (NO_TRACKED_PACKET),
+    m_enabled (false)
 {
   // m_histogramBinWidth=DEFAULT_BIN_WIDTH;
 }
@@ -96,9 +107,97 @@ FlowMonitor::DoDispose (void)
       m_flowProbes[i]->Dispose ();
       m_flowProbes[i] = 0;
     }
+  m_trackedPackets.clear ();
+  m_trackedPool.clear ();
+  m_freeTracked = NO_TRACKED_PACKET;
+  m_oldestTracked = NO_TRACKED_PACKET;
+  m_newestTracked = NO_TRACKED_PACKET;
+  if (m_csvFile.is_open ())
+    {
+      m_csvFile.close ();
+    }
   Object::DoDispose ();
 }
 
+size_t
+FlowMonitor::TrackedPacketKeyHash::operator () (const TrackedPacketKey &key) const
+{
+  return key.first * 2654435761U ^ key.second;
+}
+
+uint32_t
+FlowMonitor::AllocateTrackedPacket (FlowId flowId, FlowPacketId packetId)
+{
+  uint32_t index = m_freeTracked;
+  if (index == NO_TRACKED_PACKET)
+    {
+      index = m_trackedPool.size ();
+      m_trackedPool.push_back (TrackedPacket ());
+    }
+  else
+    {
+      m_freeTracked = m_trackedPool[index].newer;
+    }
+  TrackedPacket &tracked = m_trackedPool[index];
+  tracked.flowId = flowId;
+  tracked.packetId = packetId;
+  tracked.older = NO_TRACKED_PACKET;
+  tracked.newer = NO_TRACKED_PACKET;
+  m_trackedPackets.insert (std::make_pair (TrackedPacketKey (flowId, packetId), index));
+  return index;
+}
+
+void
+FlowMonitor::ReleaseTrackedPacket (uint32_t index)
+{
+  UnlinkTrackedPacket (index);
+  TrackedPacket &tracked = m_trackedPool[index];
+  m_trackedPackets.erase (TrackedPacketKey (tracked.flowId, tracked.packetId));
+  tracked.newer = m_freeTracked;
+  m_freeTracked = index;
+}
+
+void
+FlowMonitor::LinkNewestTrackedPacket (uint32_t index)
+{
+  TrackedPacket &tracked = m_trackedPool[index];
+  tracked.older = m_newestTracked;
+  tracked.newer = NO_TRACKED_PACKET;
+  if (m_newestTracked == NO_TRACKED_PACKET)
+    {
+      m_oldestTracked = index;
+    }
+  else
+    {
+      m_trackedPool[m_newestTracked].newer = index;
+    }
+  m_newestTracked = index;
+}
+
+void
+FlowMonitor::UnlinkTrackedPacket (uint32_t index)
+{
+  TrackedPacket &tracked = m_trackedPool[index];
+  if (tracked.older == NO_TRACKED_PACKET)
+    {
+      m_oldestTracked = tracked.newer;
+    }
+  else
+    {
+      m_trackedPool[tracked.older].newer = tracked.newer;
+    }
+  if (tracked.newer == NO_TRACKED_PACKET)
+    {
+      m_newestTracked = tracked.older;
+    }
+  else
+    {
+      m_trackedPool[tracked.newer].older = tracked.older;
+    }
+  tracked.older = NO_TRACKED_PACKET;
+  tracked.newer = NO_TRACKED_PACKET;
+}
+
 inline FlowMonitor::FlowStats&
 FlowMonitor::GetStatsForFlow (FlowId flowId)
 {
@@ -137,7 +236,30 @@ FlowMonitor::ReportFirstTx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t pack
       return;
     }
   Time now = Simulator::Now ();
-  TrackedPacket &tracked = m_trackedPackets[std::make_pair (flowId, packetId)];
+  uint32_t index;
+  TrackedPacketMap::iterator iter = m_trackedPackets.find (TrackedPacketKey (flowId, packetId));
+  if (iter == m_trackedPackets.end ())
+    {
+      if (m_maxTrackedPackets > 0 && m_trackedPackets.size () >= m_maxTrackedPackets)
+        {
+          // no room left, consider the packet seen least recently as lost
+          TrackedPacket &oldest = m_trackedPool[m_oldestTracked];
+          NS_LOG_DEBUG ("ReportFirstTx: too many tracked packets, considering (flowId=" << oldest.flowId
+                        << ", packetId=" << oldest.packetId << ") as lost.");
+          std::map<FlowId, FlowStats>::iterator flow = m_flowStats.find (oldest.flowId);
+          NS_ASSERT (flow != m_flowStats.end ());
+          flow->second.lostPackets++;
+          ReleaseTrackedPacket (m_oldestTracked);
+        }
+      index = AllocateTrackedPacket (flowId, packetId);
+    }
+  else
+    {
+      index = iter->second;
+      UnlinkTrackedPacket (index);
+    }
+  LinkNewestTrackedPacket (index);
+  TrackedPacket &tracked = m_trackedPool[index];
   tracked.firstSeenTime = now;
   tracked.lastSeenTime = tracked.firstSeenTime;
   tracked.timesForwarded = 0;
@@ -164,19 +286,22 @@ FlowMonitor::ReportForwarding (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t p
     {
       return;
     }
-  std::pair<FlowId, FlowPacketId> key (flowId, packetId);
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (key);
-  if (tracked == m_trackedPackets.end ())
+  TrackedPacketMap::iterator iter = m_trackedPackets.find (TrackedPacketKey (flowId, packetId));
+  if (iter == m_trackedPackets.end ())
     {
       NS_LOG_WARN ("Received packet forward report (flowId=" << flowId << ", packetId=" << packetId
                                                              << ") but not known to be transmitted.");
       return;
     }
 
-  tracked->second.timesForwarded++;
-  tracked->second.lastSeenTime = Simulator::Now ();
+  // the packet becomes the most recently seen one
+  UnlinkTrackedPacket (iter->second);
+  LinkNewestTrackedPacket (iter->second);
+  TrackedPacket &tracked = m_trackedPool[iter->second];
+  tracked.timesForwarded++;
+  tracked.lastSeenTime = Simulator::Now ();
 
-  Time delay = (Simulator::Now () - tracked->second.firstSeenTime);
+  Time delay = (Simulator::Now () - tracked.firstSeenTime);
   probe->AddPacketStats (flowId, packetSize, delay);
 }
 
@@ -188,16 +313,18 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
     {
       return;
     }
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (std::make_pair (flowId, packetId));
-  if (tracked == m_trackedPackets.end ())
+  TrackedPacketMap::iterator iter = m_trackedPackets.find (TrackedPacketKey (flowId, packetId));
+  if (iter == m_trackedPackets.end ())
     {
       NS_LOG_WARN ("Received packet last-tx report (flowId=" << flowId << ", packetId=" << packetId
                                                              << ") but not known to be transmitted.");
       return;
     }
 
+  uint32_t index = iter->second;
+  const TrackedPacket &tracked = m_trackedPool[index];
   Time now = Simulator::Now ();
-  Time delay = (now - tracked->second.firstSeenTime);
+  Time delay = (now - tracked.firstSeenTime);
   probe->AddPacketStats (flowId, packetSize, delay);
 
   FlowStats &stats = GetStatsForFlow (flowId);
@@ -236,12 +363,12 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
         }
     }
   stats.timeLastRxPacket = now;
-  stats.timesForwarded += tracked->second.timesForwarded;
+  stats.timesForwarded += tracked.timesForwarded;
 
   NS_LOG_DEBUG ("ReportLastTx: removing tracked packet (flowId="
                 << flowId << ", packetId=" << packetId << ").");
 
-  m_trackedPackets.erase (tracked); // we don't need to track this packet anymore
+  ReleaseTrackedPacket (index); // we don't need to track this packet anymore
 }
 
 void
@@ -266,14 +393,14 @@ FlowMonitor::ReportDrop (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packetI
   stats.bytesDropped[reasonCode] += packetSize;
   NS_LOG_DEBUG ("++stats.packetsDropped[" << reasonCode<< "]; // becomes: " << stats.packetsDropped[reasonCode]);
 
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (std::make_pair (flowId, packetId));
+  TrackedPacketMap::iterator tracked = m_trackedPackets.find (TrackedPacketKey (flowId, packetId));
   if (tracked != m_trackedPackets.end ())
     {
       // we don't need to track this packet anymore
       // FIXME: this will not necessarily be true with broadcast/multicast
       NS_LOG_DEBUG ("ReportDrop: removing tracked packet (flowId="
                     << flowId << ", packetId=" << packetId << ").");
-      m_trackedPackets.erase (tracked);
+      ReleaseTrackedPacket (tracked->second);
     }
 }
 
@@ -289,24 +416,19 @@ FlowMonitor::CheckForLostPackets (Time maxDelay)
 {
   Time now = Simulator::Now ();
 
-  for (TrackedPacketMap::iterator iter = m_trackedPackets.begin ();
-       iter != m_trackedPackets.end (); )
+  // the tracked packets are linked in the order in which they were last
+  // seen, so the lost ones are all at the head of the list
+  while (m_oldestTracked != NO_TRACKED_PACKET
+         && now - m_trackedPool[m_oldestTracked].lastSeenTime >= maxDelay)
     {
-      if (now - iter->second.lastSeenTime >= maxDelay)
-        {
-          // packet is considered lost, add it to the loss statistics
-          std::map<FlowId, FlowStats>::iterator
-            flow = m_flowStats.find (iter->first.first);
-          NS_ASSERT (flow != m_flowStats.end ());
-          flow->second.lostPackets++;
-
-          // we won't track it anymore
-          m_trackedPackets.erase (iter++);
-        }
-      else
-        {
-          iter++;
-        }
+      // packet is considered lost, add it to the loss statistics
+      std::map<FlowId, FlowStats>::iterator
+        flow = m_flowStats.find (m_trackedPool[m_oldestTracked].flowId);
+      NS_ASSERT (flow != m_flowStats.end ());
+      flow->second.lostPackets++;
+
+      // we won't track it anymore
+      ReleaseTrackedPacket (m_oldestTracked);
     }
 }
 
@@ -494,5 +616,97 @@ FlowMonitor::SerializeToXmlFile (std::string fileName, bool enableHistograms, bo
 }
 
 
+void
+FlowMonitor::SerializeDeltasToCsvStream (std::ostream &os, bool writeHeader)
+{
+  CheckForLostPackets ();
+
+  if (writeHeader)
+    {
+      os << "timeNs,flowId,txBytes,rxBytes,txPackets,rxPackets,lostPackets,timesForwarded,delaySumNs,jitterSumNs\n";
+    }
+  int64_t now = Simulator::Now ().GetNanoSeconds ();
+  std::map<FlowId, ExportedStats>::iterator exported = m_exportedStats.begin ();
+  for (std::map<FlowId, FlowStats>::const_iterator flowI = m_flowStats.begin ();
+       flowI != m_flowStats.end (); flowI++)
+    {
+      const FlowStats &stats = flowI->second;
+      // both maps are sorted by flow id, and a flow is never removed
+      if (exported == m_exportedStats.end () || exported->first != flowI->first)
+        {
+          ExportedStats zero = { 0, 0, 0, 0, 0, 0, Seconds (0), Seconds (0) };
+          exported = m_exportedStats.insert (exported, std::make_pair (flowI->first, zero));
+        }
+      ExportedStats &last = exported->second;
+      exported++;
+      if (stats.txPackets == last.txPackets && stats.rxPackets == last.rxPackets
+          && stats.lostPackets == last.lostPackets && stats.timesForwarded == last.timesForwarded)
+        {
+          continue;
+        }
+      os << now << ',' << flowI->first
+         << ',' << stats.txBytes - last.txBytes
+         << ',' << stats.rxBytes - last.rxBytes
+         << ',' << stats.txPackets - last.txPackets
+         << ',' << stats.rxPackets - last.rxPackets
+         << ',' << stats.lostPackets - last.lostPackets
+         << ',' << stats.timesForwarded - last.timesForwarded
+         << ',' << (stats.delaySum - last.delaySum).GetNanoSeconds ()
+         << ',' << (stats.jitterSum - last.jitterSum).GetNanoSeconds ()
+         << '\n';
+      last.txBytes = stats.txBytes;
+      last.rxBytes = stats.rxBytes;
+      last.txPackets = stats.txPackets;
+      last.rxPackets = stats.rxPackets;
+      last.lostPackets = stats.lostPackets;
+      last.timesForwarded = stats.timesForwarded;
+      last.delaySum = stats.delaySum;
+      last.jitterSum = stats.jitterSum;
+    }
+}
+
+void
+FlowMonitor::EnablePeriodicCsvExport (std::string fileName, Time interval)
+{
+  NS_ASSERT_MSG (!m_csvFile.is_open (), "The periodic CSV export is already enabled");
+  NS_ASSERT (interval.IsStrictlyPositive ());
+  m_csvFile.open (fileName.c_str (), std::ios::out|std::ios::binary);
+  if (!m_csvFile.is_open ())
+    {
+      NS_FATAL_ERROR ("Could not open " << fileName);
+    }
+  m_csvInterval = interval;
+  m_csvFile << "# startNs=" << Simulator::Now ().GetNanoSeconds ()
+            << ",intervalNs=" << m_csvInterval.GetNanoSeconds () << '\n';
+  SerializeDeltasToCsvStream (m_csvFile, true);
+  Simulator::Schedule (m_csvInterval, &FlowMonitor::PeriodicCsvExport, this);
+  // the reference held by the event keeps the monitor alive until then
+  Simulator::ScheduleDestroy (&FlowMonitor::FinishCsvExport, Ptr<FlowMonitor> (this));
+}
+
+void
+FlowMonitor::PeriodicCsvExport ()
+{
+  if (!m_csvFile.is_open ())
+    {
+      return;
+    }
+  SerializeDeltasToCsvStream (m_csvFile, false);
+  m_csvFile.flush ();
+  Simulator::Schedule (m_csvInterval, &FlowMonitor::PeriodicCsvExport, this);
+}
+
+void
+FlowMonitor::FinishCsvExport ()
+{
+  if (!m_csvFile.is_open ())
+    {
+      return;
+    }
+  SerializeDeltasToCsvStream (m_csvFile, false);
+  m_csvFile.close ();
+}
+
+
 } // namespace ns3
 
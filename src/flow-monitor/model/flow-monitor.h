@@ -23,6 +23,7 @@
 
 #include <vector>
 #include <map>
+#include <fstream>
 
 #include "ns3/ptr.h"
 #include "ns3/object.h"
@@ -31,6 +32,7 @@
 #include "ns3/histogram.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
+#include "ns3/sgi-hashmap.h"
 
 namespace ns3 {
 
@@ -201,6 +203,28 @@ public:
   /// \param enableProbes if true, include also the per-probe/flow pair statistics in the output
   void SerializeToXmlFile (std::string fileName, bool enableHistograms, bool enableProbes);
 
+  /// Writes to an std::ostream, as comma-separated values, how the
+  /// counters of each flow changed since the previous call, one line
+  /// per flow whose counters changed.  The columns are the current
+  /// time, the flow id and the increase of txBytes, rxBytes, txPackets,
+  /// rxPackets, lostPackets, timesForwarded, delaySum and jitterSum;
+  /// the times are in nanoseconds.  Summing the lines of a flow gives
+  /// its total counters.
+  /// \param os the output stream
+  /// \param writeHeader if true, write first a line with the names of the columns
+  void SerializeDeltasToCsvStream (std::ostream &os, bool writeHeader);
+  /// Calls SerializeDeltasToCsvStream every interval, and once more when
+  /// the simulator is destroyed, appending the lines to a file, so that
+  /// the statistics of a long simulation are available while it runs.
+  /// The file starts with a comment line, "# startNs=<time>,intervalNs=<interval>",
+  /// giving when the export started and the interval in nanoseconds, since
+  /// no line is written for an interval in which no flow changed.
+  /// The utility script src/flow-monitor/examples/flowmon-parse-deltas.py
+  /// reads such a file.
+  /// \param fileName name or path of the output file that will be created
+  /// \param interval the time between two writes
+  void EnablePeriodicCsvExport (std::string fileName, Time interval);
+
 
 protected:
 
@@ -214,14 +238,51 @@ private:
     Time firstSeenTime; // absolute time when the packet was first seen by a probe
     Time lastSeenTime; // absolute time when the packet was last seen by a probe
     uint32_t timesForwarded; // number of times the packet was reportedly forwarded
+    FlowId flowId; // flow of the packet
+    FlowPacketId packetId; // id of the packet in its flow
+    uint32_t older; // index of the packet seen just before it, if any
+    uint32_t newer; // index of the packet seen just after it, if any
+  };
+
+  // the counters of a flow written by the last SerializeDeltasToCsvStream
+  struct ExportedStats
+  {
+    uint64_t txBytes;
+    uint64_t rxBytes;
+    uint32_t txPackets;
+    uint32_t rxPackets;
+    uint32_t lostPackets;
+    uint32_t timesForwarded;
+    Time delaySum;
+    Time jitterSum;
+  };
+
+  typedef std::pair<FlowId, FlowPacketId> TrackedPacketKey;
+  struct TrackedPacketKeyHash
+  {
+    size_t operator () (const TrackedPacketKey &key) const;
   };
 
   // FlowId --> FlowStats
   std::map<FlowId, FlowStats> m_flowStats;
 
-  // (FlowId,PacketId) --> TrackedPacket
-  typedef std::map< std::pair<FlowId, FlowPacketId>, TrackedPacket> TrackedPacketMap;
+  // FlowId --> counters written by the last SerializeDeltasToCsvStream
+  std::map<FlowId, ExportedStats> m_exportedStats;
+  std::ofstream m_csvFile;
+  Time m_csvInterval;
+
+  // (FlowId,PacketId) --> index of the TrackedPacket in m_trackedPool
+  typedef sgi::hash_map<TrackedPacketKey, uint32_t, TrackedPacketKeyHash> TrackedPacketMap;
   TrackedPacketMap m_trackedPackets;
+  // The tracked packets, and the free entries linked by their newer
+  // index. The tracked packets are also linked from the least to the
+  // most recently seen one, so that the lost packets are found at the
+  // head of the list without scanning all the tracked packets.
+  std::vector<TrackedPacket> m_trackedPool;
+  uint32_t m_freeTracked;
+  uint32_t m_oldestTracked;
+  uint32_t m_newestTracked;
+  uint32_t m_maxTrackedPackets;
   Time m_maxPerHopDelay;
   std::vector< Ptr<FlowProbe> > m_flowProbes;
 
@@ -239,6 +300,12 @@ private:
 
   FlowStats& GetStatsForFlow (FlowId flowId);
   void PeriodicCheckForLostPackets ();
+  void PeriodicCsvExport ();
+  void FinishCsvExport ();
+  uint32_t AllocateTrackedPacket (FlowId flowId, FlowPacketId packetId);
+  void ReleaseTrackedPacket (uint32_t index);
+  void LinkNewestTrackedPacket (uint32_t index);
+  void UnlinkTrackedPacket (uint32_t index);
 };
 
 
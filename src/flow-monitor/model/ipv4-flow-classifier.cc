@@ -94,6 +94,14 @@ bool operator == (const Ipv4FlowClassifier::FiveTuple &t1,
 }
 
 
+size_t
+Ipv4FlowClassifier::FiveTupleHash::operator () (const FiveTuple &tuple) const
+{
+  uint32_t addresses = tuple.sourceAddress.Get () * 2654435761U ^ tuple.destinationAddress.Get ();
+  uint32_t ports = (uint32_t (tuple.sourcePort) << 16 | tuple.destinationPort) ^ tuple.protocol;
+  return addresses * 2654435761U ^ ports;
+}
+
 
 Ipv4FlowClassifier::Ipv4FlowClassifier ()
 {
@@ -139,13 +147,15 @@ Ipv4FlowClassifier::Classify (const Ipv4Header &ipHeader, Ptr<const Packet> ipPa
     }
 
   // try to insert the tuple, but check if it already exists
-  std::pair<std::map<FiveTuple, FlowId>::iterator, bool> insert
+  std::pair<FlowMap::iterator, bool> insert
     = m_flowMap.insert (std::pair<FiveTuple, FlowId> (tuple, 0));
 
   // if the insertion succeeded, we need to assign this tuple a new flow identifier
   if (insert.second)
     {
       insert.first->second = GetNewFlowId ();
+      NS_ASSERT (insert.first->second == m_flows.size () + 1);
+      m_flows.push_back (tuple);
     }
 
   *out_flowId = insert.first->second;
@@ -158,13 +168,9 @@ Ipv4FlowClassifier::Classify (const Ipv4Header &ipHeader, Ptr<const Packet> ipPa
 Ipv4FlowClassifier::FiveTuple
 Ipv4FlowClassifier::FindFlow (FlowId flowId) const
 {
-  for (std::map<FiveTuple, FlowId>::const_iterator
-       iter = m_flowMap.begin (); iter != m_flowMap.end (); iter++)
+  if (flowId >= 1 && flowId <= m_flows.size ())
     {
-      if (iter->second == flowId)
-        {
-          return iter->first;
-        }
+      return m_flows[flowId - 1];
     }
   NS_FATAL_ERROR ("Could not find the flow with ID " << flowId);
   FiveTuple retval = { Ipv4Address::GetZero (), Ipv4Address::GetZero (), 0, 0, 0 };
@@ -178,9 +184,16 @@ Ipv4FlowClassifier::SerializeToXmlStream (std::ostream &os, int indent) const
 
   INDENT (indent); os << "<Ipv4FlowClassifier>\n";
 
+  // list the flows in the order of their tuples
+  std::map<FiveTuple, FlowId> flows;
+  for (uint32_t i = 0; i < m_flows.size (); i++)
+    {
+      flows[m_flows[i]] = i + 1;
+    }
+
   indent += 2;
   for (std::map<FiveTuple, FlowId>::const_iterator
-       iter = m_flowMap.begin (); iter != m_flowMap.end (); iter++)
+       iter = flows.begin (); iter != flows.end (); iter++)
     {
       INDENT (indent);
       os << "<Flow flowId=\"" << iter->second << "\""
@@ -23,9 +23,11 @@
 
 #include <stdint.h>
 #include <map>
+#include <vector>
 
 #include "ns3/ipv4-header.h"
 #include "ns3/flow-classifier.h"
+#include "ns3/sgi-hashmap.h"
 
 namespace ns3 {
 
@@ -63,7 +65,14 @@ public:
 
 private:
 
-  std::map<FiveTuple, FlowId> m_flowMap;
+  struct FiveTupleHash
+  {
+    size_t operator () (const FiveTuple &tuple) const;
+  };
+
+  typedef sgi::hash_map<FiveTuple, FlowId, FiveTupleHash> FlowMap;
+  FlowMap m_flowMap;
+  std::vector<FiveTuple> m_flows; // the tuple of each flow, indexed by flowId - 1
 
 };
 
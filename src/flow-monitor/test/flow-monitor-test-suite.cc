@@ -0,0 +1,343 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// Copyright (c) 2013
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "ns3/flow-monitor.h"
+#include "ns3/flow-probe.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/udp-header.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/test.h"
+#include <fstream>
+#include <sstream>
+
+namespace ns3 {
+
+// A probe which only reports what the test cases tell it to.
+class FlowMonitorTestProbe : public FlowProbe
+{
+public:
+  FlowMonitorTestProbe (Ptr<FlowMonitor> monitor)
+    : FlowProbe (monitor)
+  {
+  }
+};
+
+/**
+ * Report the packets of two flows to a FlowMonitor and check when the
+ * packets which are neither received nor dropped are considered lost.
+ */
+class FlowMonitorLostPacketsTestCase : public TestCase
+{
+public:
+  FlowMonitorLostPacketsTestCase ();
+private:
+  virtual void DoRun (void);
+  void RunUntil (Time time);
+};
+
+FlowMonitorLostPacketsTestCase::FlowMonitorLostPacketsTestCase ()
+  : TestCase ("Check the detection of the lost packets of a FlowMonitor")
+{
+}
+
+void
+FlowMonitorLostPacketsTestCase::RunUntil (Time time)
+{
+  Simulator::Stop (time - Simulator::Now ());
+  Simulator::Run ();
+}
+
+void
+FlowMonitorLostPacketsTestCase::DoRun (void)
+{
+  Ptr<FlowMonitor> monitor = CreateObjectWithAttributes<FlowMonitor> ("MaxPerHopDelay", TimeValue (Seconds (10)));
+  Ptr<FlowProbe> probe = CreateObject<FlowMonitorTestProbe> (monitor);
+  monitor->StartRightNow ();
+
+  monitor->ReportFirstTx (probe, 1, 1, 100);
+  monitor->ReportFirstTx (probe, 1, 2, 100);
+  monitor->ReportFirstTx (probe, 2, 1, 200);
+  RunUntil (Seconds (5));
+  monitor->ReportForwarding (probe, 1, 1, 100);
+  RunUntil (Seconds (6));
+  monitor->ReportLastRx (probe, 1, 2, 100);
+  RunUntil (Seconds (7));
+  monitor->ReportDrop (probe, 2, 1, 200, 0);
+  monitor->ReportFirstTx (probe, 2, 2, 200);
+
+  RunUntil (Seconds (14.5));
+  monitor->CheckForLostPackets ();
+  std::map<FlowId, FlowMonitor::FlowStats> stats = monitor->GetFlowStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats[1].lostPackets, 0, "A forwarded packet is lost too early");
+  NS_TEST_ASSERT_MSG_EQ (stats[1].rxPackets, 1, "Wrong number of received packets");
+  NS_TEST_ASSERT_MSG_EQ (stats[2].lostPackets, 1, "Wrong number of lost packets after a drop");
+
+  // the periodic check finds the packet forwarded at 5 s
+  RunUntil (Seconds (15.5));
+  stats = monitor->GetFlowStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats[1].lostPackets, 1, "A packet not seen for 10 s is not lost");
+  NS_TEST_ASSERT_MSG_EQ (stats[1].timesForwarded, 0, "A lost packet counts as forwarded");
+  NS_TEST_ASSERT_MSG_EQ (stats[2].lostPackets, 1, "A packet is lost too early");
+
+  // a lost packet which shows up later is ignored
+  monitor->ReportLastRx (probe, 1, 1, 100);
+  RunUntil (Seconds (17.5));
+  stats = monitor->GetFlowStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats[1].rxPackets, 1, "A lost packet is received");
+  NS_TEST_ASSERT_MSG_EQ (stats[2].lostPackets, 2, "A packet not seen for 10 s is not lost");
+  NS_TEST_ASSERT_MSG_EQ (stats[1].txPackets, 2, "Wrong number of transmitted packets");
+  NS_TEST_ASSERT_MSG_EQ (stats[2].txPackets, 2, "Wrong number of transmitted packets");
+
+  monitor->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * Track more packets than a FlowMonitor may hold and check that the
+ * least recently seen packets are considered lost.
+ */
+class FlowMonitorMaxTrackedPacketsTestCase : public TestCase
+{
+public:
+  FlowMonitorMaxTrackedPacketsTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+FlowMonitorMaxTrackedPacketsTestCase::FlowMonitorMaxTrackedPacketsTestCase ()
+  : TestCase ("Check the limit on the packets tracked by a FlowMonitor")
+{
+}
+
+void
+FlowMonitorMaxTrackedPacketsTestCase::DoRun (void)
+{
+  Ptr<FlowMonitor> monitor = CreateObjectWithAttributes<FlowMonitor> ("MaxTrackedPackets", UintegerValue (3));
+  Ptr<FlowProbe> probe = CreateObject<FlowMonitorTestProbe> (monitor);
+  monitor->StartRightNow ();
+
+  monitor->ReportFirstTx (probe, 1, 1, 100);
+  monitor->ReportFirstTx (probe, 1, 2, 100);
+  monitor->ReportFirstTx (probe, 1, 3, 100);
+  // forwarding the first packet makes the second one the oldest
+  monitor->ReportForwarding (probe, 1, 1, 100);
+  monitor->ReportFirstTx (probe, 2, 1, 100);
+  std::map<FlowId, FlowMonitor::FlowStats> stats = monitor->GetFlowStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats[1].lostPackets, 1, "The oldest packet is not lost");
+  NS_TEST_ASSERT_MSG_EQ (stats[2].lostPackets, 0, "The new packet is lost");
+
+  monitor->ReportLastRx (probe, 1, 1, 100);
+  monitor->ReportLastRx (probe, 1, 2, 100);
+  monitor->ReportLastRx (probe, 1, 3, 100);
+  monitor->ReportLastRx (probe, 2, 1, 100);
+  stats = monitor->GetFlowStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats[1].rxPackets, 2, "Wrong number of received packets");
+  NS_TEST_ASSERT_MSG_EQ (stats[1].timesForwarded, 1, "Wrong number of forwards");
+  NS_TEST_ASSERT_MSG_EQ (stats[2].rxPackets, 1, "Wrong number of received packets");
+
+  // the entries released by the received packets are reused
+  for (uint32_t i = 10; i < 13; i++)
+    {
+      monitor->ReportFirstTx (probe, 1, i, 100);
+    }
+  for (uint32_t i = 10; i < 13; i++)
+    {
+      monitor->ReportLastRx (probe, 1, i, 100);
+    }
+  stats = monitor->GetFlowStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats[1].lostPackets, 1, "A packet is lost while there is room");
+  NS_TEST_ASSERT_MSG_EQ (stats[1].rxPackets, 5, "Wrong number of received packets");
+
+  monitor->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * Write the changes of the flow statistics twice and check that only the
+ * flows which changed are written, with their increase.
+ */
+class FlowMonitorCsvExportTestCase : public TestCase
+{
+public:
+  FlowMonitorCsvExportTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+FlowMonitorCsvExportTestCase::FlowMonitorCsvExportTestCase ()
+  : TestCase ("Check the CSV export of the changes of the flow statistics")
+{
+}
+
+void
+FlowMonitorCsvExportTestCase::DoRun (void)
+{
+  Ptr<FlowMonitor> monitor = CreateObject<FlowMonitor> ();
+  Ptr<FlowProbe> probe = CreateObject<FlowMonitorTestProbe> (monitor);
+  monitor->StartRightNow ();
+
+  monitor->ReportFirstTx (probe, 1, 1, 100);
+  monitor->ReportFirstTx (probe, 2, 1, 200);
+  monitor->ReportFirstTx (probe, 2, 2, 200);
+  Simulator::Stop (MilliSeconds (3));
+  Simulator::Run ();
+  monitor->ReportForwarding (probe, 2, 1, 200);
+  monitor->ReportLastRx (probe, 2, 1, 200);
+  std::ostringstream first;
+  monitor->SerializeDeltasToCsvStream (first, true);
+  NS_TEST_ASSERT_MSG_EQ (first.str (),
+                         "timeNs,flowId,txBytes,rxBytes,txPackets,rxPackets,lostPackets,timesForwarded,delaySumNs,jitterSumNs\n"
+                         "3000000,1,100,0,1,0,0,0,0,0\n"
+                         "3000000,2,400,200,2,1,0,1,3000000,0\n",
+                         "Wrong first export");
+
+  Simulator::Stop (MilliSeconds (2));
+  Simulator::Run ();
+  monitor->ReportLastRx (probe, 2, 2, 200);
+  monitor->ReportFirstTx (probe, 3, 1, 300);
+  std::ostringstream second;
+  monitor->SerializeDeltasToCsvStream (second, false);
+  NS_TEST_ASSERT_MSG_EQ (second.str (),
+                         "5000000,2,0,200,0,1,0,0,5000000,2000000\n"
+                         "5000000,3,300,0,1,0,0,0,0,0\n",
+                         "Wrong second export");
+
+  std::ostringstream third;
+  monitor->SerializeDeltasToCsvStream (third, false);
+  NS_TEST_ASSERT_MSG_EQ (third.str (), "", "Unchanged flows are exported");
+
+  monitor->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * Export the changes of the flow statistics periodically to a file and
+ * check that the file tells the export interval, as no line is written
+ * for an interval in which no flow changed.
+ */
+class FlowMonitorPeriodicCsvExportTestCase : public TestCase
+{
+public:
+  FlowMonitorPeriodicCsvExportTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+FlowMonitorPeriodicCsvExportTestCase::FlowMonitorPeriodicCsvExportTestCase ()
+  : TestCase ("Check the periodic CSV export of the changes of the flow statistics")
+{
+}
+
+void
+FlowMonitorPeriodicCsvExportTestCase::DoRun (void)
+{
+  std::string fileName = CreateTempDirFilename ("flow-monitor-deltas.csv");
+  Ptr<FlowMonitor> monitor = CreateObject<FlowMonitor> ();
+  Ptr<FlowProbe> probe = CreateObject<FlowMonitorTestProbe> (monitor);
+  monitor->StartRightNow ();
+  monitor->EnablePeriodicCsvExport (fileName, MilliSeconds (1));
+
+  Simulator::Schedule (MicroSeconds (500), &FlowMonitor::ReportFirstTx, monitor, probe, 1, 1, 100);
+  Simulator::Schedule (MicroSeconds (2500), &FlowMonitor::ReportLastRx, monitor, probe, 1, 1, 100);
+  Simulator::Stop (MicroSeconds (3500));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::ifstream file (fileName.c_str ());
+  std::ostringstream contents;
+  contents << file.rdbuf ();
+  NS_TEST_ASSERT_MSG_EQ (contents.str (),
+                         "# startNs=0,intervalNs=1000000\n"
+                         "timeNs,flowId,txBytes,rxBytes,txPackets,rxPackets,lostPackets,timesForwarded,delaySumNs,jitterSumNs\n"
+                         "1000000,1,100,0,1,0,0,0,0,0\n"
+                         "3000000,1,0,100,0,1,0,0,2000000,0\n",
+                         "Wrong periodic export");
+
+  monitor->Dispose ();
+}
+
+/**
+ * Classify the packets of a few UDP flows and find their tuples back.
+ */
+class Ipv4FlowClassifierTestCase : public TestCase
+{
+public:
+  Ipv4FlowClassifierTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4FlowClassifierTestCase::Ipv4FlowClassifierTestCase ()
+  : TestCase ("Check the flows of Ipv4FlowClassifier")
+{
+}
+
+void
+Ipv4FlowClassifierTestCase::DoRun (void)
+{
+  Ipv4FlowClassifier classifier;
+  for (uint32_t i = 0; i < 200; i++)
+    {
+      Ipv4Header ipHeader;
+      ipHeader.SetSource (Ipv4Address (0x0a000001 + i % 100));
+      ipHeader.SetDestination (Ipv4Address ("10.1.0.1"));
+      ipHeader.SetProtocol (17);
+      ipHeader.SetIdentification (i);
+      UdpHeader udpHeader;
+      udpHeader.SetSourcePort (1000 + i % 100);
+      udpHeader.SetDestinationPort (9);
+      Ptr<Packet> packet = Create<Packet> (10);
+      packet->AddHeader (udpHeader);
+
+      uint32_t flowId;
+      uint32_t packetId;
+      NS_TEST_ASSERT_MSG_EQ (classifier.Classify (ipHeader, packet, &flowId, &packetId), true, "Packet " << i << " not classified");
+      NS_TEST_ASSERT_MSG_EQ (flowId, 1 + i % 100, "Wrong flow of packet " << i);
+      NS_TEST_ASSERT_MSG_EQ (packetId, i, "Wrong id of packet " << i);
+    }
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Ipv4FlowClassifier::FiveTuple tuple = classifier.FindFlow (i + 1);
+      NS_TEST_ASSERT_MSG_EQ (tuple.sourceAddress, Ipv4Address (0x0a000001 + i), "Wrong source of flow " << i + 1);
+      NS_TEST_ASSERT_MSG_EQ (tuple.destinationAddress, Ipv4Address ("10.1.0.1"), "Wrong destination of flow " << i + 1);
+      NS_TEST_ASSERT_MSG_EQ (tuple.sourcePort, 1000 + i, "Wrong source port of flow " << i + 1);
+      NS_TEST_ASSERT_MSG_EQ (tuple.destinationPort, 9, "Wrong destination port of flow " << i + 1);
+    }
+}
+
+class FlowMonitorTestSuite : public TestSuite
+{
+public:
+  FlowMonitorTestSuite ();
+};
+
+FlowMonitorTestSuite::FlowMonitorTestSuite ()
+  : TestSuite ("flow-monitor", UNIT)
+{
+  AddTestCase (new FlowMonitorLostPacketsTestCase (), TestCase::QUICK);
+  AddTestCase (new FlowMonitorMaxTrackedPacketsTestCase (), TestCase::QUICK);
+  AddTestCase (new FlowMonitorCsvExportTestCase (), TestCase::QUICK);
+  AddTestCase (new FlowMonitorPeriodicCsvExportTestCase (), TestCase::QUICK);
+  AddTestCase (new Ipv4FlowClassifierTestCase (), TestCase::QUICK);
+}
+
+static FlowMonitorTestSuite g_flowMonitorTestSuite;
+
+} // namespace ns3
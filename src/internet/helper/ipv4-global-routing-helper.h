@@ -83,6 +83,19 @@ public:
    *
    */
   static void RecomputeRoutingTables (void);
+  /**
+   * \brief Update the routes that were previously installed in a prior call
+   * to PopulateRoutingTables(), RecomputeRoutingTables() or
+   * UpdateRoutingTables(), after a change of the topology.
+   *
+   * Like RecomputeRoutingTables(), but the shortest path trees of the
+   * previous computation are reused: only the nodes whose tree might
+   * contain a changed link run the SPF computation again.  The trees are
+   * kept in memory from one call of this method to the next one, until
+   * the routes are recomputed by other means, so its first call
+   * recomputes all of the routes.
+   */
+  static void UpdateRoutingTables (void);
 private:
   /**
    * \internal
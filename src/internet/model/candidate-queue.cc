@@ -44,22 +44,30 @@ operator<< (std::ostream& os, const CandidateQueue& q)
 {
   typedef CandidateQueue::CandidateList_t List_t;
   typedef List_t::const_iterator CIter_t;
-  const CandidateQueue::CandidateList_t& list = q.m_candidates;
+  List_t list = q.m_candidates;
+  std::sort (list.begin (), list.end (), &CandidateQueue::CompareCandidate);
 
   os << "*** CandidateQueue Begin (<id, distance, LSA-type>) ***" << std::endl;
   for (CIter_t iter = list.begin (); iter != list.end (); iter++)
     {
       os << "<" 
-      << (*iter)->GetVertexId () << ", "
-      << (*iter)->GetDistanceFromRoot () << ", "
-      << (*iter)->GetVertexType () << ">" << std::endl;
+      << iter->vertex->GetVertexId () << ", "
+      << iter->vertex->GetDistanceFromRoot () << ", "
+      << iter->vertex->GetVertexType () << ">" << std::endl;
     }
   os << "*** CandidateQueue End ***";
   return os;
 }
 
+size_t
+CandidateQueue::SPFVertexHash::operator() (const SPFVertex *v) const
+{
+  return reinterpret_cast<size_t> (v) / sizeof (void *);
+}
+
 CandidateQueue::CandidateQueue()
-  : m_candidates ()
+  : m_candidates (),
+    m_sequence (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -87,11 +95,13 @@ CandidateQueue::Push (SPFVertex *vNew)
 {
   NS_LOG_FUNCTION (this << vNew);
 
-  CandidateList_t::iterator i = std::upper_bound (
-      m_candidates.begin (), m_candidates.end (), vNew,
-      &CandidateQueue::CompareSPFVertex
-      );
-  m_candidates.insert (i, vNew);
+  Candidate c;
+  c.vertex = vNew;
+  Update (c);
+  m_candidates.push_back (c);
+  SiftUp (m_candidates.size () - 1);
+  // if several vertices have the same id, the first one is kept.
+  m_vertices.insert (std::make_pair (vNew->GetVertexId (), vNew));
 }
 
 SPFVertex *
@@ -103,8 +113,20 @@ CandidateQueue::Pop (void)
       return 0;
     }
 
-  SPFVertex *v = m_candidates.front ();
-  m_candidates.pop_front ();
+  SPFVertex *v = m_candidates.front ().vertex;
+  m_positions.erase (v);
+  Candidate last = m_candidates.back ();
+  m_candidates.pop_back ();
+  if (!m_candidates.empty ())
+    {
+      SetCandidate (0, last);
+      SiftDown (0);
+    }
+  sgi::hash_map<Ipv4Address, SPFVertex *, Ipv4AddressHash>::iterator i = m_vertices.find (v->GetVertexId ());
+  if (i != m_vertices.end () && i->second == v)
+    {
+      m_vertices.erase (i);
+    }
   return v;
 }
 
@@ -117,7 +139,7 @@ CandidateQueue::Top (void) const
       return 0;
     }
 
-  return m_candidates.front ();
+  return m_candidates.front ().vertex;
 }
 
 bool
@@ -138,18 +160,24 @@ SPFVertex *
 CandidateQueue::Find (const Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this);
-  CandidateList_t::const_iterator i = m_candidates.begin ();
-
-  for (; i != m_candidates.end (); i++)
+  sgi::hash_map<Ipv4Address, SPFVertex *, Ipv4AddressHash>::const_iterator i = m_vertices.find (addr);
+  if (i != m_vertices.end ())
     {
-      SPFVertex *v = *i;
-      if (v->GetVertexId () == addr)
+      return i->second;
+    }
+  // The first vertex pushed with this id is gone but there might be
+  // others with the same id: return the closest one.
+  const Candidate *found = 0;
+  for (CandidateList_t::const_iterator j = m_candidates.begin (); j != m_candidates.end (); j++)
+    {
+      if (j->vertex->GetVertexId () == addr
+          && (found == 0 || CompareCandidate (*j, *found)))
         {
-          return v;
+          found = &(*j);
         }
     }
 
-  return 0;
+  return found == 0 ? 0 : found->vertex;
 }
 
 void
@@ -157,11 +185,121 @@ CandidateQueue::Reorder (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_candidates.sort (&CandidateQueue::CompareSPFVertex);
+  // Renumber the vertices whose key changed in their previous order,
+  // as a stable sort of the queue would keep them.
+  CandidateList_t changed;
+  for (CandidateList_t::const_iterator i = m_candidates.begin (); i != m_candidates.end (); i++)
+    {
+      if (i->distance != i->vertex->GetDistanceFromRoot ()
+          || i->network != (i->vertex->GetVertexType () == SPFVertex::VertexNetwork))
+        {
+          changed.push_back (*i);
+        }
+    }
+  std::sort (changed.begin (), changed.end (), &CandidateQueue::CompareCandidate);
+  for (CandidateList_t::iterator i = changed.begin (); i != changed.end (); i++)
+    {
+      Candidate &c = m_candidates[m_positions[i->vertex]];
+      Update (c);
+    }
+  for (uint32_t i = m_candidates.size () / 2; i > 0; i--)
+    {
+      SiftDown (i - 1);
+    }
   NS_LOG_LOGIC ("After reordering the CandidateQueue");
   NS_LOG_LOGIC (*this);
 }
 
+void
+CandidateQueue::Reorder (SPFVertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+
+  sgi::hash_map<const SPFVertex *, uint32_t, SPFVertexHash>::const_iterator i = m_positions.find (v);
+  NS_ASSERT_MSG (i != m_positions.end (), "CandidateQueue::Reorder (): vertex not in the queue");
+  Candidate &c = m_candidates[i->second];
+  if (c.distance == v->GetDistanceFromRoot ()
+      && c.network == (v->GetVertexType () == SPFVertex::VertexNetwork))
+    {
+      return;
+    }
+  Update (c);
+  SiftUp (i->second);
+  SiftDown (m_positions[v]);
+}
+
+void
+CandidateQueue::Update (Candidate &c)
+{
+  c.distance = c.vertex->GetDistanceFromRoot ();
+  c.network = c.vertex->GetVertexType () == SPFVertex::VertexNetwork;
+  c.sequence = m_sequence++;
+}
+
+void
+CandidateQueue::SetCandidate (uint32_t i, const Candidate &c)
+{
+  m_candidates[i] = c;
+  m_positions[c.vertex] = i;
+}
+
+void
+CandidateQueue::SiftUp (uint32_t i)
+{
+  Candidate c = m_candidates[i];
+  while (i > 0)
+    {
+      uint32_t parent = (i - 1) / 2;
+      if (!CompareCandidate (c, m_candidates[parent]))
+        {
+          break;
+        }
+      SetCandidate (i, m_candidates[parent]);
+      i = parent;
+    }
+  SetCandidate (i, c);
+}
+
+void
+CandidateQueue::SiftDown (uint32_t i)
+{
+  Candidate c = m_candidates[i];
+  uint32_t n = m_candidates.size ();
+  for (;;)
+    {
+      uint32_t child = 2 * i + 1;
+      if (child >= n)
+        {
+          break;
+        }
+      if (child + 1 < n && CompareCandidate (m_candidates[child + 1], m_candidates[child]))
+        {
+          child++;
+        }
+      if (!CompareCandidate (m_candidates[child], c))
+        {
+          break;
+        }
+      SetCandidate (i, m_candidates[child]);
+      i = child;
+    }
+  SetCandidate (i, c);
+}
+
+bool
+CandidateQueue::CompareCandidate (const Candidate &c1, const Candidate &c2)
+{
+  if (c1.distance != c2.distance)
+    {
+      return c1.distance < c2.distance;
+    }
+  if (c1.network != c2.network)
+    {
+      return c1.network;
+    }
+  return c1.sequence < c2.sequence;
+}
+
 /*
  * In this implementation, SPFVertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
@@ -22,8 +22,9 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <vector>
 #include "ns3/ipv4-address.h"
+#include "ns3/sgi-hashmap.h"
 
 namespace ns3 {
 
@@ -45,6 +46,12 @@ class SPFVertex;
  * for a Find () operation, the dynamic nature of the data and the derived
  * requirement for a Reorder () operation led us to implement this simple 
  * enhanced priority queue.
+ *
+ * The queue is a binary heap indexed by vertex so that Push, Pop and
+ * Reorder (SPFVertex *) take logarithmic time and Find takes constant
+ * time.  Vertices which compare equal are popped in the order in which
+ * they were pushed; a vertex whose distance was decreased is considered
+ * to have been pushed again when the queue is reordered.
  */
 class CandidateQueue
 {
@@ -162,6 +169,19 @@ public:
  */
   void Reorder (void);
 
+/**
+ * @brief Restores the priority order of the Candidate Queue after the
+ * value of m_distanceFromRoot of a single vertex of the queue was
+ * decreased.
+ * @internal
+ *
+ * This is equivalent to, but faster than, Reorder ().
+ *
+ * @see SPFVertex
+ * @param v The Shortest Path First Vertex whose distance changed.
+ */
+  void Reorder (SPFVertex *v);
+
 private:
 /**
  * Candidate Queue copy construction is disallowed (not implemented) to 
@@ -189,8 +209,39 @@ private:
  */
   static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
 
-  typedef std::list<SPFVertex*> CandidateList_t;
+/**
+ * \brief An element of the heap.
+ *
+ * The distance and type of the vertex are cached so that Reorder ()
+ * can find the vertices whose distance changed.
+ */
+  struct Candidate
+  {
+    SPFVertex *vertex;
+    uint32_t distance;
+    bool network;
+    uint32_t sequence;
+  };
+  struct SPFVertexHash
+  {
+    size_t operator() (const SPFVertex *v) const;
+  };
+/**
+ * \return True if c1 should be popped before c2; false otherwise
+ */
+  static bool CompareCandidate (const Candidate &c1, const Candidate &c2);
+  void SetCandidate (uint32_t i, const Candidate &c);
+  void SiftUp (uint32_t i);
+  void SiftDown (uint32_t i);
+  void Update (Candidate &c);
+
+  typedef std::vector<Candidate> CandidateList_t;
   CandidateList_t m_candidates;
+  /// the position of each vertex in m_candidates
+  sgi::hash_map<const SPFVertex *, uint32_t, SPFVertexHash> m_positions;
+  /// the vertices of the queue by vertex id
+  sgi::hash_map<Ipv4Address, SPFVertex *, Ipv4AddressHash> m_vertices;
+  uint32_t m_sequence;
 
   friend std::ostream& operator<< (std::ostream& os, const CandidateQueue& q);
 };
@@ -26,6 +26,7 @@
 #include <vector>
 #include <queue>
 #include <algorithm>
+#include <iterator>
 #include <iostream>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
@@ -439,6 +440,7 @@ GlobalRouteManagerLSDB::~GlobalRouteManagerLSDB ()
     }
   NS_LOG_LOGIC ("clear map");
   m_database.clear ();
+  m_linkData.clear ();
 }
 
 void
@@ -461,9 +463,26 @@ GlobalRouteManagerLSDB::Insert (Ipv4Address addr, GlobalRoutingLSA* lsa)
     {
       m_extdatabase.push_back (lsa);
     } 
-  else
+  else if (m_database.insert (LSDBPair_t (addr, lsa)).second)
     {
-      m_database.insert (LSDBPair_t (addr, lsa));
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+          if (lr->GetLinkType () != GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              continue;
+            }
+          // keep the LSA which comes first in the database
+          LinkDataMap_t::iterator k = m_linkData.find (lr->GetLinkData ());
+          if (k == m_linkData.end ())
+            {
+              m_linkData.insert (std::make_pair (lr->GetLinkData (), LSDBPair_t (addr, lsa)));
+            }
+          else if (addr < k->second.first)
+            {
+              k->second = LSDBPair_t (addr, lsa);
+            }
+        }
     }
 }
 
@@ -488,13 +507,10 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i != m_database.end ())
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return i->second;
     }
   return 0;
 }
@@ -504,24 +520,91 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
 //
-// Look up an LSA by its address.
+// Look up an LSA by the link data of one of its TransitNetwork link records.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LinkDataMap_t::const_iterator i = m_linkData.find (addr);
+  if (i != m_linkData.end ())
     {
-      GlobalRoutingLSA* temp = i->second;
-// Iterate among temp's Link Records
-      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
+      return i->second.second;
+    }
+  return 0;
+}
+
+bool
+GlobalRouteManagerLSDB::IsSameLSA (GlobalRoutingLSA *lsa1, GlobalRoutingLSA *lsa2)
+{
+  if (lsa1->GetLSType () != lsa2->GetLSType ()
+      || lsa1->GetLinkStateId () != lsa2->GetLinkStateId ()
+      || lsa1->GetAdvertisingRouter () != lsa2->GetAdvertisingRouter ()
+      || lsa1->GetNetworkLSANetworkMask () != lsa2->GetNetworkLSANetworkMask ()
+      || lsa1->GetNAttachedRouters () != lsa2->GetNAttachedRouters ()
+      || lsa1->GetNLinkRecords () != lsa2->GetNLinkRecords ())
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < lsa1->GetNAttachedRouters (); i++)
+    {
+      if (lsa1->GetAttachedRouter (i) != lsa2->GetAttachedRouter (i))
+        {
+          return false;
+        }
+    }
+  for (uint32_t i = 0; i < lsa1->GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord *lr1 = lsa1->GetLinkRecord (i);
+      GlobalRoutingLinkRecord *lr2 = lsa2->GetLinkRecord (i);
+      if (lr1->GetLinkType () != lr2->GetLinkType ()
+          || lr1->GetLinkId () != lr2->GetLinkId ()
+          || lr1->GetLinkData () != lr2->GetLinkData ()
+          || lr1->GetMetric () != lr2->GetMetric ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+bool
+GlobalRouteManagerLSDB::Compare (const GlobalRouteManagerLSDB *other, std::vector<Ipv4Address> &ids) const
+{
+  NS_LOG_FUNCTION (this << other);
+  LSDBMap_t::const_iterator i = m_database.begin ();
+  LSDBMap_t::const_iterator j = other->m_database.begin ();
+  while (i != m_database.end () || j != other->m_database.end ())
+    {
+      if (j == other->m_database.end () || (i != m_database.end () && i->first < j->first))
+        {
+          ids.push_back (i->first);
+          i++;
+        }
+      else if (i == m_database.end () || j->first < i->first)
         {
-          GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
-          if ( lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork &&
-               lr->GetLinkData () == addr)
+          ids.push_back (j->first);
+          j++;
+        }
+      else
+        {
+          if (!IsSameLSA (i->second, j->second))
             {
-              return temp;
+              ids.push_back (i->first);
             }
+          i++;
+          j++;
         }
     }
-  return 0;
+
+  if (m_extdatabase.size () != other->m_extdatabase.size ())
+    {
+      return false;
+    }
+  for (uint32_t k = 0; k < m_extdatabase.size (); k++)
+    {
+      if (!IsSameLSA (m_extdatabase[k], other->m_extdatabase[k]))
+        {
+          return false;
+        }
+    }
+  return true;
 }
 
 // ---------------------------------------------------------------------------
@@ -532,7 +615,9 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfroot (0),
+    m_spfrootNode (NodeList::End ()),
+    m_keepSpfTrees (false)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
@@ -541,6 +626,7 @@ GlobalRouteManagerImpl::GlobalRouteManagerImpl ()
 GlobalRouteManagerImpl::~GlobalRouteManagerImpl ()
 {
   NS_LOG_FUNCTION (this);
+  DeleteSPFTrees ();
   if (m_lsdb)
     {
       delete m_lsdb;
@@ -551,6 +637,7 @@ void
 GlobalRouteManagerImpl::DebugUseLsdb (GlobalRouteManagerLSDB* lsdb)
 {
   NS_LOG_FUNCTION (this << lsdb);
+  DeleteSPFTrees ();
   if (m_lsdb)
     {
       delete m_lsdb;
@@ -571,20 +658,12 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
         {
           continue;
         }
-      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-      uint32_t j = 0;
-      uint32_t nRoutes = gr->GetNRoutes ();
-      NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
-      // Each time we delete route 0, the route index shifts downward
-      // We can delete all routes if we delete the route numbered 0
-      // nRoutes times
-      for (j = 0; j < nRoutes; j++)
-        {
-          NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
-          gr->RemoveRoute (0);
-        }
-      NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+      DeleteGlobalRoutes (router);
     }
+  // The SPF trees are only kept from one call of UpdateGlobalRoutes to the
+  // next one
+  DeleteSPFTrees ();
+  m_keepSpfTrees = false;
   if (m_lsdb)
     {
       NS_LOG_LOGIC ("Deleting LSDB, creating new one");
@@ -593,6 +672,36 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
     }
 }
 
+void
+GlobalRouteManagerImpl::DeleteGlobalRoutes (Ptr<GlobalRouter> router)
+{
+  NS_LOG_FUNCTION (this << router);
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  uint32_t j = 0;
+  uint32_t nRoutes = gr->GetNRoutes ();
+  NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from router " << router->GetRouterId ());
+  // Each time we delete route 0, the route index shifts downward
+  // We can delete all routes if we delete the route numbered 0
+  // nRoutes times
+  for (j = 0; j < nRoutes; j++)
+    {
+      NS_LOG_LOGIC ("Deleting global route " << j << " from router " << router->GetRouterId ());
+      gr->RemoveRoute (0);
+    }
+  NS_LOG_LOGIC ("Deleted " << j << " global routes from router "<< router->GetRouterId ());
+}
+
+void
+GlobalRouteManagerImpl::DeleteSPFTrees (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (SPFTreeMap_t::iterator i = m_spfTrees.begin (); i != m_spfTrees.end (); i++)
+    {
+      delete i->second.vertices.front ();
+    }
+  m_spfTrees.clear ();
+}
+
 //
 // In order to build the routing database, we need to walk the list of nodes
 // in the system and look for those that support the GlobalRouter interface.
@@ -689,6 +798,7 @@ void
 GlobalRouteManagerImpl::InitializeRoutes ()
 {
   NS_LOG_FUNCTION (this);
+  DeleteSPFTrees ();
 //
 // Walk the list of nodes in the system.
 //
@@ -950,7 +1060,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // If we've changed the cost to get to the vertex represented by <w>, we 
 // must reorder the priority queue keyed to that cost.
 //
-                  candidate.Reorder ();
+                  candidate.Reorder (cw);
                 }
             } // new lower cost path found
         } // end W is already on the candidate list
@@ -1114,7 +1224,7 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
         }
       else 
         {
-          w->SetRootExitDirection (v->GetRootExitDirection ());
+          w->InheritAllRootExitDirections (v);
         }
     }
   else 
@@ -1327,6 +1437,37 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
   return false;
 }
 
+//
+// Find the position in the NodeList of the node whose router ID is routerId.
+// The LSA of the router normally knows its node; otherwise, walk the list.
+//
+NodeList::Iterator
+GlobalRouteManagerImpl::FindRootNode (Ipv4Address routerId) const
+{
+  NS_LOG_FUNCTION (this << routerId);
+  NodeList::Iterator listEnd = NodeList::End ();
+  GlobalRoutingLSA *lsa = m_lsdb->GetLSA (routerId);
+  if (lsa != 0 && NodeList::GetNNodes () > 0)
+    {
+      Ptr<Node> node = lsa->GetNode ();
+      NodeList::Iterator i = NodeList::Begin () + node->GetId ();
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      if (rtr != 0 && rtr->GetRouterId () == routerId)
+        {
+          return i;
+        }
+    }
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<GlobalRouter> rtr = (*i)->GetObject<GlobalRouter> ();
+      if (rtr != 0 && rtr->GetRouterId () == routerId)
+        {
+          return i;
+        }
+    }
+  return listEnd;
+}
+
 // quagga ospf_spf_calculate
 void
 GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
@@ -1356,6 +1497,8 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // We also mark this vertex as being in the SPF tree.
 //
   m_spfroot= v;
+  m_spfrootNode = FindRootNode (root);
+  std::vector<SPFVertex*> vertices (1, v);
   v->SetDistanceFromRoot (0);
   v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
@@ -1371,6 +1514,8 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
       delete m_spfroot;
+      m_spfroot = 0;
+      m_spfrootNode = NodeList::End ();
       return;
     }
 
@@ -1427,6 +1572,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // to now.
 //
       SPFVertexAddParent (v);
+      vertices.push_back (v);
 //
 // Note that when there is a choice of vertices closest to the root, network
 // vertices must be chosen before router vertices in order to necessarily
@@ -1476,6 +1622,36 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
     }  // end for loop
 
 // Second stage of SPF calculation procedure
+  SPFInstallStubsAndExternals ();
+
+//
+// We're all done setting the routing information for the node at the root of
+// the SPF tree.  Delete all of the vertices and corresponding resources, or
+// keep them for UpdateGlobalRoutes.  Go possibly do it again for the next
+// router.
+//
+  if (m_keepSpfTrees)
+    {
+      SPFTree &tree = m_spfTrees[root];
+      NS_ASSERT (tree.vertices.empty ());
+      tree.vertices.swap (vertices);
+      for (std::vector<SPFVertex*>::const_iterator i = tree.vertices.begin (); i != tree.vertices.end (); i++)
+        {
+          tree.index[(*i)->GetVertexId ()] = *i;
+        }
+    }
+  else
+    {
+      delete m_spfroot;
+    }
+  m_spfroot = 0;
+  m_spfrootNode = NodeList::End ();
+}
+
+void
+GlobalRouteManagerImpl::SPFInstallStubsAndExternals (void)
+{
+  NS_LOG_FUNCTION (this);
   SPFProcessStubs (m_spfroot);
   for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
     {
@@ -1484,14 +1660,246 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
       NS_LOG_LOGIC ("Processing External LSA with id " << extlsa->GetLinkStateId ());
       ProcessASExternals (m_spfroot, extlsa);
     }
+}
 
 //
-// We're all done setting the routing information for the node at the root of
-// the SPF tree.  Delete all of the vertices and corresponding resources.  Go
-// possibly do it again for the next router.
+// Install again the routes of the root of a kept SPF tree, after its routes
+// were deleted.  The vertices are visited in the order in which SPFCalculate
+// added them to the tree, so the routes are added in the same order as by a
+// full computation, and the ECMP lookups choose the same next hops.
 //
-  delete m_spfroot;
+void
+GlobalRouteManagerImpl::SPFInstallTreeRoutes (const SPFTree &tree)
+{
+  NS_LOG_FUNCTION (this);
+  m_spfroot = tree.vertices.front ();
+  m_spfrootNode = FindRootNode (m_spfroot->GetVertexId ());
+  for (std::vector<SPFVertex*>::const_iterator i = tree.vertices.begin () + 1; i != tree.vertices.end (); i++)
+    {
+      if ((*i)->GetVertexType () == SPFVertex::VertexRouter)
+        {
+          SPFIntraAddRouter (*i);
+        }
+      else
+        {
+          SPFIntraAddTransit (*i);
+        }
+    }
+  m_spfroot->ClearVertexProcessed ();
+  SPFInstallStubsAndExternals ();
   m_spfroot = 0;
+  m_spfrootNode = NodeList::End ();
+}
+
+bool
+GlobalRouteManagerImpl::SPFEdge::operator< (const SPFEdge &o) const
+{
+  if (to != o.to)
+    {
+      return to < o.to;
+    }
+  if (metric != o.metric)
+    {
+      return metric < o.metric;
+    }
+  return linkData < o.linkData;
+}
+
+//
+// Get the edges which leave the vertex <id> in the graph used by SPFNext,
+// sorted.
+//
+void
+GlobalRouteManagerImpl::GetEdges (GlobalRouteManagerLSDB *lsdb, Ipv4Address id, SPFEdges_t &edges)
+{
+  GlobalRoutingLSA *lsa = lsdb->GetLSA (id);
+  if (lsa == 0)
+    {
+      return;
+    }
+  SPFEdge edge;
+  if (lsa->GetLSType () == GlobalRoutingLSA::RouterLSA)
+    {
+      for (uint32_t i = 0; i < lsa->GetNLinkRecords (); i++)
+        {
+          GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (i);
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint
+              || l->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              edge.to = l->GetLinkId ();
+              edge.metric = l->GetMetric ();
+              edge.linkData = l->GetLinkData ();
+              edges.push_back (edge);
+            }
+        }
+    }
+  else if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+    {
+      for (uint32_t i = 0; i < lsa->GetNAttachedRouters (); i++)
+        {
+          GlobalRoutingLSA *w_lsa = lsdb->GetLSAByLinkData (lsa->GetAttachedRouter (i));
+          if (w_lsa != 0)
+            {
+              edge.to = w_lsa->GetLinkStateId ();
+              edge.metric = 0;
+              edge.linkData = lsa->GetAttachedRouter (i);
+              edges.push_back (edge);
+            }
+        }
+    }
+  std::sort (edges.begin (), edges.end ());
+}
+
+bool
+GlobalRouteManagerImpl::IsParent (const SPFVertex *parent, const SPFVertex *child)
+{
+  for (uint32_t i = 0; child->GetParent (i) != 0; i++)
+    {
+      if (child->GetParent (i) == parent)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+//
+// Decide what to do with a kept SPF tree once the database changed.  The
+// tree must be computed again if one of its edges, or the reverse of one of
+// its edges (which gives the next hops), changed, or if a new edge could make
+// a vertex closer to the root.  Otherwise the shape of the tree and its root
+// exit directions are still valid, but the routes for the vertices of the
+// tree which advertise different addresses must be updated.
+//
+GlobalRouteManagerImpl::SPFUpdate
+GlobalRouteManagerImpl::GetSPFUpdate (const SPFTree &tree, const std::vector<SPFChange> &changes) const
+{
+  NS_LOG_FUNCTION (this);
+  typedef sgi::hash_map<Ipv4Address, SPFVertex*, Ipv4AddressHash>::const_iterator Index_t;
+  SPFUpdate update = SPF_UNCHANGED;
+  for (std::vector<SPFChange>::const_iterator c = changes.begin (); c != changes.end (); c++)
+    {
+      Index_t u = tree.index.find (c->id);
+      if (u != tree.index.end ())
+        {
+          if (u->second == tree.vertices.front ())
+            {
+              return SPF_RECOMPUTE;
+            }
+          update = SPF_PATCH;
+        }
+      for (SPFEdges_t::const_iterator e = c->removed.begin (); e != c->removed.end (); e++)
+        {
+          Index_t w = tree.index.find (e->to);
+          if (u != tree.index.end () && w != tree.index.end ()
+              && (IsParent (u->second, w->second) || IsParent (w->second, u->second)))
+            {
+              return SPF_RECOMPUTE;
+            }
+        }
+      for (SPFEdges_t::const_iterator e = c->added.begin (); e != c->added.end (); e++)
+        {
+          if (u == tree.index.end ())
+            {
+              break;
+            }
+          Index_t w = tree.index.find (e->to);
+          if (w == tree.index.end ()
+              || u->second->GetDistanceFromRoot () + e->metric <= w->second->GetDistanceFromRoot ()
+              || IsParent (w->second, u->second))
+            {
+              return SPF_RECOMPUTE;
+            }
+        }
+    }
+  return update;
+}
+
+//
+// This is derived from the steps of InitializeRoutes, but only the routers
+// whose SPF tree is affected by the changes of the database are processed.
+//
+void
+GlobalRouteManagerImpl::UpdateGlobalRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_keepSpfTrees)
+    {
+      NS_LOG_LOGIC ("No SPF tree kept, recomputing all of the routes");
+      DeleteGlobalRoutes ();
+      m_keepSpfTrees = true;
+      BuildGlobalRoutingDatabase ();
+      InitializeRoutes ();
+      return;
+    }
+
+  GlobalRouteManagerLSDB *previous = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+
+  std::vector<Ipv4Address> ids;
+  bool sameExternals = m_lsdb->Compare (previous, ids);
+  std::vector<SPFChange> changes (ids.size ());
+  for (uint32_t i = 0; i < ids.size (); i++)
+    {
+      SPFEdges_t before;
+      SPFEdges_t after;
+      GetEdges (previous, ids[i], before);
+      GetEdges (m_lsdb, ids[i], after);
+      changes[i].id = ids[i];
+      std::set_difference (before.begin (), before.end (), after.begin (), after.end (),
+                           std::back_inserter (changes[i].removed));
+      std::set_difference (after.begin (), after.end (), before.begin (), before.end (),
+                           std::back_inserter (changes[i].added));
+    }
+  NS_LOG_LOGIC (ids.size () << " LSAs changed");
+
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Node> node = *i;
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      if (rtr == 0 || node->GetSystemId () != MpiInterface::GetSystemId ())
+        {
+          continue;
+        }
+      Ipv4Address root = rtr->GetRouterId ();
+      SPFTreeMap_t::iterator tree = m_spfTrees.find (root);
+      SPFUpdate update = SPF_RECOMPUTE;
+      if (tree != m_spfTrees.end () && sameExternals)
+        {
+          update = GetSPFUpdate (tree->second, changes);
+        }
+      if (update == SPF_RECOMPUTE)
+        {
+          NS_LOG_LOGIC ("Recomputing the SPF tree of router " << root);
+          if (tree != m_spfTrees.end ())
+            {
+              delete tree->second.vertices.front ();
+              m_spfTrees.erase (tree);
+            }
+          DeleteGlobalRoutes (rtr);
+          if (rtr->GetNumLSAs ())
+            {
+              SPFCalculate (root);
+            }
+        }
+      else
+        {
+          SPFTree &kept = tree->second;
+          for (std::vector<SPFVertex*>::iterator j = kept.vertices.begin (); j != kept.vertices.end (); j++)
+            {
+              (*j)->SetLSA (m_lsdb->GetLSA ((*j)->GetVertexId ()));
+            }
+          if (update == SPF_PATCH)
+            {
+              NS_LOG_LOGIC ("Installing again the routes of router " << root);
+              DeleteGlobalRoutes (rtr);
+              SPFInstallTreeRoutes (kept);
+            }
+        }
+    }
+  delete previous;
 }
 
 void
@@ -1552,9 +1960,10 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 //
 // We need to walk the list of nodes looking for the one that has the router
 // ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// the routing information to.  The walk starts at the node SPFCalculate
+// found, so it normally stops there.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
+  NodeList::Iterator i = m_spfrootNode;
   NodeList::Iterator listEnd = NodeList::End ();
   for (; i != listEnd; i++)
     {
@@ -1721,9 +2130,10 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 //
 // We need to walk the list of nodes looking for the one that has the router
 // ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// the routing information to.  The walk starts at the node SPFCalculate
+// found, so it normally stops there.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
+  NodeList::Iterator i = m_spfrootNode;
   NodeList::Iterator listEnd = NodeList::End ();
   for (; i != listEnd; i++)
     {
@@ -1845,9 +2255,10 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 //
 // Walk the list of nodes in the system looking for the one corresponding to
 // the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
+// building the routing table.  The walk starts at the node SPFCalculate
+// found, so it normally stops there.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
+  NodeList::Iterator i = m_spfrootNode;
   NodeList::Iterator listEnd = NodeList::End ();
   for (; i != listEnd; i++)
     {
@@ -1936,9 +2347,10 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 //
 // We need to walk the list of nodes looking for the one that has the router
 // ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// the routing information to.  The walk starts at the node SPFCalculate
+// found, so it normally stops there.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
+  NodeList::Iterator i = m_spfrootNode;
   NodeList::Iterator listEnd = NodeList::End ();
   for (; i != listEnd; i++)
     {
@@ -2081,9 +2493,10 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
 //
 // We need to walk the list of nodes looking for the one that has the router
 // ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// the routing information to.  The walk starts at the node SPFCalculate
+// found, so it normally stops there.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
+  NodeList::Iterator i = m_spfrootNode;
   NodeList::Iterator listEnd = NodeList::End ();
   for (; i != listEnd; i++)
     {
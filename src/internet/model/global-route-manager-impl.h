@@ -30,6 +30,8 @@
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/node-list.h"
+#include "ns3/sgi-hashmap.h"
 #include "global-router-interface.h"
 
 namespace ns3 {
@@ -665,6 +667,19 @@ public:
   GlobalRoutingLSA* GetExtLSA (uint32_t index) const;
   uint32_t GetNumExtLSAs () const;
 
+/**
+ * @brief Compare the Link State Advertisements of this database with the
+ * ones of another database.
+ * @internal
+ *
+ * @param other The database to compare with.
+ * @param ids The link state IDs of the LSAs which are only in one of the
+ * databases, or which are different in the two databases, are appended to
+ * this vector.
+ * @returns true if the AS external LSAs of the two databases are the same.
+ */
+  bool Compare (const GlobalRouteManagerLSDB *other, std::vector<Ipv4Address> &ids) const;
+
 
 private:
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t;
@@ -672,6 +687,14 @@ private:
 
   LSDBMap_t m_database;
   std::vector<GlobalRoutingLSA*> m_extdatabase;
+  /**
+   * For each link data of a TransitNetwork link record, the address
+   * and LSA of the first entry of m_database which has it.
+   */
+  typedef sgi::hash_map<Ipv4Address, LSDBPair_t, Ipv4AddressHash> LinkDataMap_t;
+  LinkDataMap_t m_linkData;
+
+  static bool IsSameLSA (GlobalRoutingLSA *lsa1, GlobalRoutingLSA *lsa2);
 
 /**
  * @brief GlobalRouteManagerLSDB copy construction is disallowed.  There's no 
@@ -727,6 +750,24 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Update the per-node forwarding tables after a change of the
+ * topology, reusing the SPF trees of the previous computation.
+ * @internal
+ *
+ * The routing database is built again and compared with the previous one.
+ * The SPF calculation is run again only for the routers whose shortest
+ * path tree might contain a changed link.  The other routers keep their
+ * tree, and if some of its routers or networks advertise different
+ * addresses, their routes are installed again from the tree, in the
+ * order of a full computation.
+ *
+ * The SPF trees are only kept from one call of this method to the next
+ * one, and DeleteGlobalRoutes frees them, so the first call after
+ * the routes are computed by other means recomputes all of the routes.
+ */
+  virtual void UpdateGlobalRoutes ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  * @internal
@@ -755,7 +796,60 @@ private:
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
   SPFVertex* m_spfroot;
+  /**
+   * The position in the NodeList of the node at the root of the SPF
+   * tree, found once per SPFCalculate, or NodeList::End ().
+   */
+  NodeList::Iterator m_spfrootNode;
   GlobalRouteManagerLSDB* m_lsdb;
+  NodeList::Iterator FindRootNode (Ipv4Address routerId) const;
+
+/**
+ * @brief A shortest path tree kept after its SPF calculation.
+ *
+ * The vertices are stored in the order in which they were added to the
+ * tree, starting with the root.
+ */
+  struct SPFTree
+  {
+    std::vector<SPFVertex*> vertices;
+    sgi::hash_map<Ipv4Address, SPFVertex*, Ipv4AddressHash> index;
+  };
+  typedef std::map<Ipv4Address, SPFTree> SPFTreeMap_t;
+  SPFTreeMap_t m_spfTrees;
+  /// True from a call of UpdateGlobalRoutes until the routes are deleted.
+  bool m_keepSpfTrees;
+
+  /// An edge of the LSDB graph, as seen from the vertex it leaves.
+  struct SPFEdge
+  {
+    Ipv4Address to;
+    uint16_t metric;
+    Ipv4Address linkData;
+    bool operator< (const SPFEdge &o) const;
+  };
+  typedef std::vector<SPFEdge> SPFEdges_t;
+  /// The edges which left a vertex in the previous LSDB only, and in the new one only.
+  struct SPFChange
+  {
+    Ipv4Address id;
+    SPFEdges_t removed;
+    SPFEdges_t added;
+  };
+  enum SPFUpdate
+  {
+    SPF_UNCHANGED,
+    SPF_PATCH,
+    SPF_RECOMPUTE
+  };
+
+  void DeleteGlobalRoutes (Ptr<GlobalRouter> router);
+  void DeleteSPFTrees (void);
+  static void GetEdges (GlobalRouteManagerLSDB *lsdb, Ipv4Address id, SPFEdges_t &edges);
+  static bool IsParent (const SPFVertex *parent, const SPFVertex *child);
+  SPFUpdate GetSPFUpdate (const SPFTree &tree, const std::vector<SPFChange> &changes) const;
+  void SPFInstallTreeRoutes (const SPFTree &tree);
+  void SPFInstallStubsAndExternals (void);
   bool CheckForStubNode (Ipv4Address root);
   void SPFCalculate (Ipv4Address root);
   void SPFProcessStubs (SPFVertex* v);
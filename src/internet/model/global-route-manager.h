@@ -67,6 +67,14 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Update the per-node forwarding tables after a change of the
+ * topology, only running the SPF computation again for the routers whose
+ * shortest path tree is affected
+ * @internal
+ */
+  static void UpdateGlobalRoutes ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
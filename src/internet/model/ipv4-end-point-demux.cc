@@ -18,6 +18,8 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 
+#include <algorithm>
+#include <iterator>
 #include "ipv4-end-point-demux.h"
 #include "ipv4-end-point.h"
 #include "ns3/log.h"
@@ -27,7 +29,7 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Ipv4EndPointDemux");
 
 Ipv4EndPointDemux::Ipv4EndPointDemux ()
-  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152)
+  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152), m_rank (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -35,41 +37,180 @@ Ipv4EndPointDemux::Ipv4EndPointDemux ()
 Ipv4EndPointDemux::~Ipv4EndPointDemux ()
 {
   NS_LOG_FUNCTION (this);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  for (std::map<uint64_t, Ipv4EndPoint *>::iterator i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
     {
-      Ipv4EndPoint *endPoint = *i;
+      Ipv4EndPoint *endPoint = i->second;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
+  m_ports.clear ();
+  m_localAddressPorts.clear ();
+}
+
+size_t
+Ipv4EndPointDemux::AddressPortHash::operator() (AddressPort const &x) const
+{
+  return Ipv4AddressHash () (x.first) ^ (x.second * 2654435761U);
 }
 
 bool
-Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+Ipv4EndPointDemux::IsAllocatedBefore (Ipv4EndPoint *a, Ipv4EndPoint *b)
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  return a->m_rank < b->m_rank;
+}
+
+/*
+ * An end point whose peer address or peer port is a wildcard can match
+ * many peers, so it is not indexed by its peer.
+ */
+bool
+Ipv4EndPointDemux::HasWildcardPeer (Ipv4EndPoint *endPoint)
+{
+  return endPoint->GetPeerAddress () == Ipv4Address::GetAny () || endPoint->GetPeerPort () == 0;
+}
+
+void
+Ipv4EndPointDemux::InsertInOrder (EndPoints &endPoints, Ipv4EndPoint *endPoint)
+{
+  if (endPoints.empty () || IsAllocatedBefore (endPoints.back (), endPoint))
+    {
+      endPoints.push_back (endPoint);
+    }
+  else
+    {
+      endPoints.insert (std::upper_bound (endPoints.begin (), endPoints.end (), endPoint, &IsAllocatedBefore),
+                        endPoint);
+    }
+}
+
+void
+Ipv4EndPointDemux::Erase (EndPoints &endPoints, Ipv4EndPoint *endPoint)
+{
+  EndPointsI i = std::find (endPoints.begin (), endPoints.end (), endPoint);
+  NS_ASSERT (i != endPoints.end ());
+  endPoints.erase (i);
+}
+
+Ipv4EndPoint *
+Ipv4EndPointDemux::Insert (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  endPoint->m_rank = m_rank++;
+  endPoint->m_demux = this;
+  m_endPoints[endPoint->m_rank] = endPoint;
+  Index (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  return endPoint;
+}
+
+void
+Ipv4EndPointDemux::Index (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  PortEndPoints &port = m_ports[endPoint->GetLocalPort ()];
+  if (HasWildcardPeer (endPoint))
+    {
+      InsertInOrder (port.unconnected, endPoint);
+    }
+  else
     {
-      if ((*i)->GetLocalPort  () == port) 
+      InsertInOrder (port.connected[AddressPort (endPoint->GetPeerAddress (), endPoint->GetPeerPort ())], endPoint);
+    }
+  m_localAddressPorts[AddressPort (endPoint->GetLocalAddress (), endPoint->GetLocalPort ())]++;
+}
+
+void
+Ipv4EndPointDemux::Unindex (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Ports::iterator port = m_ports.find (endPoint->GetLocalPort ());
+  NS_ASSERT (port != m_ports.end ());
+  if (HasWildcardPeer (endPoint))
+    {
+      Erase (port->second.unconnected, endPoint);
+    }
+  else
+    {
+      PeerEndPoints::iterator peer = port->second.connected.find (AddressPort (endPoint->GetPeerAddress (), endPoint->GetPeerPort ()));
+      NS_ASSERT (peer != port->second.connected.end ());
+      Erase (peer->second, endPoint);
+      if (peer->second.empty ())
         {
-          return true;
+          port->second.connected.erase (peer);
         }
     }
-  return false;
+  if (port->second.unconnected.empty () && port->second.connected.empty ())
+    {
+      m_ports.erase (port);
+    }
+  LocalAddressPorts::iterator local = m_localAddressPorts.find (AddressPort (endPoint->GetLocalAddress (), endPoint->GetLocalPort ()));
+  NS_ASSERT (local != m_localAddressPorts.end ());
+  if (--local->second == 0)
+    {
+      m_localAddressPorts.erase (local);
+    }
 }
 
-bool
-Ipv4EndPointDemux::LookupLocal (Ipv4Address addr, uint16_t port)
+/*
+ * The endpoints of the local port which can match a peer: the ones
+ * connected to this peer and the ones whose peer has a wildcard, in
+ * allocation order.  The wildcard list of the port is returned as is
+ * when no endpoint is connected to this peer, otherwise both lists are
+ * merged into the given one.
+ */
+const Ipv4EndPointDemux::EndPoints &
+Ipv4EndPointDemux::GetCandidates (uint16_t port, Ipv4Address peerAddress, uint16_t peerPort,
+                                  EndPoints &merged)
 {
-  NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  Ports::iterator i = m_ports.find (port);
+  if (i == m_ports.end ())
+    {
+      return merged;
+    }
+  PeerEndPoints::iterator peer = i->second.connected.find (AddressPort (peerAddress, peerPort));
+  if (peer == i->second.connected.end ())
+    {
+      return i->second.unconnected;
+    }
+  std::merge (i->second.unconnected.begin (), i->second.unconnected.end (),
+              peer->second.begin (), peer->second.end (),
+              std::back_inserter (merged), &IsAllocatedBefore);
+  return merged;
+}
+
+/*
+ * All of the endpoints of the local port, in allocation order.
+ */
+Ipv4EndPointDemux::EndPoints
+Ipv4EndPointDemux::GetPortEndPoints (uint16_t port)
+{
+  EndPoints endPoints;
+  Ports::iterator i = m_ports.find (port);
+  if (i != m_ports.end ())
     {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr) 
+      endPoints = i->second.unconnected;
+      for (PeerEndPoints::iterator peer = i->second.connected.begin (); peer != i->second.connected.end (); peer++)
         {
-          return true;
+          endPoints.insert (endPoints.end (), peer->second.begin (), peer->second.end ());
         }
+      endPoints.sort (&IsAllocatedBefore);
     }
-  return false;
+  return endPoints;
+}
+
+bool
+Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_ports.find (port) != m_ports.end ();
+}
+
+bool
+Ipv4EndPointDemux::LookupLocal (Ipv4Address addr, uint16_t port)
+{
+  NS_LOG_FUNCTION (this << addr << port);
+  return m_localAddressPorts.find (AddressPort (addr, port)) != m_localAddressPorts.end ();
 }
 
 Ipv4EndPoint *
@@ -82,10 +223,7 @@ Ipv4EndPointDemux::Allocate (void)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (Ipv4Address::GetAny (), port));
 }
 
 Ipv4EndPoint *
@@ -98,10 +236,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (address, port));
 }
 
 Ipv4EndPoint *
@@ -121,10 +256,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address, uint16_t port)
       NS_LOG_WARN ("Duplicate address/port; failing.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (address, port));
 }
 
 Ipv4EndPoint *
@@ -132,7 +264,9 @@ Ipv4EndPointDemux::Allocate (Ipv4Address localAddress, uint16_t localPort,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  EndPoints merged;
+  const EndPoints &candidates = GetCandidates (localPort, peerAddress, peerPort, merged);
+  for (EndPoints::const_iterator i = candidates.begin (); i != candidates.end (); i++) 
     {
       if ((*i)->GetLocalPort () == localPort &&
           (*i)->GetLocalAddress () == localAddress &&
@@ -146,25 +280,20 @@ Ipv4EndPointDemux::Allocate (Ipv4Address localAddress, uint16_t localPort,
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
-  return endPoint;
+  return Insert (endPoint);
 }
 
 void 
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::map<uint64_t, Ipv4EndPoint *>::iterator i = m_endPoints.find (endPoint->m_rank);
+  if (i != m_endPoints.end () && i->second == endPoint)
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      Unindex (endPoint);
+      endPoint->m_demux = 0;
+      m_endPoints.erase (i);
+      delete endPoint;
     }
 }
 
@@ -177,9 +306,9 @@ Ipv4EndPointDemux::GetAllEndPoints (void)
   NS_LOG_FUNCTION (this);
   EndPoints ret;
 
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  for (std::map<uint64_t, Ipv4EndPoint *>::iterator i = m_endPoints.begin (); i != m_endPoints.end (); i++)
     {
-      Ipv4EndPoint* endP = *i;
+      Ipv4EndPoint* endP = i->second;
       ret.push_back (endP);
     }
   return ret;
@@ -204,7 +333,9 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
   EndPoints retval4; // Exact match on all 4
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  EndPoints merged;
+  const EndPoints &candidates = GetCandidates (dport, saddr, sport, merged);
+  for (EndPoints::const_iterator i = candidates.begin (); i != candidates.end (); i++) 
     {
       Ipv4EndPoint* endP = *i;
       NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
@@ -319,7 +450,8 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
   // function.
   uint32_t genericity = 3;
   Ipv4EndPoint *generic = 0;
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  EndPoints endPoints = GetPortEndPoints (dport);
+  for (EndPointsI i = endPoints.begin (); i != endPoints.end (); i++) 
     {
       if ((*i)->GetLocalPort () != dport) 
         {
@@ -23,7 +23,10 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
+#include <utility>
 #include "ns3/ipv4-address.h"
+#include "ns3/sgi-hashmap.h"
 #include "ipv4-interface.h"
 
 namespace ns3 {
@@ -38,6 +41,11 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints are indexed by local port and, within a port, by peer
+ * address and port, so that a lookup only considers the endpoints which
+ * can match the packet, even when many connections share a local port.
+ * The endpoints tell their demux when their addresses change.
  */
 
 class Ipv4EndPointDemux {
@@ -74,12 +82,53 @@ public:
   void DeAllocate (Ipv4EndPoint *endPoint);
 
 private:
+  friend class Ipv4EndPoint;
+
+  /// An address and a port, the key of the indices
+  typedef std::pair<Ipv4Address, uint16_t> AddressPort;
+  class AddressPortHash : public std::unary_function<AddressPort, size_t>
+  {
+public:
+    size_t operator() (AddressPort const &x) const;
+  };
+  typedef sgi::hash_map<AddressPort, EndPoints, AddressPortHash> PeerEndPoints;
+  /**
+   * The endpoints bound to a local port.  The endpoints whose peer
+   * address or port is a wildcard are kept apart from the others, which
+   * are indexed by peer address and port.  All of the lists are
+   * in allocation order.
+   */
+  struct PortEndPoints
+  {
+    EndPoints unconnected;
+    PeerEndPoints connected;
+  };
+  typedef sgi::hash_map<uint16_t, PortEndPoints> Ports;
+  typedef sgi::hash_map<AddressPort, uint32_t, AddressPortHash> LocalAddressPorts;
+
   uint16_t AllocateEphemeralPort (void);
+  Ipv4EndPoint *Insert (Ipv4EndPoint *endPoint);
+  void Index (Ipv4EndPoint *endPoint);
+  void Unindex (Ipv4EndPoint *endPoint);
+  const EndPoints &GetCandidates (uint16_t port, Ipv4Address peerAddress, uint16_t peerPort,
+                                 EndPoints &merged);
+  EndPoints GetPortEndPoints (uint16_t port);
+  static void InsertInOrder (EndPoints &endPoints, Ipv4EndPoint *endPoint);
+  static void Erase (EndPoints &endPoints, Ipv4EndPoint *endPoint);
+  static bool IsAllocatedBefore (Ipv4EndPoint *a, Ipv4EndPoint *b);
+  static bool HasWildcardPeer (Ipv4EndPoint *endPoint);
 
   uint16_t m_ephemeral;
   uint16_t m_portLast;
   uint16_t m_portFirst;
-  EndPoints m_endPoints;
+  /// All of the endpoints, by allocation rank
+  std::map<uint64_t, Ipv4EndPoint *> m_endPoints;
+  /// The rank of the next allocated endpoint
+  uint64_t m_rank;
+  /// The endpoints by local port
+  Ports m_ports;
+  /// The number of endpoints for each local address and port
+  LocalAddressPorts m_localAddressPorts;
 };
 
 } // namespace ns3
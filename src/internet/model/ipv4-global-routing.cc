@@ -18,6 +18,7 @@
 
 #include <vector>
 #include <iomanip>
+#include <algorithm>
 #include "ns3/names.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -51,13 +52,20 @@ Ipv4GlobalRouting::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&Ipv4GlobalRouting::m_respondToInterfaceEvents),
                    MakeBooleanChecker ())
+    .AddAttribute ("IncrementalSpf",
+                   "Set to true if, when responding to interface events, only the routers whose shortest path tree is affected should run the SPF computation again",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4GlobalRouting::m_incrementalSpf),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_respondToInterfaceEvents (false),
+    m_incrementalSpf (false),
+    m_networkRouteSequence (0)
 {
   NS_LOG_FUNCTION (this);
 
@@ -78,6 +86,8 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  m_hostRouteTrie.Add (dest, Ipv4Mask::GetOnes (), route, 0);
+  NotifyRouteChange ();
 }
 
 void 
@@ -88,6 +98,8 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  m_hostRouteTrie.Add (dest, Ipv4Mask::GetOnes (), route, 0);
+  NotifyRouteChange ();
 }
 
 void 
@@ -97,12 +109,18 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                       uint32_t interface)
 {
   NS_LOG_FUNCTION (this << network << networkMask << nextHop << interface);
+  if (m_networkRoutes.empty ())
+    {
+      m_networkRouteSequence = 0;
+    }
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
                                                         networkMask,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_networkRouteTrie.Add (network, networkMask, route, m_networkRouteSequence++);
+  NotifyRouteChange ();
 }
 
 void 
@@ -111,11 +129,17 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                       uint32_t interface)
 {
   NS_LOG_FUNCTION (this << network << networkMask << interface);
+  if (m_networkRoutes.empty ())
+    {
+      m_networkRouteSequence = 0;
+    }
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_networkRouteTrie.Add (network, networkMask, route, m_networkRouteSequence++);
+  NotifyRouteChange ();
 }
 
 void 
@@ -131,9 +155,9 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  NotifyRouteChange ();
 }
 
-
 Ptr<Ipv4Route>
 Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
 {
@@ -145,47 +169,61 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
   RouteVec_t allRoutes;
 
   NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
+  const Ipv4RouteTrie::Entries *hostRoutes = m_hostRouteTrie.Find (dest, Ipv4Mask::GetOnes ());
+  if (hostRoutes != 0)
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest ().IsEqual (dest)) 
+      for (Ipv4RouteTrie::Entries::const_iterator i = hostRoutes->begin ();
+           i != hostRoutes->end ();
+           i++)
         {
+          NS_ASSERT (i->route->IsHost ());
           if (oif != 0)
             {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
+              if (oif != m_ipv4->GetNetDevice (i->route->GetInterface ()))
                 {
                   NS_LOG_LOGIC ("Not on requested interface, skipping");
                   continue;
                 }
             }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
+          allRoutes.push_back (i->route);
+          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << i->route);
         }
     }
   if (allRoutes.size () == 0) // if no host route is found
     {
       NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
-           j++) 
+      // all of the matching network routes are candidates, in the order
+      // of m_networkRoutes, whatever the length of their prefix.
+      const Ipv4RouteTrie::Entries *matches[Ipv4RouteTrie::MAX_MATCHES];
+      uint32_t nMatches = m_networkRouteTrie.Lookup (dest, matches);
+      Ipv4RouteTrie::Entries merged;
+      const Ipv4RouteTrie::Entries *networkRoutes = &merged;
+      if (nMatches == 1)
+        {
+          networkRoutes = matches[0];
+        }
+      else if (nMatches > 1)
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
+          for (uint32_t i = 0; i < nMatches; i++)
             {
-              if (oif != 0)
+              merged.insert (merged.end (), matches[i]->begin (), matches[i]->end ());
+            }
+          std::sort (merged.begin (), merged.end (), &Ipv4GlobalRouting::CompareRouteSequence);
+        }
+      for (Ipv4RouteTrie::Entries::const_iterator j = networkRoutes->begin ();
+           j != networkRoutes->end ();
+           j++)
+        {
+          if (oif != 0)
+            {
+              if (oif != m_ipv4->GetNetDevice (j->route->GetInterface ()))
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
+                  NS_LOG_LOGIC ("Not on requested interface, skipping");
+                  continue;
                 }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
             }
+          allRoutes.push_back (j->route);
+          NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << j->route);
         }
     }
   if (allRoutes.size () == 0)  // consider external if no host/network found
@@ -243,6 +281,12 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 }
 
+bool
+Ipv4GlobalRouting::CompareRouteSequence (const Ipv4RouteTrie::Entry &a, const Ipv4RouteTrie::Entry &b)
+{
+  return a.value < b.value;
+}
+
 uint32_t 
 Ipv4GlobalRouting::GetNRoutes (void) const
 {
@@ -317,6 +361,8 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           if (tmp  == index)
             {
               NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
+              m_hostRouteTrie.Remove ((*i)->GetDest (), Ipv4Mask::GetOnes (), *i);
+              NotifyRouteChange ();
               delete *i;
               m_hostRoutes.erase (i);
               NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
@@ -334,6 +380,8 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
+          m_networkRouteTrie.Remove ((*j)->GetDestNetwork (), (*j)->GetDestNetworkMask (), *j);
+          NotifyRouteChange ();
           delete *j;
           m_networkRoutes.erase (j);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -352,6 +400,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
           delete *k;
           m_ASexternalRoutes.erase (k);
+          NotifyRouteChange ();
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
           return;
         }
@@ -360,6 +409,24 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
   NS_ASSERT (false);
 }
 
+bool
+Ipv4GlobalRouting::SetRouteChangeCallback (Callback<void> cb)
+{
+  NS_LOG_FUNCTION (this);
+  m_routeChangeCallback = cb;
+  // random ECMP routing picks a route for every packet.
+  return !m_randomEcmpRouting;
+}
+
+void
+Ipv4GlobalRouting::NotifyRouteChange (void)
+{
+  if (!m_routeChangeCallback.IsNull ())
+    {
+      m_routeChangeCallback ();
+    }
+}
+
 int64_t
 Ipv4GlobalRouting::AssignStreams (int64_t stream)
 {
@@ -390,6 +457,9 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_hostRouteTrie.Clear ();
+  m_networkRouteTrie.Clear ();
+  m_routeChangeCallback = MakeNullCallback<void> ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -556,9 +626,7 @@ Ipv4GlobalRouting::NotifyInterfaceUp (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      RecomputeGlobalRoutes ();
     }
 }
 
@@ -568,9 +636,7 @@ Ipv4GlobalRouting::NotifyInterfaceDown (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      RecomputeGlobalRoutes ();
     }
 }
 
@@ -580,9 +646,7 @@ Ipv4GlobalRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress ad
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      RecomputeGlobalRoutes ();
     }
 }
 
@@ -591,6 +655,20 @@ Ipv4GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
 {
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
+    {
+      RecomputeGlobalRoutes ();
+    }
+}
+
+void
+Ipv4GlobalRouting::RecomputeGlobalRoutes (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_incrementalSpf)
+    {
+      GlobalRouteManager::UpdateGlobalRoutes ();
+    }
+  else
     {
       GlobalRouteManager::DeleteGlobalRoutes ();
       GlobalRouteManager::BuildGlobalRoutingDatabase ();
@@ -28,6 +28,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/ipv4-route-trie.h"
 
 namespace ns3 {
 
@@ -93,6 +94,7 @@ public:
   virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
   virtual void SetIpv4 (Ptr<Ipv4> ipv4);
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const;
+  virtual bool SetRouteChangeCallback (Callback<void> cb);
 
 /**
  * \brief Add a host route to the global routing table.
@@ -229,6 +231,8 @@ private:
   bool m_randomEcmpRouting;
   /// Set to true if this interface should respond to interface events by globallly recomputing routes 
   bool m_respondToInterfaceEvents;
+  /// Set to true if the routes should be updated incrementally when responding to interface events
+  bool m_incrementalSpf;
   /// A uniform random number generator for randomly routing packets among ECMP 
   Ptr<UniformRandomVariable> m_rand;
 
@@ -243,10 +247,21 @@ private:
   typedef std::list<Ipv4RoutingTableEntry *>::iterator ASExternalRoutesI;
 
   Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
+  void RecomputeGlobalRoutes (void);
+  void NotifyRouteChange (void);
+  static bool CompareRouteSequence (const Ipv4RouteTrie::Entry &a, const Ipv4RouteTrie::Entry &b);
 
   HostRoutes m_hostRoutes;
   NetworkRoutes m_networkRoutes;
   ASExternalRoutes m_ASexternalRoutes; // External routes imported
+  /// The host routes, indexed by destination
+  Ipv4RouteTrie m_hostRouteTrie;
+  /// The network routes, indexed by destination prefix with their rank in m_networkRoutes
+  Ipv4RouteTrie m_networkRouteTrie;
+  /// The rank given to the next network route
+  uint32_t m_networkRouteSequence;
+  /// Invoked whenever the routes change, for the forwarding cache of Ipv4L3Protocol
+  Callback<void> m_routeChangeCallback;
 
   Ptr<Ipv4> m_ipv4;
 };
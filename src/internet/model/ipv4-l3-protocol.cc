@@ -67,6 +67,19 @@ Ipv4L3Protocol::GetTypeId (void)
                    TimeValue (Seconds (30)),
                    MakeTimeAccessor (&Ipv4L3Protocol::m_fragmentExpirationTimeout),
                    MakeTimeChecker ())
+    .AddAttribute ("MaxFragmentsBytes",
+                   "The maximum number of bytes in the fragments of the packets being reassembled. "
+                   "When it is exceeded, the oldest packets are dropped.",
+                   UintegerValue (4194304),
+                   MakeUintegerAccessor (&Ipv4L3Protocol::m_maxFragmentsBytes),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ForwardingCache",
+                   "Set to true to reuse the route of the previous unicast packet forwarded to the same destination, "
+                   "until the routes change. Only used with routing protocols which notify their route changes, "
+                   "such as Ipv4StaticRouting and Ipv4GlobalRouting.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4L3Protocol::m_forwardingCacheEnabled),
+                   MakeBooleanChecker ())
     .AddTraceSource ("Tx", "Send ipv4 packet to outgoing interface.",
                      MakeTraceSourceAccessor (&Ipv4L3Protocol::m_txTrace))
     .AddTraceSource ("Rx", "Receive ipv4 packet from incoming interface.",
@@ -90,7 +103,11 @@ Ipv4L3Protocol::GetTypeId (void)
 }
 
 Ipv4L3Protocol::Ipv4L3Protocol()
-  : m_identification (0)
+  : m_identification (0),
+    m_forwardingCacheEnabled (false),
+    m_forwardingCacheChecked (false),
+    m_forwardingCacheSupported (false),
+    m_fragmentsBytes (0)
 
 {
   NS_LOG_FUNCTION (this);
@@ -186,6 +203,7 @@ Ipv4L3Protocol::SetRoutingProtocol (Ptr<Ipv4RoutingProtocol> routingProtocol)
   NS_LOG_FUNCTION (this << routingProtocol);
   m_routingProtocol = routingProtocol;
   m_routingProtocol->SetIpv4 (this);
+  FlushForwardingCache ();
 }
 
 
@@ -214,22 +232,17 @@ Ipv4L3Protocol::DoDispose (void)
   m_sockets.clear ();
   m_node = 0;
   m_routingProtocol = 0;
+  m_forwardingCache.clear ();
 
   for (MapFragments_t::iterator it = m_fragments.begin (); it != m_fragments.end (); it++)
     {
-      it->second = 0;
-    }
-
-  for (MapFragmentsTimers_t::iterator it = m_fragmentsTimers.begin (); it != m_fragmentsTimers.end (); it++)
-    {
-      if (it->second.IsRunning ())
-        {
-          it->second.Cancel ();
-        }
+      it->second.fragments = 0;
+      it->second.timeout.Cancel ();
     }
 
   m_fragments.clear ();
-  m_fragmentsTimers.clear ();
+  m_fragmentsAge.clear ();
+  m_fragmentsBytes = 0;
 
   Object::DoDispose ();
 }
@@ -470,7 +483,10 @@ Ipv4L3Protocol::Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t p
         {
           if (ipv4Interface->IsUp ())
             {
-              m_rxTrace (packet, m_node->GetObject<Ipv4> (), interface);
+              if (!m_rxTrace.IsEmpty ())
+                {
+                  m_rxTrace (packet, m_node->GetObject<Ipv4> (), interface);
+                }
               break;
             }
           else
@@ -512,8 +528,21 @@ Ipv4L3Protocol::Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t p
     }
 
   NS_ASSERT_MSG (m_routingProtocol != 0, "Need a routing protocol object to process packets");
-  if (!m_routingProtocol->RouteInput (packet, ipHeader, device,
-                                      MakeCallback (&Ipv4L3Protocol::IpForward, this),
+  Ipv4RoutingProtocol::UnicastForwardCallback ucb = MakeCallback (&Ipv4L3Protocol::IpForward, this);
+  if (m_forwardingCacheEnabled)
+    {
+      Ptr<Ipv4Route> route = LookupForwardingCache (ipHeader, interface);
+      if (route != 0)
+        {
+          IpForward (route, packet, ipHeader);
+          return;
+        }
+      if (m_forwardingCacheSupported)
+        {
+          ucb = MakeCallback (&Ipv4L3Protocol::IpForwardAndCache, this);
+        }
+    }
+  if (!m_routingProtocol->RouteInput (packet, ipHeader, device, ucb,
                                       MakeCallback (&Ipv4L3Protocol::IpMulticastForward, this),
                                       MakeCallback (&Ipv4L3Protocol::LocalDeliver, this),
                                       MakeCallback (&Ipv4L3Protocol::RouteInputError, this)
@@ -609,7 +638,10 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
 
           m_sendOutgoingTrace (ipHeader, packetCopy, ifaceIndex);
           packetCopy->AddHeader (ipHeader);
-          m_txTrace (packetCopy, m_node->GetObject<Ipv4> (), ifaceIndex);
+          if (!m_txTrace.IsEmpty ())
+            {
+              m_txTrace (packetCopy, m_node->GetObject<Ipv4> (), ifaceIndex);
+            }
           outInterface->Send (packetCopy, destination);
         }
       return;
@@ -633,7 +665,10 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
               Ptr<Packet> packetCopy = packet->Copy ();
               m_sendOutgoingTrace (ipHeader, packetCopy, ifaceIndex);
               packetCopy->AddHeader (ipHeader);
-              m_txTrace (packetCopy, m_node->GetObject<Ipv4> (), ifaceIndex);
+              if (!m_txTrace.IsEmpty ())
+                {
+                  m_txTrace (packetCopy, m_node->GetObject<Ipv4> (), ifaceIndex);
+                }
               outInterface->Send (packetCopy, destination);
               return;
             }
@@ -758,13 +793,19 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
               DoFragmentation (packet, outInterface->GetDevice ()->GetMtu (), listFragments);
               for ( std::list<Ptr<Packet> >::iterator it = listFragments.begin (); it != listFragments.end (); it++ )
                 {
-                  m_txTrace (*it, m_node->GetObject<Ipv4> (), interface);
+                  if (!m_txTrace.IsEmpty ())
+                    {
+                      m_txTrace (*it, m_node->GetObject<Ipv4> (), interface);
+                    }
                   outInterface->Send (*it, route->GetGateway ());
                 }
             }
           else
             {
-              m_txTrace (packet, m_node->GetObject<Ipv4> (), interface);
+              if (!m_txTrace.IsEmpty ())
+                {
+                  m_txTrace (packet, m_node->GetObject<Ipv4> (), interface);
+                }
               outInterface->Send (packet, route->GetGateway ());
             }
         }
@@ -788,13 +829,19 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
               for ( std::list<Ptr<Packet> >::iterator it = listFragments.begin (); it != listFragments.end (); it++ )
                 {
                   NS_LOG_LOGIC ("Sending fragment " << **it );
-                  m_txTrace (*it, m_node->GetObject<Ipv4> (), interface);
+                  if (!m_txTrace.IsEmpty ())
+                    {
+                      m_txTrace (*it, m_node->GetObject<Ipv4> (), interface);
+                    }
                   outInterface->Send (*it, ipHeader.GetDestination ());
                 }
             }
           else
             {
-              m_txTrace (packet, m_node->GetObject<Ipv4> (), interface);
+              if (!m_txTrace.IsEmpty ())
+                {
+                  m_txTrace (packet, m_node->GetObject<Ipv4> (), interface);
+                }
               outInterface->Send (packet, ipHeader.GetDestination ());
             }
         }
@@ -872,6 +919,57 @@ Ipv4L3Protocol::IpForward (Ptr<Ipv4Route> rtentry, Ptr<const Packet> p, const Ip
   SendRealOut (rtentry, packet, ipHeader);
 }
 
+void
+Ipv4L3Protocol::IpForwardAndCache (Ptr<Ipv4Route> rtentry, Ptr<const Packet> p, const Ipv4Header &header)
+{
+  NS_LOG_FUNCTION (this << rtentry << p << header);
+  Ipv4Address destination = header.GetDestination ();
+  if (!destination.IsBroadcast () && !destination.IsMulticast ())
+    {
+      m_forwardingCache[destination] = rtentry;
+    }
+  IpForward (rtentry, p, header);
+}
+
+Ptr<Ipv4Route>
+Ipv4L3Protocol::LookupForwardingCache (const Ipv4Header &header, uint32_t iif)
+{
+  NS_LOG_FUNCTION (this << header << iif);
+  if (!m_forwardingCacheChecked)
+    {
+      m_forwardingCacheSupported = m_routingProtocol->SetRouteChangeCallback (MakeCallback (&Ipv4L3Protocol::FlushForwardingCache, this));
+      m_forwardingCacheChecked = true;
+      NS_LOG_LOGIC ("Forwarding cache supported by the routing protocol: " << m_forwardingCacheSupported);
+    }
+  if (m_forwardingCache.empty ())
+    {
+      return 0;
+    }
+  ForwardingCache::const_iterator i = m_forwardingCache.find (header.GetDestination ());
+  if (i == m_forwardingCache.end ())
+    {
+      return 0;
+    }
+  // A cached destination is not an address of the node, unless the
+  // strong end system model makes it depend on the input interface.
+  if (!IsForwarding (iif) || (!m_weakEsModel && IsDestinationAddress (header.GetDestination (), iif)))
+    {
+      return 0;
+    }
+  NS_LOG_LOGIC ("Forwarding cache hit for " << header.GetDestination ());
+  return i->second;
+}
+
+void
+Ipv4L3Protocol::FlushForwardingCache (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_forwardingCache.clear ();
+  // ask again whether the routing protocol supports the cache, since
+  // it may have changed.
+  m_forwardingCacheChecked = false;
+}
+
 void
 Ipv4L3Protocol::LocalDeliver (Ptr<const Packet> packet, Ipv4Header const&ip, uint32_t iif)
 {
@@ -939,6 +1037,7 @@ Ipv4L3Protocol::AddAddress (uint32_t i, Ipv4InterfaceAddress address)
   NS_LOG_FUNCTION (this << i << address);
   Ptr<Ipv4Interface> interface = GetInterface (i);
   bool retVal = interface->AddAddress (address);
+  FlushForwardingCache ();
   if (m_routingProtocol != 0)
     {
       m_routingProtocol->NotifyAddAddress (i, address);
@@ -968,6 +1067,7 @@ Ipv4L3Protocol::RemoveAddress (uint32_t i, uint32_t addressIndex)
   NS_LOG_FUNCTION (this << i << addressIndex);
   Ptr<Ipv4Interface> interface = GetInterface (i);
   Ipv4InterfaceAddress address = interface->RemoveAddress (addressIndex);
+  FlushForwardingCache ();
   if (address != Ipv4InterfaceAddress ())
     {
       if (m_routingProtocol != 0)
@@ -1070,6 +1170,7 @@ Ipv4L3Protocol::SetUp (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   Ptr<Ipv4Interface> interface = GetInterface (i);
   interface->SetUp ();
+  FlushForwardingCache ();
 
   if (m_routingProtocol != 0)
     {
@@ -1083,6 +1184,7 @@ Ipv4L3Protocol::SetDown (uint32_t ifaceIndex)
   NS_LOG_FUNCTION (this << ifaceIndex);
   Ptr<Ipv4Interface> interface = GetInterface (ifaceIndex);
   interface->SetDown ();
+  FlushForwardingCache ();
 
   if (m_routingProtocol != 0)
     {
@@ -1137,6 +1239,7 @@ Ipv4L3Protocol::SetWeakEsModel (bool model)
 {
   NS_LOG_FUNCTION (this << model);
   m_weakEsModel = model;
+  FlushForwardingCache ();
 }
 
 bool 
@@ -1252,54 +1355,73 @@ Ipv4L3Protocol::ProcessFragment (Ptr<Packet>& packet, Ipv4Header& ipHeader, uint
 {
   NS_LOG_FUNCTION (this << packet << ipHeader << iif);
 
-  uint64_t addressCombination = uint64_t (ipHeader.GetSource ().Get ()) << 32 & uint64_t (ipHeader.GetDestination ().Get ());
-  uint32_t idProto = uint32_t (ipHeader.GetIdentification ()) << 16 & uint32_t (ipHeader.GetProtocol ());
-  std::pair<uint64_t, uint32_t> key;
-  bool ret = false;
+  uint64_t addressCombination = uint64_t (ipHeader.GetSource ().Get ()) << 32 | uint64_t (ipHeader.GetDestination ().Get ());
+  uint32_t idProto = uint32_t (ipHeader.GetIdentification ()) << 16 | uint32_t (ipHeader.GetProtocol ());
+  FragmentsKey_t key (addressCombination, idProto);
   Ptr<Packet> p = packet->Copy ();
 
-  key.first = addressCombination;
-  key.second = idProto;
-
-  Ptr<Fragments> fragments;
-
   MapFragments_t::iterator it = m_fragments.find (key);
   if (it == m_fragments.end ())
     {
-      fragments = Create<Fragments> ();
-      m_fragments.insert (std::make_pair (key, fragments));
-      m_fragmentsTimers[key] = Simulator::Schedule (m_fragmentExpirationTimeout,
-                                                    &Ipv4L3Protocol::HandleFragmentsTimeout, this,
-                                                    key, ipHeader, iif);
-    }
-  else
-    {
-      fragments = it->second;
+      FragmentsEntry entry;
+      entry.fragments = Create<Fragments> ();
+      entry.header = ipHeader;
+      entry.iif = iif;
+      entry.timeout = Simulator::Schedule (m_fragmentExpirationTimeout,
+                                           &Ipv4L3Protocol::HandleFragmentsTimeout, this, key);
+      entry.age = m_fragmentsAge.insert (m_fragmentsAge.end (), key);
+      it = m_fragments.insert (std::make_pair (key, entry)).first;
     }
+  Ptr<Fragments> fragments = it->second.fragments;
 
   NS_LOG_LOGIC ("Adding fragment - Size: " << packet->GetSize ( ) << " - Offset: " << (ipHeader.GetFragmentOffset ()) );
 
+  m_fragmentsBytes -= fragments->GetSize ();
   fragments->AddFragment (p, ipHeader.GetFragmentOffset (), !ipHeader.IsLastFragment () );
+  m_fragmentsBytes += fragments->GetSize ();
 
   if ( fragments->IsEntire () )
     {
       packet = fragments->GetPacket ();
-      fragments = 0;
-      m_fragments.erase (key);
-      if (m_fragmentsTimers[key].IsRunning ())
-        {
-          NS_LOG_LOGIC ("Stopping WaitFragmentsTimer at " << Simulator::Now ().GetSeconds () << " due to complete packet");
-          m_fragmentsTimers[key].Cancel ();
-        }
-      m_fragmentsTimers.erase (key);
-      ret = true;
+      NS_LOG_LOGIC ("Stopping WaitFragmentsTimer at " << Simulator::Now ().GetSeconds () << " due to complete packet");
+      RemoveFragments (it);
+      return true;
+    }
+
+  // Drop the oldest packets, possibly this one, while the fragments
+  // take too much memory.
+  while (m_fragmentsBytes > m_maxFragmentsBytes)
+    {
+      it = m_fragments.find (m_fragmentsAge.front ());
+      NS_LOG_LOGIC ("Dropping the fragments of an old packet, fragments size=" << m_fragmentsBytes);
+      m_dropTrace (it->second.header, it->second.fragments->GetPartialPacket (), DROP_FRAGMENT_TIMEOUT,
+                   m_node->GetObject<Ipv4> (), it->second.iif);
+      RemoveFragments (it);
     }
+  return false;
+}
 
-  return ret;
+void
+Ipv4L3Protocol::RemoveFragments (MapFragments_t::iterator it)
+{
+  NS_LOG_FUNCTION (this);
+  it->second.timeout.Cancel ();
+  m_fragmentsBytes -= it->second.fragments->GetSize ();
+  m_fragmentsAge.erase (it->second.age);
+  m_fragments.erase (it);
+}
+
+size_t
+Ipv4L3Protocol::FragmentsKeyHash::operator() (FragmentsKey_t const &key) const
+{
+  uint32_t addresses = uint32_t (key.first >> 32) * 2654435761U ^ uint32_t (key.first);
+  return addresses * 2654435761U ^ key.second;
 }
 
 Ipv4L3Protocol::Fragments::Fragments ()
-  : m_moreFragment (0)
+  : m_lastFragment (false),
+    m_packetSize (0),
+    m_size (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -1314,52 +1436,83 @@ Ipv4L3Protocol::Fragments::AddFragment (Ptr<Packet> fragment, uint16_t fragmentO
 {
   NS_LOG_FUNCTION (this << fragment << fragmentOffset << moreFragment);
 
-  std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator it;
+  typedef std::map<uint32_t, Ptr<Packet> >::iterator FragmentsI;
+  uint32_t start = fragmentOffset;
+  uint32_t end = start + fragment->GetSize ();
 
-  for (it = m_fragments.begin (); it != m_fragments.end (); it++)
+  if (!moreFragment && !m_lastFragment)
     {
-      if (it->second > fragmentOffset)
+      // The size of the packet is now known: drop what was received beyond it.
+      m_lastFragment = true;
+      m_packetSize = end;
+      FragmentsI it = m_fragments.lower_bound (m_packetSize);
+      while (it != m_fragments.end ())
         {
-          break;
+          m_size -= it->second->GetSize ();
+          m_fragments.erase (it++);
+        }
+      if (!m_fragments.empty ())
+        {
+          it = --m_fragments.end ();
+          uint32_t fragmentEnd = it->first + it->second->GetSize ();
+          if (fragmentEnd > m_packetSize)
+            {
+              it->second = it->second->CreateFragment (0, m_packetSize - it->first);
+              m_size -= fragmentEnd - m_packetSize;
+            }
         }
     }
-
-  if (it == m_fragments.end ())
+  if (m_lastFragment)
     {
-      m_moreFragment = moreFragment;
+      end = std::min (end, m_packetSize);
     }
 
-  m_fragments.insert (it, std::make_pair<Ptr<Packet>, uint16_t> (fragment, fragmentOffset));
-}
-
-bool
-Ipv4L3Protocol::Fragments::IsEntire () const
-{
-  NS_LOG_FUNCTION (this);
-
-  bool ret = !m_moreFragment && m_fragments.size () > 0;
-
-  if (ret)
+  // The fragments might overlap in strange ways.  We do not overwrite
+  // the "old" with the "new" because we do not know when each arrived,
+  // so only the parts of the new fragment which fill the holes between
+  // the old ones are kept.  This is different from what Linux does.
+  // It is not possible to emulate a fragmentation attack.
+  FragmentsI it = m_fragments.upper_bound (start);
+  if (it != m_fragments.begin ())
     {
-      uint16_t lastEndOffset = 0;
-
-      for (std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_fragments.begin (); it != m_fragments.end (); it++)
+      FragmentsI previous = it;
+      --previous;
+      start = std::max (start, previous->first + previous->second->GetSize ());
+    }
+  while (start < end)
+    {
+      uint32_t holeEnd = end;
+      if (it != m_fragments.end ())
         {
-          // overlapping fragments do exist
-          NS_LOG_LOGIC ("Checking overlaps " << lastEndOffset << " - " << it->second );
-
-          if (lastEndOffset < it->second)
+          holeEnd = std::min (end, it->first);
+        }
+      if (start < holeEnd)
+        {
+          NS_LOG_LOGIC ("Adding: " << start << " - " << holeEnd);
+          Ptr<Packet> piece = fragment;
+          if (start != fragmentOffset || holeEnd - start != fragment->GetSize ())
             {
-              ret = false;
-              break;
+              piece = fragment->CreateFragment (start - fragmentOffset, holeEnd - start);
             }
-          // fragments might overlap in strange ways
-          uint16_t fragmentEnd = it->first->GetSize () + it->second;
-          lastEndOffset = std::max ( lastEndOffset, fragmentEnd );
+          m_fragments.insert (it, std::make_pair (start, piece));
+          m_size += holeEnd - start;
+        }
+      if (it == m_fragments.end ())
+        {
+          break;
         }
+      start = std::max (start, it->first + it->second->GetSize ());
+      ++it;
     }
+}
 
-  return ret;
+bool
+Ipv4L3Protocol::Fragments::IsEntire () const
+{
+  NS_LOG_FUNCTION (this);
+  // The fragments do not overlap and none is beyond the end of the
+  // packet, so they cover it when their sizes add up to its size.
+  return m_lastFragment && m_size == m_packetSize;
 }
 
 Ptr<Packet>
@@ -1367,33 +1520,11 @@ Ipv4L3Protocol::Fragments::GetPacket () const
 {
   NS_LOG_FUNCTION (this);
 
-  std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_fragments.begin ();
-
   Ptr<Packet> p = Create<Packet> ();
-  uint16_t lastEndOffset = 0;
-
-  for ( it = m_fragments.begin (); it != m_fragments.end (); it++)
+  for (std::map<uint32_t, Ptr<Packet> >::const_iterator it = m_fragments.begin (); it != m_fragments.end (); it++)
     {
-      if ( lastEndOffset > it->second )
-        {
-          // The fragments are overlapping.
-          // We do not overwrite the "old" with the "new" because we do not know when each arrived.
-          // This is different from what Linux does.
-          // It is not possible to emulate a fragmentation attack.
-          uint32_t newStart = lastEndOffset - it->second;
-          if ( it->first->GetSize () > newStart )
-            {
-              uint32_t newSize = it->first->GetSize () - newStart;
-              Ptr<Packet> tempFragment = it->first->CreateFragment (newStart, newSize);
-              p->AddAtEnd (tempFragment);
-            }
-        }
-      else
-        {
-          NS_LOG_LOGIC ("Adding: " << *(it->first) );
-          p->AddAtEnd (it->first);
-        }
-      lastEndOffset = p->GetSize ();
+      NS_LOG_LOGIC ("Adding: " << *(it->second) );
+      p->AddAtEnd (it->second);
     }
 
   return p;
@@ -1403,58 +1534,42 @@ Ptr<Packet>
 Ipv4L3Protocol::Fragments::GetPartialPacket () const
 {
   NS_LOG_FUNCTION (this);
-  
-  std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_fragments.begin ();
 
   Ptr<Packet> p = Create<Packet> ();
-  uint16_t lastEndOffset = 0;
-
-  if ( m_fragments.begin ()->second > 0 )
+  for (std::map<uint32_t, Ptr<Packet> >::const_iterator it = m_fragments.begin ();
+       it != m_fragments.end () && it->first == p->GetSize (); it++)
     {
-      return p;
-    }
-
-  for ( it = m_fragments.begin (); it != m_fragments.end (); it++)
-    {
-      if ( lastEndOffset > it->second )
-        {
-          uint32_t newStart = lastEndOffset - it->second;
-          uint32_t newSize = it->first->GetSize () - newStart;
-          Ptr<Packet> tempFragment = it->first->CreateFragment (newStart, newSize);
-          p->AddAtEnd (tempFragment);
-        }
-      else if ( lastEndOffset == it->second )
-        {
-          NS_LOG_LOGIC ("Adding: " << *(it->first) );
-          p->AddAtEnd (it->first);
-        }
-      lastEndOffset = p->GetSize ();
+      NS_LOG_LOGIC ("Adding: " << *(it->second) );
+      p->AddAtEnd (it->second);
     }
 
   return p;
 }
 
+uint32_t
+Ipv4L3Protocol::Fragments::GetSize () const
+{
+  return m_size;
+}
+
 void
-Ipv4L3Protocol::HandleFragmentsTimeout (std::pair<uint64_t, uint32_t> key, Ipv4Header & ipHeader, uint32_t iif)
+Ipv4L3Protocol::HandleFragmentsTimeout (FragmentsKey_t key)
 {
-  NS_LOG_FUNCTION (this << &key << &ipHeader << iif);
+  NS_LOG_FUNCTION (this << &key);
 
   MapFragments_t::iterator it = m_fragments.find (key);
-  Ptr<Packet> packet = it->second->GetPartialPacket ();
+  Ptr<Packet> packet = it->second.fragments->GetPartialPacket ();
 
   // if we have at least 8 bytes, we can send an ICMP.
   if ( packet->GetSize () > 8 )
     {
       Ptr<Icmpv4L4Protocol> icmp = GetIcmp ();
-      icmp->SendTimeExceededTtl (ipHeader, packet);
+      icmp->SendTimeExceededTtl (it->second.header, packet);
     }
-  m_dropTrace (ipHeader, packet, DROP_FRAGMENT_TIMEOUT, m_node->GetObject<Ipv4> (), iif);
+  m_dropTrace (it->second.header, packet, DROP_FRAGMENT_TIMEOUT, m_node->GetObject<Ipv4> (), it->second.iif);
 
   // clear the buffers
-  it->second = 0;
-
-  m_fragments.erase (key);
-  m_fragmentsTimers.erase (key);
+  RemoveFragments (it);
 }
 
 } // namespace ns3
@@ -34,6 +34,7 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/nstime.h"
 #include "ns3/simulator.h"
+#include "ns3/sgi-hashmap.h"
 
 namespace ns3 {
 
@@ -219,6 +220,7 @@ protected:
   virtual void NotifyNewAggregate ();
 private:
   friend class Ipv4L3ProtocolTestCase;
+  friend class Ipv4ReassemblyTest;
   Ipv4L3Protocol(const Ipv4L3Protocol &);
   Ipv4L3Protocol &operator = (const Ipv4L3Protocol &);
 
@@ -255,6 +257,32 @@ private:
   void LocalDeliver (Ptr<const Packet> p, Ipv4Header const&ip, uint32_t iif);
   void RouteInputError (Ptr<const Packet> p, const Ipv4Header & ipHeader, Socket::SocketErrno sockErrno);
 
+  /**
+   * \brief Forward a packet and keep its route in the forwarding cache
+   * \param rtentry route given by the routing protocol
+   * \param p packet to forward
+   * \param header IPv4 header of the packet
+   */
+  void IpForwardAndCache (Ptr<Ipv4Route> rtentry,
+                          Ptr<const Packet> p,
+                          const Ipv4Header &header);
+  /**
+   * \brief Look up the forwarding cache
+   * \param header IPv4 header of a received packet
+   * \param iif the input interface
+   * \returns the cached route to forward the packet with, or 0 if the
+   *          packet must be given to the routing protocol.
+   */
+  Ptr<Ipv4Route> LookupForwardingCache (const Ipv4Header &header, uint32_t iif);
+  /**
+   * \brief Remove all of the routes of the forwarding cache
+   *
+   * Invoked by the routing protocol when its routes change, and by the
+   * changes of the interfaces, of their addresses and of the routing
+   * protocol.
+   */
+  void FlushForwardingCache (void);
+
   uint32_t AddIpv4Interface (Ptr<Ipv4Interface> interface);
   void SetupLoopback (void);
 
@@ -282,13 +310,14 @@ private:
    */
   bool ProcessFragment (Ptr<Packet>& packet, Ipv4Header & ipHeader, uint32_t iif);
 
+  /// The source and destination addresses, and the identification and protocol of a fragmented packet
+  typedef std::pair<uint64_t, uint32_t> FragmentsKey_t;
+
   /**
    * \brief Process the timeout for packet fragments
    * \param key representing the packet fragments
-   * \param ipHeader the IP header of the original packet
-   * \param iif Input Interface
    */
-  void HandleFragmentsTimeout ( std::pair<uint64_t, uint32_t> key, Ipv4Header & ipHeader, uint32_t iif);
+  void HandleFragmentsTimeout (FragmentsKey_t key);
 
   typedef std::vector<Ptr<Ipv4Interface> > Ipv4InterfaceList;
   typedef std::list<Ptr<Ipv4RawSocketImpl> > SocketList;
@@ -317,6 +346,17 @@ private:
 
   SocketList m_sockets;
 
+  typedef sgi::hash_map<Ipv4Address, Ptr<Ipv4Route>, Ipv4AddressHash> ForwardingCache;
+
+  /// Set to true to cache the routes of the forwarded unicast packets
+  bool m_forwardingCacheEnabled;
+  /// Set to true once the routing protocol was asked whether it supports the cache
+  bool m_forwardingCacheChecked;
+  /// Set to true if the routing protocol supports the cache
+  bool m_forwardingCacheSupported;
+  /// The routes of the forwarded unicast packets, by destination
+  ForwardingCache m_forwardingCache;
+
   /**
    * \class Fragments
    * \brief A Set of Fragment belonging to the same packet (src, dst, identification and proto)
@@ -360,28 +400,84 @@ public:
      */
     Ptr<Packet> GetPartialPacket () const;
 
+    /**
+     * \brief Get the number of bytes held in the fragments.
+     * \return the number of bytes, without the overlapping parts
+     */
+    uint32_t GetSize () const;
+
 private:
     /**
-     * \brief True if other fragments will be sent.
+     * \brief True if the last fragment was received.
+     */
+    bool m_lastFragment;
+
+    /**
+     * \brief The size of the packet, known once the last fragment was received.
+     */
+    uint32_t m_packetSize;
+
+    /**
+     * \brief The number of bytes held in the fragments.
      */
-    bool m_moreFragment;
+    uint32_t m_size;
 
     /**
-     * \brief The current fragments.
+     * \brief The current fragments, by offset.  They do not overlap:
+     * the part of a new fragment which overlaps older ones is dropped.
      */
-    std::list<std::pair<Ptr<Packet>, uint16_t> > m_fragments;
+    std::map<uint32_t, Ptr<Packet> > m_fragments;
 
   };
 
-  typedef std::map< std::pair<uint64_t, uint32_t>, Ptr<Fragments> > MapFragments_t;
-  typedef std::map< std::pair<uint64_t, uint32_t>, EventId > MapFragmentsTimers_t;
+  /**
+   * \class FragmentsKeyHash
+   * \brief Hash function of the keys of the fragmented packets
+   */
+  class FragmentsKeyHash : public std::unary_function<FragmentsKey_t, size_t>
+  {
+public:
+    size_t operator() (FragmentsKey_t const &key) const;
+  };
+
+  /**
+   * \brief A packet being reassembled, with the header and input
+   * interface of its first fragment.
+   */
+  struct FragmentsEntry
+  {
+    Ptr<Fragments> fragments;
+    Ipv4Header header;
+    uint32_t iif;
+    EventId timeout;
+    std::list<FragmentsKey_t>::iterator age;
+  };
+
+  typedef sgi::hash_map<FragmentsKey_t, FragmentsEntry, FragmentsKeyHash> MapFragments_t;
+
+  /**
+   * \brief Stop the reassembly of a packet and forget its fragments
+   * \param it the packet being reassembled
+   */
+  void RemoveFragments (MapFragments_t::iterator it);
 
   /**
    * \brief The hash of fragmented packets.
    */
   MapFragments_t       m_fragments;
+  /**
+   * \brief The keys of the fragmented packets, oldest first.
+   */
+  std::list<FragmentsKey_t> m_fragmentsAge;
+  /**
+   * \brief The number of bytes in the fragments of all the packets.
+   */
+  uint32_t             m_fragmentsBytes;
+  /**
+   * \brief The maximum number of bytes in the fragments of all the packets.
+   */
+  uint32_t             m_maxFragmentsBytes;
   Time                 m_fragmentExpirationTimeout;
-  MapFragmentsTimers_t m_fragmentsTimers;
 
 };
 
@@ -66,6 +66,7 @@ Ipv4ListRouting::DoDispose (void)
     }
   m_routingProtocols.clear ();
   m_ipv4 = 0;
+  m_routeChangeCallback = MakeNullCallback<void> ();
 }
 
 void
@@ -84,6 +85,23 @@ Ipv4ListRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
   *stream->GetStream () << std::endl;
 }
 
+bool
+Ipv4ListRouting::SetRouteChangeCallback (Callback<void> cb)
+{
+  NS_LOG_FUNCTION (this);
+  m_routeChangeCallback = cb;
+  bool supported = true;
+  for (Ipv4RoutingProtocolList::const_iterator rprotoIter = m_routingProtocols.begin ();
+       rprotoIter != m_routingProtocols.end (); rprotoIter++)
+    {
+      if (!(*rprotoIter).second->SetRouteChangeCallback (cb))
+        {
+          supported = false;
+        }
+    }
+  return supported;
+}
+
 void
 Ipv4ListRouting::DoInitialize (void)
 {
@@ -258,6 +276,12 @@ Ipv4ListRouting::AddRoutingProtocol (Ptr<Ipv4RoutingProtocol> routingProtocol, i
     {
       routingProtocol->SetIpv4 (m_ipv4);
     }
+  if (!m_routeChangeCallback.IsNull ())
+    {
+      // the new protocol may take over some destinations, or not
+      // support the forwarding cache at all.
+      m_routeChangeCallback ();
+    }
 }
 
 uint32_t 
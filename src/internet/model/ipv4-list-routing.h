@@ -87,6 +87,7 @@ public:
   virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
   virtual void SetIpv4 (Ptr<Ipv4> ipv4);
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const;
+  virtual bool SetRouteChangeCallback (Callback<void> cb);
 
 protected:
   void DoDispose (void);
@@ -97,6 +98,7 @@ private:
   Ipv4RoutingProtocolList m_routingProtocols;
   static bool Compare (const Ipv4RoutingProtocolEntry& a, const Ipv4RoutingProtocolEntry& b);
   Ptr<Ipv4> m_ipv4;
+  Callback<void> m_routeChangeCallback;
 
 };
 
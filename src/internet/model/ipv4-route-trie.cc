@@ -0,0 +1,232 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include "ipv4-route-trie.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4RouteTrie");
+
+namespace ns3 {
+
+const uint32_t Ipv4RouteTrie::MAX_MATCHES;
+
+Ipv4RouteTrie::Ipv4RouteTrie ()
+  : m_root (new Node ())
+{
+  NS_LOG_FUNCTION (this);
+  m_root->prefix = 0;
+  m_root->length = 0;
+  m_root->children[0] = 0;
+  m_root->children[1] = 0;
+}
+
+Ipv4RouteTrie::~Ipv4RouteTrie ()
+{
+  NS_LOG_FUNCTION (this);
+  Delete (m_root);
+}
+
+void
+Ipv4RouteTrie::Delete (Node *node)
+{
+  if (node != 0)
+    {
+      Delete (node->children[0]);
+      Delete (node->children[1]);
+      delete node;
+    }
+}
+
+uint32_t
+Ipv4RouteTrie::GetPrefixLength (Ipv4Mask mask)
+{
+  uint32_t length = mask.GetPrefixLength ();
+  NS_ASSERT_MSG (mask.Get () == GetMask (length), "Ipv4RouteTrie: non contiguous mask " << mask);
+  return length;
+}
+
+uint32_t
+Ipv4RouteTrie::GetMask (uint32_t length)
+{
+  return length == 0 ? 0 : 0xffffffff << (32 - length);
+}
+
+uint32_t
+Ipv4RouteTrie::GetBit (uint32_t address, uint32_t index)
+{
+  return (address >> (31 - index)) & 1;
+}
+
+void
+Ipv4RouteTrie::Add (Ipv4Address network, Ipv4Mask mask, Ipv4RoutingTableEntry *route, uint32_t value)
+{
+  NS_LOG_FUNCTION (this << network << mask << route << value);
+  uint32_t length = GetPrefixLength (mask);
+  uint32_t prefix = network.Get () & GetMask (length);
+  Node *node = m_root;
+  while (node->length != length)
+    {
+      // node is a strict prefix of the new one, so the new one is
+      // below the child given by the next bit.
+      Node *&child = node->children[GetBit (prefix, node->length)];
+      if (child == 0)
+        {
+          child = new Node ();
+          child->prefix = prefix;
+          child->length = length;
+          child->children[0] = 0;
+          child->children[1] = 0;
+          node = child;
+          break;
+        }
+      uint32_t common = node->length + 1;
+      uint32_t max = std::min<uint32_t> (child->length, length);
+      while (common < max && GetBit (prefix, common) == GetBit (child->prefix, common))
+        {
+          common++;
+        }
+      if (common == child->length)
+        {
+          node = child;
+          continue;
+        }
+      // split the edge to the child at the first differing bit, or at
+      // the new prefix if the child is below it.
+      Node *split = new Node ();
+      split->prefix = prefix & GetMask (common);
+      split->length = common;
+      split->children[0] = 0;
+      split->children[1] = 0;
+      split->children[GetBit (child->prefix, common)] = child;
+      child = split;
+      node = split;
+    }
+  Entry entry;
+  entry.route = route;
+  entry.value = value;
+  node->entries.push_back (entry);
+}
+
+bool
+Ipv4RouteTrie::Remove (Ipv4Address network, Ipv4Mask mask, Ipv4RoutingTableEntry *route)
+{
+  NS_LOG_FUNCTION (this << network << mask << route);
+  uint32_t length = GetPrefixLength (mask);
+  uint32_t prefix = network.Get () & GetMask (length);
+  Node *parent = 0;
+  Node *node = m_root;
+  while (node->length < length)
+    {
+      Node *child = node->children[GetBit (prefix, node->length)];
+      if (child == 0 || child->length > length
+          || (prefix & GetMask (child->length)) != child->prefix)
+        {
+          return false;
+        }
+      parent = node;
+      node = child;
+    }
+  Entries::iterator i = node->entries.begin ();
+  while (i != node->entries.end () && i->route != route)
+    {
+      i++;
+    }
+  if (i == node->entries.end ())
+    {
+      return false;
+    }
+  node->entries.erase (i);
+  // remove the nodes which no longer hold entries nor branch.
+  while (parent != 0 && node->entries.empty ()
+         && (node->children[0] == 0 || node->children[1] == 0))
+    {
+      Node *child = node->children[0] != 0 ? node->children[0] : node->children[1];
+      parent->children[GetBit (node->prefix, parent->length)] = child;
+      delete node;
+      if (child != 0 || parent == m_root)
+        {
+          break;
+        }
+      // the parent lost a branch and might now be a useless split node.
+      node = parent;
+      parent = m_root;
+      while (parent->children[GetBit (node->prefix, parent->length)] != node)
+        {
+          parent = parent->children[GetBit (node->prefix, parent->length)];
+        }
+    }
+  return true;
+}
+
+void
+Ipv4RouteTrie::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  Delete (m_root->children[0]);
+  Delete (m_root->children[1]);
+  m_root->children[0] = 0;
+  m_root->children[1] = 0;
+  m_root->entries.clear ();
+}
+
+const Ipv4RouteTrie::Entries *
+Ipv4RouteTrie::Find (Ipv4Address network, Ipv4Mask mask) const
+{
+  uint32_t length = GetPrefixLength (mask);
+  uint32_t prefix = network.Get () & GetMask (length);
+  const Node *node = m_root;
+  while (node->length < length)
+    {
+      node = node->children[GetBit (prefix, node->length)];
+      if (node == 0 || node->length > length
+          || (prefix & GetMask (node->length)) != node->prefix)
+        {
+          return 0;
+        }
+    }
+  return node->entries.empty () ? 0 : &node->entries;
+}
+
+uint32_t
+Ipv4RouteTrie::Lookup (Ipv4Address dest, const Entries *matches[MAX_MATCHES]) const
+{
+  uint32_t address = dest.Get ();
+  uint32_t n = 0;
+  const Node *node = m_root;
+  while (true)
+    {
+      if (!node->entries.empty ())
+        {
+          matches[n++] = &node->entries;
+        }
+      if (node->length == 32)
+        {
+          break;
+        }
+      node = node->children[GetBit (address, node->length)];
+      if (node == 0 || (address & GetMask (node->length)) != node->prefix)
+        {
+          break;
+        }
+    }
+  return n;
+}
+
+} // namespace ns3
@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef IPV4_ROUTE_TRIE_H
+#define IPV4_ROUTE_TRIE_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+class Ipv4RoutingTableEntry;
+
+/**
+ * \ingroup internet
+ *
+ * \brief A path-compressed binary trie which indexes the routing table
+ * entries of Ipv4GlobalRouting and Ipv4StaticRouting by destination
+ * prefix.
+ *
+ * Each prefix of the trie holds the entries added for it, in the order
+ * in which they were added, together with a value chosen by the
+ * routing protocol (a metric or a sequence number).  A lookup returns
+ * the entries of all of the prefixes which match an address, so the
+ * routing protocols keep their own selection rules (longest prefix and
+ * metric, or equal-cost multipath) while visiting at most one trie
+ * node per distinct prefix length on the path to the address instead
+ * of scanning the whole table.
+ *
+ * The trie does not own the routing table entries.  Only contiguous
+ * network masks are supported.
+ */
+class Ipv4RouteTrie
+{
+public:
+  /// A routing table entry and the value given with it to Add.
+  struct Entry
+  {
+    Ipv4RoutingTableEntry *route;
+    uint32_t value;
+  };
+  typedef std::vector<Entry> Entries;
+  /// The number of prefix lengths of an IPv4 address (0 to 32).
+  static const uint32_t MAX_MATCHES = 33;
+
+  Ipv4RouteTrie ();
+  ~Ipv4RouteTrie ();
+
+  /**
+   * \param network the destination network of the route
+   * \param mask the network mask of the route
+   * \param route the routing table entry
+   * \param value a value stored with the entry
+   *
+   * Add the entry after the other entries of the same prefix.
+   */
+  void Add (Ipv4Address network, Ipv4Mask mask, Ipv4RoutingTableEntry *route, uint32_t value);
+  /**
+   * \param network the destination network of the route
+   * \param mask the network mask of the route
+   * \param route the routing table entry to remove
+   * \returns true if the entry was found and removed.
+   */
+  bool Remove (Ipv4Address network, Ipv4Mask mask, Ipv4RoutingTableEntry *route);
+  /**
+   * Remove all of the entries.
+   */
+  void Clear (void);
+  /**
+   * \param network the destination network
+   * \param mask the network mask
+   * \returns the entries of this exact prefix, or 0 if there are none.
+   */
+  const Entries * Find (Ipv4Address network, Ipv4Mask mask) const;
+  /**
+   * \param dest the address to look up
+   * \param matches filled with the entries of the prefixes which match
+   *        dest, from the shortest to the longest prefix
+   * \returns the number of prefixes stored in matches
+   */
+  uint32_t Lookup (Ipv4Address dest, const Entries *matches[MAX_MATCHES]) const;
+
+private:
+  struct Node
+  {
+    uint32_t prefix;
+    uint8_t length;
+    Node *children[2];
+    Entries entries;
+  };
+
+  Ipv4RouteTrie (const Ipv4RouteTrie &o);
+  Ipv4RouteTrie &operator = (const Ipv4RouteTrie &o);
+
+  static uint32_t GetPrefixLength (Ipv4Mask mask);
+  static uint32_t GetMask (uint32_t length);
+  static uint32_t GetBit (uint32_t address, uint32_t index);
+  static void Delete (Node *node);
+
+  Node *m_root;
+};
+
+} // namespace ns3
+
+#endif /* IPV4_ROUTE_TRIE_H */
@@ -35,4 +35,10 @@ TypeId Ipv4RoutingProtocol::GetTypeId (void)
   return tid;
 }
 
+bool
+Ipv4RoutingProtocol::SetRouteChangeCallback (Callback<void> cb)
+{
+  return false;
+}
+
 } // namespace ns3
@@ -152,6 +152,22 @@ public:
    * \param stream the ostream the Routing table is printed to
    */
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const = 0;
+
+  /**
+   * \brief Let the forwarding cache of Ipv4L3Protocol reuse the unicast routes
+   * given by RouteInput
+   *
+   * \param cb the callback to invoke whenever the unicast routes given by
+   *           RouteInput may change
+   * \returns true if the unicast route given by RouteInput for a packet
+   *          only depends on its destination and may be reused for the
+   *          following packets to that destination until cb is invoked,
+   *          false otherwise.
+   *
+   * The default implementation returns false, so that RouteInput is
+   * called for every received packet.
+   */
+  virtual bool SetRouteChangeCallback (Callback<void> cb);
 };
 
 } // namespace ns3
@@ -72,6 +72,8 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_networkRouteTrie.Add (network, networkMask, route, metric);
+  NotifyRouteChange ();
 }
 
 void 
@@ -86,6 +88,8 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_networkRouteTrie.Add (network, networkMask, route, metric);
+  NotifyRouteChange ();
 }
 
 void 
@@ -143,6 +147,8 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
                                                         networkMask,
                                                         outputInterface);
   m_networkRoutes.push_back (make_pair (route,0));
+  m_networkRouteTrie.Add (network, networkMask, route, 0);
+  NotifyRouteChange ();
 }
 
 uint32_t 
@@ -223,7 +229,6 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
 {
   NS_LOG_FUNCTION (this << dest << " " << oif);
   Ptr<Ipv4Route> rtentry = 0;
-  uint16_t longest_mask = 0;
   uint32_t shortest_metric = 0xffffffff;
   /* when sending on local multicast, there have to be interface specified */
   if (dest.IsLocalMulticast ())
@@ -239,19 +244,22 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 
 
-  for (NetworkRoutesI i = m_networkRoutes.begin (); 
-       i != m_networkRoutes.end (); 
-       i++) 
+  // the matching prefixes are visited from the longest one, and the
+  // first one with a usable route wins.  Among the routes of that
+  // prefix, the last one with the smallest metric is chosen.
+  const Ipv4RouteTrie::Entries *matches[Ipv4RouteTrie::MAX_MATCHES];
+  uint32_t nMatches = m_networkRouteTrie.Lookup (dest, matches);
+  for (uint32_t k = nMatches; k > 0 && rtentry == 0; k--)
     {
-      Ipv4RoutingTableEntry *j=i->first;
-      uint32_t metric =i->second;
-      Ipv4Mask mask = (j)->GetDestNetworkMask ();
-      uint16_t masklen = mask.GetPrefixLength ();
-      Ipv4Address entry = (j)->GetDestNetwork ();
-      NS_LOG_LOGIC ("Searching for route to " << dest << ", checking against route to " << entry << "/" << masklen);
-      if (mask.IsMatch (dest, entry)) 
+      const Ipv4RouteTrie::Entries *routes = matches[k - 1];
+      Ipv4RoutingTableEntry *route = 0;
+      for (Ipv4RouteTrie::Entries::const_iterator i = routes->begin (); 
+           i != routes->end (); 
+           i++) 
         {
-          NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << masklen << ", metric " << metric);
+          Ipv4RoutingTableEntry *j = i->route;
+          uint32_t metric = i->value;
+          NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << j->GetDestNetworkMask ().GetPrefixLength () << ", metric " << metric);
           if (oif != 0)
             {
               if (oif != m_ipv4->GetNetDevice (j->GetInterface ()))
@@ -260,23 +268,16 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
                   continue;
                 }
             }
-          if (masklen < longest_mask) // Not interested if got shorter mask
-            {
-              NS_LOG_LOGIC ("Previous match longer, skipping");
-              continue;
-            }
-          if (masklen > longest_mask) // Reset metric if longer masklen
-            {
-              shortest_metric = 0xffffffff;
-            }
-          longest_mask = masklen;
           if (metric > shortest_metric)
             {
               NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
               continue;
             }
           shortest_metric = metric;
-          Ipv4RoutingTableEntry* route = (j);
+          route = j;
+        }
+      if (route != 0)
+        {
           uint32_t interfaceIdx = route->GetInterface ();
           rtentry = Create<Ipv4Route> ();
           rtentry->SetDestination (route->GetDest ());
@@ -442,6 +443,8 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
     {
       if (tmp == index)
         {
+          m_networkRouteTrie.Remove (j->first->GetDestNetwork (), j->first->GetDestNetworkMask (), j->first);
+          NotifyRouteChange ();
           delete j->first;
           m_networkRoutes.erase (j);
           return;
@@ -592,6 +595,8 @@ Ipv4StaticRouting::DoDispose (void)
     {
       delete (j->first);
     }
+  m_networkRouteTrie.Clear ();
+  m_routeChangeCallback = MakeNullCallback<void> ();
   for (MulticastRoutesI i = m_multicastRoutes.begin (); 
        i != m_multicastRoutes.end (); 
        i = m_multicastRoutes.erase (i)) 
@@ -748,6 +753,24 @@ Ipv4StaticRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
         }
     }
 }
+
+bool
+Ipv4StaticRouting::SetRouteChangeCallback (Callback<void> cb)
+{
+  NS_LOG_FUNCTION (this);
+  m_routeChangeCallback = cb;
+  return true;
+}
+
+void
+Ipv4StaticRouting::NotifyRouteChange (void)
+{
+  if (!m_routeChangeCallback.IsNull ())
+    {
+      m_routeChangeCallback ();
+    }
+}
+
 Ipv4Address
 Ipv4StaticRouting::SourceAddressSelection (uint32_t interfaceIdx, Ipv4Address dest)
 {
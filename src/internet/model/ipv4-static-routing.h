@@ -31,6 +31,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-route-trie.h"
 
 namespace ns3 {
 
@@ -86,6 +87,7 @@ public:
   virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
   virtual void SetIpv4 (Ptr<Ipv4> ipv4);
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const;
+  virtual bool SetRouteChangeCallback (Callback<void> cb);
 
 /**
  * \brief Add a network route to the static routing table.
@@ -388,9 +390,14 @@ private:
                                         uint32_t interface);
 
   Ipv4Address SourceAddressSelection (uint32_t interface, Ipv4Address dest);
+  void NotifyRouteChange (void);
 
   NetworkRoutes m_networkRoutes;
+  /// The network routes, indexed by destination prefix with their metric
+  Ipv4RouteTrie m_networkRouteTrie;
   MulticastRoutes m_multicastRoutes;
+  /// Invoked whenever the unicast routes change, for the forwarding cache of Ipv4L3Protocol
+  Callback<void> m_routeChangeCallback;
 
   Ptr<Ipv4> m_ipv4;
 };
@@ -18,6 +18,8 @@
  * Author: Sebastien Vincent <vincent@clarinet.u-strasbg.fr>
  */
 
+#include <algorithm>
+#include <iterator>
 #include "ipv6-end-point-demux.h"
 #include "ipv6-end-point.h"
 #include "ns3/log.h"
@@ -29,7 +31,8 @@ NS_LOG_COMPONENT_DEFINE ("Ipv6EndPointDemux");
 Ipv6EndPointDemux::Ipv6EndPointDemux ()
   : m_ephemeral (49152),
     m_portFirst (49152),
-    m_portLast (65535)
+    m_portLast (65535),
+    m_rank (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -37,39 +40,154 @@ Ipv6EndPointDemux::Ipv6EndPointDemux ()
 Ipv6EndPointDemux::~Ipv6EndPointDemux ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  for (std::map<uint64_t, Ipv6EndPoint *>::iterator i = m_endPoints.begin (); i != m_endPoints.end (); i++)
     {
-      Ipv6EndPoint *endPoint = *i;
+      Ipv6EndPoint *endPoint = i->second;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
+  m_ports.clear ();
+  m_localAddressPorts.clear ();
 }
 
-bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+size_t Ipv6EndPointDemux::AddressPortHash::operator() (AddressPort const &x) const
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  return Ipv6AddressHash () (x.first) ^ (x.second * 2654435761U);
+}
+
+bool Ipv6EndPointDemux::IsAllocatedBefore (Ipv6EndPoint *a, Ipv6EndPoint *b)
+{
+  return a->m_rank < b->m_rank;
+}
+
+bool Ipv6EndPointDemux::HasWildcardPeer (Ipv6EndPoint *endPoint)
+{
+  return endPoint->GetPeerAddress () == Ipv6Address::GetAny () || endPoint->GetPeerPort () == 0;
+}
+
+void Ipv6EndPointDemux::InsertInOrder (EndPoints &endPoints, Ipv6EndPoint *endPoint)
+{
+  if (endPoints.empty () || IsAllocatedBefore (endPoints.back (), endPoint))
+    {
+      endPoints.push_back (endPoint);
+    }
+  else
     {
-      if ((*i)->GetLocalPort  () == port)
+      endPoints.insert (std::upper_bound (endPoints.begin (), endPoints.end (), endPoint, &IsAllocatedBefore),
+                        endPoint);
+    }
+}
+
+void Ipv6EndPointDemux::Erase (EndPoints &endPoints, Ipv6EndPoint *endPoint)
+{
+  EndPointsI i = std::find (endPoints.begin (), endPoints.end (), endPoint);
+  NS_ASSERT (i != endPoints.end ());
+  endPoints.erase (i);
+}
+
+Ipv6EndPoint* Ipv6EndPointDemux::Insert (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  endPoint->m_rank = m_rank++;
+  endPoint->m_demux = this;
+  m_endPoints[endPoint->m_rank] = endPoint;
+  Index (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  return endPoint;
+}
+
+void Ipv6EndPointDemux::Index (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  PortEndPoints &port = m_ports[endPoint->GetLocalPort ()];
+  if (HasWildcardPeer (endPoint))
+    {
+      InsertInOrder (port.unconnected, endPoint);
+    }
+  else
+    {
+      InsertInOrder (port.connected[AddressPort (endPoint->GetPeerAddress (), endPoint->GetPeerPort ())], endPoint);
+    }
+  m_localAddressPorts[AddressPort (endPoint->GetLocalAddress (), endPoint->GetLocalPort ())]++;
+}
+
+void Ipv6EndPointDemux::Unindex (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Ports::iterator port = m_ports.find (endPoint->GetLocalPort ());
+  NS_ASSERT (port != m_ports.end ());
+  if (HasWildcardPeer (endPoint))
+    {
+      Erase (port->second.unconnected, endPoint);
+    }
+  else
+    {
+      PeerEndPoints::iterator peer = port->second.connected.find (AddressPort (endPoint->GetPeerAddress (), endPoint->GetPeerPort ()));
+      NS_ASSERT (peer != port->second.connected.end ());
+      Erase (peer->second, endPoint);
+      if (peer->second.empty ())
         {
-          return true;
+          port->second.connected.erase (peer);
         }
     }
-  return false;
+  if (port->second.unconnected.empty () && port->second.connected.empty ())
+    {
+      m_ports.erase (port);
+    }
+  LocalAddressPorts::iterator local = m_localAddressPorts.find (AddressPort (endPoint->GetLocalAddress (), endPoint->GetLocalPort ()));
+  NS_ASSERT (local != m_localAddressPorts.end ());
+  if (--local->second == 0)
+    {
+      m_localAddressPorts.erase (local);
+    }
 }
 
-bool Ipv6EndPointDemux::LookupLocal (Ipv6Address addr, uint16_t port)
+const Ipv6EndPointDemux::EndPoints & Ipv6EndPointDemux::GetCandidates (uint16_t port, Ipv6Address peerAddress, uint16_t peerPort,
+                                                                        EndPoints &merged)
 {
-  NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  Ports::iterator i = m_ports.find (port);
+  if (i == m_ports.end ())
+    {
+      return merged;
+    }
+  PeerEndPoints::iterator peer = i->second.connected.find (AddressPort (peerAddress, peerPort));
+  if (peer == i->second.connected.end ())
+    {
+      return i->second.unconnected;
+    }
+  std::merge (i->second.unconnected.begin (), i->second.unconnected.end (),
+              peer->second.begin (), peer->second.end (),
+              std::back_inserter (merged), &IsAllocatedBefore);
+  return merged;
+}
+
+Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::GetPortEndPoints (uint16_t port)
+{
+  EndPoints endPoints;
+  Ports::iterator i = m_ports.find (port);
+  if (i != m_ports.end ())
     {
-      if ((*i)->GetLocalPort () == port
-          && (*i)->GetLocalAddress () == addr)
+      endPoints = i->second.unconnected;
+      for (PeerEndPoints::iterator peer = i->second.connected.begin (); peer != i->second.connected.end (); peer++)
         {
-          return true;
+          endPoints.insert (endPoints.end (), peer->second.begin (), peer->second.end ());
         }
+      endPoints.sort (&IsAllocatedBefore);
     }
-  return false;
+  return endPoints;
+}
+
+bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_ports.find (port) != m_ports.end ();
+}
+
+bool Ipv6EndPointDemux::LookupLocal (Ipv6Address addr, uint16_t port)
+{
+  NS_LOG_FUNCTION (this << addr << port);
+  return m_localAddressPorts.find (AddressPort (addr, port)) != m_localAddressPorts.end ();
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
@@ -81,10 +199,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (Ipv6Address::GetAny (), port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
@@ -96,10 +211,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (address, port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (uint16_t port)
@@ -117,17 +229,16 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address, uint16_t port)
       NS_LOG_WARN ("Duplicate address/port; failing.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (address, port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address localAddress, uint16_t localPort,
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  EndPoints merged;
+  const EndPoints &candidates = GetCandidates (localPort, peerAddress, peerPort, merged);
+  for (EndPoints::const_iterator i = candidates.begin (); i != candidates.end (); i++)
     {
       if ((*i)->GetLocalPort () == localPort
           && (*i)->GetLocalAddress () == localAddress
@@ -141,24 +252,19 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address localAddress, uint16_t lo
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
-  return endPoint;
+  return Insert (endPoint);
 }
 
 void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  std::map<uint64_t, Ipv6EndPoint *>::iterator i = m_endPoints.find (endPoint->m_rank);
+  if (i != m_endPoints.end () && i->second == endPoint)
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      Unindex (endPoint);
+      endPoint->m_demux = 0;
+      m_endPoints.erase (i);
+      delete endPoint;
     }
 }
 
@@ -179,7 +285,9 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
   EndPoints retval4; /* Exact match on all 4 */
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  EndPoints merged;
+  const EndPoints &candidates = GetCandidates (dport, saddr, sport, merged);
+  for (EndPoints::const_iterator i = candidates.begin (); i != candidates.end (); i++)
     {
       Ipv6EndPoint* endP = *i;
       NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
@@ -282,8 +390,9 @@ Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport,
 {
   uint32_t genericity = 3;
   Ipv6EndPoint *generic = 0;
+  EndPoints endPoints = GetPortEndPoints (dport);
 
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  for (EndPointsI i = endPoints.begin (); i != endPoints.end (); i++)
     {
       uint32_t tmp = 0;
 
@@ -342,7 +451,12 @@ uint16_t Ipv6EndPointDemux::AllocateEphemeralPort ()
 
 Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::GetEndPoints () const
 {
-  return m_endPoints;
+  EndPoints endPoints;
+  for (std::map<uint64_t, Ipv6EndPoint *>::const_iterator i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+    {
+      endPoints.push_back (i->second);
+    }
+  return endPoints;
 }
 
 } /* namespace ns3 */
@@ -23,7 +23,10 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
+#include <utility>
 #include "ns3/ipv6-address.h"
+#include "ns3/sgi-hashmap.h"
 #include "ipv6-interface.h"
 
 namespace ns3 {
@@ -137,12 +140,90 @@ public:
   EndPoints GetEndPoints () const;
 
 private:
+  friend class Ipv6EndPoint;
+
+  /**
+   * \brief An address and a port, the key of the indices.
+   */
+  typedef std::pair<Ipv6Address, uint16_t> AddressPort;
+
+  /**
+   * \class AddressPortHash
+   * \brief Hash function class for AddressPort.
+   */
+  class AddressPortHash : public std::unary_function<AddressPort, size_t>
+  {
+public:
+    size_t operator() (AddressPort const &x) const;
+  };
+
+  typedef sgi::hash_map<AddressPort, EndPoints, AddressPortHash> PeerEndPoints;
+
+  /**
+   * \brief The end points bound to a local port.
+   *
+   * The end points whose peer address or port is a wildcard are kept
+   * apart from the others, which are indexed by peer address and port.  All of the lists are in allocation order.
+   */
+  struct PortEndPoints
+  {
+    EndPoints unconnected;
+    PeerEndPoints connected;
+  };
+
+  typedef sgi::hash_map<uint16_t, PortEndPoints> Ports;
+  typedef sgi::hash_map<AddressPort, uint32_t, AddressPortHash> LocalAddressPorts;
+
   /**
    * \brief Allocate a ephemeral port.
    * \return a port
    */
   uint16_t AllocateEphemeralPort ();
 
+  /**
+   * \brief Register and index a new end point.
+   * \param endPoint the end point
+   * \return the end point
+   */
+  Ipv6EndPoint * Insert (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Add an end point to the indices.
+   * \param endPoint the end point
+   */
+  void Index (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Remove an end point from the indices.
+   * \param endPoint the end point
+   */
+  void Unindex (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Get the end points of a local port which can match a peer.
+   * \param port local port
+   * \param peerAddress peer address
+   * \param peerPort peer port
+   * \param merged an empty list, which holds the result when both kinds
+   * of end points have to be merged
+   * \return the end points connected to this peer and the end points
+   * whose peer has a wildcard, in allocation order
+   */
+  const EndPoints &GetCandidates (uint16_t port, Ipv6Address peerAddress, uint16_t peerPort,
+                                  EndPoints &merged);
+
+  /**
+   * \brief Get all of the end points of a local port.
+   * \param port local port
+   * \return the end points, in allocation order
+   */
+  EndPoints GetPortEndPoints (uint16_t port);
+
+  static void InsertInOrder (EndPoints &endPoints, Ipv6EndPoint *endPoint);
+  static void Erase (EndPoints &endPoints, Ipv6EndPoint *endPoint);
+  static bool IsAllocatedBefore (Ipv6EndPoint *a, Ipv6EndPoint *b);
+  static bool HasWildcardPeer (Ipv6EndPoint *endPoint);
+
   /**
    * \brief The ephemeral port.
    */
@@ -159,9 +240,24 @@ private:
   uint16_t m_portLast;
 
   /**
-   * \brief A list of IPv6 end points.
+   * \brief All of the IPv6 end points, by allocation rank.
+   */
+  std::map<uint64_t, Ipv6EndPoint *> m_endPoints;
+
+  /**
+   * \brief The rank of the next allocated end point.
+   */
+  uint64_t m_rank;
+
+  /**
+   * \brief The end points by local port.
+   */
+  Ports m_ports;
+
+  /**
+   * \brief The number of end points for each local address and port.
    */
-  EndPoints m_endPoints;
+  LocalAddressPorts m_localAddressPorts;
 };
 
 } /* namespace ns3 */
@@ -33,6 +33,7 @@ namespace ns3
 
 class Header;
 class Packet;
+class Ipv6EndPointDemux;
 
 /**
  * \class Ipv6EndPoint
@@ -168,6 +169,8 @@ public:
                     uint8_t code, uint32_t info);
 
 private:
+  friend class Ipv6EndPointDemux;
+
   /**
    * \brief ForwardUp wrapper.
    * \param p packet
@@ -208,6 +211,17 @@ private:
    */
   uint16_t m_peerPort;
 
+  /**
+   * \brief The demux which indexes this end point by its addresses and
+   * ports, if any.
+   */
+  Ipv6EndPointDemux *m_demux;
+
+  /**
+   * \brief The allocation rank of this end point in m_demux.
+   */
+  uint64_t m_rank;
+
   /**
    * \brief The NetDevice the EndPoint is bound to (if any).
    */
@@ -36,6 +36,10 @@ class Packet;
  *
  * \brief class for the reordering buffer that keeps the data from lower layer, i.e.
  *        TcpL4Protocol, sent to the application
+ *
+ * The data is kept as non-overlapping blocks indexed by the sequence
+ * number of their first byte, so that a new segment is only compared
+ * with the blocks it may overlap.
  */
 class TcpRxBuffer : public Object
 {
@@ -53,7 +53,7 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_firstByteSeq (n), m_size (0), m_maxBuffer (32768), m_data (0)
+  : m_firstByteSeq (n), m_size (0), m_maxBuffer (32768)
 {
 }
 
@@ -107,7 +107,10 @@ TcpTxBuffer::Add (Ptr<Packet> p)
     {
       if (p->GetSize () > 0)
         {
-          m_data.push_back (p);
+          Item item;
+          item.seq = m_firstByteSeq + SequenceNumber32 (m_size);
+          item.packet = p;
+          m_data.push_back (item);
           m_size += p->GetSize ();
           NS_LOG_LOGIC ("Updated size=" << m_size << ", lastSeq=" << m_firstByteSeq + SequenceNumber32 (m_size));
         }
@@ -143,54 +146,32 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
       return Create<Packet> (s);
     }
 
-  // Extract data from the buffer and return
-  uint32_t offset = seq - m_firstByteSeq.Get ();
-  uint32_t count = 0;      // Offset of the first byte of a packet in the buffer
-  uint32_t pktSize = 0;
-  bool beginFound = false;
-  int pktCount = 0;
-  Ptr<Packet> outPacket;
-  NS_LOG_LOGIC ("There are " << m_data.size () << " number of packets in buffer");
-  for (BufIterator i = m_data.begin (); i != m_data.end (); ++i)
+  // Extract data from the buffer and return. The first packet is the
+  // last one which starts at or before seq.
+  BufIterator i = std::upper_bound (m_data.begin (), m_data.end (), seq, CompareSequence);
+  NS_ASSERT (i != m_data.begin ());
+  --i;
+  uint32_t packetOffset = seq - i->seq;
+  uint32_t fragmentLength = i->packet->GetSize () - packetOffset;
+  NS_LOG_LOGIC ("First byte found in packet of seq " << i->seq << ", packet len=" << i->packet->GetSize ());
+  if (fragmentLength >= s)
+    { // Data to be copied falls entirely in this packet
+      return i->packet->CreateFragment (packetOffset, s);
+    }
+  Ptr<Packet> outPacket = i->packet->CreateFragment (packetOffset, fragmentLength);
+  uint32_t count = fragmentLength;      // Number of bytes in the output packet
+  for (++i; count < s; ++i)
     {
-      pktCount++;
-      pktSize = (*i)->GetSize ();
-      if (!beginFound)
-        { // Look for first fragment
-          if (count + pktSize > offset)
-            {
-              NS_LOG_LOGIC ("First byte found in packet #" << pktCount << " at buffer offset " << count
-                                                           << ", packet len=" << pktSize);
-              beginFound = true;
-              uint32_t packetOffset = offset - count;
-              uint32_t fragmentLength = count + pktSize - offset;
-              if (fragmentLength >= s)
-                { // Data to be copied falls entirely in this packet
-                  return (*i)->CreateFragment (packetOffset, s);
-                }
-              else
-                { // This packet only fulfills part of the request
-                  outPacket = (*i)->CreateFragment (packetOffset, fragmentLength);
-                }
-              NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
-            }
-        }
-      else if (count + pktSize >= offset + s)
+      NS_ASSERT (i != m_data.end ());
+      uint32_t pktSize = i->packet->GetSize ();
+      if (count + pktSize > s)
         { // Last packet fragment found
-          NS_LOG_LOGIC ("Last byte found in packet #" << pktCount << " at buffer offset " << count
-                                                      << ", packet len=" << pktSize);
-          uint32_t fragmentLength = offset + s - count;
-          Ptr<Packet> endFragment = (*i)->CreateFragment (0, fragmentLength);
-          outPacket->AddAtEnd (endFragment);
-          NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
+          NS_LOG_LOGIC ("Last byte found in packet of seq " << i->seq << ", packet len=" << pktSize);
+          outPacket->AddAtEnd (i->packet->CreateFragment (0, s - count));
           break;
         }
-      else
-        {
-          NS_LOG_LOGIC ("Appending to output the packet #" << pktCount << " of offset " << count << " len=" << pktSize);
-          outPacket->AddAtEnd (*i);
-          NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
-        }
+      NS_LOG_LOGIC ("Appending to output the packet of seq " << i->seq << " len=" << pktSize);
+      outPacket->AddAtEnd (i->packet);
       count += pktSize;
     }
   NS_ASSERT (outPacket->GetSize () == s);
@@ -201,6 +182,13 @@ void
 TcpTxBuffer::SetHeadSequence (const SequenceNumber32& seq)
 {
   NS_LOG_FUNCTION (this << seq);
+  // The application may have sent data before the connection was set up
+  SequenceNumber32 itemSeq = seq;
+  for (BufIterator i = m_data.begin (); i != m_data.end (); ++i)
+    {
+      i->seq = itemSeq;
+      itemSeq += i->packet->GetSize ();
+    }
   m_firstByteSeq = seq;
 }
 
@@ -213,30 +201,27 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
   // Cases do not need to scan the buffer
   if (m_firstByteSeq >= seq) return;
 
-  // Scan the buffer and discard packets
-  uint32_t offset = seq - m_firstByteSeq.Get ();  // Number of bytes to remove
-  uint32_t pktSize;
-  NS_LOG_LOGIC ("Offset=" << offset);
-  BufIterator i = m_data.begin ();
-  while (i != m_data.end ())
+  // Discard the packets which are entirely behind seq, and trim the
+  // one which holds it.
+  while (!m_data.empty () && m_firstByteSeq < seq)
     {
-      if (offset > (*i)->GetSize ())
+      Item &item = m_data.front ();
+      uint32_t pktSize = item.packet->GetSize ();
+      uint32_t offset = seq - m_firstByteSeq.Get ();  // Number of bytes to remove
+      if (offset >= pktSize)
         { // This packet is behind the seqnum. Remove this packet from the buffer
-          pktSize = (*i)->GetSize ();
           m_size -= pktSize;
-          offset -= pktSize;
           m_firstByteSeq += pktSize;
-          i = m_data.erase (i);
-          NS_LOG_LOGIC ("Removed one packet of size " << pktSize << ", offset=" << offset);
+          m_data.pop_front ();
+          NS_LOG_LOGIC ("Removed one packet of size " << pktSize);
         }
-      else if (offset > 0)
+      else
         { // Part of the packet is behind the seqnum. Fragment
-          pktSize = (*i)->GetSize () - offset;
-          *i = (*i)->CreateFragment (offset, pktSize);
+          item.packet = item.packet->CreateFragment (offset, pktSize - offset);
+          item.seq = seq;
           m_size -= offset;
           m_firstByteSeq += offset;
-          NS_LOG_LOGIC ("Fragmented one packet by size " << offset << ", new size=" << pktSize);
-          break;
+          NS_LOG_LOGIC ("Fragmented one packet by size " << offset << ", new size=" << pktSize - offset);
         }
     }
   // Catching the case of ACKing a FIN
@@ -249,4 +234,10 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
   NS_ASSERT (m_firstByteSeq == seq);
 }
 
+bool
+TcpTxBuffer::CompareSequence (const SequenceNumber32 &seq, const Item &item)
+{
+  return seq < item.seq;
+}
+
 } // namepsace ns3
@@ -21,7 +21,7 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
-#include <list>
+#include <deque>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/object.h"
@@ -36,6 +36,12 @@ class Packet;
  *
  * \brief class for keeping the data sent by the application to the TCP socket, i.e.
  *        the sending buffer.
+ *
+ * The packets are kept in a deque together with the sequence number of
+ * their first byte, so that the packet holding a given sequence number
+ * is found by a binary search instead of a walk from the head of the
+ * buffer.  Segments are built from fragments of the buffered packets,
+ * which share their data.
  */
 class TcpTxBuffer : public Object
 {
@@ -108,12 +114,20 @@ public:
   void DiscardUpTo (const SequenceNumber32& seq);
 
 private:
-  typedef std::list<Ptr<Packet> >::iterator BufIterator;
+  /// A buffered packet and the sequence number of its first byte
+  struct Item
+  {
+    SequenceNumber32 seq;
+    Ptr<Packet> packet;
+  };
+  typedef std::deque<Item>::iterator BufIterator;
+
+  static bool CompareSequence (const SequenceNumber32 &seq, const Item &item);
 
   TracedValue<SequenceNumber32> m_firstByteSeq; //< Sequence number of the first byte in data (SND.UNA)
   uint32_t m_size;                              //< Number of data bytes
   uint32_t m_maxBuffer;                         //< Max number of data bytes in buffer (SND.WND)
-  std::list<Ptr<Packet> > m_data;               //< Corresponding data (may be null)
+  std::deque<Item> m_data;                      //< Corresponding data, by increasing sequence number
 };
 
 } // namepsace ns3
@@ -0,0 +1,297 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv6-end-point-demux.h"
+#include "ns3/ipv6-end-point.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-interface.h"
+
+using namespace ns3;
+
+/**
+ * A server with a listening end point and many connections on the
+ * same local port, plus end points whose peer is set after allocation.
+ */
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase ()
+  : TestCase ("Check the matches of Ipv4EndPointDemux with many connections on a port")
+{
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv4EndPointDemux demux;
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  Ipv4Address local ("10.0.0.1");
+
+  Ipv4EndPoint *listener = demux.Allocate (80);
+  NS_TEST_ASSERT_MSG_NE (listener, 0, "Could not allocate the listener");
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (Ipv4Address::GetAny (), 80), 0, "Allocated the same local address and port twice");
+  std::vector<Ipv4EndPoint *> connections;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      Ipv4EndPoint *endPoint = demux.Allocate (local, 80, Ipv4Address (0x0b000000 + i / 10), 1000 + i % 10);
+      NS_TEST_ASSERT_MSG_NE (endPoint, 0, "Could not allocate connection " << i);
+      connections.push_back (endPoint);
+    }
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (local, 80, Ipv4Address (0x0b000000), 1000), 0, "Allocated the same four-tuple twice");
+
+  for (uint32_t i = 0; i < connections.size (); i++)
+    {
+      Ipv4EndPointDemux::EndPoints endPoints = demux.Lookup (local, 80, Ipv4Address (0x0b000000 + i / 10), 1000 + i % 10, interface);
+      NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of matches for connection " << i);
+      NS_TEST_ASSERT_MSG_EQ (endPoints.front (), connections[i], "Wrong match for connection " << i);
+    }
+  Ipv4EndPointDemux::EndPoints endPoints = demux.Lookup (local, 80, Ipv4Address ("12.0.0.1"), 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of matches for a new peer");
+  NS_TEST_ASSERT_MSG_EQ (endPoints.front (), listener, "A new peer does not match the listener");
+  endPoints = demux.Lookup (local, 81, Ipv4Address ("12.0.0.1"), 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.empty (), true, "Matched an unused port");
+
+  // an end point which connects after its allocation, as a TCP client does.
+  Ipv4EndPoint *client = demux.Allocate ();
+  NS_TEST_ASSERT_MSG_NE (client, 0, "Could not allocate an ephemeral port");
+  uint16_t port = client->GetLocalPort ();
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (port), true, "Ephemeral port not found");
+  client->SetPeer (Ipv4Address ("12.0.0.2"), 80);
+  client->SetLocalAddress (local);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupLocal (local, port), true, "Local address of the client not found");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupLocal (Ipv4Address::GetAny (), port), false, "Stale local address of the client");
+  endPoints = demux.Lookup (local, port, Ipv4Address ("12.0.0.2"), 80, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of matches for the client");
+  NS_TEST_ASSERT_MSG_EQ (endPoints.front (), client, "Wrong match for the client");
+  endPoints = demux.Lookup (local, port, Ipv4Address ("12.0.0.3"), 80, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.empty (), true, "The client matches another peer");
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, port, Ipv4Address ("12.0.0.2"), 80), client, "SimpleLookup does not find the client");
+
+  demux.DeAllocate (client);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (port), false, "Deallocated port still found");
+  for (uint32_t i = 0; i < connections.size (); i += 2)
+    {
+      demux.DeAllocate (connections[i]);
+    }
+  endPoints = demux.Lookup (local, 80, Ipv4Address (0x0b000000), 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.front (), listener, "A closed connection still matches");
+  endPoints = demux.Lookup (local, 80, Ipv4Address (0x0b000000), 1001, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.front (), connections[1], "An open connection does not match");
+  NS_TEST_ASSERT_MSG_EQ (demux.GetAllEndPoints ().size (), 501, "Wrong number of end points");
+  NS_TEST_ASSERT_MSG_EQ (demux.GetAllEndPoints ().front (), listener, "End points not in allocation order");
+}
+
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase ()
+  : TestCase ("Check the matches of Ipv6EndPointDemux with many connections on a port")
+{
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv6EndPointDemux demux;
+  Ptr<Ipv6Interface> interface = CreateObject<Ipv6Interface> ();
+  Ipv6Address local ("2001::1");
+
+  Ipv6EndPoint *listener = demux.Allocate (80);
+  NS_TEST_ASSERT_MSG_NE (listener, 0, "Could not allocate the listener");
+  std::vector<Ipv6EndPoint *> connections;
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Ipv6EndPoint *endPoint = demux.Allocate (local, 80, Ipv6Address ("2001::2"), 1000 + i);
+      NS_TEST_ASSERT_MSG_NE (endPoint, 0, "Could not allocate connection " << i);
+      connections.push_back (endPoint);
+    }
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (local, 80, Ipv6Address ("2001::2"), 1000), 0, "Allocated the same four-tuple twice");
+  for (uint32_t i = 0; i < connections.size (); i++)
+    {
+      Ipv6EndPointDemux::EndPoints endPoints = demux.Lookup (local, 80, Ipv6Address ("2001::2"), 1000 + i, interface);
+      NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of matches for connection " << i);
+      NS_TEST_ASSERT_MSG_EQ (endPoints.front (), connections[i], "Wrong match for connection " << i);
+    }
+  Ipv6EndPointDemux::EndPoints endPoints = demux.Lookup (local, 80, Ipv6Address ("2001::3"), 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.front (), listener, "A new peer does not match the listener");
+
+  Ipv6EndPoint *client = demux.Allocate ();
+  uint16_t port = client->GetLocalPort ();
+  client->SetPeer (Ipv6Address ("2001::3"), 80);
+  endPoints = demux.Lookup (local, port, Ipv6Address ("2001::3"), 80, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of matches for the client");
+  NS_TEST_ASSERT_MSG_EQ (endPoints.front (), client, "Wrong match for the client");
+  client->SetLocalPort (port + 1);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (port), false, "Stale local port of the client");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (port + 1), true, "New local port of the client not found");
+  demux.DeAllocate (client);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (port + 1), false, "Deallocated port still found");
+  NS_TEST_ASSERT_MSG_EQ (demux.GetEndPoints ().size (), 101, "Wrong number of end points");
+}
+
+/**
+ * End points whose peer address or peer port is a wildcard, which match
+ * the peers on the other field only.
+ */
+class Ipv4EndPointDemuxWildcardPeerTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxWildcardPeerTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4EndPointDemuxWildcardPeerTestCase::Ipv4EndPointDemuxWildcardPeerTestCase ()
+  : TestCase ("Check the matches of Ipv4EndPointDemux with a wildcard peer address or port")
+{
+}
+
+void
+Ipv4EndPointDemuxWildcardPeerTestCase::DoRun (void)
+{
+  Ipv4EndPointDemux demux;
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  Ipv4Address local ("10.0.0.1");
+  Ipv4Address peer ("12.0.0.1");
+
+  Ipv4EndPoint *anyPort = demux.Allocate (local, 90, peer, 0);
+  NS_TEST_ASSERT_MSG_NE (anyPort, 0, "Could not allocate an end point with a wildcard peer port");
+  Ipv4EndPoint *anyAddress = demux.Allocate (local, 91, Ipv4Address::GetAny (), 5000);
+  NS_TEST_ASSERT_MSG_NE (anyAddress, 0, "Could not allocate an end point with a wildcard peer address");
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (local, 90, peer, 0), 0, "Allocated the same wildcard peer twice");
+  Ipv4EndPoint *connection = demux.Allocate (local, 90, peer, 1000);
+  NS_TEST_ASSERT_MSG_NE (connection, 0, "Could not allocate a connection");
+
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, 90, peer, 2000), anyPort, "The wildcard peer port does not match");
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, 91, Ipv4Address ("12.0.0.2"), 5000), anyAddress, "The wildcard peer address does not match");
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, 90, peer, 1000), connection, "The connection does not match");
+
+  Ipv4EndPointDemux::EndPoints endPoints = demux.Lookup (local, 90, peer, 0, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of matches for the wildcard peer port");
+  NS_TEST_ASSERT_MSG_EQ (endPoints.front (), anyPort, "Wrong match for the wildcard peer port");
+  endPoints = demux.Lookup (local, 90, peer, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of matches for the connection");
+  NS_TEST_ASSERT_MSG_EQ (endPoints.front (), connection, "Wrong match for the connection");
+  endPoints = demux.Lookup (local, 90, Ipv4Address ("12.0.0.2"), 0, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.empty (), true, "Another peer address matches");
+  endPoints = demux.Lookup (local, 91, Ipv4Address ("12.0.0.2"), 5001, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.empty (), true, "Another peer port matches");
+
+  // move the end points between the wildcard and connected lists
+  anyPort->SetPeer (peer, 3000);
+  anyAddress->SetPeer (peer, 0);
+  endPoints = demux.Lookup (local, 90, peer, 0, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.empty (), true, "A stale wildcard peer port matches");
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, 90, peer, 3000), anyPort, "The new peer port does not match");
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, 91, peer, 2000), anyAddress, "The new wildcard peer port does not match");
+  endPoints = demux.Lookup (local, 91, peer, 0, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of matches for the new wildcard peer port");
+  demux.DeAllocate (anyPort);
+  demux.DeAllocate (anyAddress);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (91), false, "Deallocated port still found");
+  NS_TEST_ASSERT_MSG_EQ (demux.GetAllEndPoints ().size (), 1, "Wrong number of end points");
+}
+
+class Ipv6EndPointDemuxWildcardPeerTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxWildcardPeerTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+Ipv6EndPointDemuxWildcardPeerTestCase::Ipv6EndPointDemuxWildcardPeerTestCase ()
+  : TestCase ("Check the matches of Ipv6EndPointDemux with a wildcard peer address or port")
+{
+}
+
+void
+Ipv6EndPointDemuxWildcardPeerTestCase::DoRun (void)
+{
+  Ipv6EndPointDemux demux;
+  Ptr<Ipv6Interface> interface = CreateObject<Ipv6Interface> ();
+  Ipv6Address local ("2001::1");
+  Ipv6Address peer ("2001::2");
+
+  Ipv6EndPoint *anyPort = demux.Allocate (local, 90, peer, 0);
+  NS_TEST_ASSERT_MSG_NE (anyPort, 0, "Could not allocate an end point with a wildcard peer port");
+  Ipv6EndPoint *anyAddress = demux.Allocate (local, 91, Ipv6Address::GetAny (), 5000);
+  NS_TEST_ASSERT_MSG_NE (anyAddress, 0, "Could not allocate an end point with a wildcard peer address");
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (local, 90, peer, 0), 0, "Allocated the same wildcard peer twice");
+  Ipv6EndPoint *connection = demux.Allocate (local, 90, peer, 1000);
+  NS_TEST_ASSERT_MSG_NE (connection, 0, "Could not allocate a connection");
+
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, 90, peer, 2000), anyPort, "The wildcard peer port does not match");
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, 91, Ipv6Address ("2001::3"), 5000), anyAddress, "The wildcard peer address does not match");
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, 90, peer, 1000), connection, "The connection does not match");
+
+  Ipv6EndPointDemux::EndPoints endPoints = demux.Lookup (local, 90, peer, 0, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of matches for the wildcard peer port");
+  NS_TEST_ASSERT_MSG_EQ (endPoints.front (), anyPort, "Wrong match for the wildcard peer port");
+  endPoints = demux.Lookup (local, 90, peer, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of matches for the connection");
+  NS_TEST_ASSERT_MSG_EQ (endPoints.front (), connection, "Wrong match for the connection");
+  endPoints = demux.Lookup (local, 90, Ipv6Address ("2001::3"), 0, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.empty (), true, "Another peer address matches");
+  endPoints = demux.Lookup (local, 91, Ipv6Address ("2001::3"), 5001, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.empty (), true, "Another peer port matches");
+
+  anyPort->SetPeer (peer, 3000);
+  anyAddress->SetPeer (peer, 0);
+  endPoints = demux.Lookup (local, 90, peer, 0, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.empty (), true, "A stale wildcard peer port matches");
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, 90, peer, 3000), anyPort, "The new peer port does not match");
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, 91, peer, 2000), anyAddress, "The new wildcard peer port does not match");
+  endPoints = demux.Lookup (local, 91, peer, 0, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of matches for the new wildcard peer port");
+  demux.DeAllocate (anyPort);
+  demux.DeAllocate (anyAddress);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (91), false, "Deallocated port still found");
+  NS_TEST_ASSERT_MSG_EQ (demux.GetEndPoints ().size (), 1, "Wrong number of end points");
+}
+
+class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite ();
+};
+
+EndPointDemuxTestSuite::EndPointDemuxTestSuite ()
+  : TestSuite ("end-point-demux", UNIT)
+{
+  AddTestCase (new Ipv4EndPointDemuxTestCase (), TestCase::QUICK);
+  AddTestCase (new Ipv6EndPointDemuxTestCase (), TestCase::QUICK);
+  AddTestCase (new Ipv4EndPointDemuxWildcardPeerTestCase (), TestCase::QUICK);
+  AddTestCase (new Ipv6EndPointDemuxWildcardPeerTestCase (), TestCase::QUICK);
+}
+
+static EndPointDemuxTestSuite g_endPointDemuxTestSuite;
@@ -53,13 +53,40 @@ GlobalRouteManagerImplTestCase::DoRun (void)
       candidate.Push (v);
     }
 
+  uint32_t lastDistance = 0;
   for (int i = 0; i < 100; ++i)
     {
       SPFVertex *v = candidate.Pop ();
+      NS_TEST_ASSERT_MSG_EQ ((v->GetDistanceFromRoot () >= lastDistance), true,
+                             "Vertices should be popped by increasing distance");
+      lastDistance = v->GetDistanceFromRoot ();
       delete v;
       v = 0;
     }
 
+  // a vertex whose distance decreases must move ahead of the others
+  SPFVertex *vertices[10];
+  for (int i = 0; i < 10; ++i)
+    {
+      vertices[i] = new SPFVertex;
+      vertices[i]->SetDistanceFromRoot (10 + i);
+      candidate.Push (vertices[i]);
+    }
+  vertices[7]->SetDistanceFromRoot (5);
+  candidate.Reorder (vertices[7]);
+  vertices[3]->SetDistanceFromRoot (5);
+  candidate.Reorder ();
+  NS_TEST_ASSERT_MSG_EQ (candidate.Pop (), vertices[7], "Reordered vertex should be popped first");
+  NS_TEST_ASSERT_MSG_EQ (candidate.Pop (), vertices[3], "Reordered vertex should be popped second");
+  for (int i = 0; i < 10; ++i)
+    {
+      if (i != 3 && i != 7)
+        {
+          NS_TEST_ASSERT_MSG_EQ (candidate.Pop (), vertices[i], "Vertices should be popped by increasing distance");
+        }
+      delete vertices[i];
+    }
+
   // Build fake link state database; four routers (0-3), 3 point-to-point
   // links
   //
@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/socket.h"
+#include "ns3/node.h"
+#include "ns3/boolean.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/internet-stack-helper.h"
+
+using namespace ns3;
+
+/**
+ * A router forwards packets to a destination with its forwarding cache
+ * enabled, while its static route to the destination changes.
+ */
+class Ipv4ForwardingCacheTestCase : public TestCase
+{
+public:
+  Ipv4ForwardingCacheTestCase ();
+private:
+  virtual void DoRun (void);
+  void Forward (const Ipv4Header &header, Ptr<const Packet> p, uint32_t interface);
+  void Send (Ptr<Socket> socket);
+  void ChangeRoute (Ptr<Ipv4StaticRouting> routing, Ipv4Address nextHop, uint32_t interface);
+
+  std::vector<uint32_t> m_interfaces;
+};
+
+Ipv4ForwardingCacheTestCase::Ipv4ForwardingCacheTestCase ()
+  : TestCase ("Check that the forwarding cache follows the route changes")
+{
+}
+
+void
+Ipv4ForwardingCacheTestCase::Forward (const Ipv4Header &header, Ptr<const Packet> p, uint32_t interface)
+{
+  m_interfaces.push_back (interface);
+}
+
+void
+Ipv4ForwardingCacheTestCase::Send (Ptr<Socket> socket)
+{
+  socket->SendTo (Create<Packet> (100), 0, InetSocketAddress (Ipv4Address ("10.9.0.1"), 9));
+}
+
+void
+Ipv4ForwardingCacheTestCase::ChangeRoute (Ptr<Ipv4StaticRouting> routing, Ipv4Address nextHop, uint32_t interface)
+{
+  for (uint32_t i = 0; i < routing->GetNRoutes (); i++)
+    {
+      if (routing->GetRoute (i).GetDest () == Ipv4Address ("10.9.0.1"))
+        {
+          routing->RemoveRoute (i);
+          break;
+        }
+    }
+  routing->AddHostRouteTo (Ipv4Address ("10.9.0.1"), nextHop, interface);
+}
+
+void
+Ipv4ForwardingCacheTestCase::DoRun (void)
+{
+  // a source, a router and two next hops, on three links
+  NodeContainer nodes;
+  nodes.Create (4);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  const char *addresses[3][2] = {
+    { "10.1.0.1", "10.1.0.2" },
+    { "10.2.0.1", "10.2.0.2" },
+    { "10.3.0.1", "10.3.0.2" }
+  };
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      Ptr<Node> ends[2] = { nodes.Get (i == 0 ? 0 : 1), nodes.Get (i == 0 ? 1 : i + 1) };
+      for (uint32_t j = 0; j < 2; j++)
+        {
+          Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+          device->SetAddress (Mac48Address::Allocate ());
+          device->SetChannel (channel);
+          ends[j]->AddDevice (device);
+          Ptr<Ipv4> ipv4 = ends[j]->GetObject<Ipv4> ();
+          uint32_t interface = ipv4->AddInterface (device);
+          ipv4->AddAddress (interface, Ipv4InterfaceAddress (Ipv4Address (addresses[i][j]), Ipv4Mask ("255.255.0.0")));
+          ipv4->SetUp (interface);
+        }
+    }
+  Ipv4StaticRoutingHelper helper;
+  helper.GetStaticRouting (nodes.Get (0)->GetObject<Ipv4> ())->SetDefaultRoute (Ipv4Address ("10.1.0.2"), 1);
+  Ptr<Ipv4StaticRouting> routing = helper.GetStaticRouting (nodes.Get (1)->GetObject<Ipv4> ());
+  routing->AddHostRouteTo (Ipv4Address ("10.9.0.1"), Ipv4Address ("10.2.0.2"), 2);
+  Ptr<Ipv4L3Protocol> router = nodes.Get (1)->GetObject<Ipv4L3Protocol> ();
+  router->SetAttribute ("ForwardingCache", BooleanValue (true));
+  router->TraceConnectWithoutContext ("UnicastForward", MakeCallback (&Ipv4ForwardingCacheTestCase::Forward, this));
+
+  Ptr<Socket> socket = nodes.Get (0)->GetObject<UdpSocketFactory> ()->CreateSocket ();
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Simulator::Schedule (Seconds (1 + i), &Ipv4ForwardingCacheTestCase::Send, this, socket);
+      Simulator::Schedule (Seconds (5 + i), &Ipv4ForwardingCacheTestCase::Send, this, socket);
+      Simulator::Schedule (Seconds (9 + i), &Ipv4ForwardingCacheTestCase::Send, this, socket);
+    }
+  Simulator::Schedule (Seconds (4), &Ipv4ForwardingCacheTestCase::ChangeRoute, this, routing, Ipv4Address ("10.3.0.2"), 3);
+  // the router takes the address of the destination, so that it now
+  // delivers the packets locally.
+  Simulator::Schedule (Seconds (8), &Ipv4L3Protocol::AddAddress, router, 2, Ipv4InterfaceAddress (Ipv4Address ("10.9.0.1"), Ipv4Mask ("255.255.255.255")));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_interfaces.size (), 6, "Wrong number of forwarded packets");
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_interfaces[i], 2, "Packet " << i << " forwarded on the wrong interface");
+      NS_TEST_ASSERT_MSG_EQ (m_interfaces[3 + i], 3, "Packet " << 3 + i << " forwarded with a stale route");
+    }
+}
+
+class Ipv4ForwardingCacheTestSuite : public TestSuite
+{
+public:
+  Ipv4ForwardingCacheTestSuite ();
+};
+
+Ipv4ForwardingCacheTestSuite::Ipv4ForwardingCacheTestSuite ()
+  : TestSuite ("ipv4-forwarding-cache", UNIT)
+{
+  AddTestCase (new Ipv4ForwardingCacheTestCase (), TestCase::QUICK);
+}
+
+static Ipv4ForwardingCacheTestSuite g_ipv4ForwardingCacheTestSuite;
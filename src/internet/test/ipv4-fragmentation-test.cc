@@ -402,11 +402,136 @@ Ipv4FragmentationTest::DoRun (void)
   Simulator::Destroy ();
 }
 //-----------------------------------------------------------------------------
+/**
+ * Feed the fragments of several packets straight to the reassembly,
+ * interleaved, out of order and overlapping, then check the memory cap.
+ */
+namespace ns3 {
+
+class Ipv4ReassemblyTest: public TestCase
+{
+  Ptr<Ipv4L3Protocol> m_ipv4;
+  uint32_t m_drops;
+
+public:
+  virtual void DoRun (void);
+  Ipv4ReassemblyTest ();
+
+  void DropTrace (const Ipv4Header &header, Ptr<const Packet> packet,
+                  Ipv4L3Protocol::DropReason reason, Ptr<Ipv4> ipv4, uint32_t iif);
+  bool AddFragment (Ipv4Address source, uint32_t offset, uint32_t size, bool last, Ptr<Packet> &packet);
+  bool CheckPacket (Ipv4Address source, Ptr<Packet> packet, uint32_t size);
+};
+
+Ipv4ReassemblyTest::Ipv4ReassemblyTest ()
+  : TestCase ("Verify the IPv4 reassembly of interleaved and overlapping fragments"),
+    m_drops (0)
+{
+}
+
+void
+Ipv4ReassemblyTest::DropTrace (const Ipv4Header &header, Ptr<const Packet> packet,
+                               Ipv4L3Protocol::DropReason reason, Ptr<Ipv4> ipv4, uint32_t iif)
+{
+  if (reason == Ipv4L3Protocol::DROP_FRAGMENT_TIMEOUT)
+    {
+      m_drops++;
+    }
+}
+
+bool
+Ipv4ReassemblyTest::AddFragment (Ipv4Address source, uint32_t offset, uint32_t size, bool last, Ptr<Packet> &packet)
+{
+  // the payload byte at offset i of the packet from source is i + source
+  uint8_t data[2000];
+  for (uint32_t i = 0; i < size; i++)
+    {
+      data[i] = offset + i + source.Get ();
+    }
+  packet = Create<Packet> (data, size);
+  Ipv4Header header;
+  header.SetSource (source);
+  header.SetDestination (Ipv4Address ("10.0.0.1"));
+  header.SetIdentification (7);
+  header.SetProtocol (17);
+  header.SetFragmentOffset (offset);
+  if (last)
+    {
+      header.SetLastFragment ();
+    }
+  else
+    {
+      header.SetMoreFragments ();
+    }
+  header.SetPayloadSize (size);
+  return m_ipv4->ProcessFragment (packet, header, 1);
+}
+
+bool
+Ipv4ReassemblyTest::CheckPacket (Ipv4Address source, Ptr<Packet> packet, uint32_t size)
+{
+  if (packet->GetSize () != size)
+    {
+      return false;
+    }
+  uint8_t data[10000];
+  packet->CopyData (data, size);
+  for (uint32_t i = 0; i < size; i++)
+    {
+      if (data[i] != uint8_t (i + source.Get ()))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+Ipv4ReassemblyTest::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  AddInternetStack (node);
+  m_ipv4 = node->GetObject<Ipv4L3Protocol> ();
+  m_ipv4->TraceConnectWithoutContext ("Drop", MakeCallback (&Ipv4ReassemblyTest::DropTrace, this));
+
+  // two packets with the same identification from two sources
+  Ipv4Address a ("10.0.0.2");
+  Ipv4Address b ("10.0.0.3");
+  Ptr<Packet> packet;
+  NS_TEST_EXPECT_MSG_EQ (AddFragment (a, 2000, 1000, true, packet), false, "Reassembled a packet from its last fragment");
+  NS_TEST_EXPECT_MSG_EQ (AddFragment (b, 0, 1000, false, packet), false, "Reassembled a packet from its first fragment");
+  NS_TEST_EXPECT_MSG_EQ (AddFragment (a, 0, 1200, false, packet), false, "Reassembled a packet with a hole");
+  NS_TEST_EXPECT_MSG_EQ (AddFragment (b, 1000, 1000, true, packet), true, "Could not reassemble the packet of b");
+  NS_TEST_EXPECT_MSG_EQ (CheckPacket (b, packet, 2000), true, "Wrong content of the packet of b");
+  // a fragment which overlaps both ends of the hole
+  NS_TEST_EXPECT_MSG_EQ (AddFragment (a, 800, 1600, false, packet), true, "Could not reassemble the packet of a");
+  NS_TEST_EXPECT_MSG_EQ (CheckPacket (a, packet, 3000), true, "Wrong content of the packet of a");
+  NS_TEST_EXPECT_MSG_EQ (m_ipv4->m_fragments.size (), 0, "Fragments left after the reassembly");
+  NS_TEST_EXPECT_MSG_EQ (m_ipv4->m_fragmentsBytes, 0, "Bytes left after the reassembly");
+
+  // the oldest packet is dropped when the fragments exceed the limit
+  m_ipv4->SetAttribute ("MaxFragmentsBytes", UintegerValue (2500));
+  AddFragment (a, 0, 1000, false, packet);
+  AddFragment (b, 0, 1000, false, packet);
+  NS_TEST_EXPECT_MSG_EQ (m_drops, 0, "Dropped fragments below the limit");
+  AddFragment (Ipv4Address ("10.0.0.4"), 0, 1000, false, packet);
+  NS_TEST_EXPECT_MSG_EQ (m_drops, 1, "Did not drop the oldest packet above the limit");
+  NS_TEST_EXPECT_MSG_EQ (m_ipv4->m_fragmentsBytes, 2000, "Wrong number of bytes after the drop");
+  NS_TEST_EXPECT_MSG_EQ (AddFragment (a, 1000, 1000, true, packet), false, "Reassembled a dropped packet");
+  NS_TEST_EXPECT_MSG_EQ (m_drops, 2, "Did not drop the packet of b after a new packet");
+  NS_TEST_EXPECT_MSG_EQ (AddFragment (Ipv4Address ("10.0.0.4"), 1000, 500, true, packet), true, "Could not reassemble a recent packet");
+
+  Simulator::Destroy ();
+}
+
+} // namespace ns3
+//-----------------------------------------------------------------------------
 class Ipv4FragmentationTestSuite : public TestSuite
 {
 public:
   Ipv4FragmentationTestSuite () : TestSuite ("ipv4-fragmentation", UNIT)
   {
     AddTestCase (new Ipv4FragmentationTest, TestCase::QUICK);
+    AddTestCase (new Ipv4ReassemblyTest, TestCase::QUICK);
   }
 } g_ipv4fragmentationTestSuite;
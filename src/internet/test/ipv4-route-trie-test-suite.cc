@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/ipv4-route-trie.h"
+#include "ns3/ipv4-routing-table-entry.h"
+
+using namespace ns3;
+
+class Ipv4RouteTrieTestCase : public TestCase
+{
+public:
+  Ipv4RouteTrieTestCase ();
+private:
+  virtual void DoRun (void);
+  uint32_t Random (void);
+  void Check (const Ipv4RouteTrie &trie, const std::vector<Ipv4RoutingTableEntry *> &routes,
+              Ipv4Address dest);
+
+  uint32_t m_state;
+};
+
+Ipv4RouteTrieTestCase::Ipv4RouteTrieTestCase ()
+  : TestCase ("Check the matches of Ipv4RouteTrie against a linear search"),
+    m_state (1)
+{
+}
+
+uint32_t
+Ipv4RouteTrieTestCase::Random (void)
+{
+  m_state = m_state * 1103515245 + 12345;
+  return m_state >> 8;
+}
+
+void
+Ipv4RouteTrieTestCase::Check (const Ipv4RouteTrie &trie, const std::vector<Ipv4RoutingTableEntry *> &routes,
+                              Ipv4Address dest)
+{
+  // the expected matches: the routes which match dest, by increasing
+  // prefix length and then in the order in which they were added.
+  std::vector<std::vector<Ipv4RoutingTableEntry *> > expected (33);
+  for (std::vector<Ipv4RoutingTableEntry *>::const_iterator i = routes.begin (); i != routes.end (); i++)
+    {
+      if (*i != 0 && (*i)->GetDestNetworkMask ().IsMatch (dest, (*i)->GetDestNetwork ()))
+        {
+          expected[(*i)->GetDestNetworkMask ().GetPrefixLength ()].push_back (*i);
+        }
+    }
+  const Ipv4RouteTrie::Entries *matches[Ipv4RouteTrie::MAX_MATCHES];
+  uint32_t n = trie.Lookup (dest, matches);
+  uint32_t k = 0;
+  for (uint32_t length = 0; length <= 32; length++)
+    {
+      if (expected[length].empty ())
+        {
+          continue;
+        }
+      NS_TEST_ASSERT_MSG_LT (k, n, "Missing match of length " << length << " for " << dest);
+      NS_TEST_ASSERT_MSG_EQ (matches[k]->size (), expected[length].size (), "Wrong matches of length " << length << " for " << dest);
+      for (uint32_t i = 0; i < expected[length].size (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((*matches[k])[i].route, expected[length][i], "Wrong match order for " << dest);
+          NS_TEST_ASSERT_MSG_EQ ((*matches[k])[i].value, expected[length][i]->GetInterface (), "Wrong value for " << dest);
+        }
+      NS_TEST_ASSERT_MSG_EQ (trie.Find (dest, Ipv4Mask (length == 0 ? 0 : 0xffffffff << (32 - length))),
+                             matches[k], "Find does not agree with Lookup for " << dest);
+      k++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (k, n, "Unexpected matches for " << dest);
+}
+
+void
+Ipv4RouteTrieTestCase::DoRun (void)
+{
+  Ipv4RouteTrie trie;
+  std::vector<Ipv4RoutingTableEntry *> routes;
+  // the prefixes are drawn in 10.0.0.0/12, with few distinct values of
+  // the low bits, so that they often nest or are equal.
+  for (uint32_t round = 0; round < 4; round++)
+    {
+      for (uint32_t i = 0; i < 300; i++)
+        {
+          uint32_t length = Random () % 33;
+          uint32_t address = 0x0a000000 | (Random () & 0x000f0000) | ((Random () % 4) * 0x01010101 & 0x0000ffff);
+          Ipv4Mask mask (length == 0 ? 0 : 0xffffffff << (32 - length));
+          Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
+          *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address (address), mask, routes.size ());
+          routes.push_back (route);
+          trie.Add (route->GetDestNetwork (), mask, route, route->GetInterface ());
+        }
+      for (uint32_t i = 0; i < 150; i++)
+        {
+          uint32_t index = Random () % routes.size ();
+          Ipv4RoutingTableEntry *route = routes[index];
+          if (route != 0)
+            {
+              NS_TEST_ASSERT_MSG_EQ (trie.Remove (route->GetDestNetwork (), route->GetDestNetworkMask (), route), true,
+                                     "Could not remove a route to " << route->GetDestNetwork ());
+              NS_TEST_ASSERT_MSG_EQ (trie.Remove (route->GetDestNetwork (), route->GetDestNetworkMask (), route), false,
+                                     "Removed a route twice");
+              delete route;
+              routes[index] = 0;
+            }
+        }
+      for (uint32_t i = 0; i < 500; i++)
+        {
+          Check (trie, routes, Ipv4Address (0x0a000000 | (Random () & 0x000f0000) | ((Random () % 4) * 0x01010101 & 0x0000ffff)));
+        }
+    }
+  trie.Clear ();
+  for (std::vector<Ipv4RoutingTableEntry *>::iterator i = routes.begin (); i != routes.end (); i++)
+    {
+      if (*i != 0)
+        {
+          Check (trie, std::vector<Ipv4RoutingTableEntry *> (), (*i)->GetDestNetwork ());
+          delete *i;
+        }
+    }
+}
+
+class Ipv4RouteTrieTestSuite : public TestSuite
+{
+public:
+  Ipv4RouteTrieTestSuite ();
+};
+
+Ipv4RouteTrieTestSuite::Ipv4RouteTrieTestSuite ()
+  : TestSuite ("ipv4-route-trie", UNIT)
+{
+  AddTestCase (new Ipv4RouteTrieTestCase (), TestCase::QUICK);
+}
+
+static Ipv4RouteTrieTestSuite g_ipv4RouteTrieTestSuite;
@@ -0,0 +1,183 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-tx-buffer.h"
+#include "ns3/tcp-rx-buffer.h"
+
+using namespace ns3;
+
+/**
+ * The byte of the stream at a given offset, so that the content of the
+ * segments can be checked.
+ */
+static uint8_t
+StreamByte (uint32_t offset)
+{
+  return (offset * 7 + offset / 251) & 0xff;
+}
+
+static Ptr<Packet>
+CreateStreamPacket (uint32_t offset, uint32_t size)
+{
+  std::vector<uint8_t> data (size);
+  for (uint32_t i = 0; i < size; i++)
+    {
+      data[i] = StreamByte (offset + i);
+    }
+  return Create<Packet> (&data[0], size);
+}
+
+static bool
+IsStreamPacket (Ptr<Packet> p, uint32_t offset)
+{
+  std::vector<uint8_t> data (p->GetSize () + 1);
+  p->CopyData (&data[0], p->GetSize ());
+  for (uint32_t i = 0; i < p->GetSize (); i++)
+    {
+      if (data[i] != StreamByte (offset + i))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+class TcpTxBufferTestCase : public TestCase
+{
+public:
+  TcpTxBufferTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TcpTxBufferTestCase::TcpTxBufferTestCase ()
+  : TestCase ("Check the segments copied from TcpTxBuffer")
+{
+}
+
+void
+TcpTxBufferTestCase::DoRun (void)
+{
+  TcpTxBuffer buffer (100);
+  buffer.SetMaxBufferSize (100000);
+  // data sent before the connection is set up, with a head sequence
+  // close to the wrap around.
+  uint32_t added = 0;
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      buffer.Add (CreateStreamPacket (added, 10 + i));
+      added += 10 + i;
+    }
+  SequenceNumber32 head (0xffffff00);
+  buffer.SetHeadSequence (head);
+  NS_TEST_ASSERT_MSG_EQ (buffer.TailSequence (), head + SequenceNumber32 (added), "Wrong tail sequence");
+
+  uint32_t acked = 0;
+  uint32_t state = 1;
+  for (uint32_t round = 0; round < 200; round++)
+    {
+      state = state * 1103515245 + 12345;
+      uint32_t size = 1 + (state >> 8) % 700;
+      NS_TEST_ASSERT_MSG_EQ (buffer.Add (CreateStreamPacket (added, size)), true, "Could not add a packet");
+      added += size;
+      for (uint32_t i = 0; i < 5; i++)
+        {
+          state = state * 1103515245 + 12345;
+          uint32_t offset = acked + (state >> 8) % (added - acked);
+          uint32_t length = 1 + (state >> 4) % 1500;
+          Ptr<Packet> p = buffer.CopyFromSequence (length, head + SequenceNumber32 (offset));
+          NS_TEST_ASSERT_MSG_EQ (p->GetSize (), std::min (length, added - offset), "Wrong segment size");
+          NS_TEST_ASSERT_MSG_EQ (IsStreamPacket (p, offset), true, "Wrong segment content at offset " << offset);
+        }
+      state = state * 1103515245 + 12345;
+      acked += (state >> 8) % (added - acked + 1);
+      buffer.DiscardUpTo (head + SequenceNumber32 (acked));
+      NS_TEST_ASSERT_MSG_EQ (buffer.HeadSequence (), head + SequenceNumber32 (acked), "Wrong head sequence");
+      NS_TEST_ASSERT_MSG_EQ (buffer.Size (), added - acked, "Wrong size");
+    }
+}
+
+class TcpRxBufferTestCase : public TestCase
+{
+public:
+  TcpRxBufferTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TcpRxBufferTestCase::TcpRxBufferTestCase ()
+  : TestCase ("Check the reassembly of overlapping segments in TcpRxBuffer")
+{
+}
+
+void
+TcpRxBufferTestCase::DoRun (void)
+{
+  TcpRxBuffer buffer;
+  SequenceNumber32 head (0xfffff000);
+  buffer.SetNextRxSequence (head);
+  buffer.SetMaxBufferSize (20000);
+  uint32_t extracted = 0;
+  uint32_t state = 1;
+  for (uint32_t round = 0; round < 2000; round++)
+    {
+      // segments which overlap each other and the data already received
+      state = state * 1103515245 + 12345;
+      uint32_t received = buffer.NextRxSequence () - head;
+      uint32_t offset = std::max (received + (state >> 8) % 9000, extracted + 1000) - 1000;
+      uint32_t size = 1 + (state >> 4) % 1000;
+      TcpHeader tcph;
+      tcph.SetSequenceNumber (head + SequenceNumber32 (offset));
+      buffer.Add (CreateStreamPacket (offset, size), tcph);
+      if (offset <= received && offset + size > received)
+        {
+          uint32_t nextReceived = buffer.NextRxSequence () - head;
+          NS_TEST_ASSERT_MSG_GT (nextReceived, offset + size - 1, "In-sequence data not accepted");
+        }
+      NS_TEST_ASSERT_MSG_EQ (buffer.Available (), (buffer.NextRxSequence () - head) - extracted, "Wrong available size");
+      if (round % 3 == 0)
+        {
+          Ptr<Packet> p = buffer.Extract ((state >> 12) % 3000);
+          if (p != 0)
+            {
+              NS_TEST_ASSERT_MSG_EQ (IsStreamPacket (p, extracted), true, "Wrong data extracted at offset " << extracted);
+              extracted += p->GetSize ();
+            }
+        }
+    }
+  NS_TEST_ASSERT_MSG_GT (extracted, 0, "No data extracted");
+}
+
+class TcpBufferTestSuite : public TestSuite
+{
+public:
+  TcpBufferTestSuite ();
+};
+
+TcpBufferTestSuite::TcpBufferTestSuite ()
+  : TestSuite ("tcp-buffer", UNIT)
+{
+  AddTestCase (new TcpTxBufferTestCase (), TestCase::QUICK);
+  AddTestCase (new TcpRxBufferTestCase (), TestCase::QUICK);
+}
+
+static TcpBufferTestSuite g_tcpBufferTestSuite;
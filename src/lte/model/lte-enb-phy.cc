@@ -564,21 +564,24 @@ LteEnbPhy::StartSubFrame (void)
                     }
                   mask = (mask << 1);
                 }
-              // fire trace of DL Tx PHY stats
-              for (uint8_t i = 0; i < dci->GetDci ().m_mcs.size (); i++)
+              // fire trace of DL Tx PHY stats, if anyone listens to it
+              if (!m_dlPhyTransmission.IsEmpty ())
                 {
-                  PhyTransmissionStatParameters params;
-                  params.m_cellId = m_cellId;
-                  params.m_imsi = 0; // it will be set by DlPhyTransmissionCallback in LteHelper
-                  params.m_timestamp = Simulator::Now ().GetMilliSeconds ();
-                  params.m_rnti = dci->GetDci ().m_rnti;
-                  params.m_txMode = 0; // TBD
-                  params.m_layer = i;
-                  params.m_mcs = dci->GetDci ().m_mcs.at (i);
-                  params.m_size = dci->GetDci ().m_tbsSize.at (i);
-                  params.m_rv = dci->GetDci ().m_rv.at (i);
-                  params.m_ndi = dci->GetDci ().m_ndi.at (i);
-                  m_dlPhyTransmission (params);
+                  for (uint8_t i = 0; i < dci->GetDci ().m_mcs.size (); i++)
+                    {
+                      PhyTransmissionStatParameters params;
+                      params.m_cellId = m_cellId;
+                      params.m_imsi = 0; // it will be set by DlPhyTransmissionCallback in LteHelper
+                      params.m_timestamp = Simulator::Now ().GetMilliSeconds ();
+                      params.m_rnti = dci->GetDci ().m_rnti;
+                      params.m_txMode = 0; // TBD
+                      params.m_layer = i;
+                      params.m_mcs = dci->GetDci ().m_mcs.at (i);
+                      params.m_size = dci->GetDci ().m_tbsSize.at (i);
+                      params.m_rv = dci->GetDci ().m_rv.at (i);
+                      params.m_ndi = dci->GetDci ().m_ndi.at (i);
+                      m_dlPhyTransmission (params);
+                    }
                 }
               
             }
@@ -34,6 +34,7 @@
 #include "ns3/wifi-net-device.h"
 #include "ns3/wifi-mac.h"
 #include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
 #include "ns3/lte-ue-phy.h"
 #include "ns3/lte-enb-phy.h"
 #include "ns3/uan-net-device.h"
@@ -332,6 +333,9 @@ bool AnimationInterface::SetOutputFile (const std::string& fn)
       NS_FATAL_ERROR ("Unable to open Animation output file");
       return false; // Can't open
     }
+  // The trace is written in many small pieces, so buffer more of them
+  // than the default before each write to the file
+  std::setvbuf (m_f, 0, _IOFBF, 1 << 16);
   m_outputFileName = fn;
   m_outputFileSet = true;
   return true;
@@ -619,6 +623,7 @@ void AnimationInterface::StartAnimation (bool restart)
       Ptr<Node> n = *i;
       NS_LOG_INFO ("Update Position for Node: " << n->GetId ());
       Vector v = UpdatePosition (n); 
+      m_movingNodes.insert (n->GetId ());
       m_topoMinX = std::min (m_topoMinX, v.x);
       m_topoMinY = std::min (m_topoMinY, v.y);
       m_topoMaxX = std::max (m_topoMaxX, v.x);
@@ -813,8 +818,10 @@ void AnimationInterface::ConnectCallbacks ()
                    MakeCallback (&AnimationInterface::WifiPhyTxBeginTrace, this));
   Config::Connect ("NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyRxBegin",
                    MakeCallback (&AnimationInterface::WifiPhyRxBeginTrace, this));
-  Config::ConnectWithoutContext ("/NodeList/*/$ns3::MobilityModel/CourseChange",
-                   MakeCallback (&AnimationInterface::MobilityCourseChangeTrace, this));
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); ++i)
+    {
+      ConnectCourseChange (*i);
+    }
   Config::Connect ("/NodeList/*/DeviceList/*/$ns3::WimaxNetDevice/Tx",
                    MakeCallback (&AnimationInterface::WimaxTxTrace, this));
   Config::Connect ("/NodeList/*/DeviceList/*/$ns3::WimaxNetDevice/Rx",
@@ -878,9 +885,16 @@ int AnimationInterface::WriteN (const std::string& st, FILE * f)
 std::vector <Ptr <Node> >  AnimationInterface::RecalcTopoBounds ()
 {
   std::vector < Ptr <Node> > MovedNodes;
-  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); ++i)
+  // The nodes created since the last check have no known location yet
+  for (uint32_t id = m_nodeLocation.size (); id < NodeList::GetNNodes (); ++id)
     {
-      Ptr<Node> n = *i;
+      m_movingNodes.insert (id);
+    }
+  // Only the nodes which were moving, or whose course changed, since
+  // the last check can be at a new location
+  for (std::set<uint32_t>::iterator i = m_movingNodes.begin (); i != m_movingNodes.end (); )
+    {
+      Ptr<Node> n = NodeList::GetNode (*i);
       NS_ASSERT (n);
       Ptr <MobilityModel> mobility = n->GetObject <MobilityModel> ();
       Vector newLocation;
@@ -892,16 +906,26 @@ std::vector <Ptr <Node> >  AnimationInterface::RecalcTopoBounds ()
         {
           newLocation = mobility->GetPosition ();
         }
-      if (!NodeHasMoved (n, newLocation))
-        {
-          continue; //Location has not changed
-        }
-      else
+      if (NodeHasMoved (n, newLocation))
         {
           UpdatePosition (n, newLocation);
           RecalcTopoBounds (newLocation);
           MovedNodes.push_back (n);
         }
+      // A node which stands still stays at this location until its
+      // course changes, provided its mobility model notifies all the
+      // changes of course: other models, such as a lazy waypoint model
+      // or a constant acceleration model, may start moving at any time.
+      // The model may also have been aggregated after the start of the
+      // animation, so its changes of course are only followed from now.
+      if (mobility && ConnectCourseChange (n) && NodeStaysStill (mobility))
+        {
+          m_movingNodes.erase (i++);
+        }
+      else
+        {
+          ++i;
+        }
     }
   return MovedNodes;
 }
@@ -1497,10 +1521,11 @@ void AnimationInterface::CsmaMacRxTrace (std::string context,
 void AnimationInterface::MobilityCourseChangeTrace (Ptr <const MobilityModel> mobility)
 
 {
-  if (!m_started || !IsInTimeWindow ())
-    return;
   Ptr <Node> n = mobility->GetObject <Node> ();
   NS_ASSERT (n);
+  m_movingNodes.insert (n->GetId ());
+  if (!m_started || !IsInTimeWindow ())
+    return;
   Vector v ;
   if (!mobility)
     {
@@ -1520,6 +1545,37 @@ void AnimationInterface::MobilityCourseChangeTrace (Ptr <const MobilityModel> mo
   WriteDummyPacket ();
 }
 
+bool AnimationInterface::ConnectCourseChange (Ptr <Node> n)
+{
+  if (m_courseChangeNodes.find (n->GetId ()) != m_courseChangeNodes.end ())
+    {
+      return true;
+    }
+  Ptr <MobilityModel> mobility = n->GetObject <MobilityModel> ();
+  if (!mobility)
+    {
+      return false;
+    }
+  mobility->TraceConnectWithoutContext ("CourseChange",
+                                        MakeCallback (&AnimationInterface::MobilityCourseChangeTrace, this));
+  m_courseChangeNodes.insert (n->GetId ());
+  return true;
+}
+
+bool AnimationInterface::NodeStaysStill (Ptr <MobilityModel> mobility)
+{
+  if (DynamicCast <ConstantPositionMobilityModel> (mobility))
+    {
+      return true;
+    }
+  if (DynamicCast <ConstantVelocityMobilityModel> (mobility))
+    {
+      Vector velocity = mobility->GetVelocity ();
+      return velocity.x == 0 && velocity.y == 0 && velocity.z == 0;
+    }
+  return false;
+}
+
 bool AnimationInterface::NodeHasMoved (Ptr <Node> n, Vector newLocation)
 {
   Vector oldLocation = GetPosition (n);
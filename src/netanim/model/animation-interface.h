@@ -24,12 +24,14 @@
 #include <string>
 #include <cstdio>
 #include <map>
+#include <set>
 #include "ns3/ptr.h"
 #include "ns3/net-device.h"
 #include "ns3/node-container.h"
 #include "ns3/nstime.h"
 #include "ns3/log.h"
 #include "ns3/node-list.h"
+#include "ns3/mobility-model.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/simulator.h"
 #include "ns3/config.h"
@@ -564,11 +566,22 @@ private:
   uint64_t GetAnimUidFromPacket (Ptr <const Packet>);
 
   std::map<uint32_t, Vector> m_nodeLocation;
+  // Nodes whose position may have changed since the last mobility check:
+  // all of them but the nodes which stood still then, with a model whose
+  // changes of course are followed, and whose course did not change since
+  std::set<uint32_t> m_movingNodes;
   Vector GetPosition (Ptr <Node> n);
   Vector UpdatePosition (Ptr <Node> n);
   Vector UpdatePosition (Ptr <Node> n, Vector v);
   void WriteDummyPacket ();
   bool NodeHasMoved (Ptr <Node> n, Vector newLocation);
+  // Whether the node of this model cannot move before its course changes
+  bool NodeStaysStill (Ptr <MobilityModel> mobility);
+  // Nodes whose CourseChange trace calls MobilityCourseChangeTrace
+  std::set<uint32_t> m_courseChangeNodes;
+  // Connect the CourseChange trace of the mobility model of a node, if
+  // not done yet; returns false if the node has no mobility model
+  bool ConnectCourseChange (Ptr <Node> n);
 
   void PurgePendingWifi ();
   void PurgePendingWimax ();
@@ -26,6 +26,7 @@
 #include "ns3/netanim-module.h"
 #include "ns3/applications-module.h"
 #include "ns3/point-to-point-layout-module.h"
+#include "ns3/mobility-module.h"
 
 namespace ns3 {
 
@@ -106,6 +107,240 @@ AnimationInterfaceTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * Move a node for a while, among nodes which stand still, and check
+ * which node locations the mobility checks write.
+ */
+class AnimationInterfaceMobilityTestCase : public TestCase
+{
+public:
+  AnimationInterfaceMobilityTestCase ();
+  virtual
+  ~AnimationInterfaceMobilityTestCase ();
+  virtual void
+  DoRun (void);
+  static void
+  Write (const char *str);
+
+  static std::vector<std::string> m_written;
+};
+
+std::vector<std::string> AnimationInterfaceMobilityTestCase::m_written;
+
+AnimationInterfaceMobilityTestCase::AnimationInterfaceMobilityTestCase () :
+  TestCase ("Verify the mobility output of AnimationInterface")
+{
+}
+
+AnimationInterfaceMobilityTestCase::~AnimationInterfaceMobilityTestCase ()
+{
+}
+
+void
+AnimationInterfaceMobilityTestCase::Write (const char *str)
+{
+  m_written.push_back (str);
+}
+
+void
+AnimationInterfaceMobilityTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantVelocityMobilityModel");
+  mobility.Install (nodes);
+  Ptr<ConstantVelocityMobilityModel> mover = nodes.Get (1)->GetObject<ConstantVelocityMobilityModel> ();
+  nodes.Get (2)->GetObject<MobilityModel> ()->SetPosition (Vector (50, 50, 0));
+
+  // the node moves from 1 s to 2 s, then from 2.5 s on
+  Simulator::Schedule (Seconds (1), &ConstantVelocityMobilityModel::SetVelocity, mover, Vector (10, 0, 0));
+  Simulator::Schedule (Seconds (2), &ConstantVelocityMobilityModel::SetVelocity, mover, Vector (0, 0, 0));
+  Simulator::Schedule (Seconds (2.5), &ConstantVelocityMobilityModel::SetVelocity, mover, Vector (-10, 0, 0));
+
+  std::string traceFileName = "netanim-mobility-test.xml";
+  AnimationInterface anim (traceFileName.c_str ());
+  m_written.clear ();
+  anim.SetAnimWriteCallback (&AnimationInterfaceMobilityTestCase::Write);
+  Simulator::Stop (Seconds (2.8));
+  Simulator::Run ();
+
+  // the checks write the moved nodes without their colors
+  std::vector<std::string> checked;
+  std::string last;
+  for (uint32_t i = 0; i < m_written.size (); i++)
+    {
+      std::string::size_type pos = m_written[i].find ("<node id=\"");
+      if (pos != std::string::npos)
+        {
+          checked.push_back (m_written[i].substr (pos, m_written[i].find ('\n', pos) + 1 - pos));
+        }
+      if (m_written[i].find ("<node id = \"1\"") != std::string::npos)
+        {
+          last = m_written[i];
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (checked.size (), 4, "Wrong number of node locations written by the mobility checks");
+  NS_TEST_ASSERT_MSG_EQ (checked[0], "<node id=\"1\" descr=\"\" locX = \"2.5\" locY = \"0\" />\n", "Wrong location at 1.25 s");
+  NS_TEST_ASSERT_MSG_EQ (checked[2], "<node id=\"1\" descr=\"\" locX = \"7.5\" locY = \"0\" />\n", "Wrong location at 1.75 s");
+  NS_TEST_ASSERT_MSG_EQ (checked[3], "<node id=\"1\" descr=\"\" locX = \"7.5\" locY = \"0\" />\n", "Wrong location at 2.75 s");
+  NS_TEST_ASSERT_MSG_NE (last.find ("locX=\"10\""), std::string::npos, "Wrong location of the last course change");
+
+  anim.ResetAnimWriteCallback ();
+  Simulator::Destroy ();
+  unlink (traceFileName.c_str ());
+}
+
+/**
+ * Move a node with a lazy waypoint model, which does not notify the end
+ * of a pause, and check that the mobility checks follow it.
+ */
+class AnimationInterfaceWaypointTestCase : public TestCase
+{
+public:
+  AnimationInterfaceWaypointTestCase ();
+  virtual
+  ~AnimationInterfaceWaypointTestCase ();
+  virtual void
+  DoRun (void);
+  static void
+  Write (const char *str);
+
+  static std::vector<std::string> m_written;
+};
+
+std::vector<std::string> AnimationInterfaceWaypointTestCase::m_written;
+
+AnimationInterfaceWaypointTestCase::AnimationInterfaceWaypointTestCase () :
+  TestCase ("Verify the mobility output of AnimationInterface after a lazy waypoint pause")
+{
+}
+
+AnimationInterfaceWaypointTestCase::~AnimationInterfaceWaypointTestCase ()
+{
+}
+
+void
+AnimationInterfaceWaypointTestCase::Write (const char *str)
+{
+  m_written.push_back (str);
+}
+
+void
+AnimationInterfaceWaypointTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (1);
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::WaypointMobilityModel",
+                             "LazyNotify", BooleanValue (true));
+  mobility.Install (nodes);
+
+  // the node stands still until 1 s, then moves until 2 s
+  Ptr<WaypointMobilityModel> waypoints = nodes.Get (0)->GetObject<WaypointMobilityModel> ();
+  waypoints->AddWaypoint (Waypoint (Seconds (0), Vector (0, 0, 0)));
+  waypoints->AddWaypoint (Waypoint (Seconds (1), Vector (0, 0, 0)));
+  waypoints->AddWaypoint (Waypoint (Seconds (2), Vector (10, 0, 0)));
+
+  std::string traceFileName = "netanim-waypoint-test.xml";
+  AnimationInterface anim (traceFileName.c_str ());
+  m_written.clear ();
+  anim.SetAnimWriteCallback (&AnimationInterfaceWaypointTestCase::Write);
+  Simulator::Stop (Seconds (2.3));
+  Simulator::Run ();
+
+  // the checks write the moved nodes without their colors, and the
+  // checks at 1 s and 2 s trigger the lazy course changes
+  std::vector<std::string> checked;
+  std::string last;
+  for (uint32_t i = 0; i < m_written.size (); i++)
+    {
+      std::string::size_type pos = m_written[i].find ("<node id=\"");
+      if (pos != std::string::npos)
+        {
+          checked.push_back (m_written[i].substr (pos, m_written[i].find ('\n', pos) + 1 - pos));
+        }
+      if (m_written[i].find ("<node id = \"0\"") != std::string::npos)
+        {
+          last = m_written[i];
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (checked.size (), 3, "Wrong number of node locations written by the mobility checks");
+  NS_TEST_ASSERT_MSG_EQ (checked[0], "<node id=\"0\" descr=\"\" locX = \"2.5\" locY = \"0\" />\n", "Wrong location at 1.25 s");
+  NS_TEST_ASSERT_MSG_EQ (checked[2], "<node id=\"0\" descr=\"\" locX = \"7.5\" locY = \"0\" />\n", "Wrong location at 1.75 s");
+  NS_TEST_ASSERT_MSG_NE (last.find ("locX=\"10\""), std::string::npos, "Wrong location of the last course change");
+
+  anim.ResetAnimWriteCallback ();
+  Simulator::Destroy ();
+  unlink (traceFileName.c_str ());
+}
+
+/**
+ * Place a node with SetConstantPosition after the AnimationInterface is
+ * created, then move it, and check that the move is written.
+ */
+class AnimationInterfaceLatePositionTestCase : public TestCase
+{
+public:
+  AnimationInterfaceLatePositionTestCase ();
+  virtual
+  ~AnimationInterfaceLatePositionTestCase ();
+  virtual void
+  DoRun (void);
+  static void
+  Write (const char *str);
+
+  static std::vector<std::string> m_written;
+};
+
+std::vector<std::string> AnimationInterfaceLatePositionTestCase::m_written;
+
+AnimationInterfaceLatePositionTestCase::AnimationInterfaceLatePositionTestCase () :
+  TestCase ("Verify the mobility output of AnimationInterface for a node placed after its creation")
+{
+}
+
+AnimationInterfaceLatePositionTestCase::~AnimationInterfaceLatePositionTestCase ()
+{
+}
+
+void
+AnimationInterfaceLatePositionTestCase::Write (const char *str)
+{
+  m_written.push_back (str);
+}
+
+void
+AnimationInterfaceLatePositionTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (1);
+
+  std::string traceFileName = "netanim-late-position-test.xml";
+  AnimationInterface anim (traceFileName.c_str ());
+  m_written.clear ();
+  anim.SetAnimWriteCallback (&AnimationInterfaceLatePositionTestCase::Write);
+  AnimationInterface::SetConstantPosition (nodes.Get (0), 1, 2);
+  Ptr<MobilityModel> position = nodes.Get (0)->GetObject<MobilityModel> ();
+  Simulator::Schedule (Seconds (1.1), &MobilityModel::SetPosition, position, Vector (5, 5, 0));
+  Simulator::Stop (Seconds (1.3));
+  Simulator::Run ();
+
+  std::string last;
+  for (uint32_t i = 0; i < m_written.size (); i++)
+    {
+      if (m_written[i].find ("<node id = \"0\"") != std::string::npos)
+        {
+          last = m_written[i];
+        }
+    }
+  NS_TEST_ASSERT_MSG_NE (last.find ("locX=\"5\""), std::string::npos, "The move of the node was not written");
+
+  anim.ResetAnimWriteCallback ();
+  Simulator::Destroy ();
+  unlink (traceFileName.c_str ());
+}
+
 static class AnimationInterfaceTestSuite : public TestSuite
 {
 public:
@@ -113,6 +348,9 @@ public:
     TestSuite ("animation-interface", UNIT)
   {
     AddTestCase (new AnimationInterfaceTestCase (), TestCase::QUICK);
+    AddTestCase (new AnimationInterfaceMobilityTestCase (), TestCase::QUICK);
+    AddTestCase (new AnimationInterfaceWaypointTestCase (), TestCase::QUICK);
+    AddTestCase (new AnimationInterfaceLatePositionTestCase (), TestCase::QUICK);
   }
 } g_animationInterfaceTestSuite;
 
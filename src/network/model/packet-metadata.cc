@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include <utility>
+#include <algorithm>
 #include <list>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
@@ -33,6 +34,7 @@ namespace ns3 {
 
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
+bool PacketMetadata::m_enableLight = false;
 bool PacketMetadata::m_metadataSkipped = false;
 uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
@@ -60,6 +62,40 @@ PacketMetadata::Enable (void)
                  "to call ns3::PacketMetadata::Enable () near the beginning of"
                  " the program, before any packets are sent.");
   m_enable = true;
+  m_enableLight = false;
+}
+
+void 
+PacketMetadata::EnableLight (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  NS_ASSERT_MSG (!m_metadataSkipped,
+                 "Error: attempting to enable the packet metadata "
+                 "subsystem too late in the simulation, which is not allowed.\n"
+                 "Call ns3::PacketMetadata::EnableLight () near the beginning of"
+                 " the program, before any packets are sent.");
+  m_enable = true;
+  m_enableLight = true;
+}
+
+void
+PacketMetadata::Disable (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_enable = false;
+  m_enableLight = false;
+}
+
+bool
+PacketMetadata::IsEnabled (void)
+{
+  return m_enable;
+}
+
+bool
+PacketMetadata::IsLightEnabled (void)
+{
+  return m_enableLight;
 }
 
 void 
@@ -134,6 +170,11 @@ PacketMetadata::IsStateOk (void) const
 {
   NS_LOG_FUNCTION (this);
   bool ok = m_used <= m_data->m_size;
+  if (m_enableLight)
+    {
+      ok &= (m_used % sizeof (struct PacketMetadata::LightItem)) == 0;
+      return ok;
+    }
   ok &= IsPointerOk (m_head);
   ok &= IsPointerOk (m_tail);
   uint16_t current = m_head;
@@ -545,6 +586,22 @@ PacketMetadata::ReadItems (uint16_t current,
                         item->typeUid << extraItem->fragmentEnd << extraItem->fragmentStart <<
                         extraItem->packetUid);
   NS_ASSERT (current <= m_data->m_size);
+  if (m_enableLight)
+    {
+      // present a light record as a small item with no fragment.
+      const uint16_t recordSize = sizeof (struct PacketMetadata::LightItem);
+      struct PacketMetadata::LightItem lightItem;
+      LightRead (current, &lightItem);
+      item->next = (current + 2 * recordSize <= m_used) ? current + recordSize : 0xffff;
+      item->prev = (current >= recordSize) ? current - recordSize : 0xffff;
+      item->typeUid = lightItem.typeUid;
+      item->size = lightItem.size;
+      item->chunkUid = 0;
+      extraItem->fragmentStart = 0;
+      extraItem->fragmentEnd = lightItem.size;
+      extraItem->packetUid = m_packetUid;
+      return recordSize;
+    }
   const uint8_t *buffer = &m_data->m_data[current];
   item->next = buffer[0];
   item->next |= (buffer[1]) << 8;
@@ -578,6 +635,322 @@ PacketMetadata::ReadItems (uint16_t current,
   return buffer - &m_data->m_data[current];
 }
 
+void
+PacketMetadata::LightRead (uint16_t offset, struct PacketMetadata::LightItem *item) const
+{
+  NS_ASSERT (offset + sizeof (struct PacketMetadata::LightItem) <= m_used);
+  memcpy (item, &m_data->m_data[offset], sizeof (struct PacketMetadata::LightItem));
+}
+
+void
+PacketMetadata::LightWrite (uint16_t offset, const struct PacketMetadata::LightItem *item)
+{
+  NS_ASSERT (offset + sizeof (struct PacketMetadata::LightItem) <= m_data->m_size);
+  memcpy (&m_data->m_data[offset], item, sizeof (struct PacketMetadata::LightItem));
+}
+
+void
+PacketMetadata::LightAppend (uint32_t typeUid, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << typeUid << size);
+  const uint16_t recordSize = sizeof (struct PacketMetadata::LightItem);
+  if (m_used == 0 && typeUid != 0)
+    {
+      // the first record always holds the payload size.
+      LightAppend (0, 0);
+    }
+  if (m_used + recordSize > m_data->m_size ||
+      (m_data->m_count != 1 &&
+       m_used != m_data->m_dirtyEnd))
+    {
+      ReserveCopy (recordSize);
+    }
+  struct PacketMetadata::LightItem item;
+  item.typeUid = typeUid;
+  item.size = size;
+  LightWrite (m_used, &item);
+  m_used += recordSize;
+  m_data->m_dirtyEnd = m_used;
+}
+
+void
+PacketMetadata::LightMakeWritable (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_data->m_count != 1)
+    {
+      ReserveCopy (0);
+    }
+}
+
+uint32_t
+PacketMetadata::LightGetPayload (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (m_used == 0)
+    {
+      return 0;
+    }
+  struct PacketMetadata::LightItem item;
+  LightRead (0, &item);
+  return item.size;
+}
+
+void
+PacketMetadata::LightSetPayload (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  if (m_used == 0)
+    {
+      LightAppend (0, size);
+      return;
+    }
+  if (LightGetPayload () == size)
+    {
+      return;
+    }
+  LightMakeWritable ();
+  struct PacketMetadata::LightItem item;
+  item.typeUid = 0;
+  item.size = size;
+  LightWrite (0, &item);
+}
+
+/**
+ * \param trailer true to look for a trailer, false to look for a header.
+ * \returns the offset of the last header or trailer added and
+ *          still present, 0xffff if there is none.
+ */
+uint16_t
+PacketMetadata::LightFindOutermost (bool trailer) const
+{
+  NS_LOG_FUNCTION (this << trailer);
+  const uint16_t recordSize = sizeof (struct PacketMetadata::LightItem);
+  struct PacketMetadata::LightItem item;
+  for (uint16_t current = m_used; current >= 2 * recordSize; )
+    {
+      current -= recordSize;
+      LightRead (current, &item);
+      if (((item.typeUid & 0x1) == 0x1) == trailer)
+        {
+          return current;
+        }
+    }
+  return 0xffff;
+}
+
+/**
+ * \param trailer true to look for a trailer, false to look for a header.
+ * \returns the offset of the first header or trailer added and
+ *          still present, 0xffff if there is none.
+ */
+uint16_t
+PacketMetadata::LightFindInnermost (bool trailer) const
+{
+  NS_LOG_FUNCTION (this << trailer);
+  const uint16_t recordSize = sizeof (struct PacketMetadata::LightItem);
+  struct PacketMetadata::LightItem item;
+  for (uint16_t current = recordSize; current < m_used; current += recordSize)
+    {
+      LightRead (current, &item);
+      if (((item.typeUid & 0x1) == 0x1) == trailer)
+        {
+          return current;
+        }
+    }
+  return 0xffff;
+}
+
+void
+PacketMetadata::LightErase (uint16_t offset)
+{
+  NS_LOG_FUNCTION (this << offset);
+  const uint16_t recordSize = sizeof (struct PacketMetadata::LightItem);
+  NS_ASSERT (offset >= recordSize && offset + recordSize <= m_used);
+  if (offset + recordSize == m_used)
+    {
+      // removing the last record does not touch the shared buffer.
+      m_used -= recordSize;
+      return;
+    }
+  LightMakeWritable ();
+  memmove (&m_data->m_data[offset], &m_data->m_data[offset + recordSize],
+           m_used - offset - recordSize);
+  m_used -= recordSize;
+  m_data->m_dirtyEnd = m_used;
+}
+
+/**
+ * \param trailer true to remove all trailers, false to remove all headers.
+ * \returns the total size of the records removed.
+ *
+ * The caller is responsible for adding the returned size to the payload.
+ */
+uint32_t
+PacketMetadata::LightFlatten (bool trailer)
+{
+  NS_LOG_FUNCTION (this << trailer);
+  if (m_used == 0)
+    {
+      return 0;
+    }
+  LightMakeWritable ();
+  const uint16_t recordSize = sizeof (struct PacketMetadata::LightItem);
+  struct PacketMetadata::LightItem item;
+  uint32_t flattened = 0;
+  uint16_t to = recordSize;
+  for (uint16_t from = recordSize; from < m_used; from += recordSize)
+    {
+      LightRead (from, &item);
+      if (((item.typeUid & 0x1) == 0x1) == trailer)
+        {
+          flattened += item.size;
+        }
+      else
+        {
+          if (to != from)
+            {
+              LightWrite (to, &item);
+            }
+          to += recordSize;
+        }
+    }
+  m_used = to;
+  m_data->m_dirtyEnd = m_used;
+  return flattened;
+}
+
+void
+PacketMetadata::LightRemoveAtStart (uint32_t start)
+{
+  NS_LOG_FUNCTION (this << start);
+  uint32_t leftToRemove = start;
+  struct PacketMetadata::LightItem item;
+  while (leftToRemove > 0)
+    {
+      uint16_t current = LightFindOutermost (false);
+      if (current == 0xffff)
+        {
+          break;
+        }
+      LightRead (current, &item);
+      if (item.size > leftToRemove)
+        {
+          // the remains of this header and all the headers it
+          // encloses can no longer be deserialized: merge them
+          // into the payload.
+          uint32_t flattened = LightFlatten (false);
+          LightSetPayload (LightGetPayload () + flattened - leftToRemove);
+          return;
+        }
+      LightErase (current);
+      leftToRemove -= item.size;
+    }
+  uint32_t payload = LightGetPayload ();
+  uint32_t fromPayload = std::min (payload, leftToRemove);
+  LightSetPayload (payload - fromPayload);
+  leftToRemove -= fromPayload;
+  while (leftToRemove > 0)
+    {
+      uint16_t current = LightFindInnermost (true);
+      if (current == 0xffff)
+        {
+          break;
+        }
+      LightRead (current, &item);
+      LightErase (current);
+      if (item.size > leftToRemove)
+        {
+          // the payload is empty here.
+          LightSetPayload (item.size - leftToRemove);
+          return;
+        }
+      leftToRemove -= item.size;
+    }
+}
+
+void
+PacketMetadata::LightRemoveAtEnd (uint32_t end)
+{
+  NS_LOG_FUNCTION (this << end);
+  uint32_t leftToRemove = end;
+  struct PacketMetadata::LightItem item;
+  while (leftToRemove > 0)
+    {
+      uint16_t current = LightFindOutermost (true);
+      if (current == 0xffff)
+        {
+          break;
+        }
+      LightRead (current, &item);
+      if (item.size > leftToRemove)
+        {
+          uint32_t flattened = LightFlatten (true);
+          LightSetPayload (LightGetPayload () + flattened - leftToRemove);
+          return;
+        }
+      LightErase (current);
+      leftToRemove -= item.size;
+    }
+  uint32_t payload = LightGetPayload ();
+  uint32_t fromPayload = std::min (payload, leftToRemove);
+  LightSetPayload (payload - fromPayload);
+  leftToRemove -= fromPayload;
+  while (leftToRemove > 0)
+    {
+      uint16_t current = LightFindInnermost (false);
+      if (current == 0xffff)
+        {
+          break;
+        }
+      LightRead (current, &item);
+      LightErase (current);
+      if (item.size > leftToRemove)
+        {
+          LightSetPayload (item.size - leftToRemove);
+          return;
+        }
+      leftToRemove -= item.size;
+    }
+}
+
+void
+PacketMetadata::LightAddAtEnd (PacketMetadata const &o)
+{
+  NS_LOG_FUNCTION (this << &o);
+  if (o.m_used == 0)
+    {
+      return;
+    }
+  if (m_used == 0)
+    {
+      *this = o;
+      return;
+    }
+  // our trailers and the headers of the other packet end up in
+  // the middle of the resulting packet: merge them into the payload.
+  uint32_t payload = LightGetPayload () + LightFlatten (true) + o.LightGetPayload ();
+  const uint16_t recordSize = sizeof (struct PacketMetadata::LightItem);
+  struct PacketMetadata::LightItem item;
+  for (uint16_t current = recordSize; current < o.m_used; current += recordSize)
+    {
+      o.LightRead (current, &item);
+      if ((item.typeUid & 0x1) == 0)
+        {
+          payload += item.size;
+        }
+    }
+  LightSetPayload (payload);
+  for (uint16_t current = recordSize; current < o.m_used; current += recordSize)
+    {
+      o.LightRead (current, &item);
+      if ((item.typeUid & 0x1) == 0x1)
+        {
+          LightAppend (item.typeUid, item.size);
+        }
+    }
+}
+
 struct PacketMetadata::Data *
 PacketMetadata::Create (uint32_t size)
 {
@@ -680,6 +1053,18 @@ PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_enableLight)
+    {
+      if (uid == 0)
+        {
+          LightSetPayload (size);
+        }
+      else
+        {
+          LightAppend (uid, size);
+        }
+      return;
+    }
 
   struct PacketMetadata::SmallItem item;
   item.next = m_head;
@@ -702,6 +1087,27 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_enableLight)
+    {
+      uint16_t current = LightFindOutermost (false);
+      bool found = current != 0xffff;
+      if (found)
+        {
+          struct PacketMetadata::LightItem item;
+          LightRead (current, &item);
+          found = item.typeUid == uid && item.size == size;
+        }
+      if (!found)
+        {
+          if (m_enableChecking)
+            {
+              NS_FATAL_ERROR ("Removing unexpected header.");
+            }
+          return;
+        }
+      LightErase (current);
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_head, &item, &extraItem);
@@ -750,6 +1156,11 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_enableLight)
+    {
+      LightAppend (uid | 0x1, size);
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   item.next = 0xffff;
   item.prev = m_tail;
@@ -772,6 +1183,27 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_enableLight)
+    {
+      uint16_t current = LightFindOutermost (true);
+      bool found = current != 0xffff;
+      if (found)
+        {
+          struct PacketMetadata::LightItem item;
+          LightRead (current, &item);
+          found = item.typeUid == (uid | 0x1) && item.size == size;
+        }
+      if (!found)
+        {
+          if (m_enableChecking)
+            {
+              NS_FATAL_ERROR ("Removing unexpected trailer.");
+            }
+          return;
+        }
+      LightErase (current);
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_tail, &item, &extraItem);
@@ -819,6 +1251,12 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
       m_metadataSkipped = true;
       return;
     }
+  if (m_enableLight)
+    {
+      LightAddAtEnd (o);
+      NS_ASSERT (IsStateOk ());
+      return;
+    }
   if (m_tail == 0xffff)
     {
       // We have no items so 'AddAtEnd' is 
@@ -908,6 +1346,12 @@ PacketMetadata::RemoveAtStart (uint32_t start)
       return;
     }
   NS_ASSERT (m_data != 0);
+  if (m_enableLight)
+    {
+      LightRemoveAtStart (start);
+      NS_ASSERT (IsStateOk ());
+      return;
+    }
   uint32_t leftToRemove = start;
   uint16_t current = m_head;
   while (current != 0xffff && leftToRemove > 0)
@@ -971,6 +1415,12 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
       return;
     }
   NS_ASSERT (m_data != 0);
+  if (m_enableLight)
+    {
+      LightRemoveAtEnd (end);
+      NS_ASSERT (IsStateOk ());
+      return;
+    }
 
   uint32_t leftToRemove = end;
   uint16_t current = m_tail;
@@ -1065,14 +1515,65 @@ PacketMetadata::ItemIterator::ItemIterator (const PacketMetadata *metadata, Buff
     m_buffer (buffer),
     m_current (metadata->m_head),
     m_offset (0),
-    m_hasReadTail (false)
+    m_hasReadTail (false),
+    m_pass (0)
 {
   NS_LOG_FUNCTION (this << metadata << &buffer);
+  if (PacketMetadata::m_enableLight)
+    {
+      m_current = metadata->m_used;
+      LightSeek ();
+    }
+}
+void
+PacketMetadata::ItemIterator::LightSeek (void)
+{
+  NS_LOG_FUNCTION (this);
+  const uint16_t recordSize = sizeof (struct PacketMetadata::LightItem);
+  struct PacketMetadata::LightItem lightItem;
+  if (m_pass == 0)
+    {
+      // headers, from the last one added to the first one.
+      while (m_current >= 2 * recordSize)
+        {
+          m_current -= recordSize;
+          m_metadata->LightRead (m_current, &lightItem);
+          if ((lightItem.typeUid & 0x1) == 0)
+            {
+              return;
+            }
+        }
+      m_current = 0;
+      m_pass = 1;
+      if (m_metadata->LightGetPayload () > 0)
+        {
+          return;
+        }
+      m_pass = 2;
+    }
+  if (m_pass == 2)
+    {
+      // trailers, from the first one added to the last one.
+      while (m_current + 2 * recordSize <= m_metadata->m_used)
+        {
+          m_current += recordSize;
+          m_metadata->LightRead (m_current, &lightItem);
+          if ((lightItem.typeUid & 0x1) == 0x1)
+            {
+              return;
+            }
+        }
+      m_pass = 3;
+    }
 }
 bool
 PacketMetadata::ItemIterator::HasNext (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (PacketMetadata::m_enableLight)
+    {
+      return m_pass != 3;
+    }
   if (m_current == 0xffff)
     {
       return false;
@@ -1088,6 +1589,40 @@ PacketMetadata::ItemIterator::Next (void)
 {
   NS_LOG_FUNCTION (this);
   struct PacketMetadata::Item item;
+  if (PacketMetadata::m_enableLight)
+    {
+      struct PacketMetadata::LightItem lightItem;
+      m_metadata->LightRead (m_current, &lightItem);
+      item.tid.SetUid (lightItem.typeUid >> 1);
+      item.isFragment = false;
+      item.currentSize = lightItem.size;
+      item.currentTrimedFromStart = 0;
+      item.currentTrimedFromEnd = 0;
+      if (m_pass == 0)
+        {
+          item.type = PacketMetadata::Item::HEADER;
+          ns3::Buffer tmp = m_buffer;
+          tmp.RemoveAtStart (m_offset);
+          tmp.RemoveAtEnd (tmp.GetSize () - item.currentSize);
+          item.current = tmp.Begin ();
+        }
+      else if (m_pass == 1)
+        {
+          item.type = PacketMetadata::Item::PAYLOAD;
+          m_pass = 2;
+        }
+      else
+        {
+          item.type = PacketMetadata::Item::TRAILER;
+          ns3::Buffer tmp = m_buffer;
+          tmp.RemoveAtEnd (tmp.GetSize () - (m_offset + item.currentSize));
+          tmp.RemoveAtStart (tmp.GetSize () - item.currentSize);
+          item.current = tmp.End ();
+        }
+      m_offset += item.currentSize;
+      LightSeek ();
+      return item;
+    }
   struct PacketMetadata::SmallItem smallItem;
   struct PacketMetadata::ExtraItem extraItem;
   m_metadata->ReadItems (m_current, &smallItem, &extraItem);
@@ -1165,6 +1700,12 @@ PacketMetadata::GetSerializedSize (void) const
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t current = m_head;
+  uint32_t tail = m_tail;
+  if (m_enableLight && m_used > 0)
+    {
+      current = 0;
+      tail = m_used - sizeof (struct PacketMetadata::LightItem);
+    }
   while (current != 0xffff)
     {
       ReadItems (current, &item, &extraItem);
@@ -1180,7 +1721,7 @@ PacketMetadata::GetSerializedSize (void) const
           totalSize += 4 + tid.GetName ().size ();
         }
       totalSize += 1 + 4 + 2 + 4 + 4 + 8;
-      if (current == m_tail)
+      if (current == tail)
         {
           break;
         }
@@ -1205,6 +1746,13 @@ PacketMetadata::Serialize (uint8_t* buffer, uint32_t maxSize) const
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t current = m_head;
+  uint32_t tail = m_tail;
+  if (m_enableLight && m_used > 0)
+    {
+      // in light mode, the isBig byte carries the trailer bit.
+      current = 0;
+      tail = m_used - sizeof (struct PacketMetadata::LightItem);
+    }
   while (current != 0xffff)
     {
       ReadItems (current, &item, &extraItem);
@@ -1278,7 +1826,7 @@ PacketMetadata::Serialize (uint8_t* buffer, uint32_t maxSize) const
           return 0;
         }
 
-      if (current == m_tail)
+      if (current == tail)
         {
           break;
         }
@@ -1345,6 +1893,11 @@ PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
                     ", size="<<item.size<<", chunkUid="<<item.chunkUid<<
                     ", fragmentStart="<<extraItem.fragmentStart<<", fragmentEnd="<<
                     extraItem.fragmentEnd<< ", packetUid="<<extraItem.packetUid);
+      if (m_enableLight)
+        {
+          DoAddHeader (item.typeUid, item.size);
+          continue;
+        }
       uint32_t tmp = AddBig (0xffff, m_tail, &item, &extraItem);
       UpdateTail (tmp);
     }
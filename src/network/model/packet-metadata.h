@@ -75,6 +75,16 @@ class Trailer;
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
  * encoding.
+ *
+ * When enabled with PacketMetadata::EnableLight, a much cheaper
+ * representation is used instead: the data buffer holds a flat array
+ * of fixed-size (type uid, size) records, one per header or trailer,
+ * in the order in which they were added, preceded by a single record
+ * which holds the size of the payload. No fragment offsets, chunk uids
+ * or packet uids are recorded: whenever a header or trailer is only
+ * partially removed or ends up in the middle of a packet because of
+ * AddAtEnd, it is merged into the payload. This is sufficient to print
+ * the packets which are seen in traces but not to track fragments.
  */
 class PacketMetadata 
 {
@@ -123,10 +133,36 @@ private:
     uint16_t m_current;
     uint32_t m_offset;
     bool m_hasReadTail;
+    /* light mode only: 0 while iterating over headers, 1 for the
+     * payload, 2 while iterating over trailers, and 3 when done.
+     */
+    uint8_t m_pass;
+    void LightSeek (void);
   };
 
   static void Enable (void);
   static void EnableChecking (void);
+  /**
+   * Enable the light metadata mode which records only the type uid
+   * and size of each header and trailer. It is mutually exclusive
+   * with the full mode enabled by Enable: the last of the two to be
+   * called wins.
+   */
+  static void EnableLight (void);
+  /**
+   * Disable the metadata of the packets created or modified from now
+   * on. This is only meant to restore the initial mode, for instance
+   * at the end of a test which enabled the metadata.
+   */
+  static void Disable (void);
+  /**
+   * \returns true if the metadata is enabled, in the full or light mode.
+   */
+  static bool IsEnabled (void);
+  /**
+   * \returns true if the light metadata mode is enabled.
+   */
+  static bool IsLightEnabled (void);
 
   inline PacketMetadata (uint64_t uid, uint32_t size);
   inline PacketMetadata (PacketMetadata const &o);
@@ -291,6 +327,19 @@ private:
      */
     uint64_t packetUid;
   };
+  /* A record of the light metadata mode. The record at offset zero
+     holds the size of the payload (typeUid is zero); the other
+     records are stored in the order in which the headers and trailers
+     were added.
+   */
+  struct LightItem {
+    /* the high 31 bits hold the uid of the header or trailer type.
+       The low bit is one for trailers and zero for headers.
+     */
+    uint32_t typeUid;
+    /* the size (in bytes) of the header, trailer or payload. */
+    uint32_t size;
+  };
 
   class DataFreeList : public std::vector<struct Data *>
   {
@@ -329,6 +378,20 @@ public:
   bool IsPointerOk (uint16_t pointer) const;
   bool IsSharedPointerOk (uint16_t pointer) const;
 
+  inline void LightRead (uint16_t offset, struct PacketMetadata::LightItem *item) const;
+  inline void LightWrite (uint16_t offset, const struct PacketMetadata::LightItem *item);
+  void LightAppend (uint32_t typeUid, uint32_t size);
+  void LightMakeWritable (void);
+  uint32_t LightGetPayload (void) const;
+  void LightSetPayload (uint32_t size);
+  uint16_t LightFindOutermost (bool trailer) const;
+  uint16_t LightFindInnermost (bool trailer) const;
+  void LightErase (uint16_t offset);
+  uint32_t LightFlatten (bool trailer);
+  void LightRemoveAtStart (uint32_t start);
+  void LightRemoveAtEnd (uint32_t end);
+  void LightAddAtEnd (PacketMetadata const &o);
+
 
   static struct PacketMetadata::Data *Create (uint32_t size);
   static void Recycle (struct PacketMetadata::Data *data);
@@ -338,6 +401,7 @@ public:
   static DataFreeList m_freeList;
   static bool m_enable;
   static bool m_enableChecking;
+  static bool m_enableLight;
 
   // set to true when adding metadata to a packet is skipped because
   // m_enable is false; used to detect enabling of metadata in the
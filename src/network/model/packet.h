@@ -171,7 +171,9 @@ private:
  * output from Packet::Print. If you wish to only enable
  * checking of metadata, and do not need any printing capability, you can
  * call Packet::EnableChecking: its runtime cost is lower than
- * Packet::EnablePrinting.
+ * Packet::EnablePrinting. Packet::EnableLightPrinting is a cheaper
+ * alternative to Packet::EnablePrinting which keeps only the type
+ * and size of each header and trailer.
  *
  * - The set of tags contain simulation-specific information which cannot
  * be stored in the packet byte buffer because the protocol headers or trailers
@@ -421,6 +423,15 @@ public:
    * simulation setup and before any packet is created.
    */
   static void EnablePrinting (void);
+  /**
+   * Like EnablePrinting, but only keeps track of the type and size
+   * of the headers and trailers present in each packet, which is
+   * enough for Packet::Print and costs much less per header
+   * operation. Fragments of headers and trailers are not tracked:
+   * they are reported as payload. Calling EnablePrinting or
+   * EnableChecking later switches back to the full metadata.
+   */
+  static void EnableLightPrinting (void);
   /**
    * The packet metadata is also used to perform extensive
    * sanity checks at runtime when performing operations on a 
@@ -256,6 +256,8 @@ public:
   virtual ~PacketMetadataTest ();
   void CheckHistory (Ptr<Packet> p, const char *file, int line, uint32_t n, ...);
   virtual void DoRun (void);
+protected:
+  PacketMetadataTest (std::string name);
 private:
   Ptr<Packet> DoAddHeader (Ptr<Packet> p);
 };
@@ -265,6 +267,11 @@ PacketMetadataTest::PacketMetadataTest ()
 {
 }
 
+PacketMetadataTest::PacketMetadataTest (std::string name)
+  : TestCase (name)
+{
+}
+
 PacketMetadataTest::~PacketMetadataTest ()
 {
 }
@@ -820,6 +827,123 @@ PacketMetadataTest::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (msg, std::string ("hello world"), "Could not find original data in received packet");
 }
 //-----------------------------------------------------------------------------
+class PacketMetadataLightTest : public PacketMetadataTest {
+public:
+  PacketMetadataLightTest ();
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+private:
+  bool m_originalEnable;
+  bool m_originalLight;
+};
+
+PacketMetadataLightTest::PacketMetadataLightTest ()
+  : PacketMetadataTest ("Light packet metadata")
+{
+}
+
+void
+PacketMetadataLightTest::DoSetup (void)
+{
+  m_originalEnable = PacketMetadata::IsEnabled ();
+  m_originalLight = PacketMetadata::IsLightEnabled ();
+}
+
+void
+PacketMetadataLightTest::DoTeardown (void)
+{
+  if (m_originalLight)
+    {
+      PacketMetadata::EnableLight ();
+    }
+  else if (m_originalEnable)
+    {
+      PacketMetadata::Enable ();
+    }
+  else
+    {
+      PacketMetadata::Disable ();
+    }
+}
+
+void
+PacketMetadataLightTest::DoRun (void)
+{
+  PacketMetadata::EnableLight ();
+
+  Ptr<Packet> p = Create<Packet> (10);
+  Ptr<Packet> p1;
+  ADD_TRAILER (p, 100);
+  CHECK_HISTORY (p, 2, 10, 100);
+
+  p = Create<Packet> (10);
+  ADD_HEADER (p, 1);
+  ADD_HEADER (p, 2);
+  ADD_HEADER (p, 3);
+  CHECK_HISTORY (p, 4, 
+                 3, 2, 1, 10);
+  REM_HEADER (p, 3);
+  CHECK_HISTORY (p, 3, 
+                 2, 1, 10);
+  p1 = p->Copy ();
+  REM_HEADER (p1, 2);
+  REM_HEADER (p1, 1);
+  CHECK_HISTORY (p1, 1, 10);
+  CHECK_HISTORY (p, 3, 
+                 2, 1, 10);
+  ADD_HEADER (p1, 4);
+  CHECK_HISTORY (p1, 2, 4, 10);
+  CHECK_HISTORY (p, 3, 
+                 2, 1, 10);
+
+  p = Create<Packet> (10);
+  ADD_HEADER (p, 1);
+  ADD_TRAILER (p, 5);
+  ADD_HEADER (p, 2);
+  ADD_TRAILER (p, 6);
+  CHECK_HISTORY (p, 5, 
+                 2, 1, 10, 5, 6);
+  REM_HEADER (p, 2);
+  REM_HEADER (p, 1);
+  CHECK_HISTORY (p, 3, 
+                 10, 5, 6);
+  REM_TRAILER (p, 6);
+  CHECK_HISTORY (p, 2, 
+                 10, 5);
+
+  // partially removed headers and trailers become payload.
+  p = Create<Packet> (10);
+  ADD_HEADER (p, 8);
+  ADD_HEADER (p, 5);
+  ADD_TRAILER (p, 4);
+  p1 = p->CreateFragment (5, 22);
+  CHECK_HISTORY (p1, 3, 
+                 8, 10, 4);
+  p1 = p->CreateFragment (6, 21);
+  CHECK_HISTORY (p1, 2, 
+                 17, 4);
+  p1 = p->CreateFragment (0, 5);
+  CHECK_HISTORY (p1, 1, 5);
+  p1 = p->CreateFragment (0, 25);
+  CHECK_HISTORY (p1, 3, 
+                 5, 8, 12);
+
+  // the trailers of the first packet and the headers of the
+  // second one end up in the payload.
+  p = Create<Packet> (10);
+  ADD_HEADER (p, 1);
+  ADD_TRAILER (p, 2);
+  p1 = Create<Packet> (4);
+  ADD_HEADER (p1, 3);
+  ADD_TRAILER (p1, 4);
+  p->AddAtEnd (p1);
+  CHECK_HISTORY (p, 3, 
+                 1, 19, 4);
+  CHECK_HISTORY (p1, 3, 
+                 3, 4, 4);
+}
+//-----------------------------------------------------------------------------
 class PacketMetadataTestSuite : public TestSuite
 {
 public:
@@ -830,6 +954,7 @@ PacketMetadataTestSuite::PacketMetadataTestSuite ()
   : TestSuite ("packet-metadata", UNIT)
 {
   AddTestCase (new PacketMetadataTest, TestCase::QUICK);
+  AddTestCase (new PacketMetadataLightTest, TestCase::QUICK);
 }
 
 PacketMetadataTestSuite g_packetMetadataTest;
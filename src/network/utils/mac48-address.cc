@@ -270,6 +270,21 @@ AsInt (std::string v)
   return retval;
 }
 
+size_t
+Mac48AddressHash::operator() (Mac48Address const &x) const
+{
+  uint8_t buffer[6];
+  x.CopyTo (buffer);
+  // allocated addresses mostly differ in their last bytes so give
+  // them the low bits of the hash.
+  size_t hash = 0;
+  for (uint8_t i = 0; i < 6; i++)
+    {
+      hash = (hash << 8) ^ (hash >> (sizeof (size_t) * 8 - 8)) ^ buffer[i];
+    }
+  return hash;
+}
+
 std::istream& operator>> (std::istream& is, Mac48Address & address)
 {
   std::string v;
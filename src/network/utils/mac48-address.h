@@ -161,6 +161,16 @@ inline bool operator < (const Mac48Address &a, const Mac48Address &b)
   return memcmp (a.m_address, b.m_address, 6) < 0;
 }
 
+/**
+ * \class Mac48AddressHash
+ * \brief Hash function class for MAC-48 addresses.
+ */
+class Mac48AddressHash : public std::unary_function<Mac48Address, size_t>
+{
+public:
+  size_t operator() (Mac48Address const &x) const;
+};
+
 std::ostream& operator<< (std::ostream& os, const Mac48Address & address);
 std::istream& operator>> (std::istream& is, Mac48Address & address);
 
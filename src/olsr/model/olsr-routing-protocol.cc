@@ -47,6 +47,7 @@
 #include "ns3/enum.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/ipv4-header.h"
+#include <algorithm>
 
 /********** Useful macros **********/
 
@@ -196,7 +197,8 @@ RoutingProtocol::RoutingProtocol ()
     m_tcTimer (Timer::CANCEL_ON_DESTROY),
     m_midTimer (Timer::CANCEL_ON_DESTROY),
     m_hnaTimer (Timer::CANCEL_ON_DESTROY),
-    m_queuedMessagesTimer (Timer::CANCEL_ON_DESTROY)
+    m_queuedMessagesTimer (Timer::CANCEL_ON_DESTROY),
+    m_routingTableTimer (Timer::CANCEL_ON_DESTROY)
 {
   m_uniformRandomVariable = CreateObject<UniformRandomVariable> ();
 
@@ -218,6 +220,7 @@ RoutingProtocol::SetIpv4 (Ptr<Ipv4> ipv4)
   m_midTimer.SetFunction (&RoutingProtocol::MidTimerExpire, this);
   m_hnaTimer.SetFunction (&RoutingProtocol::HnaTimerExpire, this);
   m_queuedMessagesTimer.SetFunction (&RoutingProtocol::SendQueuedMessages, this);
+  m_routingTableTimer.SetFunction (&RoutingProtocol::RoutingTableComputation, this);
 
   m_packetSequenceNumber = OLSR_MAX_SEQ_NUM;
   m_messageSequenceNumber = OLSR_MAX_SEQ_NUM;
@@ -235,6 +238,7 @@ void RoutingProtocol::DoDispose ()
   m_ipv4 = 0;
   m_hnaRoutingTable = 0;
   m_routingTableAssociation = 0;
+  m_routingTableTimer.Cancel ();
 
   for (std::map< Ptr<Socket>, Ipv4InterfaceAddress >::iterator iter = m_socketAddresses.begin ();
        iter != m_socketAddresses.end (); iter++)
@@ -502,7 +506,7 @@ RoutingProtocol::RecvOlsr (Ptr<Socket> socket)
     }
 
   // After processing all OLSR messages, we must recompute the routing table
-  RoutingTableComputation ();
+  ScheduleRoutingTableComputation ();
 }
 
 ///
@@ -869,6 +873,22 @@ RoutingProtocol::GetMainAddress (Ipv4Address iface_addr) const
     return iface_addr;
 }
 
+///
+/// \brief Schedules the computation of the routing table at the current
+/// time, unless it is already scheduled.
+///
+/// The routing table is thus computed once for all of the changes of
+/// the state made at a given time.
+///
+void
+RoutingProtocol::ScheduleRoutingTableComputation ()
+{
+  if (!m_routingTableTimer.IsRunning ())
+    {
+      m_routingTableTimer.Schedule (Seconds (0));
+    }
+}
+
 ///
 /// \brief Creates the routing table of the node following RFC 3626 hints.
 ///
@@ -1023,57 +1043,74 @@ RoutingProtocol::RoutingTableComputation ()
         }
     }
 
-  for (uint32_t h = 2;; h++)
+  // 3.1. For each topology entry in the topology table, if its
+  // T_dest_addr does not correspond to R_dest_addr of any
+  // route entry in the routing table AND its T_last_addr
+  // corresponds to R_dest_addr of a route entry whose R_dist
+  // is equal to h, then a new route entry MUST be recorded in
+  // the routing table (if it does not already exist).
+  //
+  // This is a breadth-first search which starts at the 2-hop
+  // neighbors: the destinations at distance h+1 are only looked for
+  // among the topology tuples whose T_last_addr is at distance h.
+  // The tuples of each level are handled in topology set order, so
+  // that, among routes of equal cost, the one of the first tuple in
+  // the topology set is kept.
+  std::vector<Ipv4Address> lastAddrs;
+  for (std::map<Ipv4Address, RoutingTableEntry>::const_iterator it = m_table.begin ();
+       it != m_table.end (); it++)
     {
-      bool added = false;
-
-      // 3.1. For each topology entry in the topology table, if its
-      // T_dest_addr does not correspond to R_dest_addr of any
-      // route entry in the routing table AND its T_last_addr
-      // corresponds to R_dest_addr of a route entry whose R_dist
-      // is equal to h, then a new route entry MUST be recorded in
-      // the routing table (if it does not already exist)
-      const TopologySet &topology = m_state.GetTopologySet ();
-      for (TopologySet::const_iterator it = topology.begin ();
+      if (it->second.distance == 2)
+        {
+          lastAddrs.push_back (it->first);
+        }
+    }
+  std::vector<Ipv4Address> destAddrs;
+  std::vector<const TopologyTuple *> topology;
+  for (uint32_t h = 2; !lastAddrs.empty (); h++)
+    {
+      destAddrs.clear ();
+      topology.clear ();
+      for (std::vector<Ipv4Address>::const_iterator lastAddr = lastAddrs.begin ();
+           lastAddr != lastAddrs.end (); lastAddr++)
+        {
+          m_state.FindTopologyTuples (*lastAddr, topology);
+        }
+      // the tuples are stored contiguously in the topology set
+      std::sort (topology.begin (), topology.end ());
+      for (std::vector<const TopologyTuple *>::const_iterator it = topology.begin ();
            it != topology.end (); it++)
         {
-          const TopologyTuple &topology_tuple = *it;
+          const TopologyTuple &topology_tuple = **it;
           NS_LOG_LOGIC ("Looking at topology tuple: " << topology_tuple);
 
-          RoutingTableEntry destAddrEntry, lastAddrEntry;
-          bool have_destAddrEntry = Lookup (topology_tuple.destAddr, destAddrEntry);
-          bool have_lastAddrEntry = Lookup (topology_tuple.lastAddr, lastAddrEntry);
-          if (!have_destAddrEntry && have_lastAddrEntry && lastAddrEntry.distance == h)
-            {
-              NS_LOG_LOGIC ("Adding routing table entry based on the topology tuple.");
-              // then a new route entry MUST be recorded in
-              //                the routing table (if it does not already exist) where:
-              //                     R_dest_addr  = T_dest_addr;
-              //                     R_next_addr  = R_next_addr of the recorded
-              //                                    route entry where:
-              //                                    R_dest_addr == T_last_addr
-              //                     R_dist       = h+1; and
-              //                     R_iface_addr = R_iface_addr of the recorded
-              //                                    route entry where:
-              //                                       R_dest_addr == T_last_addr.
-              AddEntry (topology_tuple.destAddr,
-                        lastAddrEntry.nextAddr,
-                        lastAddrEntry.interface,
-                        h + 1);
-              added = true;
-            }
-          else
+          RoutingTableEntry destAddrEntry;
+          if (Lookup (topology_tuple.destAddr, destAddrEntry))
             {
               NS_LOG_LOGIC ("NOT adding routing table entry based on the topology tuple: "
-                            "have_destAddrEntry=" << have_destAddrEntry
-                                                  << " have_lastAddrEntry=" << have_lastAddrEntry
-                                                  << " lastAddrEntry.distance=" << (int) lastAddrEntry.distance
-                                                  << " (h=" << h << ")");
+                            "have_destAddrEntry=1 (h=" << h << ")");
+              continue;
             }
-        }
-
-      if (!added)
-        break;
+          NS_LOG_LOGIC ("Adding routing table entry based on the topology tuple.");
+          // then a new route entry MUST be recorded in
+          //                the routing table (if it does not already exist) where:
+          //                     R_dest_addr  = T_dest_addr;
+          //                     R_next_addr  = R_next_addr of the recorded
+          //                                    route entry where:
+          //                                    R_dest_addr == T_last_addr
+          //                     R_dist       = h+1; and
+          //                     R_iface_addr = R_iface_addr of the recorded
+          //                                    route entry where:
+          //                                       R_dest_addr == T_last_addr.
+          RoutingTableEntry lastAddrEntry;
+          Lookup (topology_tuple.lastAddr, lastAddrEntry);
+          AddEntry (topology_tuple.destAddr,
+                    lastAddrEntry.nextAddr,
+                    lastAddrEntry.interface,
+                    h + 1);
+          destAddrs.push_back (topology_tuple.destAddr);
+        }
+      lastAddrs.swap (destAddrs);
     }
 
   // 4. For each entry in the multiple interface association base
@@ -1379,20 +1416,13 @@ RoutingProtocol::ProcessMid (const olsr::MessageHeader &msg,
   for (std::vector<Ipv4Address>::const_iterator i = mid.interfaceAddresses.begin ();
        i != mid.interfaceAddresses.end (); i++)
     {
-      bool updated = false;
-      IfaceAssocSet &ifaceAssoc = m_state.GetIfaceAssocSetMutable ();
-      for (IfaceAssocSet::iterator tuple = ifaceAssoc.begin ();
-           tuple != ifaceAssoc.end (); tuple++)
+      IfaceAssocTuple *ifaceAssoc = m_state.FindIfaceAssocTuple (*i, msg.GetOriginatorAddress ());
+      if (ifaceAssoc != NULL)
         {
-          if (tuple->ifaceAddr == *i
-              && tuple->mainAddr == msg.GetOriginatorAddress ())
-            {
-              NS_LOG_LOGIC ("IfaceAssoc updated: " << *tuple);
-              tuple->time = now + msg.GetVTime ();
-              updated = true;
-            }
+          NS_LOG_LOGIC ("IfaceAssoc updated: " << *ifaceAssoc);
+          ifaceAssoc->time = now + msg.GetVTime ();
         }
-      if (!updated)
+      else
         {
           IfaceAssocTuple tuple;
           tuple.ifaceAddr = *i;
@@ -2356,7 +2386,7 @@ RoutingProtocol::NeighborLoss (const LinkTuple &tuple)
   m_state.EraseMprSelectorTuples (GetMainAddress (tuple.neighborIfaceAddr));
 
   MprComputation ();
-  RoutingTableComputation ();
+  ScheduleRoutingTableComputation ();
 }
 
 ///
@@ -79,6 +79,8 @@ class RoutingProtocol : public Ipv4RoutingProtocol
 {
 public:
   friend class OlsrMprTestCase;
+  friend class OlsrRoutingTableTestCase;
+  friend class OlsrEqualCostRoutesTestCase;
   static TypeId GetTypeId (void);
 
   RoutingProtocol ();
@@ -212,6 +214,7 @@ private:
 
   void MprComputation ();
   void RoutingTableComputation ();
+  void ScheduleRoutingTableComputation ();
   Ipv4Address GetMainAddress (Ipv4Address iface_addr) const;
   bool UsesNonOlsrOutgoingInterface (const Ipv4RoutingTableEntry &route);
 
@@ -242,6 +245,7 @@ private:
   /// A list of pending messages which are buffered awaiting for being sent.
   olsr::MessageList m_queuedMessages;
   Timer m_queuedMessagesTimer; // timer for throttling outgoing messages
+  Timer m_routingTableTimer; // timer for computing the routing table once per timestamp
 
   void ForwardDefault (olsr::MessageHeader olsrMessage,
                        DuplicateTuple *duplicated,
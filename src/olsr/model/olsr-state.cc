@@ -26,6 +26,7 @@
 ///		state of an OLSR node.
 ///
 
+#include <algorithm>
 #include "olsr-state.h"
 
 
@@ -280,36 +281,53 @@ OlsrState::GetMprSet () const
 
 /********** Duplicate Set Manipulation **********/
 
+size_t
+OlsrState::DuplicateKeyHash::operator() (DuplicateKey const &key) const
+{
+  return key.first.Get () * 2654435761U ^ key.second;
+}
+
 DuplicateTuple*
 OlsrState::FindDuplicateTuple (Ipv4Address const &addr, uint16_t sequenceNumber)
 {
-  for (DuplicateSet::iterator it = m_duplicateSet.begin ();
-       it != m_duplicateSet.end (); it++)
-    {
-      if (it->address == addr && it->sequenceNumber == sequenceNumber)
-        return &(*it);
-    }
-  return NULL;
+  sgi::hash_map<DuplicateKey, uint32_t, DuplicateKeyHash>::const_iterator it =
+    m_duplicateIndex.find (DuplicateKey (addr, sequenceNumber));
+  if (it == m_duplicateIndex.end ())
+    return NULL;
+  return &m_duplicateSet[it->second];
 }
 
 void
 OlsrState::EraseDuplicateTuple (const DuplicateTuple &tuple)
 {
-  for (DuplicateSet::iterator it = m_duplicateSet.begin ();
-       it != m_duplicateSet.end (); it++)
+  sgi::hash_map<DuplicateKey, uint32_t, DuplicateKeyHash>::iterator it =
+    m_duplicateIndex.find (DuplicateKey (tuple.address, tuple.sequenceNumber));
+  if (it == m_duplicateIndex.end ())
+    return;
+  // The order of the Duplicate Set does not matter, so the last tuple
+  // takes the place of the erased one (which might be referenced by
+  // tuple, so it is not used after this point).
+  uint32_t position = it->second;
+  m_duplicateIndex.erase (it);
+  if (position + 1 != m_duplicateSet.size ())
     {
-      if (*it == tuple)
-        {
-          m_duplicateSet.erase (it);
-          break;
-        }
+      DuplicateTuple &moved = m_duplicateSet[position];
+      moved = m_duplicateSet.back ();
+      m_duplicateIndex[DuplicateKey (moved.address, moved.sequenceNumber)] = position;
     }
+  m_duplicateSet.pop_back ();
 }
 
 void
 OlsrState::InsertDuplicateTuple (DuplicateTuple const &tuple)
 {
-  m_duplicateSet.push_back (tuple);
+  // Only the first tuple of a message can be found, so a second one
+  // is not kept.
+  if (m_duplicateIndex.insert (std::make_pair (DuplicateKey (tuple.address, tuple.sequenceNumber),
+                                               m_duplicateSet.size ())).second)
+    {
+      m_duplicateSet.push_back (tuple);
+    }
 }
 
 /********** Link Set Manipulation **********/
@@ -366,15 +384,54 @@ OlsrState::InsertLinkTuple (LinkTuple const &tuple)
 
 /********** Topology Set Manipulation **********/
 
+/// Remove the tuples at the given positions, in increasing order and
+/// already removed from the index, from a set, and shift down the
+/// positions of the following tuples in the index. The remaining tuples
+/// keep their order, on which the routing table computation relies to
+/// choose among routes of equal cost.
+template <typename T>
+static void
+ErasePositions (std::vector<T> &set,
+                sgi::hash_map<Ipv4Address, std::vector<uint32_t>, Ipv4AddressHash> &index,
+                const std::vector<uint32_t> &erased)
+{
+  uint32_t next = erased.front ();
+  std::vector<uint32_t>::const_iterator e = erased.begin ();
+  for (uint32_t i = erased.front (); i < set.size (); i++)
+    {
+      if (e != erased.end () && *e == i)
+        {
+          e++;
+          continue;
+        }
+      set[next++] = set[i];
+    }
+  set.erase (set.begin () + next, set.end ());
+
+  for (sgi::hash_map<Ipv4Address, std::vector<uint32_t>, Ipv4AddressHash>::iterator it = index.begin ();
+       it != index.end (); it++)
+    {
+      for (std::vector<uint32_t>::iterator i = it->second.begin ();
+           i != it->second.end (); i++)
+        {
+          *i -= std::lower_bound (erased.begin (), erased.end (), *i) - erased.begin ();
+        }
+    }
+}
+
 TopologyTuple*
 OlsrState::FindTopologyTuple (Ipv4Address const &destAddr,
                               Ipv4Address const &lastAddr)
 {
-  for (TopologySet::iterator it = m_topologySet.begin ();
-       it != m_topologySet.end (); it++)
+  sgi::hash_map<Ipv4Address, std::vector<uint32_t>, Ipv4AddressHash>::const_iterator it =
+    m_topologyIndex.find (lastAddr);
+  if (it == m_topologyIndex.end ())
+    return NULL;
+  for (std::vector<uint32_t>::const_iterator i = it->second.begin ();
+       i != it->second.end (); i++)
     {
-      if (it->destAddr == destAddr && it->lastAddr == lastAddr)
-        return &(*it);
+      if (m_topologySet[*i].destAddr == destAddr)
+        return &m_topologySet[*i];
     }
   return NULL;
 }
@@ -382,24 +439,52 @@ OlsrState::FindTopologyTuple (Ipv4Address const &destAddr,
 TopologyTuple*
 OlsrState::FindNewerTopologyTuple (Ipv4Address const & lastAddr, uint16_t ansn)
 {
-  for (TopologySet::iterator it = m_topologySet.begin ();
-       it != m_topologySet.end (); it++)
+  sgi::hash_map<Ipv4Address, std::vector<uint32_t>, Ipv4AddressHash>::const_iterator it =
+    m_topologyIndex.find (lastAddr);
+  if (it == m_topologyIndex.end ())
+    return NULL;
+  for (std::vector<uint32_t>::const_iterator i = it->second.begin ();
+       i != it->second.end (); i++)
     {
-      if (it->lastAddr == lastAddr && it->sequenceNumber > ansn)
-        return &(*it);
+      if (m_topologySet[*i].sequenceNumber > ansn)
+        return &m_topologySet[*i];
     }
   return NULL;
 }
 
+void
+OlsrState::FindTopologyTuples (const Ipv4Address &lastAddr,
+                               std::vector<const TopologyTuple *> &tuples) const
+{
+  sgi::hash_map<Ipv4Address, std::vector<uint32_t>, Ipv4AddressHash>::const_iterator it =
+    m_topologyIndex.find (lastAddr);
+  if (it == m_topologyIndex.end ())
+    return;
+  for (std::vector<uint32_t>::const_iterator i = it->second.begin ();
+       i != it->second.end (); i++)
+    {
+      tuples.push_back (&m_topologySet[*i]);
+    }
+}
+
 void
 OlsrState::EraseTopologyTuple (const TopologyTuple &tuple)
 {
-  for (TopologySet::iterator it = m_topologySet.begin ();
-       it != m_topologySet.end (); it++)
+  sgi::hash_map<Ipv4Address, std::vector<uint32_t>, Ipv4AddressHash>::iterator it =
+    m_topologyIndex.find (tuple.lastAddr);
+  if (it == m_topologyIndex.end ())
+    return;
+  for (uint32_t i = 0; i < it->second.size (); i++)
     {
-      if (*it == tuple)
+      if (m_topologySet[it->second[i]] == tuple)
         {
-          m_topologySet.erase (it);
+          std::vector<uint32_t> erased (1, it->second[i]);
+          it->second.erase (it->second.begin () + i);
+          if (it->second.empty ())
+            {
+              m_topologyIndex.erase (it);
+            }
+          ErasePositions (m_topologySet, m_topologyIndex, erased);
           break;
         }
     }
@@ -408,23 +493,38 @@ OlsrState::EraseTopologyTuple (const TopologyTuple &tuple)
 void
 OlsrState::EraseOlderTopologyTuples (const Ipv4Address &lastAddr, uint16_t ansn)
 {
-  for (TopologySet::iterator it = m_topologySet.begin ();
-       it != m_topologySet.end ();)
+  sgi::hash_map<Ipv4Address, std::vector<uint32_t>, Ipv4AddressHash>::iterator it =
+    m_topologyIndex.find (lastAddr);
+  if (it == m_topologyIndex.end ())
+    return;
+  std::vector<uint32_t> erased;
+  for (uint32_t i = 0; i < it->second.size ();)
     {
-      if (it->lastAddr == lastAddr && it->sequenceNumber < ansn)
+      if (m_topologySet[it->second[i]].sequenceNumber < ansn)
         {
-          it = m_topologySet.erase (it);
+          erased.push_back (it->second[i]);
+          it->second.erase (it->second.begin () + i);
         }
       else
         {
-          it++;
+          i++;
         }
     }
+  if (it->second.empty ())
+    {
+      m_topologyIndex.erase (it);
+    }
+  if (!erased.empty ())
+    {
+      // the positions of a last address are in increasing order
+      ErasePositions (m_topologySet, m_topologyIndex, erased);
+    }
 }
 
 void
 OlsrState::InsertTopologyTuple (TopologyTuple const &tuple)
 {
+  m_topologyIndex[tuple.lastAddr].push_back (m_topologySet.size ());
   m_topologySet.push_back (tuple);
 }
 
@@ -433,23 +533,35 @@ OlsrState::InsertTopologyTuple (TopologyTuple const &tuple)
 IfaceAssocTuple*
 OlsrState::FindIfaceAssocTuple (Ipv4Address const &ifaceAddr)
 {
-  for (IfaceAssocSet::iterator it = m_ifaceAssocSet.begin ();
-       it != m_ifaceAssocSet.end (); it++)
-    {
-      if (it->ifaceAddr == ifaceAddr)
-        return &(*it);
-    }
-  return NULL;
+  sgi::hash_map<Ipv4Address, std::vector<uint32_t>, Ipv4AddressHash>::const_iterator it =
+    m_ifaceAssocIndex.find (ifaceAddr);
+  if (it == m_ifaceAssocIndex.end ())
+    return NULL;
+  return &m_ifaceAssocSet[it->second.front ()];
 }
 
 const IfaceAssocTuple*
 OlsrState::FindIfaceAssocTuple (Ipv4Address const &ifaceAddr) const
 {
-  for (IfaceAssocSet::const_iterator it = m_ifaceAssocSet.begin ();
-       it != m_ifaceAssocSet.end (); it++)
+  sgi::hash_map<Ipv4Address, std::vector<uint32_t>, Ipv4AddressHash>::const_iterator it =
+    m_ifaceAssocIndex.find (ifaceAddr);
+  if (it == m_ifaceAssocIndex.end ())
+    return NULL;
+  return &m_ifaceAssocSet[it->second.front ()];
+}
+
+IfaceAssocTuple*
+OlsrState::FindIfaceAssocTuple (Ipv4Address const &ifaceAddr, Ipv4Address const &mainAddr)
+{
+  sgi::hash_map<Ipv4Address, std::vector<uint32_t>, Ipv4AddressHash>::const_iterator it =
+    m_ifaceAssocIndex.find (ifaceAddr);
+  if (it == m_ifaceAssocIndex.end ())
+    return NULL;
+  for (std::vector<uint32_t>::const_iterator i = it->second.begin ();
+       i != it->second.end (); i++)
     {
-      if (it->ifaceAddr == ifaceAddr)
-        return &(*it);
+      if (m_ifaceAssocSet[*i].mainAddr == mainAddr)
+        return &m_ifaceAssocSet[*i];
     }
   return NULL;
 }
@@ -457,12 +569,21 @@ OlsrState::FindIfaceAssocTuple (Ipv4Address const &ifaceAddr) const
 void
 OlsrState::EraseIfaceAssocTuple (const IfaceAssocTuple &tuple)
 {
-  for (IfaceAssocSet::iterator it = m_ifaceAssocSet.begin ();
-       it != m_ifaceAssocSet.end (); it++)
+  sgi::hash_map<Ipv4Address, std::vector<uint32_t>, Ipv4AddressHash>::iterator it =
+    m_ifaceAssocIndex.find (tuple.ifaceAddr);
+  if (it == m_ifaceAssocIndex.end ())
+    return;
+  for (uint32_t i = 0; i < it->second.size (); i++)
     {
-      if (*it == tuple)
+      if (m_ifaceAssocSet[it->second[i]] == tuple)
         {
-          m_ifaceAssocSet.erase (it);
+          std::vector<uint32_t> erased (1, it->second[i]);
+          it->second.erase (it->second.begin () + i);
+          if (it->second.empty ())
+            {
+              m_ifaceAssocIndex.erase (it);
+            }
+          ErasePositions (m_ifaceAssocSet, m_ifaceAssocIndex, erased);
           break;
         }
     }
@@ -471,6 +592,7 @@ OlsrState::EraseIfaceAssocTuple (const IfaceAssocTuple &tuple)
 void
 OlsrState::InsertIfaceAssocTuple (const IfaceAssocTuple &tuple)
 {
+  m_ifaceAssocIndex[tuple.ifaceAddr].push_back (m_ifaceAssocSet.size ());
   m_ifaceAssocSet.push_back (tuple);
 }
 
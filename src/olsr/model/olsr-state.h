@@ -26,6 +26,7 @@
 #define OLSR_STATE_H
 
 #include "olsr-repositories.h"
+#include "ns3/sgi-hashmap.h"
 
 namespace ns3 {
 
@@ -48,6 +49,22 @@ protected:
   AssociationSet m_associationSet; ///<	Association Set (RFC 3626, section12.2). Associations obtained from HNA messages generated by other nodes.
   Associations m_associations;  ///< The node's local Host Network Associations that will be advertised using HNA messages.
 
+  /// The originator address and message sequence number of a Duplicate Tuple.
+  typedef std::pair<Ipv4Address, uint16_t> DuplicateKey;
+  /// Hash function of the keys of the Duplicate Set.
+  class DuplicateKeyHash : public std::unary_function<DuplicateKey, size_t>
+  {
+public:
+    size_t operator() (DuplicateKey const &key) const;
+  };
+  /// The positions of the Duplicate Set tuples, by key.
+  sgi::hash_map<DuplicateKey, uint32_t, DuplicateKeyHash> m_duplicateIndex;
+  /// The positions of the Topology Set tuples, by last address, in insertion order.
+  sgi::hash_map<Ipv4Address, std::vector<uint32_t>, Ipv4AddressHash> m_topologyIndex;
+
+  /// The positions of the Interface Association Set tuples, by interface address.
+  sgi::hash_map<Ipv4Address, std::vector<uint32_t>, Ipv4AddressHash> m_ifaceAssocIndex;
+
 public:
 
   OlsrState ()
@@ -134,18 +151,25 @@ public:
   void EraseOlderTopologyTuples (const Ipv4Address &lastAddr,
                                  uint16_t ansn);
   void InsertTopologyTuple (const TopologyTuple &tuple);
+  /// Appends to tuples the topology tuples whose last address is lastAddr,
+  /// in the order in which they were inserted.
+  void FindTopologyTuples (const Ipv4Address &lastAddr,
+                           std::vector<const TopologyTuple *> &tuples) const;
 
   // Interface association
   const IfaceAssocSet & GetIfaceAssocSet () const
   {
     return m_ifaceAssocSet;
   }
+  /// The tuples may be modified, but not inserted nor erased.
   IfaceAssocSet & GetIfaceAssocSetMutable ()
   {
     return m_ifaceAssocSet;
   }
   IfaceAssocTuple* FindIfaceAssocTuple (const Ipv4Address &ifaceAddr);
   const IfaceAssocTuple* FindIfaceAssocTuple (const Ipv4Address &ifaceAddr) const;
+  IfaceAssocTuple* FindIfaceAssocTuple (const Ipv4Address &ifaceAddr,
+                                        const Ipv4Address &mainAddr);
   void EraseIfaceAssocTuple (const IfaceAssocTuple &tuple);
   void InsertIfaceAssocTuple (const IfaceAssocTuple &tuple);
 
@@ -23,6 +23,9 @@
 #include "ns3/test.h"
 #include "ns3/olsr-routing-protocol.h"
 #include "ns3/ipv4-header.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simulator.h"
 
 /********** Willingness **********/
 
@@ -167,6 +170,257 @@ OlsrMprTestCase::DoRun ()
   NS_TEST_EXPECT_MSG_EQ ((mpr.find ("10.0.0.9") == mpr.end ()), true, "Node 1 must NOT select node 8 as MPR");
 }
 
+/// Testcase for the Topology Set index and the routing table computation
+class OlsrRoutingTableTestCase : public TestCase {
+public:
+  OlsrRoutingTableTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+};
+
+OlsrRoutingTableTestCase::OlsrRoutingTableTestCase ()
+  : TestCase ("Check OLSR routing table computation from the topology set")
+{
+}
+
+void
+OlsrRoutingTableTestCase::DoRun ()
+{
+  // The routes are added through the interface of the local address
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetAddress (Mac48Address::Allocate ());
+  node->AddDevice (device);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  uint32_t interface = ipv4->AddInterface (device);
+  ipv4->AddAddress (interface, Ipv4InterfaceAddress (Ipv4Address ("10.0.0.1"), Ipv4Mask ("255.255.255.0")));
+  ipv4->SetUp (interface);
+
+  Ptr<RoutingProtocol> protocol = CreateObject<RoutingProtocol> ();
+  protocol->SetIpv4 (ipv4);
+  protocol->m_mainAddress = Ipv4Address ("10.0.0.1");
+  OlsrState & state = protocol->m_state;
+
+  /*
+   *  1 -- 2 -- 3 -- 4 -- 5 -- 6
+   *                 |         |
+   *                 7 ------- 8
+   *
+   * Node 1 only knows 2 as a neighbor and 3 as a 2-hop neighbor, the
+   * rest comes from the topology set.
+   */
+  LinkTuple link;
+  link.localIfaceAddr = Ipv4Address ("10.0.0.1");
+  link.neighborIfaceAddr = Ipv4Address ("10.0.0.2");
+  link.symTime = Seconds (3600);
+  link.asymTime = Seconds (3600);
+  link.time = Seconds (3600);
+  state.InsertLinkTuple (link);
+  NeighborTuple neighbor;
+  neighbor.neighborMainAddr = Ipv4Address ("10.0.0.2");
+  neighbor.status = NeighborTuple::STATUS_SYM;
+  neighbor.willingness = OLSR_WILL_DEFAULT;
+  state.InsertNeighborTuple (neighbor);
+  TwoHopNeighborTuple twoHop;
+  twoHop.neighborMainAddr = Ipv4Address ("10.0.0.2");
+  twoHop.twoHopNeighborAddr = Ipv4Address ("10.0.0.3");
+  twoHop.expirationTime = Seconds (3600);
+  state.InsertTwoHopNeighborTuple (twoHop);
+
+  const char *edges[][2] = {
+    { "10.0.0.3", "10.0.0.4" }, { "10.0.0.4", "10.0.0.3" },
+    { "10.0.0.4", "10.0.0.5" }, { "10.0.0.5", "10.0.0.4" },
+    { "10.0.0.5", "10.0.0.6" }, { "10.0.0.6", "10.0.0.5" },
+    { "10.0.0.4", "10.0.0.7" }, { "10.0.0.7", "10.0.0.4" },
+    { "10.0.0.7", "10.0.0.8" }, { "10.0.0.8", "10.0.0.7" },
+    { "10.0.0.6", "10.0.0.8" }, { "10.0.0.8", "10.0.0.6" },
+    { "10.0.0.3", "10.0.0.2" },
+  };
+  for (uint32_t i = 0; i < sizeof (edges) / sizeof (edges[0]); i++)
+    {
+      TopologyTuple topology;
+      topology.lastAddr = Ipv4Address (edges[i][0]);
+      topology.destAddr = Ipv4Address (edges[i][1]);
+      topology.sequenceNumber = 1;
+      topology.expirationTime = Seconds (3600);
+      state.InsertTopologyTuple (topology);
+    }
+  NS_TEST_EXPECT_MSG_NE (state.FindTopologyTuple (Ipv4Address ("10.0.0.8"), Ipv4Address ("10.0.0.6")), 0,
+                         "Topology tuple 6 -> 8 not found");
+  NS_TEST_EXPECT_MSG_NE (state.FindTopologyTuple (Ipv4Address ("10.0.0.6"), Ipv4Address ("10.0.0.8")), 0,
+                         "Topology tuple 8 -> 6 not found");
+  NS_TEST_EXPECT_MSG_EQ (state.FindTopologyTuple (Ipv4Address ("10.0.0.3"), Ipv4Address ("10.0.0.8")), 0,
+                         "Found a topology tuple 8 -> 3");
+
+  protocol->RoutingTableComputation ();
+  const uint32_t distances[] = { 0, 0, 1, 2, 3, 4, 5, 4, 5 };
+  for (uint32_t i = 2; i <= 8; i++)
+    {
+      RoutingTableEntry entry;
+      NS_TEST_ASSERT_MSG_EQ (protocol->Lookup (Ipv4Address (0x0a000000 + i), entry), true, "No route to node " << i);
+      NS_TEST_EXPECT_MSG_EQ (entry.distance, distances[i], "Wrong distance to node " << i);
+      NS_TEST_EXPECT_MSG_EQ (entry.nextAddr, Ipv4Address ("10.0.0.2"), "Wrong next hop to node " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (protocol->GetSize (), 7, "Wrong number of routes");
+
+  // Node 4 advertises a newer topology without node 7, and node 8
+  // no longer advertises node 7: node 7 becomes unreachable, while
+  // node 8 is still reachable through node 6.
+  NS_TEST_EXPECT_MSG_EQ (state.FindNewerTopologyTuple (Ipv4Address ("10.0.0.4"), 1), 0,
+                         "Found a topology tuple newer than the newest one");
+  state.EraseOlderTopologyTuples (Ipv4Address ("10.0.0.4"), 2);
+  TopologyTuple topology;
+  topology.lastAddr = Ipv4Address ("10.0.0.4");
+  topology.sequenceNumber = 2;
+  topology.expirationTime = Seconds (3600);
+  topology.destAddr = Ipv4Address ("10.0.0.3");
+  state.InsertTopologyTuple (topology);
+  topology.destAddr = Ipv4Address ("10.0.0.5");
+  state.InsertTopologyTuple (topology);
+  NS_TEST_EXPECT_MSG_NE (state.FindNewerTopologyTuple (Ipv4Address ("10.0.0.4"), 1), 0,
+                         "Newer topology tuple not found");
+  state.EraseTopologyTuple (*state.FindTopologyTuple (Ipv4Address ("10.0.0.7"), Ipv4Address ("10.0.0.8")));
+  NS_TEST_EXPECT_MSG_EQ (state.FindTopologyTuple (Ipv4Address ("10.0.0.7"), Ipv4Address ("10.0.0.4")), 0,
+                         "Old topology tuple 4 -> 7 still found");
+  NS_TEST_EXPECT_MSG_NE (state.FindTopologyTuple (Ipv4Address ("10.0.0.4"), Ipv4Address ("10.0.0.7")), 0,
+                         "Topology tuple 7 -> 4 not found");
+  NS_TEST_EXPECT_MSG_EQ (state.GetTopologySet ().size (), 11, "Wrong size of the topology set");
+
+  protocol->RoutingTableComputation ();
+  RoutingTableEntry entry;
+  NS_TEST_EXPECT_MSG_EQ (protocol->Lookup (Ipv4Address ("10.0.0.7"), entry), false, "Route to node 7 not removed");
+  NS_TEST_ASSERT_MSG_EQ (protocol->Lookup (Ipv4Address ("10.0.0.8"), entry), true, "No route to node 8");
+  NS_TEST_EXPECT_MSG_EQ (entry.distance, 6, "Wrong distance to node 8");
+
+  // Duplicate set
+  DuplicateTuple duplicate;
+  duplicate.address = Ipv4Address ("10.0.0.5");
+  duplicate.retransmitted = false;
+  duplicate.expirationTime = Seconds (30);
+  for (uint16_t i = 0; i < 10; i++)
+    {
+      duplicate.sequenceNumber = i;
+      state.InsertDuplicateTuple (duplicate);
+    }
+  state.EraseDuplicateTuple (*state.FindDuplicateTuple (Ipv4Address ("10.0.0.5"), 3));
+  NS_TEST_EXPECT_MSG_EQ (state.FindDuplicateTuple (Ipv4Address ("10.0.0.5"), 3), 0, "Erased duplicate tuple found");
+  for (uint16_t i = 0; i < 10; i++)
+    {
+      if (i != 3)
+        {
+          DuplicateTuple *tuple = state.FindDuplicateTuple (Ipv4Address ("10.0.0.5"), i);
+          NS_TEST_ASSERT_MSG_NE (tuple, 0, "Duplicate tuple " << i << " not found");
+          NS_TEST_EXPECT_MSG_EQ (tuple->sequenceNumber, i, "Wrong duplicate tuple " << i);
+        }
+    }
+
+  protocol->Dispose ();
+  Simulator::Destroy ();
+}
+
+/// Testcase for the choice among routes of equal cost
+class OlsrEqualCostRoutesTestCase : public TestCase {
+public:
+  OlsrEqualCostRoutesTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+};
+
+OlsrEqualCostRoutesTestCase::OlsrEqualCostRoutesTestCase ()
+  : TestCase ("Check that OLSR keeps the route of the first topology tuple among routes of equal cost")
+{
+}
+
+void
+OlsrEqualCostRoutesTestCase::DoRun ()
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetAddress (Mac48Address::Allocate ());
+  node->AddDevice (device);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  uint32_t interface = ipv4->AddInterface (device);
+  ipv4->AddAddress (interface, Ipv4InterfaceAddress (Ipv4Address ("10.0.0.1"), Ipv4Mask ("255.255.255.0")));
+  ipv4->SetUp (interface);
+
+  Ptr<RoutingProtocol> protocol = CreateObject<RoutingProtocol> ();
+  protocol->SetIpv4 (ipv4);
+  protocol->m_mainAddress = Ipv4Address ("10.0.0.1");
+  OlsrState & state = protocol->m_state;
+
+  /*
+   *      2 -- 4
+   *     /      \
+   *    1        6
+   *     \      /
+   *      3 -- 5 -- 7
+   *
+   * Node 6 is at 3 hops through both node 2 and node 3.
+   */
+  const char *neighbors[][2] = {
+    { "10.0.0.2", "10.0.0.4" }, { "10.0.0.3", "10.0.0.5" },
+  };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      LinkTuple link;
+      link.localIfaceAddr = Ipv4Address ("10.0.0.1");
+      link.neighborIfaceAddr = Ipv4Address (neighbors[i][0]);
+      link.symTime = Seconds (3600);
+      link.asymTime = Seconds (3600);
+      link.time = Seconds (3600);
+      state.InsertLinkTuple (link);
+      NeighborTuple neighbor;
+      neighbor.neighborMainAddr = Ipv4Address (neighbors[i][0]);
+      neighbor.status = NeighborTuple::STATUS_SYM;
+      neighbor.willingness = OLSR_WILL_DEFAULT;
+      state.InsertNeighborTuple (neighbor);
+      TwoHopNeighborTuple twoHop;
+      twoHop.neighborMainAddr = Ipv4Address (neighbors[i][0]);
+      twoHop.twoHopNeighborAddr = Ipv4Address (neighbors[i][1]);
+      twoHop.expirationTime = Seconds (3600);
+      state.InsertTwoHopNeighborTuple (twoHop);
+    }
+
+  // The tuple 5 -> 6 comes before the tuple 4 -> 6 in the topology
+  // set, so the route to node 6 goes through node 3.
+  const char *edges[][2] = {
+    { "10.0.0.5", "10.0.0.7" }, { "10.0.0.5", "10.0.0.6" }, { "10.0.0.4", "10.0.0.6" },
+  };
+  for (uint32_t i = 0; i < sizeof (edges) / sizeof (edges[0]); i++)
+    {
+      TopologyTuple topology;
+      topology.lastAddr = Ipv4Address (edges[i][0]);
+      topology.destAddr = Ipv4Address (edges[i][1]);
+      topology.sequenceNumber = 1;
+      topology.expirationTime = Seconds (3600);
+      state.InsertTopologyTuple (topology);
+    }
+
+  protocol->RoutingTableComputation ();
+  RoutingTableEntry entry;
+  NS_TEST_ASSERT_MSG_EQ (protocol->Lookup (Ipv4Address ("10.0.0.6"), entry), true, "No route to node 6");
+  NS_TEST_EXPECT_MSG_EQ (entry.distance, 3, "Wrong distance to node 6");
+  NS_TEST_EXPECT_MSG_EQ (entry.nextAddr, Ipv4Address ("10.0.0.3"), "Wrong next hop to node 6");
+
+  // Erasing the first tuple must not change the order of the others
+  state.EraseTopologyTuple (*state.FindTopologyTuple (Ipv4Address ("10.0.0.7"), Ipv4Address ("10.0.0.5")));
+  NS_TEST_EXPECT_MSG_EQ (state.GetTopologySet ()[0].destAddr, Ipv4Address ("10.0.0.6"), "Wrong first topology tuple");
+  NS_TEST_EXPECT_MSG_EQ (state.GetTopologySet ()[0].lastAddr, Ipv4Address ("10.0.0.5"), "Wrong first topology tuple");
+
+  protocol->RoutingTableComputation ();
+  NS_TEST_EXPECT_MSG_EQ (protocol->Lookup (Ipv4Address ("10.0.0.7"), entry), false, "Route to node 7 not removed");
+  NS_TEST_ASSERT_MSG_EQ (protocol->Lookup (Ipv4Address ("10.0.0.6"), entry), true, "No route to node 6");
+  NS_TEST_EXPECT_MSG_EQ (entry.distance, 3, "Wrong distance to node 6");
+  NS_TEST_EXPECT_MSG_EQ (entry.nextAddr, Ipv4Address ("10.0.0.3"), "Wrong next hop to node 6");
+
+  protocol->Dispose ();
+  Simulator::Destroy ();
+}
+
 static class OlsrProtocolTestSuite : public TestSuite
 {
 public:
@@ -177,6 +431,8 @@ OlsrProtocolTestSuite::OlsrProtocolTestSuite()
   : TestSuite ("routing-olsr", UNIT)
 {
   AddTestCase (new OlsrMprTestCase (), TestCase::QUICK);
+  AddTestCase (new OlsrRoutingTableTestCase (), TestCase::QUICK);
+  AddTestCase (new OlsrEqualCostRoutesTestCase (), TestCase::QUICK);
 }
 
 }
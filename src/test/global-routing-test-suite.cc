@@ -15,6 +15,7 @@
  */
 
 #include <vector>
+#include <sstream>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
 #include "ns3/csma-helper.h"
@@ -24,6 +25,8 @@
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
 #include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/global-router-interface.h"
 #include "ns3/ipv4-static-routing-helper.h"
 #include "ns3/node.h"
 #include "ns3/node-container.h"
@@ -48,21 +51,24 @@ using namespace ns3;
 class DynamicGlobalRoutingTestCase : public TestCase
 {
 public:
-  DynamicGlobalRoutingTestCase ();
+  DynamicGlobalRoutingTestCase (bool incremental);
   virtual ~DynamicGlobalRoutingTestCase ();
 
 private:
   void SinkRx (std::string path, Ptr<const Packet> p, const Address &address);
   void HandleRead (Ptr<Socket>);
   virtual void DoRun (void);
+  bool m_incremental;
   int m_count;
   std::vector<uint8_t> m_firstInterface;
   std::vector<uint8_t> m_secondInterface;
 };
 
 // Add some help text to this case to describe what it is intended to test
-DynamicGlobalRoutingTestCase::DynamicGlobalRoutingTestCase ()
-  : TestCase ("Dynamic global routing example"), m_count (0)
+DynamicGlobalRoutingTestCase::DynamicGlobalRoutingTestCase (bool incremental)
+  : TestCase (incremental ? "Dynamic global routing example with incremental SPF" : "Dynamic global routing example"),
+    m_incremental (incremental),
+    m_count (0)
 {
   m_firstInterface.resize (16);
   m_secondInterface.resize (16);
@@ -142,6 +148,7 @@ DynamicGlobalRoutingTestCase::DoRun (void)
   // The below value configures the default behavior of global routing.
   // By default, it is disabled.  To respond to interface events, set to true
   Config::SetDefault ("ns3::Ipv4GlobalRouting::RespondToInterfaceEvents", BooleanValue (true));
+  Config::SetDefault ("ns3::Ipv4GlobalRouting::IncrementalSpf", BooleanValue (m_incremental));
 
   NodeContainer c;
   c.Create (7);
@@ -254,6 +261,7 @@ DynamicGlobalRoutingTestCase::DoRun (void)
   Simulator::Schedule (Seconds (14),&Ipv4::SetUp,ipv41, ipv4ifIndex1);
 
   Simulator::Run ();
+  Config::SetDefault ("ns3::Ipv4GlobalRouting::IncrementalSpf", BooleanValue (false));
 
   NS_TEST_ASSERT_MSG_EQ (m_count, 68, "Dynamic global routing did not deliver all packets");
 // Test that for node n6, the interface facing n5 receives packets at
@@ -385,6 +393,115 @@ GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class GlobalRoutingIncrementalTestCase : public TestCase
+{
+public:
+  GlobalRoutingIncrementalTestCase ();
+  virtual ~GlobalRoutingIncrementalTestCase ();
+
+private:
+  std::string GetRoutes (NodeContainer c);
+  void CheckRoutes (NodeContainer c, std::string event);
+  virtual void DoRun (void);
+};
+
+GlobalRoutingIncrementalTestCase::GlobalRoutingIncrementalTestCase ()
+  : TestCase ("Incremental update of the global routes")
+{
+}
+
+GlobalRoutingIncrementalTestCase::~GlobalRoutingIncrementalTestCase ()
+{
+}
+
+// The routes of all the nodes, in the order of their routing tables, which
+// decides the next hop among equal cost routes
+std::string
+GlobalRoutingIncrementalTestCase::GetRoutes (NodeContainer c)
+{
+  std::ostringstream oss;
+  for (uint32_t i = 0; i < c.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = c.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      oss << "node " << i << ":";
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          oss << " [" << *routing->GetRoute (j) << "]";
+        }
+      oss << std::endl;
+    }
+  return oss.str ();
+}
+
+void
+GlobalRoutingIncrementalTestCase::CheckRoutes (NodeContainer c, std::string event)
+{
+  Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
+  std::string updated = GetRoutes (c);
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  std::string recomputed = GetRoutes (c);
+  NS_TEST_EXPECT_MSG_EQ (updated, recomputed, "Incremental routes differ from the recomputed ones after " << event);
+  // The recomputation freed the SPF trees, keep them again for the next event
+  Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
+  NS_TEST_EXPECT_MSG_EQ (GetRoutes (c), recomputed, "Routes differ from the recomputed ones after " << event);
+}
+
+// A 3x3 grid of routers connected by point-to-point links with various
+// metrics, plus a csma segment shared by three of them.  Every interface
+// of the grid goes down and up again; after each event, the incrementally
+// updated routes must be the same as the recomputed ones.
+//
+void
+GlobalRoutingIncrementalTestCase::DoRun (void)
+{
+  NodeContainer c;
+  c.Create (9);
+  InternetStackHelper internet;
+  internet.Install (c);
+
+  PointToPointHelper p2p;
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  std::vector<std::pair<Ptr<Ipv4>, uint32_t> > interfaces;
+  for (uint32_t i = 0; i < 9; i++)
+    {
+      for (uint32_t j = i + 1; j < 9; j++)
+        {
+          bool right = (j == i + 1 && j % 3 != 0);
+          bool down = (j == i + 3);
+          if (!right && !down)
+            {
+              continue;
+            }
+          Ipv4InterfaceContainer link = ipv4.Assign (p2p.Install (c.Get (i), c.Get (j)));
+          ipv4.NewNetwork ();
+          for (uint32_t k = 0; k < 2; k++)
+            {
+              std::pair<Ptr<Ipv4>, uint32_t> interface = link.Get (k);
+              interface.first->SetMetric (interface.second, 1 + (i + j + k) % 3);
+              interfaces.push_back (interface);
+            }
+        }
+    }
+  CsmaHelper csma;
+  ipv4.SetBase ("10.2.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer lan = ipv4.Assign (csma.Install (NodeContainer (c.Get (0), c.Get (4), c.Get (8))));
+  interfaces.push_back (lan.Get (1));
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  CheckRoutes (c, "no change");
+  CheckRoutes (c, "no change");
+  for (uint32_t i = 0; i < interfaces.size (); i++)
+    {
+      std::ostringstream event;
+      event << "interface " << interfaces[i].second << " of " << interfaces[i].first;
+      interfaces[i].first->SetDown (interfaces[i].second);
+      CheckRoutes (c, event.str () + " down");
+      interfaces[i].first->SetUp (interfaces[i].second);
+      CheckRoutes (c, event.str () + " up");
+    }
+  Simulator::Destroy ();
+}
 
 class GlobalRoutingTestSuite : public TestSuite
 {
@@ -395,8 +512,10 @@ public:
 GlobalRoutingTestSuite::GlobalRoutingTestSuite ()
   : TestSuite ("global-routing", UNIT)
 {
-  AddTestCase (new DynamicGlobalRoutingTestCase, TestCase::QUICK);
+  AddTestCase (new DynamicGlobalRoutingTestCase (false), TestCase::QUICK);
+  AddTestCase (new DynamicGlobalRoutingTestCase (true), TestCase::QUICK);
   AddTestCase (new GlobalRoutingSlash32TestCase, TestCase::QUICK);
+  AddTestCase (new GlobalRoutingIncrementalTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
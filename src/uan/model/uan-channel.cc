@@ -26,6 +26,8 @@
 #include "ns3/node.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "ns3/log.h"
 
 #include "uan-channel.h"
@@ -58,15 +60,54 @@ UanChannel::GetTypeId ()
                    PointerValue (CreateObject<UanNoiseModelDefault> ()),
                    MakePointerAccessor (&UanChannel::m_noise),
                    MakePointerChecker<UanNoiseModel> ())
+    .AddAttribute ("PropagationCache",
+                   "Keep the delay, power delay profile and path loss between a transmitter "
+                   "and a receiver until either of them moves.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&UanChannel::m_propagationCacheEnabled),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxRange",
+                   "Maximum distance, in meters, from a transmitter to the receivers of its "
+                   "packets. Zero means that every device receives them.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&UanChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0.0))
   ;
 
   return tid;
 }
 
+UanChannel::PropagationKey::PropagationKey (uint32_t src, uint32_t dst, uint32_t mode)
+  : m_src (src),
+    m_dst (dst),
+    m_mode (mode)
+{
+}
+
+bool
+UanChannel::PropagationKey::operator == (const PropagationKey &o) const
+{
+  return m_src == o.m_src && m_dst == o.m_dst && m_mode == o.m_mode;
+}
+
+size_t
+UanChannel::PropagationKeyHash::operator () (const PropagationKey &key) const
+{
+  return (key.m_src * 65599 + key.m_dst) * 31 + key.m_mode;
+}
+
+static bool
+SamePosition (const Vector &a, const Vector &b)
+{
+  return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
 UanChannel::UanChannel ()
   : Channel (),
     m_prop (0),
-    m_cleared (false)
+    m_cleared (false),
+    m_propagationCacheEnabled (false),
+    m_maxRange (0.0)
 {
 }
 
@@ -97,6 +138,7 @@ UanChannel::Clear ()
         }
     }
   m_devList.clear ();
+  m_propagationCache.clear ();
   if (m_prop)
     {
       m_prop->Clear ();
@@ -121,6 +163,7 @@ UanChannel::SetPropagationModel (Ptr<UanPropModel> prop)
 {
   NS_LOG_DEBUG ("Set Prop Model " << this);
   m_prop = prop;
+  m_propagationCache.clear ();
 }
 
 uint32_t
@@ -147,6 +190,7 @@ UanChannel::TxPacket (Ptr<UanTransducer> src, Ptr<Packet> packet,
                       double txPowerDb, UanTxMode txMode)
 {
   Ptr<MobilityModel> senderMobility = 0;
+  uint32_t srcIndex = 0;
 
   NS_LOG_DEBUG ("Channel scheduling");
   for (UanDeviceList::const_iterator i = m_devList.begin (); i
@@ -158,21 +202,62 @@ UanChannel::TxPacket (Ptr<UanTransducer> src, Ptr<Packet> packet,
           senderMobility = i->first->GetNode ()->GetObject<MobilityModel> ();
           break;
         }
+      srcIndex++;
     }
   NS_ASSERT (senderMobility != 0);
+  Vector senderPosition;
+  if (m_propagationCacheEnabled || m_maxRange > 0)
+    {
+      senderPosition = senderMobility->GetPosition ();
+    }
   uint32_t j = 0;
   UanDeviceList::const_iterator i = m_devList.begin ();
   for (; i != m_devList.end (); i++)
     {
       if (src != i->second)
         {
-          NS_LOG_DEBUG ("Scheduling " << i->first->GetMac ()->GetAddress ());
           Ptr<MobilityModel> rcvrMobility = i->first->GetNode ()->GetObject<MobilityModel> ();
-          Time delay = m_prop->GetDelay (senderMobility, rcvrMobility, txMode);
-          UanPdp pdp = m_prop->GetPdp (senderMobility, rcvrMobility, txMode);
-          double rxPowerDb = txPowerDb - m_prop->GetPathLossDb (senderMobility,
-                                                                rcvrMobility,
-                                                                txMode);
+          Vector rcvrPosition;
+          if (m_propagationCacheEnabled || m_maxRange > 0)
+            {
+              rcvrPosition = rcvrMobility->GetPosition ();
+            }
+          if (m_maxRange > 0 && CalculateDistance (senderPosition, rcvrPosition) > m_maxRange)
+            {
+              j++;
+              continue;
+            }
+          NS_LOG_DEBUG ("Scheduling " << i->first->GetMac ()->GetAddress ());
+          Time delay;
+          UanPdp computedPdp;
+          const UanPdp *pdp = &computedPdp;
+          double pathLossDb;
+          if (m_propagationCacheEnabled)
+            {
+              std::pair<PropagationCache::iterator, bool> ret =
+                m_propagationCache.insert (std::make_pair (PropagationKey (srcIndex, j, txMode.GetUid ()),
+                                                           PropagationProfile ()));
+              PropagationProfile &profile = ret.first->second;
+              if (ret.second || !SamePosition (profile.m_srcPosition, senderPosition)
+                  || !SamePosition (profile.m_dstPosition, rcvrPosition))
+                {
+                  profile.m_srcPosition = senderPosition;
+                  profile.m_dstPosition = rcvrPosition;
+                  profile.m_delay = m_prop->GetDelay (senderMobility, rcvrMobility, txMode);
+                  profile.m_pdp = m_prop->GetPdp (senderMobility, rcvrMobility, txMode);
+                  profile.m_pathLossDb = m_prop->GetPathLossDb (senderMobility, rcvrMobility, txMode);
+                }
+              delay = profile.m_delay;
+              pdp = &profile.m_pdp;
+              pathLossDb = profile.m_pathLossDb;
+            }
+          else
+            {
+              delay = m_prop->GetDelay (senderMobility, rcvrMobility, txMode);
+              computedPdp = m_prop->GetPdp (senderMobility, rcvrMobility, txMode);
+              pathLossDb = m_prop->GetPathLossDb (senderMobility, rcvrMobility, txMode);
+            }
+          double rxPowerDb = txPowerDb - pathLossDb;
 
           NS_LOG_DEBUG ("txPowerDb=" << txPowerDb << "dB, rxPowerDb="
                                      << rxPowerDb << "dB, distance="
@@ -188,7 +273,7 @@ UanChannel::TxPacket (Ptr<UanTransducer> src, Ptr<Packet> packet,
                                           copy,
                                           rxPowerDb,
                                           txMode,
-                                          pdp);
+                                          *pdp);
         }
       j++;
     }
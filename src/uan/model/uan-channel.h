@@ -26,6 +26,9 @@
 #include "ns3/packet.h"
 #include "ns3/uan-prop-model.h"
 #include "ns3/uan-noise-model.h"
+#include "ns3/vector.h"
+#include "ns3/nstime.h"
+#include "ns3/sgi-hashmap.h"
 
 #include <list>
 #include <vector>
@@ -40,6 +43,13 @@ class UanTxMode;
 /**
  * \class UanChannel
  * \brief Channel class used by UAN devices
+ *
+ * If the "PropagationCache" attribute is true, the delay, power delay
+ * profile and path loss between a transmitter and a receiver are kept
+ * until either of them moves, instead of being recomputed by the
+ * propagation model for every packet. If the "MaxRange" attribute is
+ * positive, the receivers farther than this distance from the
+ * transmitter do not receive its packets at all.
  */
 class UanChannel : public Channel
 {
@@ -100,10 +110,41 @@ public:
   void Clear (void);
 
 private:
+  /**
+   * \brief A transmitter, a receiver and a transmission mode.
+   */
+  struct PropagationKey
+  {
+    PropagationKey (uint32_t src, uint32_t dst, uint32_t mode);
+    bool operator == (const PropagationKey &o) const;
+    uint32_t m_src;  //!< index of the transmitter in m_devList
+    uint32_t m_dst;  //!< index of the receiver in m_devList
+    uint32_t m_mode; //!< uid of the transmission mode
+  };
+  struct PropagationKeyHash
+  {
+    size_t operator () (const PropagationKey &key) const;
+  };
+  /**
+   * \brief The output of the propagation model for given positions.
+   */
+  struct PropagationProfile
+  {
+    Vector m_srcPosition;
+    Vector m_dstPosition;
+    Time m_delay;
+    UanPdp m_pdp;
+    double m_pathLossDb;
+  };
+  typedef sgi::hash_map<PropagationKey, PropagationProfile, PropagationKeyHash> PropagationCache;
+
   UanDeviceList m_devList;
   Ptr<UanPropModel> m_prop;
   Ptr<UanNoiseModel> m_noise;
   bool m_cleared;
+  bool m_propagationCacheEnabled;
+  double m_maxRange;
+  PropagationCache m_propagationCache;
 
   void SendUp (uint32_t i, Ptr<Packet> packet, double rxPowerDb, UanTxMode txMode, UanPdp pdp);
 protected:
@@ -31,6 +31,8 @@
 #include "ns3/object-factory.h"
 #include "ns3/pointer.h"
 #include "ns3/callback.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 
 using namespace ns3;
 
@@ -44,10 +46,13 @@ private:
   Ptr<UanNetDevice> CreateNode (Vector pos, Ptr<UanChannel> chan);
   bool DoPhyTests ();
   uint32_t DoOnePhyTest (Time t1, Time t2, uint32_t r1, uint32_t r2, Ptr<UanPropModel> prop, uint32_t mode1 = 0, uint32_t mode2 = 0);
+  bool DoChannelTests ();
+  std::vector<Time> DoOneChannelTest (bool propagationCache, double maxRange);
   bool RxPacket (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address &sender);
   void SendOnePacket (Ptr<UanNetDevice> dev, uint32_t mode);
   ObjectFactory m_phyFac;
   uint32_t m_bytesRx;
+  std::vector<Time> m_rxTimes;
 
 };
 
@@ -61,6 +66,7 @@ bool
 UanTest::RxPacket (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address &sender)
 {
   m_bytesRx += pkt->GetSize ();
+  m_rxTimes.push_back (Simulator::Now ());
   return true;
 }
 void
@@ -217,6 +223,69 @@ UanTest::DoPhyTests ()
   return false;
 }
 
+std::vector<Time>
+UanTest::DoOneChannelTest (bool propagationCache, double maxRange)
+{
+  Ptr<UanChannel> channel = CreateObject<UanChannel> ();
+  channel->SetAttribute ("PropagationModel", PointerValue (CreateObject<UanPropModelIdeal> ()));
+  channel->SetAttribute ("PropagationCache", BooleanValue (propagationCache));
+  channel->SetAttribute ("MaxRange", DoubleValue (maxRange));
+
+  Ptr<UanNetDevice> dev0 = CreateNode (Vector (50, 50, 50), channel);
+  Ptr<UanNetDevice> dev1 = CreateNode (Vector (0, 50, 50), channel);
+  Ptr<UanNetDevice> dev2 = CreateNode (Vector (1550, 50, 50), channel);
+
+  dev0->SetReceiveCallback (MakeCallback (&UanTest::RxPacket, this));
+
+  // the receiver moves between the two rounds of transmissions, which
+  // changes the propagation delays.
+  Simulator::Schedule (Seconds (1.0), &UanTest::SendOnePacket, this, dev1, 0);
+  Simulator::Schedule (Seconds (4.0), &UanTest::SendOnePacket, this, dev2, 0);
+  Simulator::Schedule (Seconds (7.0), &MobilityModel::SetPosition,
+                       dev0->GetNode ()->GetObject<MobilityModel> (), Vector (800, 50, 50));
+  Simulator::Schedule (Seconds (8.0), &UanTest::SendOnePacket, this, dev1, 0);
+  Simulator::Schedule (Seconds (11.0), &UanTest::SendOnePacket, this, dev2, 0);
+
+  m_rxTimes.clear ();
+  Simulator::Stop (Seconds (20.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  return m_rxTimes;
+}
+
+bool
+UanTest::DoChannelTests ()
+{
+  UanModesList mList;
+  UanTxMode mode = UanTxModeFactory::CreateMode (UanTxMode::FSK, 80, 80, 10000, 4000, 2, "TestMode");
+  mList.AppendMode (UanTxMode (mode));
+  m_phyFac = ObjectFactory ();
+  m_phyFac.SetTypeId ("ns3::UanPhyGen");
+  m_phyFac.Set ("PerModel", PointerValue (CreateObject<UanPhyPerGenDefault> ()));
+  m_phyFac.Set ("SinrModel", PointerValue (CreateObject<UanPhyCalcSinrDefault> ()));
+  m_phyFac.Set ("SupportedModes", UanModesListValue (mList));
+
+  std::vector<Time> expected = DoOneChannelTest (false, 0.0);
+  NS_TEST_ASSERT_MSG_EQ_RETURNS_BOOL (expected.size (), 4, "Should have received the 4 packets");
+
+  std::vector<Time> cached = DoOneChannelTest (true, 0.0);
+  NS_TEST_ASSERT_MSG_EQ_RETURNS_BOOL (cached.size (), expected.size (), "Propagation cache changed the receptions");
+  for (uint32_t i = 0; i < cached.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ_RETURNS_BOOL (cached[i], expected[i], "Propagation cache changed the reception time of packet " << i);
+    }
+
+  // the first packet of the farther node is out of range.
+  std::vector<Time> inRange = DoOneChannelTest (true, 1000.0);
+  NS_TEST_ASSERT_MSG_EQ_RETURNS_BOOL (inRange.size (), 3, "Should have received the 3 packets sent in range");
+  NS_TEST_ASSERT_MSG_EQ_RETURNS_BOOL (inRange[0], expected[0], "Wrong reception time of the first packet");
+  NS_TEST_ASSERT_MSG_EQ_RETURNS_BOOL (inRange[1], expected[2], "Wrong reception time of the third packet");
+  NS_TEST_ASSERT_MSG_EQ_RETURNS_BOOL (inRange[2], expected[3], "Wrong reception time of the fourth packet");
+
+  return false;
+}
+
 void
 UanTest::DoRun (void)
 {
@@ -238,6 +307,7 @@ UanTest::DoRun (void)
 #endif // UAN_PROP_BH_INSTALLED
 
   DoPhyTests ();
+  DoChannelTests ();
 }
 
 
@@ -465,7 +465,8 @@ EdcaTxopN::NotifyAccessGranted (void)
                   if (aggregated)
                     {
                       isAmsdu = true;
-                      m_queue->Remove (peekedPacket);
+                      m_queue->DequeueByTidAndAddress (&peekedHdr, m_currentHdr.GetQosTid (),
+                                                       WifiMacHeader::ADDR1, m_currentHdr.GetAddr1 ());
                     }
                   else
                     {
@@ -170,10 +170,14 @@ Time
 InterferenceHelper::GetEnergyDuration (double energyW)
 {
   Time now = Simulator::Now ();
+  if (!m_rxing)
+    {
+      RemoveNiChangesBefore (now, false);
+    }
   double noiseInterferenceW = 0.0;
   Time end = now;
   noiseInterferenceW = m_firstPower;
-  for (NiChanges::const_iterator i = m_niChanges.begin (); i != m_niChanges.end (); i++)
+  for (NiTimeline::const_iterator i = m_niChanges.begin (); i != m_niChanges.end (); i++)
     {
       noiseInterferenceW += i->GetDelta ();
       end = i->GetTime ();
@@ -195,18 +199,9 @@ InterferenceHelper::AppendEvent (Ptr<InterferenceHelper::Event> event)
   Time now = Simulator::Now ();
   if (!m_rxing)
     {
-      NiChanges::iterator nowIterator = GetPosition (now);
-      for (NiChanges::iterator i = m_niChanges.begin (); i != nowIterator; i++)
-        {
-          m_firstPower += i->GetDelta ();
-        }
-      m_niChanges.erase (m_niChanges.begin (), nowIterator);
-      m_niChanges.insert (m_niChanges.begin (), NiChange (event->GetStartTime (), event->GetRxPowerW ()));
-    }
-  else
-    {
-      AddNiChangeEvent (NiChange (event->GetStartTime (), event->GetRxPowerW ()));
+      RemoveNiChangesBefore (now, true);
     }
+  AddNiChangeEvent (NiChange (event->GetStartTime (), event->GetRxPowerW ()));
   AddNiChangeEvent (NiChange (event->GetEndTime (), -event->GetRxPowerW ()));
 
 }
@@ -231,7 +226,8 @@ InterferenceHelper::CalculateNoiseInterferenceW (Ptr<InterferenceHelper::Event>
 {
   double noiseInterference = m_firstPower;
   NS_ASSERT (m_rxing);
-  for (NiChanges::const_iterator i = m_niChanges.begin () + 1; i != m_niChanges.end (); i++)
+  NiTimeline::const_iterator i = m_niChanges.begin ();
+  for (i++; i != m_niChanges.end (); i++)
     {
       if ((event->GetEndTime () == i->GetTime ()) && event->GetRxPowerW () == -i->GetDelta ())
         {
@@ -372,18 +368,29 @@ InterferenceHelper::EraseEvents (void)
   m_rxing = false;
   m_firstPower = 0.0;
 }
-InterferenceHelper::NiChanges::iterator
+InterferenceHelper::NiTimeline::iterator
 InterferenceHelper::GetPosition (Time moment)
 {
-  return std::upper_bound (m_niChanges.begin (), m_niChanges.end (), NiChange (moment, 0));
-
+  return m_niChanges.upper_bound (NiChange (moment, 0));
 }
 void
 InterferenceHelper::AddNiChangeEvent (NiChange change)
 {
+  // the hint is the upper bound of the changes which happen at the same
+  // time so that the new change is inserted after them.
   m_niChanges.insert (GetPosition (change.GetTime ()), change);
 }
 void
+InterferenceHelper::RemoveNiChangesBefore (Time moment, bool inclusive)
+{
+  NiTimeline::iterator end = inclusive ? GetPosition (moment) : m_niChanges.lower_bound (NiChange (moment, 0));
+  for (NiTimeline::const_iterator i = m_niChanges.begin (); i != end; i++)
+    {
+      m_firstPower += i->GetDelta ();
+    }
+  m_niChanges.erase (m_niChanges.begin (), end);
+}
+void
 InterferenceHelper::NotifyRxStart ()
 {
   m_rxing = true;
@@ -392,5 +399,6 @@ void
 InterferenceHelper::NotifyRxEnd ()
 {
   m_rxing = false;
+  RemoveNiChangesBefore (Simulator::Now (), false);
 }
 } // namespace ns3
@@ -23,6 +23,7 @@
 #include <stdint.h>
 #include <vector>
 #include <list>
+#include <set>
 #include "wifi-mode.h"
 #include "wifi-preamble.h"
 #include "wifi-phy-standard.h"
@@ -109,6 +110,11 @@ private:
     double m_delta;
   };
   typedef std::vector <NiChange> NiChanges;
+  /**
+   * The timeline of the noise and interference changes. Changes which
+   * happen at the same time are kept in insertion order.
+   */
+  typedef std::multiset <NiChange> NiTimeline;
   typedef std::list<Ptr<Event> > Events;
 
   InterferenceHelper (const InterferenceHelper &o);
@@ -122,12 +128,22 @@ private:
   double m_noiseFigure; /**< noise figure (linear) */
   Ptr<ErrorRateModel> m_errorRateModel;
   /// Experimental: needed for energy duration calculation
-  NiChanges m_niChanges;
+  NiTimeline m_niChanges;
+  /// the sum of the deltas of the changes which were removed from m_niChanges
   double m_firstPower;
   bool m_rxing;
   /// Returns an iterator to the first nichange, which is later than moment
-  NiChanges::iterator GetPosition (Time moment);
+  NiTimeline::iterator GetPosition (Time moment);
   void AddNiChangeEvent (NiChange change);
+  /**
+   * Fold the changes which happened before moment into m_firstPower
+   * and remove them from the timeline.
+   *
+   * \param moment the time before which changes are removed
+   * \param inclusive if true, the changes which happen at moment
+   *        are removed too
+   */
+  void RemoveNiChangesBefore (Time moment, bool inclusive);
 };
 
 } // namespace ns3
@@ -416,6 +416,12 @@ MinstrelWifiManager::DoReportFinalDataFailed (WifiRemoteStation *st)
   station->m_isSampling = false;
   station->m_sampleRateSlower = false;
 
+  CheckInit (station);
+  if (!station->m_initialized)
+    {
+      return;
+    }
+
   UpdateRetry (station);
 
   m_minstrelTable[station->m_txrate].numRateAttempt += station->m_retry;
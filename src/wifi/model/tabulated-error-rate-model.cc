@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include "tabulated-error-rate-model.h"
+#include "nist-error-rate-model.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("TabulatedErrorRateModel");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (TabulatedErrorRateModel);
+
+TypeId
+TabulatedErrorRateModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TabulatedErrorRateModel")
+    .SetParent<ErrorRateModel> ()
+    .AddConstructor<TabulatedErrorRateModel> ()
+    .AddAttribute ("ErrorRateModel",
+                   "The error rate model which is tabulated. "
+                   "A NistErrorRateModel is used if none is set.",
+                   PointerValue (),
+                   MakePointerAccessor (&TabulatedErrorRateModel::m_reference),
+                   MakePointerChecker<ErrorRateModel> ())
+    .AddAttribute ("MinSnrDb",
+                   "The lowest SNR (dB) of the tables. The success rate of "
+                   "lower SNRs is computed by the ErrorRateModel.",
+                   DoubleValue (-10.0),
+                   MakeDoubleAccessor (&TabulatedErrorRateModel::m_minSnrDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxSnrDb",
+                   "The highest SNR (dB) of the tables. The success rate of "
+                   "higher SNRs is computed by the ErrorRateModel.",
+                   DoubleValue (40.0),
+                   MakeDoubleAccessor (&TabulatedErrorRateModel::m_maxSnrDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("SnrStepDb",
+                   "The distance (dB) between two consecutive SNRs of the tables.",
+                   DoubleValue (0.01),
+                   MakeDoubleAccessor (&TabulatedErrorRateModel::m_snrStepDb),
+                   MakeDoubleChecker<double> (0.0))
+  ;
+  return tid;
+}
+
+TabulatedErrorRateModel::TabulatedErrorRateModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TabulatedErrorRateModel::~TabulatedErrorRateModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TabulatedErrorRateModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_reference = 0;
+  m_tables.clear ();
+  ErrorRateModel::DoDispose ();
+}
+
+const std::vector<double> &
+TabulatedErrorRateModel::GetTable (WifiMode mode) const
+{
+  uint32_t uid = mode.GetUid ();
+  if (uid >= m_tables.size ())
+    {
+      m_tables.resize (uid + 1);
+    }
+  std::vector<double> &table = m_tables[uid];
+  if (table.empty ())
+    {
+      NS_ASSERT (m_snrStepDb > 0 && m_maxSnrDb > m_minSnrDb);
+      if (m_reference == 0)
+        {
+          m_reference = CreateObject<NistErrorRateModel> ();
+        }
+      uint32_t n = static_cast<uint32_t> (std::floor ((m_maxSnrDb - m_minSnrDb) / m_snrStepDb + 0.5)) + 1;
+      NS_LOG_DEBUG ("tabulating " << mode << " with " << n << " points");
+      table.resize (n);
+      for (uint32_t i = 0; i < n; i++)
+        {
+          double snrDb = m_minSnrDb + i * m_snrStepDb;
+          table[i] = m_reference->GetChunkSuccessRate (mode, std::pow (10.0, snrDb / 10.0), 1);
+        }
+    }
+  return table;
+}
+
+double
+TabulatedErrorRateModel::GetChunkSuccessRate (WifiMode mode, double snr, uint32_t nbits) const
+{
+  const std::vector<double> &table = GetTable (mode);
+  if (snr > 0)
+    {
+      double position = (10.0 * std::log10 (snr) - m_minSnrDb) / m_snrStepDb;
+      if (position >= 0 && position < table.size () - 1)
+        {
+          uint32_t i = static_cast<uint32_t> (position);
+          double fraction = position - i;
+          double bitSuccessRate = table[i] + fraction * (table[i + 1] - table[i]);
+          return std::pow (bitSuccessRate, static_cast<double> (nbits));
+        }
+    }
+  return m_reference->GetChunkSuccessRate (mode, snr, nbits);
+}
+
+} // namespace ns3
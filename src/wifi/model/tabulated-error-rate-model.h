@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef TABULATED_ERROR_RATE_MODEL_H
+#define TABULATED_ERROR_RATE_MODEL_H
+
+#include <stdint.h>
+#include <vector>
+#include "wifi-mode.h"
+#include "error-rate-model.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ *
+ * An error rate model which approximates another error rate model
+ * (the NistErrorRateModel by default) with lookup tables.
+ *
+ * All the error rate models of this module compute the success rate
+ * of a chunk of nbits bits as the nbits-th power of the success
+ * rate of a single bit. For each WifiMode, this model samples the
+ * single-bit success rate of the reference model on a uniform SNR
+ * grid (in dB), the first time the mode is used, and then answers
+ * GetChunkSuccessRate with a linear interpolation in the table
+ * followed by a single std::pow. SNRs outside of the table are
+ * delegated to the reference model.
+ *
+ * The table bounds and resolution must be set before the first call
+ * to GetChunkSuccessRate.
+ */
+class TabulatedErrorRateModel : public ErrorRateModel
+{
+public:
+  static TypeId GetTypeId (void);
+
+  TabulatedErrorRateModel ();
+  virtual ~TabulatedErrorRateModel ();
+
+  virtual double GetChunkSuccessRate (WifiMode mode, double snr, uint32_t nbits) const;
+
+private:
+  virtual void DoDispose (void);
+  const std::vector<double> & GetTable (WifiMode mode) const;
+
+  mutable Ptr<ErrorRateModel> m_reference;
+  double m_minSnrDb;
+  double m_maxSnrDb;
+  double m_snrStepDb;
+  /**
+   * Single-bit success rates indexed by WifiMode uid and then by
+   * SNR grid point. Filled on demand.
+   */
+  mutable std::vector<std::vector<double> > m_tables;
+};
+
+} // namespace ns3
+
+#endif /* TABULATED_ERROR_RATE_MODEL_H */
@@ -23,6 +23,7 @@
 #include "ns3/simulator.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/assert.h"
 
 #include "wifi-mac-queue.h"
 #include "qos-blocked-destinations.h"
@@ -100,34 +101,53 @@ WifiMacQueue::Enqueue (Ptr<const Packet> packet, const WifiMacHeader &hdr)
     {
       return;
     }
+  Insert (false, packet, hdr);
+}
+
+void
+WifiMacQueue::Insert (bool front, Ptr<const Packet> packet, const WifiMacHeader &hdr)
+{
   Time now = Simulator::Now ();
-  m_queue.push_back (Item (packet, hdr, now));
+  PacketQueueI it = m_queue.insert (front ? m_queue.begin () : m_queue.end (),
+                                    Item (packet, hdr, now));
+  // all the packets are stamped with the current time so the most
+  // recent one always expires last.
+  it->expiry = m_expiry.insert (m_expiry.end (), it);
+  if (hdr.IsQosData ())
+    {
+      PacketIndex &flow = m_flows[std::make_pair (hdr.GetAddr1 (), hdr.GetQosTid ())];
+      it->flow = flow.insert (front ? flow.begin () : flow.end (), it);
+    }
   m_size++;
 }
 
 void
-WifiMacQueue::Cleanup (void)
+WifiMacQueue::Erase (PacketQueueI it)
 {
-  if (m_queue.empty ())
+  m_expiry.erase (it->expiry);
+  if (it->hdr.IsQosData ())
     {
-      return;
+      FlowIndexI flow = m_flows.find (std::make_pair (it->hdr.GetAddr1 (), it->hdr.GetQosTid ()));
+      NS_ASSERT (flow != m_flows.end ());
+      flow->second.erase (it->flow);
+      if (flow->second.empty ())
+        {
+          m_flows.erase (flow);
+        }
     }
+  m_queue.erase (it);
+  m_size--;
+}
 
+void
+WifiMacQueue::Cleanup (void)
+{
   Time now = Simulator::Now ();
-  uint32_t n = 0;
-  for (PacketQueueI i = m_queue.begin (); i != m_queue.end ();)
+  while (!m_expiry.empty ()
+         && m_expiry.front ()->tstamp + m_maxDelay <= now)
     {
-      if (i->tstamp + m_maxDelay > now)
-        {
-          i++;
-        }
-      else
-        {
-          i = m_queue.erase (i);
-          n++;
-        }
+      Erase (m_expiry.front ());
     }
-  m_size -= n;
 }
 
 Ptr<const Packet>
@@ -136,11 +156,10 @@ WifiMacQueue::Dequeue (WifiMacHeader *hdr)
   Cleanup ();
   if (!m_queue.empty ())
     {
-      Item i = m_queue.front ();
-      m_queue.pop_front ();
-      m_size--;
-      *hdr = i.hdr;
-      return i.packet;
+      Ptr<const Packet> packet = m_queue.front ().packet;
+      *hdr = m_queue.front ().hdr;
+      Erase (m_queue.begin ());
+      return packet;
     }
   return 0;
 }
@@ -151,40 +170,54 @@ WifiMacQueue::Peek (WifiMacHeader *hdr)
   Cleanup ();
   if (!m_queue.empty ())
     {
-      Item i = m_queue.front ();
-      *hdr = i.hdr;
-      return i.packet;
+      *hdr = m_queue.front ().hdr;
+      return m_queue.front ().packet;
     }
   return 0;
 }
 
-Ptr<const Packet>
-WifiMacQueue::DequeueByTidAndAddress (WifiMacHeader *hdr, uint8_t tid,
-                                      WifiMacHeader::AddressType type, Mac48Address dest)
+WifiMacQueue::PacketQueueI
+WifiMacQueue::Find (uint8_t tid, WifiMacHeader::AddressType type, Mac48Address dest)
 {
-  Cleanup ();
-  Ptr<const Packet> packet = 0;
-  if (!m_queue.empty ())
+  NS_ASSERT (type <= 4);
+  if (type == WifiMacHeader::ADDR1)
+    {
+      FlowIndexI flow = m_flows.find (std::make_pair (dest, tid));
+      if (flow == m_flows.end ())
+        {
+          return m_queue.end ();
+        }
+      return flow->second.front ();
+    }
+  PacketQueueI it;
+  for (it = m_queue.begin (); it != m_queue.end (); ++it)
     {
-      PacketQueueI it;
-      NS_ASSERT (type <= 4);
-      for (it = m_queue.begin (); it != m_queue.end (); ++it)
+      if (it->hdr.IsQosData ())
         {
-          if (it->hdr.IsQosData ())
+          if (GetAddressForPacket (type, it) == dest
+              && it->hdr.GetQosTid () == tid)
             {
-              if (GetAddressForPacket (type, it) == dest
-                  && it->hdr.GetQosTid () == tid)
-                {
-                  packet = it->packet;
-                  *hdr = it->hdr;
-                  m_queue.erase (it);
-                  m_size--;
-                  break;
-                }
+              break;
             }
         }
     }
-  return packet;
+  return it;
+}
+
+Ptr<const Packet>
+WifiMacQueue::DequeueByTidAndAddress (WifiMacHeader *hdr, uint8_t tid,
+                                      WifiMacHeader::AddressType type, Mac48Address dest)
+{
+  Cleanup ();
+  PacketQueueI it = Find (tid, type, dest);
+  if (it != m_queue.end ())
+    {
+      Ptr<const Packet> packet = it->packet;
+      *hdr = it->hdr;
+      Erase (it);
+      return packet;
+    }
+  return 0;
 }
 
 Ptr<const Packet>
@@ -192,22 +225,11 @@ WifiMacQueue::PeekByTidAndAddress (WifiMacHeader *hdr, uint8_t tid,
                                    WifiMacHeader::AddressType type, Mac48Address dest)
 {
   Cleanup ();
-  if (!m_queue.empty ())
+  PacketQueueI it = Find (tid, type, dest);
+  if (it != m_queue.end ())
     {
-      PacketQueueI it;
-      NS_ASSERT (type <= 4);
-      for (it = m_queue.begin (); it != m_queue.end (); ++it)
-        {
-          if (it->hdr.IsQosData ())
-            {
-              if (GetAddressForPacket (type, it) == dest
-                  && it->hdr.GetQosTid () == tid)
-                {
-                  *hdr = it->hdr;
-                  return it->packet;
-                }
-            }
-        }
+      *hdr = it->hdr;
+      return it->packet;
     }
   return 0;
 }
@@ -229,6 +251,8 @@ void
 WifiMacQueue::Flush (void)
 {
   m_queue.erase (m_queue.begin (), m_queue.end ());
+  m_expiry.clear ();
+  m_flows.clear ();
   m_size = 0;
 }
 
@@ -258,8 +282,7 @@ WifiMacQueue::Remove (Ptr<const Packet> packet)
     {
       if (it->packet == packet)
         {
-          m_queue.erase (it);
-          m_size--;
+          Erase (it);
           return true;
         }
     }
@@ -274,9 +297,7 @@ WifiMacQueue::PushFront (Ptr<const Packet> packet, const WifiMacHeader &hdr)
     {
       return;
     }
-  Time now = Simulator::Now ();
-  m_queue.push_front (Item (packet, hdr, now));
-  m_size++;
+  Insert (true, packet, hdr);
 }
 
 uint32_t
@@ -284,19 +305,20 @@ WifiMacQueue::GetNPacketsByTidAndAddress (uint8_t tid, WifiMacHeader::AddressTyp
                                           Mac48Address addr)
 {
   Cleanup ();
+  NS_ASSERT (type <= 4);
+  if (type == WifiMacHeader::ADDR1)
+    {
+      FlowIndexI flow = m_flows.find (std::make_pair (addr, tid));
+      return flow == m_flows.end () ? 0 : flow->second.size ();
+    }
   uint32_t nPackets = 0;
-  if (!m_queue.empty ())
+  for (PacketQueueI it = m_queue.begin (); it != m_queue.end (); it++)
     {
-      PacketQueueI it;
-      NS_ASSERT (type <= 4);
-      for (it = m_queue.begin (); it != m_queue.end (); it++)
+      if (GetAddressForPacket (type, it) == addr)
         {
-          if (GetAddressForPacket (type, it) == addr)
+          if (it->hdr.IsQosData () && it->hdr.GetQosTid () == tid)
             {
-              if (it->hdr.IsQosData () && it->hdr.GetQosTid () == tid)
-                {
-                  nPackets++;
-                }
+              nPackets++;
             }
         }
     }
@@ -317,8 +339,7 @@ WifiMacQueue::DequeueFirstAvailable (WifiMacHeader *hdr, Time &timestamp,
           *hdr = it->hdr;
           timestamp = it->tstamp;
           packet = it->packet;
-          m_queue.erase (it);
-          m_size--;
+          Erase (it);
           return packet;
         }
     }
@@ -23,6 +23,7 @@
 #define WIFI_MAC_QUEUE_H
 
 #include <list>
+#include <map>
 #include <utility>
 #include "ns3/packet.h"
 #include "ns3/nstime.h"
@@ -48,6 +49,13 @@ class QosBlockedDestinations;
  * to verify whether or not it should be dropped. If
  * dot11EDCATableMSDULifetime has elapsed, it is dropped.
  * Otherwise, it is returned to the caller.
+ *
+ * Packets are stamped with the current time when they are queued, so
+ * the queue keeps them in insertion order in a separate index whose
+ * head is always the next packet to expire. The QoS data packets are
+ * also indexed by receiver address (Address 1) and TID, in queue
+ * order, so that the ByTidAndAddress methods do not have to walk the
+ * whole queue when <i>type</i> is WifiMacHeader::ADDR1.
  */
 class WifiMacQueue : public Object
 {
@@ -126,9 +134,29 @@ private:
   typedef std::list<struct Item> PacketQueue;
   typedef std::list<struct Item>::reverse_iterator PacketQueueRI;
   typedef std::list<struct Item>::iterator PacketQueueI;
+  typedef std::list<PacketQueueI> PacketIndex;
+  typedef std::list<PacketQueueI>::iterator PacketIndexI;
+  typedef std::pair<Mac48Address, uint8_t> FlowId;
+  typedef std::map<FlowId, PacketIndex> FlowIndex;
+  typedef std::map<FlowId, PacketIndex>::iterator FlowIndexI;
 
   void Cleanup (void);
   Mac48Address GetAddressForPacket (enum WifiMacHeader::AddressType type, PacketQueueI);
+  /**
+   * Add a packet at the head or at the tail of the queue and to the
+   * indices.
+   */
+  void Insert (bool front, Ptr<const Packet> packet, const WifiMacHeader &hdr);
+  /**
+   * Remove a packet from the queue and from the indices.
+   */
+  void Erase (PacketQueueI it);
+  /**
+   * \returns an iterator to the first QoS data packet whose address
+   * indicated by <i>type</i> equals to <i>addr</i> and whose tid
+   * equals to <i>tid</i>, or m_queue.end ().
+   */
+  PacketQueueI Find (uint8_t tid, WifiMacHeader::AddressType type, Mac48Address addr);
 
   struct Item
   {
@@ -138,9 +166,17 @@ private:
     Ptr<const Packet> packet;
     WifiMacHeader hdr;
     Time tstamp;
+    /// position of this packet in m_expiry
+    PacketIndexI expiry;
+    /// position of this packet in its flow of m_flows, if it is a QoS data packet
+    PacketIndexI flow;
   };
 
   PacketQueue m_queue;
+  /// the packets of m_queue, oldest timestamp first
+  PacketIndex m_expiry;
+  /// the QoS data packets of m_queue, by receiver address and tid
+  FlowIndex m_flows;
   WifiMacParameters *m_parameters;
   uint32_t m_size;
   uint32_t m_maxSize;
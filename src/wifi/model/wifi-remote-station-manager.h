@@ -23,6 +23,7 @@
 #include <vector>
 #include <utility>
 #include "ns3/mac48-address.h"
+#include "ns3/sgi-hashmap.h"
 #include "ns3/traced-callback.h"
 #include "ns3/packet.h"
 #include "ns3/object.h"
@@ -398,8 +399,15 @@ private:
   uint32_t DoGetFragmentationThreshold (void) const;
   uint32_t GetNFragments (const WifiMacHeader *header, Ptr<const Packet> packet);
 
-  typedef std::vector <WifiRemoteStation *> Stations;
-  typedef std::vector <WifiRemoteStationState *> StationStates;
+  /// A remote station is identified by its address and a TID
+  typedef std::pair<Mac48Address, uint8_t> StationKey;
+  class StationKeyHash : public std::unary_function<StationKey, size_t>
+  {
+public:
+    size_t operator() (StationKey const &x) const;
+  };
+  typedef sgi::hash_map<StationKey, WifiRemoteStation *, StationKeyHash> Stations;
+  typedef sgi::hash_map<Mac48Address, WifiRemoteStationState *, Mac48AddressHash> StationStates;
 
   StationStates m_states;
   Stations m_stations;
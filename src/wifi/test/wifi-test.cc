@@ -29,12 +29,15 @@
 #include "ns3/propagation-loss-model.h"
 #include "ns3/error-rate-model.h"
 #include "ns3/yans-error-rate-model.h"
+#include "ns3/nist-error-rate-model.h"
+#include "ns3/tabulated-error-rate-model.h"
 #include "ns3/constant-position-mobility-model.h"
 #include "ns3/node.h"
 #include "ns3/simulator.h"
 #include "ns3/test.h"
 #include "ns3/object-factory.h"
 #include "ns3/dca-txop.h"
+#include "ns3/wifi-mac-queue.h"
 #include "ns3/mac-rx-middle.h"
 #include "ns3/pointer.h"
 #include "ns3/rng-seed-manager.h"
@@ -426,6 +429,152 @@ Bug555TestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_secondTransmissionTime, expectedSecondTransmissionTime, "The second transmission time not correct!");
 }
 
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that the TabulatedErrorRateModel stays close to the
+ * NistErrorRateModel it tabulates, including between grid points and
+ * for long chunks where the interpolation error is amplified.
+ */
+class TabulatedErrorRateModelTest : public TestCase
+{
+public:
+  TabulatedErrorRateModelTest ();
+
+  virtual void DoRun (void);
+};
+
+TabulatedErrorRateModelTest::TabulatedErrorRateModelTest ()
+  : TestCase ("TabulatedErrorRateModel versus NistErrorRateModel")
+{
+}
+
+void
+TabulatedErrorRateModelTest::DoRun (void)
+{
+  Ptr<NistErrorRateModel> nist = CreateObject<NistErrorRateModel> ();
+  Ptr<TabulatedErrorRateModel> tabulated = CreateObject<TabulatedErrorRateModel> ();
+  tabulated->SetAttribute ("ErrorRateModel", PointerValue (nist));
+
+  std::vector<WifiMode> modes;
+  modes.push_back (WifiPhy::GetDsssRate1Mbps ());
+  modes.push_back (WifiPhy::GetDsssRate11Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate6Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate9Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate12Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate18Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate24Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate36Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate48Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate54Mbps ());
+
+  uint32_t nbits[] = { 1, 8 * 64, 8 * 1500 };
+
+  for (std::vector<WifiMode>::const_iterator mode = modes.begin (); mode != modes.end (); ++mode)
+    {
+      // 0.1234 dB steps fall between the 0.01 dB grid points.
+      for (double snrDb = -15.0; snrDb < 45.0; snrDb += 0.1234)
+        {
+          double snr = std::pow (10.0, snrDb / 10.0);
+          for (uint32_t i = 0; i < sizeof (nbits) / sizeof (nbits[0]); i++)
+            {
+              double expected = nist->GetChunkSuccessRate (*mode, snr, nbits[i]);
+              double got = tabulated->GetChunkSuccessRate (*mode, snr, nbits[i]);
+              NS_TEST_ASSERT_MSG_EQ_TOL (got, expected, 1e-3,
+                                         "mode=" << *mode << " snr=" << snrDb << "dB nbits=" << nbits[i]);
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that the indices of the WifiMacQueue follow the order of
+ * the queue and that expired packets are dropped from all of them.
+ */
+class WifiMacQueueTest : public TestCase
+{
+public:
+  WifiMacQueueTest ();
+
+  virtual void DoRun (void);
+private:
+  WifiMacHeader MakeHeader (Mac48Address to, uint8_t tid) const;
+  void Enqueue (uint32_t size, Mac48Address to, uint8_t tid);
+  void CheckExpiry (Mac48Address to);
+
+  Ptr<WifiMacQueue> m_queue;
+};
+
+WifiMacQueueTest::WifiMacQueueTest ()
+  : TestCase ("WifiMacQueue indices and expiry")
+{
+}
+
+WifiMacHeader
+WifiMacQueueTest::MakeHeader (Mac48Address to, uint8_t tid) const
+{
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_QOSDATA);
+  hdr.SetAddr1 (to);
+  hdr.SetQosTid (tid);
+  return hdr;
+}
+
+void
+WifiMacQueueTest::Enqueue (uint32_t size, Mac48Address to, uint8_t tid)
+{
+  m_queue->Enqueue (Create<Packet> (size), MakeHeader (to, tid));
+}
+
+void
+WifiMacQueueTest::CheckExpiry (Mac48Address to)
+{
+  // the packets enqueued at 0s are gone, the one enqueued at 1s is left.
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (1, WifiMacHeader::ADDR1, to), 0,
+                         "expired packets are still indexed");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetSize (), 1, "expired packets are still queued");
+  WifiMacHeader hdr;
+  Ptr<const Packet> packet = m_queue->PeekByTidAndAddress (&hdr, 2, WifiMacHeader::ADDR1, to);
+  NS_TEST_ASSERT_MSG_NE (packet, 0, "packet which did not expire was dropped");
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 40, "wrong packet left");
+}
+
+void
+WifiMacQueueTest::DoRun (void)
+{
+  Mac48Address a = Mac48Address ("00:00:00:00:00:01");
+  Mac48Address b = Mac48Address ("00:00:00:00:00:02");
+  m_queue = CreateObject<WifiMacQueue> ();
+  m_queue->SetMaxDelay (Seconds (2.0));
+
+  Enqueue (10, a, 1);
+  Enqueue (11, b, 1);
+  Enqueue (12, a, 1);
+  Enqueue (13, a, 2);
+  m_queue->PushFront (Create<Packet> (14), MakeHeader (a, 1));
+
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (1, WifiMacHeader::ADDR1, a), 3, "wrong count");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (1, WifiMacHeader::ADDR2, a), 0, "wrong count");
+  WifiMacHeader hdr;
+  Ptr<const Packet> packet = m_queue->PeekByTidAndAddress (&hdr, 1, WifiMacHeader::ADDR1, a);
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 14, "PushFront did not put the packet at the head of its flow");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->Remove (packet), true, "Remove failed");
+  packet = m_queue->DequeueByTidAndAddress (&hdr, 1, WifiMacHeader::ADDR1, a);
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 10, "wrong packet dequeued");
+  packet = m_queue->Dequeue (&hdr);
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 11, "FIFO order not kept");
+  packet = m_queue->PeekByTidAndAddress (&hdr, 1, WifiMacHeader::ADDR1, a);
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 12, "wrong packet peeked");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (1, WifiMacHeader::ADDR1, b), 0, "wrong count");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetSize (), 2, "wrong size");
+
+  Simulator::Schedule (Seconds (1.0), &WifiMacQueueTest::Enqueue, this, 40, a, 2);
+  Simulator::Schedule (Seconds (2.5), &WifiMacQueueTest::CheckExpiry, this, a);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_queue = 0;
+}
+
 //-----------------------------------------------------------------------------
 
 class WifiTestSuite : public TestSuite
@@ -441,6 +590,8 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new QosUtilsIsOldPacketTest, TestCase::QUICK);
   AddTestCase (new InterferenceHelperSequenceTest, TestCase::QUICK); // Bug 991
   AddTestCase (new Bug555TestCase, TestCase::QUICK); // Bug 555
+  AddTestCase (new TabulatedErrorRateModelTest, TestCase::QUICK);
+  AddTestCase (new WifiMacQueueTest, TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite;
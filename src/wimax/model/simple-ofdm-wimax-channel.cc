@@ -39,14 +39,33 @@ namespace ns3 {
 // NS_OBJECT_ENSURE_REGISTERED (simpleOfdmWimaxChannel);
 
 
+SimpleOfdmWimaxChannel::Link::Link ()
+  : m_valid (false)
+{
+}
+
+size_t
+SimpleOfdmWimaxChannel::PhyHash::operator () (const WimaxPhy *phy) const
+{
+  return reinterpret_cast<size_t> (phy);
+}
+
+static bool
+SamePosition (const Vector &a, const Vector &b)
+{
+  return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
 SimpleOfdmWimaxChannel::SimpleOfdmWimaxChannel (void)
 {
   m_loss = 0;
+  m_cacheLinks = false;
 }
 
 SimpleOfdmWimaxChannel::~SimpleOfdmWimaxChannel (void)
 {
   m_phyList.clear ();
+  m_links.clear ();
 }
 
 SimpleOfdmWimaxChannel::SimpleOfdmWimaxChannel (PropModel propModel)
@@ -71,6 +90,9 @@ SimpleOfdmWimaxChannel::SimpleOfdmWimaxChannel (PropModel propModel)
     default:
       m_loss = 0;
     }
+  // only the random propagation loss changes between two blocks
+  m_cacheLinks = m_loss != 0 && propModel != RANDOM_PROPAGATION;
+  m_links.clear ();
 
 }
 
@@ -98,6 +120,9 @@ SimpleOfdmWimaxChannel::SetPropagationModel (PropModel propModel)
     default:
       m_loss = 0;
     }
+  // only the random propagation loss changes between two blocks
+  m_cacheLinks = m_loss != 0 && propModel != RANDOM_PROPAGATION;
+  m_links.clear ();
 
 }
 
@@ -117,14 +142,9 @@ SimpleOfdmWimaxChannel::DoGetNDevices (void) const
 Ptr<NetDevice>
 SimpleOfdmWimaxChannel::DoGetDevice (uint32_t index) const
 {
-  uint32_t j = 0;
-  for (std::list<Ptr<SimpleOfdmWimaxPhy> >::const_iterator iter = m_phyList.begin (); iter != m_phyList.end (); ++iter)
+  if (index < m_phyList.size ())
     {
-      if (j == index)
-        {
-          return (*iter)->GetDevice ();
-        }
-      j++;
+      return m_phyList[index]->GetDevice ();
     }
 
   NS_FATAL_ERROR ("Unable to get device");
@@ -147,15 +167,43 @@ SimpleOfdmWimaxChannel::Send (Time BlockTime,
   Ptr<MobilityModel> senderMobility = 0;
   Ptr<MobilityModel> receiverMobility = 0;
   senderMobility = phy->GetDevice ()->GetNode ()->GetObject<MobilityModel> ();
+  std::vector<Link> *links = 0;
+  Vector senderPosition;
+  if (m_cacheLinks && senderMobility != 0)
+    {
+      links = &m_links[PeekPointer (phy)];
+      links->resize (m_phyList.size ());
+      senderPosition = senderMobility->GetPosition ();
+    }
   simpleOfdmSendParam * param;
-  for (std::list<Ptr<SimpleOfdmWimaxPhy> >::iterator iter = m_phyList.begin (); iter != m_phyList.end (); ++iter)
+  for (uint32_t i = 0; i < m_phyList.size (); i++)
     {
+      Ptr<SimpleOfdmWimaxPhy> rxPhy = m_phyList[i];
       Time delay = Seconds (0);
-      if (phy != *iter)
+      if (phy != rxPhy)
         {
           double distance = 0;
-          receiverMobility = (*iter)->GetDevice ()->GetNode ()->GetObject<MobilityModel> ();
-          if (receiverMobility != 0 && senderMobility != 0 && m_loss != 0)
+          receiverMobility = rxPhy->GetDevice ()->GetNode ()->GetObject<MobilityModel> ();
+          if (receiverMobility != 0 && links != 0)
+            {
+              Link &link = (*links)[i];
+              Vector receiverPosition = receiverMobility->GetPosition ();
+              if (!link.m_valid || link.m_txPowerDbm != txPowerDbm
+                  || !SamePosition (link.m_txPosition, senderPosition)
+                  || !SamePosition (link.m_rxPosition, receiverPosition))
+                {
+                  distance = senderMobility->GetDistanceFrom (receiverMobility);
+                  link.m_valid = true;
+                  link.m_txPosition = senderPosition;
+                  link.m_rxPosition = receiverPosition;
+                  link.m_txPowerDbm = txPowerDbm;
+                  link.m_delay = Seconds (distance/300000000.0);
+                  link.m_rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+                }
+              delay = link.m_delay;
+              rxPowerDbm = link.m_rxPowerDbm;
+            }
+          else if (receiverMobility != 0 && senderMobility != 0 && m_loss != 0)
             {
               distance = senderMobility->GetDistanceFrom (receiverMobility);
               delay =  Seconds (distance/300000000.0);
@@ -169,7 +217,7 @@ SimpleOfdmWimaxChannel::Send (Time BlockTime,
                                            direction,
                                            rxPowerDbm,
                                            burst);
-          Ptr<Object> dstNetDevice = (*iter)->GetDevice ();
+          Ptr<Object> dstNetDevice = rxPhy->GetDevice ();
           uint32_t dstNode;
           if (dstNetDevice == 0)
             {
@@ -183,7 +231,7 @@ SimpleOfdmWimaxChannel::Send (Time BlockTime,
                                           delay,
                                           &SimpleOfdmWimaxChannel::EndSendDummyBlock,
                                           this,
-                                          *iter,
+                                          rxPhy,
                                           param);
         }
     }
@@ -207,11 +255,9 @@ int64_t
 SimpleOfdmWimaxChannel::AssignStreams (int64_t stream)
 {
   int64_t currentStream = stream;
-  typedef std::list<Ptr<SimpleOfdmWimaxPhy> > PhyList;
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+  for (uint32_t i = 0; i < m_phyList.size (); i++)
     {
-      Ptr<SimpleOfdmWimaxPhy> simpleOfdm = (*i);
-      currentStream += simpleOfdm->AssignStreams (currentStream);
+      currentStream += m_phyList[i]->AssignStreams (currentStream);
     }
   return (currentStream - stream);
 }
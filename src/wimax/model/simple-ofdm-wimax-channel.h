@@ -22,12 +22,14 @@
 #ifndef SIMPLE_OFDM_WIMAX_CHANNEL_H
 #define SIMPLE_OFDM_WIMAX_CHANNEL_H
 
-#include <list>
+#include <vector>
 #include "wimax-channel.h"
 #include "bvec.h"
 #include "wimax-phy.h"
 #include "ns3/propagation-loss-model.h"
 #include "simple-ofdm-send-param.h"
+#include "ns3/vector.h"
+#include "ns3/sgi-hashmap.h"
 
 namespace ns3 {
 
@@ -37,6 +39,10 @@ class SimpleOfdmWimaxPhy;
 
 /**
  * \ingroup wimax
+ *
+ * The received power and the propagation delay between two devices are
+ * kept until either of them moves, unless the propagation model is
+ * RANDOM_PROPAGATION. The burst sent is shared by all the receivers.
  */
 class SimpleOfdmWimaxChannel : public WimaxChannel
 {
@@ -92,12 +98,37 @@ public:
   int64_t AssignStreams (int64_t stream);
 
 private:
+  /**
+   * \brief The received power and propagation delay from a transmitter to
+   * a receiver, for given positions and transmission power.
+   */
+  struct Link
+  {
+    Link ();
+    bool m_valid;
+    Vector m_txPosition;
+    Vector m_rxPosition;
+    double m_txPowerDbm;
+    double m_rxPowerDbm;
+    Time m_delay;
+  };
+  struct PhyHash
+  {
+    size_t operator () (const WimaxPhy *phy) const;
+  };
+  /**
+   * The links of each transmitter, indexed like m_phyList.
+   */
+  typedef sgi::hash_map<const WimaxPhy *, std::vector<Link>, PhyHash> LinkCache;
+
   void DoAttach (Ptr<WimaxPhy> phy);
-  std::list<Ptr<SimpleOfdmWimaxPhy> > m_phyList;
+  std::vector<Ptr<SimpleOfdmWimaxPhy> > m_phyList;
   uint32_t DoGetNDevices (void) const;
   void EndSendDummyBlock  (Ptr<SimpleOfdmWimaxPhy> rxphy, simpleOfdmSendParam * param);
   Ptr<NetDevice> DoGetDevice (uint32_t i) const;
   Ptr<PropagationLossModel> m_loss;
+  bool m_cacheLinks;
+  LinkCache m_links;
 };
 
 } // namespace ns3
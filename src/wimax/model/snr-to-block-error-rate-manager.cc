@@ -19,64 +19,134 @@
  *                              <amine.ismail@udcast.com>
  */
 
-#include <cstring>
 #include "ns3/snr-to-block-error-rate-manager.h"
 #include "ns3/snr-to-block-error-rate-record.h"
 #include "default-traces.h"
 #include "ns3/log.h"
+#include "ns3/assert.h"
 #include <fstream>
+#include <sstream>
+#include <cstdio>
 
 NS_LOG_COMPONENT_DEFINE ("SNRToBlockErrorRateManager");
 
 namespace ns3 {
 
 SNRToBlockErrorRateManager::SNRToBlockErrorRateManager (void)
+  : m_traces (Create<Traces> ())
 {
-
-  for (int i = 0; i < 7; i++)
-    {
-      m_recordModulation[i] = new std::vector<SNRToBlockErrorRateRecord*> ();
-    }
   m_activateLoss = false;
-  std::strcpy (m_traceFilePath,"DefaultTraces");
+  m_traceFilePath = "DefaultTraces";
 }
 
 SNRToBlockErrorRateManager::~SNRToBlockErrorRateManager (void)
 {
-  ClearRecords ();
-  for (int i = 0; i < 7; i++)
-    {
-      delete m_recordModulation[i];
-    }
 }
 
 void
 SNRToBlockErrorRateManager::ClearRecords (void)
 {
-  for (int i = 0; i < 7; i++)
+  m_traces = Create<Traces> ();
+}
+
+void
+SNRToBlockErrorRateManager::ActivateLoss (bool loss)
+{
+  m_activateLoss = loss;
+}
+
+void
+SNRToBlockErrorRateManager::AddRecord (Trace &trace, double snrValue, double bitErrorRate, double burstErrorRate,
+                                       double sigma2, double I1, double I2)
+{
+  trace.values.push_back (snrValue);
+  trace.values.push_back (bitErrorRate);
+  trace.values.push_back (burstErrorRate);
+  trace.values.push_back (sigma2);
+  trace.values.push_back (I1);
+  trace.values.push_back (I2);
+}
+
+void
+SNRToBlockErrorRateManager::Index (Trace &trace)
+{
+  trace.grid.clear ();
+  uint32_t n = trace.values.size () / COLUMNS;
+  if (n < 2)
+    {
+      return;
+    }
+  for (uint32_t i = 1; i < n; i++)
+    {
+      if (trace.values[i * COLUMNS + SNR_VALUE] < trace.values[(i - 1) * COLUMNS + SNR_VALUE])
+        {
+          // not sorted: Lookup scans the records
+          return;
+        }
+    }
+  double first = trace.values[SNR_VALUE];
+  double last = trace.values[(n - 1) * COLUMNS + SNR_VALUE];
+  if (!(last > first))
+    {
+      return;
+    }
+  // one cell per record; each cell holds the first record whose SNR is
+  // above the start of the cell.
+  trace.gridStart = first;
+  trace.gridScale = n / (last - first);
+  trace.grid.resize (n);
+  uint32_t i = 0;
+  for (uint32_t cell = 0; cell < n; cell++)
     {
+      double start = first + cell / trace.gridScale;
+      while (i < n && trace.values[i * COLUMNS + SNR_VALUE] <= start)
+        {
+          i++;
+        }
+      trace.grid[cell] = i;
+    }
+}
 
-      for (std::vector<SNRToBlockErrorRateRecord*>::iterator iter = m_recordModulation[i]->begin (); iter
-           != m_recordModulation[i]->end (); ++iter)
+Ptr<SNRToBlockErrorRateManager::Traces>
+SNRToBlockErrorRateManager::GetDefaultTraces (void)
+{
+  static Ptr<Traces> traces;
+  if (traces == 0)
+    {
+      const double *tables[7] = { modulation0[0], modulation1[0], modulation2[0], modulation3[0],
+                                  modulation4[0], modulation5[0], modulation6[0] };
+      const uint32_t sizes[7] = { sizeof(modulation0[0]) / sizeof(double), sizeof(modulation1[0]) / sizeof(double),
+                                  sizeof(modulation2[0]) / sizeof(double), sizeof(modulation3[0]) / sizeof(double),
+                                  sizeof(modulation4[0]) / sizeof(double), sizeof(modulation5[0]) / sizeof(double),
+                                  sizeof(modulation6[0]) / sizeof(double) };
+      traces = Create<Traces> ();
+      for (int i = 0; i < 7; i++)
         {
-          if (*iter)
+          // the tables hold one row per column of the traces
+          for (uint32_t j = 0; j < sizes[i]; j++)
             {
-              delete (*iter);
-              (*iter) = 0;
+              AddRecord (traces->modulation[i],
+                         tables[i][0 * sizes[i] + j],
+                         tables[i][1 * sizes[i] + j],
+                         tables[i][2 * sizes[i] + j],
+                         tables[i][3 * sizes[i] + j],
+                         tables[i][4 * sizes[i] + j],
+                         tables[i][5 * sizes[i] + j]);
             }
+          Index (traces->modulation[i]);
         }
-      m_recordModulation[i]->clear ();
     }
+  return traces;
 }
 
 void
-SNRToBlockErrorRateManager::ActivateLoss (bool loss)
+SNRToBlockErrorRateManager::LoadTraces (void)
 {
-  m_activateLoss = loss;
+  LoadTraces ("%s/modulation%d.txt");
 }
 
 void
-SNRToBlockErrorRateManager::LoadTraces (void)
+SNRToBlockErrorRateManager::LoadTraces (const char *fileNameFormat)
 {
   std::ifstream m_ifTraceFile;
   ClearRecords ();
@@ -85,7 +155,7 @@ SNRToBlockErrorRateManager::LoadTraces (void)
   for (int i = 0; i < 7; i++)
     {
       char traceFile[1024];
-      sprintf (traceFile, "%s/modulation%d.txt", m_traceFilePath, i);
+      std::snprintf (traceFile, sizeof (traceFile), fileNameFormat, m_traceFilePath.c_str (), i);
 
       m_ifTraceFile.open (traceFile, std::ifstream::in);
       if (m_ifTraceFile.good () == false)
@@ -97,16 +167,10 @@ SNRToBlockErrorRateManager::LoadTraces (void)
       while (m_ifTraceFile.good ())
         {
           m_ifTraceFile >> snrValue >> bitErrorRate >> burstErrorRate >> sigma2 >> I1 >> I2;
-          SNRToBlockErrorRateRecord *record = new SNRToBlockErrorRateRecord (snrValue,
-                                                                             bitErrorRate,
-                                                                             burstErrorRate,
-                                                                             sigma2,
-                                                                             I1,
-                                                                             I2);
-          m_recordModulation[i]->push_back (record);
-
+          AddRecord (m_traces->modulation[i], snrValue, bitErrorRate, burstErrorRate, sigma2, I1, I2);
         }
       m_ifTraceFile.close ();
+      Index (m_traces->modulation[i]);
     }
   m_activateLoss = true;
 }
@@ -114,172 +178,80 @@ SNRToBlockErrorRateManager::LoadTraces (void)
 void
 SNRToBlockErrorRateManager::LoadDefaultTraces (void)
 {
-  double snrValue, bitErrorRate, burstErrorRate, sigma2, I1, I2;
-  ClearRecords ();
-  for (unsigned int j = 0; j < sizeof(modulation0[0]) / sizeof(double); j++)
-    {
-      snrValue = modulation0[0][j];
-      bitErrorRate = modulation0[1][j];
-      burstErrorRate = modulation0[2][j];
-      sigma2 = modulation0[3][j];
-      I1 = modulation0[4][j];
-      I2 = modulation0[5][j];
-      SNRToBlockErrorRateRecord *record = new SNRToBlockErrorRateRecord (snrValue,
-                                                                         bitErrorRate,
-                                                                         burstErrorRate,
-                                                                         sigma2,
-                                                                         I1,
-                                                                         I2);
-      m_recordModulation[0]->push_back (record);
-    }
-  for (unsigned int j = 0; j < sizeof(modulation1[0]) / sizeof(double); j++)
-    {
-      snrValue = modulation1[0][j];
-      bitErrorRate = modulation1[1][j];
-      burstErrorRate = modulation1[2][j];
-      sigma2 = modulation1[3][j];
-      I1 = modulation1[4][j];
-      I2 = modulation1[5][j];
-      SNRToBlockErrorRateRecord *record = new SNRToBlockErrorRateRecord (snrValue,
-                                                                         bitErrorRate,
-                                                                         burstErrorRate,
-                                                                         sigma2,
-                                                                         I1,
-                                                                         I2);
-      m_recordModulation[1]->push_back (record);
-    }
-  for (unsigned int j = 0; j < sizeof(modulation2[0]) / sizeof(double); j++)
-    {
-      snrValue = modulation2[0][j];
-      bitErrorRate = modulation2[1][j];
-      burstErrorRate = modulation2[2][j];
-      sigma2 = modulation2[3][j];
-      I1 = modulation2[4][j];
-      I2 = modulation2[5][j];
-      SNRToBlockErrorRateRecord *record = new SNRToBlockErrorRateRecord (snrValue,
-                                                                         bitErrorRate,
-                                                                         burstErrorRate,
-                                                                         sigma2,
-                                                                         I1,
-                                                                         I2);
-      m_recordModulation[2]->push_back (record);
-    }
-  for (unsigned int j = 0; j < sizeof(modulation3[0]) / sizeof(double); j++)
-    {
-      snrValue = modulation3[0][j];
-      bitErrorRate = modulation3[1][j];
-      burstErrorRate = modulation3[2][j];
-      sigma2 = modulation3[3][j];
-      I1 = modulation3[4][j];
-      I2 = modulation3[5][j];
-      SNRToBlockErrorRateRecord *record = new SNRToBlockErrorRateRecord (snrValue,
-                                                                         bitErrorRate,
-                                                                         burstErrorRate,
-                                                                         sigma2,
-                                                                         I1,
-                                                                         I2);
-      m_recordModulation[3]->push_back (record);
-    }
-  for (unsigned int j = 0; j < sizeof(modulation4[0]) / sizeof(double); j++)
-    {
-      snrValue = modulation4[0][j];
-      bitErrorRate = modulation4[1][j];
-      burstErrorRate = modulation4[2][j];
-      sigma2 = modulation4[3][j];
-      I1 = modulation4[4][j];
-      I2 = modulation4[5][j];
-      SNRToBlockErrorRateRecord *record = new SNRToBlockErrorRateRecord (snrValue,
-                                                                         bitErrorRate,
-                                                                         burstErrorRate,
-                                                                         sigma2,
-                                                                         I1,
-                                                                         I2);
-      m_recordModulation[4]->push_back (record);
-    }
-  for (unsigned int j = 0; j < sizeof(modulation5[0]) / sizeof(double); j++)
-    {
-      snrValue = modulation5[0][j];
-      bitErrorRate = modulation5[1][j];
-      burstErrorRate = modulation5[2][j];
-      sigma2 = modulation5[3][j];
-      I1 = modulation5[4][j];
-      I2 = modulation5[5][j];
-      SNRToBlockErrorRateRecord *record = new SNRToBlockErrorRateRecord (snrValue,
-                                                                         bitErrorRate,
-                                                                         burstErrorRate,
-                                                                         sigma2,
-                                                                         I1,
-                                                                         I2);
-      m_recordModulation[5]->push_back (record);
-    }
-  for (unsigned int j = 0; j < sizeof(modulation6[0]) / sizeof(double); j++)
-    {
-      snrValue = modulation6[0][j];
-      bitErrorRate = modulation6[1][j];
-      burstErrorRate = modulation6[2][j];
-      sigma2 = modulation6[3][j];
-      I1 = modulation6[4][j];
-      I2 = modulation6[5][j];
-      SNRToBlockErrorRateRecord *record = new SNRToBlockErrorRateRecord (snrValue,
-                                                                         bitErrorRate,
-                                                                         burstErrorRate,
-                                                                         sigma2,
-                                                                         I1,
-                                                                         I2);
-      m_recordModulation[6]->push_back (record);
-    }
+  m_traces = GetDefaultTraces ();
   m_activateLoss = true;
 }
 
 void
 SNRToBlockErrorRateManager::ReLoadTraces (void)
 {
-  double snrValue, bitErrorRate, burstErrorRate, sigma2, I1, I2;
+  LoadTraces ("%s/Modulation%d.txt");
+}
 
-  ClearRecords ();
+void
+SNRToBlockErrorRateManager::SetTraceFilePath (char *traceFilePath)
+{
+  m_traceFilePath = traceFilePath;
+}
 
-  std::ifstream m_ifTraceFile;
+std::string
+SNRToBlockErrorRateManager::GetTraceFilePath (void)
+{
+  return m_traceFilePath;
+}
 
-  for (int i = 0; i < 7; i++)
+uint32_t
+SNRToBlockErrorRateManager::Lookup (const Trace &trace, double SNR, double &coeff1, double &coeff2) const
+{
+  uint32_t n = trace.values.size () / COLUMNS;
+  NS_ASSERT_MSG (n > 0, "No SNR to block error rate traces");
+  const double *snr = &trace.values[SNR_VALUE];
+  if (SNR <= snr[0])
     {
-      char traceFile[1024];
-      sprintf (traceFile, "%s/Modulation%d.txt", m_traceFilePath, i);
+      return 0;
+    }
+  if (SNR >= snr[(n - 1) * COLUMNS])
+    {
+      return n;
+    }
 
-      m_ifTraceFile.open (traceFile, std::ifstream::in);
-      if (m_ifTraceFile.good () == false)
+  // the first record whose SNR is above the SNR value
+  uint32_t i;
+  if (trace.grid.empty ())
+    {
+      for (i = 0; i < n; i++)
         {
-          NS_LOG_INFO ("Unable to load " << traceFile << "!!Loading default traces...");
-          LoadDefaultTraces ();
-          return;
+          if (SNR < snr[i * COLUMNS])
+            {
+              break;
+            }
         }
-      while (m_ifTraceFile.good ())
+      NS_ASSERT (i < n);
+    }
+  else
+    {
+      double cell = (SNR - trace.gridStart) * trace.gridScale;
+      i = trace.grid[cell < n ? (uint32_t) cell : n - 1];
+      while (snr[(i - 1) * COLUMNS] > SNR)
         {
-          m_ifTraceFile >> snrValue >> bitErrorRate >> burstErrorRate >> sigma2 >> I1 >> I2;
-          SNRToBlockErrorRateRecord *record = new SNRToBlockErrorRateRecord (snrValue,
-                                                                             bitErrorRate,
-                                                                             burstErrorRate,
-                                                                             sigma2,
-                                                                             I1,
-                                                                             I2);
-
-          m_recordModulation[i]->push_back (record);
-
+          i--;
+        }
+      while (snr[i * COLUMNS] <= SNR)
+        {
+          i++;
         }
-      m_ifTraceFile.close ();
     }
-  m_activateLoss = true;
+  double intervalSize = (snr[i * COLUMNS] - snr[(i - 1) * COLUMNS]);
+  coeff1 = (SNR - snr[(i - 1) * COLUMNS]) / intervalSize;
+  coeff2 = -1 * (SNR - snr[i * COLUMNS]) / intervalSize;
+  return i;
 }
 
-void
-SNRToBlockErrorRateManager::SetTraceFilePath (char *traceFilePath)
-{
-  std::strcpy (m_traceFilePath, traceFilePath);
-}
-
-std::string
-SNRToBlockErrorRateManager::GetTraceFilePath (void)
+double
+SNRToBlockErrorRateManager::Interpolate (const Trace &trace, uint32_t i, double coeff1, double coeff2,
+                                         enum Column column) const
 {
-  return (std::string (m_traceFilePath));
+  return coeff2 * (trace.values[(i - 1) * COLUMNS + column]) + coeff1 * (trace.values[i * COLUMNS + column]);
 }
 
 double
@@ -291,33 +263,18 @@ SNRToBlockErrorRateManager::GetBlockErrorRate (double SNR, uint8_t modulation)
       return 0;
     }
 
-  std::vector<SNRToBlockErrorRateRecord *> *record = 0;
-
-  record = m_recordModulation[modulation];
-
-  if (SNR <= (record->at (0)->GetSNRValue ()))
+  const Trace &trace = m_traces->modulation[modulation];
+  double coeff1, coeff2;
+  uint32_t i = Lookup (trace, SNR, coeff1, coeff2);
+  if (i == 0)
     {
       return 1;
     }
-  if (SNR >= (record->at (record->size () - 1)->GetSNRValue ()))
+  if (i == trace.values.size () / COLUMNS)
     {
       return 0;
     }
-
-  std::vector<SNRToBlockErrorRateRecord*>::const_iterator iter;
-  unsigned int i;
-  for (i = 0; i < record->size (); i++)
-    {
-      if (SNR < record->at (i)->GetSNRValue ())
-        {
-          break;
-        }
-    }
-  double intervalSize = (record->at (i)->GetSNRValue () - record->at (i - 1)->GetSNRValue ());
-  double coeff1 = (SNR - record->at (i - 1)->GetSNRValue ()) / intervalSize;
-  double coeff2 = -1 * (SNR - record->at (i)->GetSNRValue ()) / intervalSize;
-  double BlockErrorRate = coeff2 * (record->at (i - 1)->GetBlockErrorRate ()) + coeff1 * (record->at (i)->GetBlockErrorRate ());
-  return BlockErrorRate;
+  return Interpolate (trace, i, coeff1, coeff2, BLOCK_ERROR_RATE);
 }
 
 SNRToBlockErrorRateRecord *
@@ -330,42 +287,50 @@ SNRToBlockErrorRateManager::GetSNRToBlockErrorRateRecord (double SNR,
       return new SNRToBlockErrorRateRecord (SNR, 0, 0, 0, 0, 0);
     }
 
-  std::vector<SNRToBlockErrorRateRecord *> *record = 0;
-  record = m_recordModulation[modulation];
-
-  if (SNR <= (record->at (0)->GetSNRValue ()))
+  const Trace &trace = m_traces->modulation[modulation];
+  double coeff1, coeff2;
+  uint32_t i = Lookup (trace, SNR, coeff1, coeff2);
+  uint32_t n = trace.values.size () / COLUMNS;
+  if (i == 0 || i == n)
     {
-      return
-        record->at (0)->Copy ();
-    }
-  if (SNR >= (record->at (record->size () - 1)->GetSNRValue ()))
-    {
-      return
-        record->at (record->size () - 1)->Copy ();
+      const double *record = &trace.values[(i == 0 ? 0 : n - 1) * COLUMNS];
+      return new SNRToBlockErrorRateRecord (record[SNR_VALUE], record[BIT_ERROR_RATE], record[BLOCK_ERROR_RATE],
+                                            record[SIGMA2], record[I1_VALUE], record[I2_VALUE]);
     }
 
-  std::vector<SNRToBlockErrorRateRecord*>::const_iterator iter;
-  unsigned int i;
-  for (i = 0; i < record->size (); i++)
-    {
-      if (SNR < record->at (i)->GetSNRValue ())
-        {
-          break;
-        }
-    }
-  double intervalSize = (record->at (i)->GetSNRValue ()
-                         - record->at (i - 1)->GetSNRValue ());
-  double coeff1 = (SNR - record->at (i - 1)->GetSNRValue ()) / intervalSize;
-  double coeff2 = -1 * (SNR - record->at (i)->GetSNRValue ()) / intervalSize;
-  double BER = coeff2 * (record->at (i - 1)->GetBitErrorRate ()) + coeff1 * (record->at (i)->GetBitErrorRate ());
-  double BlcER = coeff2 * (record->at (i - 1)->GetBlockErrorRate ()) + coeff1 * (record->at (i)->GetBlockErrorRate ());
-  double sigma2 = coeff2 * (record->at (i - 1)->GetSigma2 ()) + coeff1 * (record->at (i)->GetSigma2 ());
-  double I1 = coeff2 * (record->at (i - 1)->GetI1 ()) + coeff1 * (record->at (i)->GetI1 ());
-  double I2 = coeff2 * (record->at (i - 1)->GetI2 ()) + coeff1 * (record->at (i)->GetI2 ());
+  double BER = Interpolate (trace, i, coeff1, coeff2, BIT_ERROR_RATE);
+  double BlcER = Interpolate (trace, i, coeff1, coeff2, BLOCK_ERROR_RATE);
+  double sigma2 = Interpolate (trace, i, coeff1, coeff2, SIGMA2);
+  double I1 = Interpolate (trace, i, coeff1, coeff2, I1_VALUE);
+  double I2 = Interpolate (trace, i, coeff1, coeff2, I2_VALUE);
 
   SNRToBlockErrorRateRecord * SNRToBlockErrorRate = new SNRToBlockErrorRateRecord (SNR, BER, BlcER, sigma2, I1,I2);
   return SNRToBlockErrorRate;
 }
 
+void
+SNRToBlockErrorRateManager::GetConfidenceInterval (double SNR, uint8_t modulation, double &I1, double &I2)
+{
+  if (m_activateLoss == false)
+    {
+      I1 = 0;
+      I2 = 0;
+      return;
+    }
+
+  const Trace &trace = m_traces->modulation[modulation];
+  double coeff1, coeff2;
+  uint32_t i = Lookup (trace, SNR, coeff1, coeff2);
+  uint32_t n = trace.values.size () / COLUMNS;
+  if (i == 0 || i == n)
+    {
+      const double *record = &trace.values[(i == 0 ? 0 : n - 1) * COLUMNS];
+      I1 = record[I1_VALUE];
+      I2 = record[I2_VALUE];
+      return;
+    }
+  I1 = Interpolate (trace, i, coeff1, coeff2, I1_VALUE);
+  I2 = Interpolate (trace, i, coeff1, coeff2, I2_VALUE);
 }
 
+}
@@ -25,7 +25,9 @@
 
 #include "ns3/snr-to-block-error-rate-record.h"
 #include <vector>
+#include <string>
 #include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
 
 namespace ns3 {
 
@@ -42,6 +44,11 @@ namespace ns3 {
  *  ...           ...       ...          ...                      ...                        ...
  *  ...           ...       ...          ...                      ...                        ...
  * SNR_value(n)   BER(n)    Blc_ER(n)    STANDARD_DEVIATION(n)    CONFIDENCE_INTERVAL1(n)    CONFIDENCE_INTERVAL2(n)
+ *
+ * The traces of each modulation are indexed by a uniform grid of SNR
+ * values, so that finding the two records around a SNR value takes a
+ * constant time. The default traces are loaded once and shared by all
+ * the managers which use them.
  */
 class SNRToBlockErrorRateManager
 {
@@ -72,6 +79,15 @@ public:
    * \return the Block Error Rate
    */
   GetSNRToBlockErrorRateRecord (double SNR, uint8_t modulation);
+  /**
+   * \brief returns the confidence interval of the Block Error Rate for a given modulation and SNR value, as
+   * GetSNRToBlockErrorRateRecord does, without allocating a record
+   * \param SNR the SNR value
+   * \param modulation one of the seven MCS
+   * \param I1 the lower boundary of the confidence interval
+   * \param I2 the upper boundary of the confidence interval
+   */
+  void GetConfidenceInterval (double SNR, uint8_t modulation, double &I1, double &I2);
   /**
    * \brief Loads the traces form the repository specified in the constructor or setted by SetTraceFilePath function. If
    * no repository is provided, default traces will be loaded from default-traces.h file
@@ -91,12 +107,54 @@ public:
    */
   void ActivateLoss (bool loss);
 private:
+  /// The columns of the traces of one modulation
+  enum Column
+  {
+    SNR_VALUE = 0,
+    BIT_ERROR_RATE,
+    BLOCK_ERROR_RATE,
+    SIGMA2,
+    I1_VALUE,
+    I2_VALUE,
+    COLUMNS
+  };
+  /// The traces of one modulation, and their SNR index
+  struct Trace
+  {
+    /// The records, COLUMNS values per record
+    std::vector<double> values;
+    /// For each cell of the grid, the first record whose SNR is above the cell start
+    std::vector<uint32_t> grid;
+    /// SNR value at the start of the grid
+    double gridStart;
+    /// Inverse of the width of a grid cell
+    double gridScale;
+  };
+  /// The traces of the seven modulations
+  class Traces : public SimpleRefCount<Traces>
+  {
+  public:
+    Trace modulation[7];
+  };
+
+  static Ptr<Traces> GetDefaultTraces (void);
+  static void AddRecord (Trace &trace, double snrValue, double bitErrorRate, double burstErrorRate,
+                         double sigma2, double I1, double I2);
+  static void Index (Trace &trace);
+  void LoadTraces (const char *fileNameFormat);
+  /**
+   * \brief Find the records around a SNR value, and the weights of their values
+   * \return the index of the upper record, or 0 if SNR is at or below the first record and the size of the
+   * trace if it is at or above the last one
+   */
+  uint32_t Lookup (const Trace &trace, double SNR, double &coeff1, double &coeff2) const;
+  double Interpolate (const Trace &trace, uint32_t i, double coeff1, double coeff2, enum Column column) const;
   void ClearRecords (void);
   double m_speed; // in m/s
   uint8_t m_activateLoss;
-  char m_traceFilePath[1024];
+  std::string m_traceFilePath;
 
-  std::vector<SNRToBlockErrorRateRecord *> * m_recordModulation[7];
+  Ptr<Traces> m_traces;
 
 };
 }
@@ -511,10 +511,10 @@ WimaxNetDevice::Receive (Ptr<const PacketBurst> burst)
 
   NS_LOG_DEBUG ("WimaxNetDevice::Receive, station = " << GetMacAddress ());
 
-  Ptr<PacketBurst> b = burst->Copy ();
-  for (std::list<Ptr<Packet> >::const_iterator iter = b->Begin (); iter != b->End (); ++iter)
+  // the burst is shared by all the stations which receive it.
+  for (std::list<Ptr<Packet> >::const_iterator iter = burst->Begin (); iter != burst->End (); ++iter)
     {
-      Ptr<Packet> packet = *iter;
+      Ptr<Packet> packet = (*iter)->Copy ();
       DoReceive (packet);
     }
 }
@@ -155,6 +155,16 @@ bool Ns3WimaxSNRtoBLERTestCase::DoRunOnce (uint8_t modulationType)
     {
       BLERRec = l_SNRToBlockErrorRateManager.GetSNRToBlockErrorRateRecord (i,
                                                                            modulationType);
+      double I1, I2;
+      l_SNRToBlockErrorRateManager.GetConfidenceInterval (i, modulationType, I1, I2);
+      NS_TEST_EXPECT_MSG_EQ (I1, BLERRec->GetI1 (), "Wrong lower boundary for SNR " << i);
+      NS_TEST_EXPECT_MSG_EQ (I2, BLERRec->GetI2 (), "Wrong upper boundary for SNR " << i);
+      double blockErrorRate = l_SNRToBlockErrorRateManager.GetBlockErrorRate (i, modulationType);
+      NS_TEST_EXPECT_MSG_EQ ((blockErrorRate >= 0 && blockErrorRate <= 1), true, "Wrong block error rate for SNR " << i);
+      if (BLERRec->GetSNRValue () == i)
+        {
+          NS_TEST_EXPECT_MSG_EQ (blockErrorRate, BLERRec->GetBlockErrorRate (), "Wrong block error rate for SNR " << i);
+        }
       delete BLERRec;
     }
   return false;
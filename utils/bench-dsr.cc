@@ -0,0 +1,183 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure how the cost of the DSR route cache grows with the number of
+// nodes. The nodes are placed on a square grid of static wifi nodes in
+// which every node reaches its eight closest neighbors, and CBR flows
+// cross the grid. The whole simulation is timed first. Then the route
+// cache of every node is exercised the way DSR does when it forwards
+// data: every node looks up a route to every other node, adds back
+// the routes it found, which updates the link cache, and looks them up
+// again.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/dsr-module.h"
+#include <iostream>
+#include <cmath>
+
+using namespace ns3;
+
+static uint64_t g_received = 0;
+
+static void
+RxSink (Ptr<const Packet> packet, const Address &from)
+{
+  g_received++;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nodes = 49;
+  uint32_t flows = 10;
+  double stop = 60;
+  std::string cacheType = "LinkCache";
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of nodes, placed on a square grid", nodes);
+  cmd.AddValue ("flows", "Number of CBR flows", flows);
+  cmd.AddValue ("stop", "Simulated duration in seconds", stop);
+  cmd.AddValue ("cacheType", "DSR route cache: LinkCache or PathCache", cacheType);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_UNLESS (nodes >= 2, "Need at least 2 nodes");
+  NS_ABORT_MSG_UNLESS (flows <= nodes / 2, "Need two nodes per flow");
+  uint32_t side = std::ceil (std::sqrt (double (nodes)));
+
+  Config::SetDefault ("ns3::dsr::DsrRouting::CacheType", StringValue (cacheType));
+
+  NodeContainer adhocNodes;
+  adhocNodes.Create (nodes);
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211b);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager", "DataMode", StringValue ("DsssRate11Mbps"),
+                                "ControlMode", StringValue ("DsssRate11Mbps"));
+  YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+  YansWifiChannelHelper wifiChannel;
+  wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  wifiChannel.AddPropagationLoss ("ns3::RangePropagationLossModel", "MaxRange", DoubleValue (150));
+  wifiPhy.SetChannel (wifiChannel.Create ());
+  NqosWifiMacHelper wifiMac = NqosWifiMacHelper::Default ();
+  wifiMac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (wifiPhy, wifiMac, adhocNodes);
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "MinX", DoubleValue (0.0),
+                                 "MinY", DoubleValue (0.0),
+                                 "DeltaX", DoubleValue (100.0),
+                                 "DeltaY", DoubleValue (100.0),
+                                 "GridWidth", UintegerValue (side),
+                                 "LayoutType", StringValue ("RowFirst"));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (adhocNodes);
+
+  InternetStackHelper internet;
+  DsrMainHelper dsrMain;
+  DsrHelper dsr;
+  internet.Install (adhocNodes);
+  dsrMain.Install (dsr, adhocNodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.0.0", "255.255.0.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  uint16_t port = 9;
+  for (uint32_t i = 0; i < flows; i++)
+    {
+      PacketSinkHelper sink ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+      ApplicationContainer sinkApps = sink.Install (adhocNodes.Get (i));
+      sinkApps.Start (Seconds (0.0));
+      sinkApps.Get (0)->TraceConnectWithoutContext ("Rx", MakeCallback (&RxSink));
+
+      OnOffHelper onoff ("ns3::UdpSocketFactory", Address (InetSocketAddress (interfaces.GetAddress (i), port)));
+      onoff.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1.0]"));
+      onoff.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0.0]"));
+      onoff.SetAttribute ("PacketSize", UintegerValue (64));
+      onoff.SetAttribute ("DataRate", DataRateValue (DataRate ("4kbps")));
+      ApplicationContainer apps = onoff.Install (adhocNodes.Get (nodes - 1 - i));
+      apps.Start (Seconds (1.0 + 0.1 * i));
+      apps.Stop (Seconds (stop));
+    }
+
+  std::cout << "Running bench-dsr with nodes=" << nodes << " flows=" << flows
+            << " stop=" << stop << "s cacheType=" << cacheType << std::endl;
+
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Stop (Seconds (stop));
+  Simulator::Run ();
+  uint64_t simMs = time.End ();
+
+  uint64_t lookups = 0;
+  uint64_t found = 0;
+  time.Start ();
+  for (uint32_t i = 0; i < nodes; i++)
+    {
+      Ptr<dsr::RouteCache> routeCache = adhocNodes.Get (i)->GetObject<dsr::DsrRouting> ()->GetRouteCache ();
+      Ipv4Address source = interfaces.GetAddress (i);
+      std::vector<dsr::RouteCacheEntry::IP_VECTOR> routes;
+      for (uint32_t j = 0; j < nodes; j++)
+        {
+          dsr::RouteCacheEntry entry;
+          lookups++;
+          if (j != i && routeCache->LookupRoute (interfaces.GetAddress (j), entry))
+            {
+              found++;
+              routes.push_back (entry.GetVector ());
+            }
+        }
+      for (uint32_t j = 0; j < routes.size (); j++)
+        {
+          if (routeCache->IsLinkCache ())
+            {
+              routeCache->AddRoute_Link (routes[j], source);
+            }
+          else
+            {
+              dsr::RouteCacheEntry entry (routes[j], routes[j].back (), routeCache->GetCacheTimeout ());
+              routeCache->AddRoute (entry);
+            }
+          dsr::RouteCacheEntry entry;
+          lookups++;
+          routeCache->LookupRoute (routes[j].back (), entry);
+        }
+    }
+  uint64_t cacheMs = time.End ();
+  Simulator::Destroy ();
+
+  double pps = g_received;
+  pps *= 1000;
+  pps /= simMs > 0 ? simMs : 1;
+  double lps = lookups;
+  lps *= 1000;
+  lps /= cacheMs > 0 ? cacheMs : 1;
+  std::cout << "received=" << g_received << " packets" << std::endl;
+  std::cout << "routes=" << double (found) / nodes << " per node" << std::endl;
+  std::cout << "time=" << simMs << " ms" << std::endl;
+  std::cout << "rate=" << pps << " packets/s" << std::endl;
+  std::cout << "cache-time=" << cacheMs << " ms" << std::endl;
+  std::cout << "cache-rate=" << lps << " lookups/s" << std::endl;
+
+  return 0;
+}
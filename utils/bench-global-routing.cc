@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure how long Ipv4GlobalRoutingHelper::PopulateRoutingTables
+// takes on a random connected topology of n routers. The routers
+// form a ring of point-to-point links, and every router gets
+// (degree - 2) / 2 additional links to random other routers.
+// Then, measure how long it takes to update the routes when random
+// links go down and up again, with RecomputeRoutingTables or with
+// UpdateRoutingTables if --incremental is set.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 200;
+  uint32_t degree = 4;
+  uint32_t seed = 1;
+  uint32_t flaps = 0;
+  bool incremental = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("n", "Number of routers", n);
+  cmd.AddValue ("degree", "Average number of links per router", degree);
+  cmd.AddValue ("seed", "Seed of the topology generator", seed);
+  cmd.AddValue ("flaps", "Number of links which go down and up again", flaps);
+  cmd.AddValue ("incremental", "Update the routes incrementally after a link flap", incremental);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_UNLESS (n >= 3, "Need at least 3 routers");
+  std::srand (seed);
+
+  NodeContainer nodes;
+  nodes.Create (n);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  PointToPointHelper p2p;
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.252");
+
+  uint32_t links = 0;
+  std::vector<Ipv4InterfaceContainer> interfaces;
+  uint32_t chords = degree > 2 ? n * (degree - 2) / 2 : 0;
+  for (uint32_t i = 0; i < n + chords; i++)
+    {
+      uint32_t a = i < n ? i : std::rand () % n;
+      uint32_t b = i < n ? (i + 1) % n : std::rand () % n;
+      if (a == b)
+        {
+          continue;
+        }
+      NetDeviceContainer devices = p2p.Install (nodes.Get (a), nodes.Get (b));
+      interfaces.push_back (address.Assign (devices));
+      address.NewNetwork ();
+      links++;
+    }
+
+  std::cout << "Running bench-global-routing with n=" << n << " links=" << links << std::endl;
+
+  SystemWallClockMs time;
+  time.Start ();
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  uint64_t deltaMs = time.End ();
+  std::cout << "time=" << deltaMs << " ms" << std::endl;
+
+  if (flaps > 0)
+    {
+      time.Start ();
+      for (uint32_t i = 0; i < 2 * flaps; i++)
+        {
+          std::pair<Ptr<Ipv4>, uint32_t> interface = interfaces[(i / 2 * 7919) % links].Get (0);
+          if (i % 2 == 0)
+            {
+              interface.first->SetDown (interface.second);
+            }
+          else
+            {
+              interface.first->SetUp (interface.second);
+            }
+          if (incremental)
+            {
+              Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
+            }
+          else
+            {
+              Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+            }
+        }
+      deltaMs = time.End ();
+      std::cout << "flaps=" << flaps << " incremental=" << incremental
+                << " time=" << deltaMs << " ms" << std::endl;
+    }
+
+  Simulator::Destroy ();
+
+  return 0;
+}
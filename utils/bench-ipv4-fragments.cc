@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure how many bytes of large UDP datagrams are reassembled per
+// second of wall clock time. Several senders send datagrams much
+// larger than the MTU of their point-to-point links to a router,
+// which forwards their fragments, interleaved, to a single receiver.
+// The receiver thus holds the fragments of many datagrams at once.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include <iostream>
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  uint32_t senders = 20;
+  uint32_t packetSize = 16000;
+  uint32_t mtu = 576;
+  std::string dataRate = "10Mbps";
+  std::string delay = "1ms";
+  double stop = 10;
+
+  CommandLine cmd;
+  cmd.AddValue ("senders", "Number of sending nodes", senders);
+  cmd.AddValue ("packetSize", "Size of the UDP datagrams", packetSize);
+  cmd.AddValue ("mtu", "MTU of the links", mtu);
+  cmd.AddValue ("dataRate", "Data rate of each sender", dataRate);
+  cmd.AddValue ("delay", "Delay of the links", delay);
+  cmd.AddValue ("stop", "Simulated duration of the transfer in seconds", stop);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_UNLESS (senders >= 1, "Need at least 1 sender");
+
+  NodeContainer router;
+  router.Create (1);
+  NodeContainer receiver;
+  receiver.Create (1);
+  NodeContainer sources;
+  sources.Create (senders);
+  InternetStackHelper internet;
+  internet.Install (router);
+  internet.Install (receiver);
+  internet.Install (sources);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("Mtu", UintegerValue (mtu));
+  p2p.SetChannelAttribute ("Delay", StringValue (delay));
+  p2p.SetQueue ("ns3::DropTailQueue", "MaxPackets", UintegerValue (100000));
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  // the link to the receiver carries the traffic of all of the senders
+  DataRate senderRate (dataRate);
+  p2p.SetDeviceAttribute ("DataRate", DataRateValue (DataRate (senderRate.GetBitRate () * senders * 2)));
+  Ipv4InterfaceContainer receiverInterfaces = address.Assign (p2p.Install (router.Get (0), receiver.Get (0)));
+  p2p.SetDeviceAttribute ("DataRate", DataRateValue (DataRate (senderRate.GetBitRate () * 2)));
+  for (uint32_t i = 0; i < senders; i++)
+    {
+      address.NewNetwork ();
+      address.Assign (p2p.Install (sources.Get (i), router.Get (0)));
+    }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  uint16_t port = 9;
+  OnOffHelper source ("ns3::UdpSocketFactory", InetSocketAddress (receiverInterfaces.GetAddress (1), port));
+  source.SetConstantRate (senderRate, packetSize);
+  ApplicationContainer sourceApps = source.Install (sources);
+  sourceApps.Start (Seconds (0.0));
+  sourceApps.Stop (Seconds (stop));
+  PacketSinkHelper sink ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer sinkApps = sink.Install (receiver);
+  sinkApps.Start (Seconds (0.0));
+  sinkApps.Stop (Seconds (stop));
+
+  std::cout << "Running bench-ipv4-fragments with senders=" << senders << " packetSize=" << packetSize
+            << " mtu=" << mtu << " dataRate=" << dataRate << " stop=" << stop << "s" << std::endl;
+
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Stop (Seconds (stop));
+  Simulator::Run ();
+  uint64_t deltaMs = time.End ();
+  uint64_t received = DynamicCast<PacketSink> (sinkApps.Get (0))->GetTotalRx ();
+  Simulator::Destroy ();
+
+  double bps = received;
+  bps *= 1000;
+  bps /= deltaMs > 0 ? deltaMs : 1;
+  std::cout << "received=" << received << " bytes" << std::endl;
+  std::cout << "time=" << deltaMs << " ms" << std::endl;
+  std::cout << "rate=" << bps << " bytes/s" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure how many route lookups per second of wall clock time
+// Ipv4GlobalRouting or Ipv4StaticRouting can do on a router whose
+// table holds a large number of host and network routes. The
+// destinations are drawn among the routed hosts and networks, so
+// that every lookup finds a route.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  uint32_t hosts = 10000;
+  uint32_t networks = 1000;
+  uint32_t interfaces = 4;
+  uint32_t lookups = 1000000;
+  uint32_t seed = 1;
+  std::string routing = "global";
+
+  CommandLine cmd;
+  cmd.AddValue ("hosts", "Number of host routes", hosts);
+  cmd.AddValue ("networks", "Number of /24 network routes", networks);
+  cmd.AddValue ("interfaces", "Number of interfaces of the router", interfaces);
+  cmd.AddValue ("lookups", "Number of route lookups", lookups);
+  cmd.AddValue ("seed", "Seed of the destination generator", seed);
+  cmd.AddValue ("routing", "Routing protocol: global or static", routing);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_UNLESS (routing == "global" || routing == "static", "Unknown routing " << routing);
+  NS_ABORT_MSG_UNLESS (interfaces >= 1, "Need at least 1 interface");
+  std::srand (seed);
+
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (Ipv4StaticRoutingHelper ());
+  internet.Install (node);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  for (uint32_t i = 0; i < interfaces; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (device);
+      uint32_t interface = ipv4->AddInterface (device);
+      ipv4->AddAddress (interface, Ipv4InterfaceAddress (Ipv4Address (0xc0a80001 + (i << 8)), Ipv4Mask ("255.255.255.0")));
+      ipv4->SetUp (interface);
+    }
+
+  Ptr<Ipv4RoutingProtocol> protocol;
+  Ptr<Ipv4StaticRouting> staticRouting;
+  Ptr<Ipv4GlobalRouting> globalRouting;
+  if (routing == "global")
+    {
+      globalRouting = CreateObject<Ipv4GlobalRouting> ();
+      ipv4->SetRoutingProtocol (globalRouting);
+      protocol = globalRouting;
+    }
+  else
+    {
+      staticRouting = Ipv4StaticRoutingHelper ().GetStaticRouting (ipv4);
+      protocol = staticRouting;
+    }
+
+  // hosts in 10.0.0.0/8 and networks in 172.16.0.0/12
+  std::vector<Ipv4Address> destinations;
+  for (uint32_t i = 0; i < hosts; i++)
+    {
+      Ipv4Address dest (0x0a000000 | (std::rand () & 0x00ffffff));
+      uint32_t interface = 1 + std::rand () % interfaces;
+      Ipv4Address nextHop (0xc0a80002 + ((interface - 1) << 8));
+      if (globalRouting)
+        {
+          globalRouting->AddHostRouteTo (dest, nextHop, interface);
+        }
+      else
+        {
+          staticRouting->AddHostRouteTo (dest, nextHop, interface);
+        }
+      destinations.push_back (dest);
+    }
+  for (uint32_t i = 0; i < networks; i++)
+    {
+      Ipv4Address network (0xac100000 | (std::rand () & 0x000fff00));
+      uint32_t interface = 1 + std::rand () % interfaces;
+      Ipv4Address nextHop (0xc0a80002 + ((interface - 1) << 8));
+      if (globalRouting)
+        {
+          globalRouting->AddNetworkRouteTo (network, Ipv4Mask ("255.255.255.0"), nextHop, interface);
+        }
+      else
+        {
+          staticRouting->AddNetworkRouteTo (network, Ipv4Mask ("255.255.255.0"), nextHop, interface);
+        }
+      destinations.push_back (Ipv4Address (network.Get () | (1 + std::rand () % 254)));
+    }
+  NS_ABORT_MSG_UNLESS (!destinations.empty (), "Need at least one route");
+
+  std::cout << "Running bench-ipv4-lookup with routing=" << routing << " hosts=" << hosts
+            << " networks=" << networks << " lookups=" << lookups << std::endl;
+
+  Ipv4Header header;
+  Socket::SocketErrno sockerr;
+  uint32_t found = 0;
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < lookups; i++)
+    {
+      header.SetDestination (destinations[i % destinations.size ()]);
+      if (protocol->RouteOutput (0, header, 0, sockerr) != 0)
+        {
+          found++;
+        }
+    }
+  uint64_t deltaMs = time.End ();
+  Simulator::Destroy ();
+
+  double lps = lookups;
+  lps *= 1000;
+  lps /= deltaMs > 0 ? deltaMs : 1;
+  std::cout << "found=" << found << " routes" << std::endl;
+  std::cout << "time=" << deltaMs << " ms" << std::endl;
+  std::cout << "rate=" << lps << " lookups/s" << std::endl;
+
+  return 0;
+}
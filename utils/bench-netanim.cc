@@ -0,0 +1,101 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure how much wall clock time the NetAnim trace of a large
+// scenario takes when most of the nodes do not move. The nodes are
+// placed on a square grid, and some of them walk randomly; no packet
+// is sent, so that the trace only holds the positions of the nodes.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/netanim-module.h"
+#include <iostream>
+#include <cmath>
+#include <cstdio>
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  uint32_t nodes = 5000;
+  uint32_t mobile = 500;
+  double spacing = 20;
+  double stop = 100;
+  std::string output = "bench-netanim.xml";
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of nodes, placed on a square grid", nodes);
+  cmd.AddValue ("mobile", "Number of nodes which walk randomly", mobile);
+  cmd.AddValue ("spacing", "Distance between the nodes in meters", spacing);
+  cmd.AddValue ("stop", "Simulated duration in seconds", stop);
+  cmd.AddValue ("output", "Name of the NetAnim trace file, removed at the end", output);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_UNLESS (mobile <= nodes, "More mobile nodes than nodes");
+  uint32_t side = std::ceil (std::sqrt (double (nodes)));
+
+  NodeContainer staticNodes;
+  staticNodes.Create (nodes - mobile);
+  NodeContainer mobileNodes;
+  mobileNodes.Create (mobile);
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "MinX", DoubleValue (0.0),
+                                 "MinY", DoubleValue (0.0),
+                                 "DeltaX", DoubleValue (spacing),
+                                 "DeltaY", DoubleValue (spacing),
+                                 "GridWidth", UintegerValue (side),
+                                 "LayoutType", StringValue ("RowFirst"));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (staticNodes);
+  mobility.SetMobilityModel ("ns3::RandomWalk2dMobilityModel",
+                             "Bounds", RectangleValue (Rectangle (0, side * spacing, 0, side * spacing)),
+                             "Time", StringValue ("5s"),
+                             "Mode", StringValue ("Time"));
+  mobility.Install (mobileNodes);
+
+  std::cout << "Running bench-netanim with nodes=" << nodes << " mobile=" << mobile
+            << " stop=" << stop << "s" << std::endl;
+
+  SystemWallClockMs time;
+  time.Start ();
+  {
+    // the trace file is complete once the interface is destroyed
+    AnimationInterface anim (output);
+    Simulator::Stop (Seconds (stop));
+    Simulator::Run ();
+    Simulator::Destroy ();
+  }
+  uint64_t deltaMs = time.End ();
+
+  FILE *f = std::fopen (output.c_str (), "r");
+  long size = 0;
+  if (f)
+    {
+      std::fseek (f, 0, SEEK_END);
+      size = std::ftell (f);
+      std::fclose (f);
+      std::remove (output.c_str ());
+    }
+  std::cout << "size=" << size << " bytes" << std::endl;
+  std::cout << "time=" << deltaMs << " ms" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,100 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure how many OLSR packets are received and processed per second
+// of wall clock time in a grid of nodes connected by point-to-point
+// links, where OLSR is the only traffic. Every node ends up with a
+// route to every interface of the other nodes, so the Topology and
+// Interface Association Sets of each node cover the whole grid.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/point-to-point-layout-module.h"
+#include "ns3/olsr-module.h"
+#include <iostream>
+
+using namespace ns3;
+
+static uint64_t g_packets = 0;
+
+static void
+RxOlsr (const olsr::PacketHeader &header, const olsr::MessageList &messages)
+{
+  g_packets++;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t rows = 10;
+  uint32_t cols = 10;
+  double stop = 30;
+
+  CommandLine cmd;
+  cmd.AddValue ("rows", "Number of rows of the grid", rows);
+  cmd.AddValue ("cols", "Number of columns of the grid", cols);
+  cmd.AddValue ("stop", "Simulated duration in seconds", stop);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_UNLESS (rows >= 1 && cols >= 2, "Need at least 2 nodes");
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  PointToPointGridHelper grid (rows, cols, p2p);
+  OlsrHelper olsr;
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr);
+  grid.InstallStack (internet);
+  grid.AssignIpv4Addresses (Ipv4AddressHelper ("10.0.0.0", "255.255.255.0"),
+                            Ipv4AddressHelper ("10.128.0.0", "255.255.255.0"));
+
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::olsr::RoutingProtocol/Rx", MakeCallback (&RxOlsr));
+
+  std::cout << "Running bench-olsr with rows=" << rows << " cols=" << cols
+            << " stop=" << stop << "s" << std::endl;
+
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Stop (Seconds (stop));
+  Simulator::Run ();
+  uint64_t deltaMs = time.End ();
+
+  uint64_t routes = 0;
+  for (uint32_t i = 0; i < rows; i++)
+    {
+      for (uint32_t j = 0; j < cols; j++)
+        {
+          Ptr<olsr::RoutingProtocol> protocol =
+            DynamicCast<olsr::RoutingProtocol> (grid.GetNode (i, j)->GetObject<Ipv4> ()->GetRoutingProtocol ());
+          routes += protocol->GetRoutingTableEntries ().size ();
+        }
+    }
+  Simulator::Destroy ();
+
+  double pps = g_packets;
+  pps *= 1000;
+  pps /= deltaMs > 0 ? deltaMs : 1;
+  std::cout << "routes=" << routes / (rows * cols) << " per node" << std::endl;
+  std::cout << "received=" << g_packets << " packets" << std::endl;
+  std::cout << "time=" << deltaMs << " ms" << std::endl;
+  std::cout << "rate=" << pps << " packets/s" << std::endl;
+
+  return 0;
+}
@@ -270,6 +270,10 @@ int main (int argc, char *argv[])
         {
           Packet::EnablePrinting ();
         }
+      if (strncmp ("--enable-light-printing", argv[0], strlen ("--enable-light-printing")) == 0)
+        {
+          Packet::EnableLightPrinting ();
+        }
       argc--;
       argv++;
   }
@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure how many bytes of a bulk TCP transfer are simulated per
+// second of wall clock time. A BulkSendApplication sends to a
+// PacketSink over a single point-to-point link with large socket
+// buffers, so that the simulation time is dominated by the TCP send
+// and receive paths. With --errorRate, segments are dropped at the
+// receiver, so that its reordering buffer holds out-of-order data.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include <iostream>
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  std::string dataRate = "1Gbps";
+  std::string delay = "5ms";
+  uint32_t bufferSize = 1 << 20;
+  uint32_t sendSize = 512;
+  uint32_t segmentSize = 1448;
+  double errorRate = 0;
+  double stop = 10;
+
+  CommandLine cmd;
+  cmd.AddValue ("dataRate", "Data rate of the link", dataRate);
+  cmd.AddValue ("delay", "Delay of the link", delay);
+  cmd.AddValue ("bufferSize", "Size of the send and receive buffers of the sockets", bufferSize);
+  cmd.AddValue ("sendSize", "Size of the packets given to the sending socket", sendSize);
+  cmd.AddValue ("segmentSize", "TCP maximum segment size", segmentSize);
+  cmd.AddValue ("errorRate", "Rate of the segments dropped at the receiver", errorRate);
+  cmd.AddValue ("stop", "Simulated duration of the transfer in seconds", stop);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (bufferSize));
+  Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (bufferSize));
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (segmentSize));
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue (dataRate));
+  p2p.SetChannelAttribute ("Delay", StringValue (delay));
+  p2p.SetQueue ("ns3::DropTailQueue", "MaxPackets", UintegerValue (1000));
+  NetDeviceContainer devices = p2p.Install (nodes);
+  if (errorRate > 0)
+    {
+      Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+      em->SetAttribute ("ErrorRate", DoubleValue (errorRate));
+      em->SetAttribute ("ErrorUnit", StringValue ("ERROR_UNIT_PACKET"));
+      devices.Get (1)->SetAttribute ("ReceiveErrorModel", PointerValue (em));
+    }
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  uint16_t port = 9;
+  BulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (interfaces.GetAddress (1), port));
+  source.SetAttribute ("SendSize", UintegerValue (sendSize));
+  ApplicationContainer sourceApps = source.Install (nodes.Get (0));
+  sourceApps.Start (Seconds (0.0));
+  sourceApps.Stop (Seconds (stop));
+  PacketSinkHelper sink ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer sinkApps = sink.Install (nodes.Get (1));
+  sinkApps.Start (Seconds (0.0));
+  sinkApps.Stop (Seconds (stop));
+
+  std::cout << "Running bench-tcp-bulk with dataRate=" << dataRate << " delay=" << delay
+            << " bufferSize=" << bufferSize << " errorRate=" << errorRate
+            << " stop=" << stop << "s" << std::endl;
+
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Stop (Seconds (stop));
+  Simulator::Run ();
+  uint64_t deltaMs = time.End ();
+  uint64_t received = DynamicCast<PacketSink> (sinkApps.Get (0))->GetTotalRx ();
+  Simulator::Destroy ();
+
+  double bps = received;
+  bps *= 1000;
+  bps /= deltaMs > 0 ? deltaMs : 1;
+  std::cout << "received=" << received << " bytes" << std::endl;
+  std::cout << "time=" << deltaMs << " ms" << std::endl;
+  std::cout << "rate=" << bps << " bytes/s" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,145 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure how many packets per second of wall clock time a static
+// underwater sensor field can deliver. The sensors are placed on a
+// square grid at the same depth, with a sink at its center, and they
+// periodically send a packet to the sink, in turn, through a UanChannel
+// with the Thorp propagation model. The propagation cache and the range
+// cutoff of the channel can be enabled.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/uan-module.h"
+#include <iostream>
+#include <cmath>
+
+using namespace ns3;
+
+static uint64_t g_received = 0;
+
+static void
+SendPacket (Ptr<Socket> socket, uint32_t packetSize, Time interval)
+{
+  socket->Send (Create<Packet> (packetSize));
+  Simulator::Schedule (interval, &SendPacket, socket, packetSize, interval);
+}
+
+static void
+ReceivePacket (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      g_received++;
+    }
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nodes = 200;
+  double spacing = 500;
+  double depth = 70;
+  uint32_t packetSize = 20;
+  double interval = 600;
+  double stop = 10000;
+  bool propagationCache = false;
+  double maxRange = 0;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of sensors, placed on a square grid", nodes);
+  cmd.AddValue ("spacing", "Distance between the sensors in meters", spacing);
+  cmd.AddValue ("depth", "Depth of the sensors in meters", depth);
+  cmd.AddValue ("packetSize", "Size of the packets in bytes", packetSize);
+  cmd.AddValue ("interval", "Time between the packets of a sensor in seconds", interval);
+  cmd.AddValue ("stop", "Simulated duration in seconds", stop);
+  cmd.AddValue ("propagationCache", "Enable the propagation cache of the channel", propagationCache);
+  cmd.AddValue ("maxRange", "Range cutoff of the channel in meters, 0 to disable it", maxRange);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_UNLESS (nodes >= 1, "Need at least 1 sensor");
+  uint32_t side = std::ceil (std::sqrt (double (nodes)));
+
+  NodeContainer sensors;
+  sensors.Create (nodes);
+  NodeContainer sink;
+  sink.Create (1);
+
+  PacketSocketHelper socketHelper;
+  socketHelper.Install (sensors);
+  socketHelper.Install (sink);
+
+  Ptr<UanChannel> channel = CreateObjectWithAttributes<UanChannel> ("PropagationModel", PointerValue (CreateObject<UanPropModelThorp> ()),
+                                                                    "PropagationCache", BooleanValue (propagationCache),
+                                                                    "MaxRange", DoubleValue (maxRange));
+  UanHelper uan;
+  NetDeviceContainer devices = uan.Install (sensors, channel);
+  NetDeviceContainer sinkDevices = uan.Install (sink, channel);
+
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator> ();
+  positions->Add (Vector ((side - 1) * spacing / 2, (side - 1) * spacing / 2, depth));
+  for (uint32_t i = 0; i < nodes; i++)
+    {
+      positions->Add (Vector ((i % side) * spacing, (i / side) * spacing, depth));
+    }
+  mobility.SetPositionAllocator (positions);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (sink);
+  mobility.Install (sensors);
+
+  PacketSocketAddress socket;
+  socket.SetSingleDevice (sinkDevices.Get (0)->GetIfIndex ());
+  socket.SetPhysicalAddress (sinkDevices.Get (0)->GetAddress ());
+  socket.SetProtocol (0);
+
+  TypeId tid = TypeId::LookupByName ("ns3::PacketSocketFactory");
+  for (uint32_t i = 0; i < nodes; i++)
+    {
+      Ptr<Socket> sensorSocket = Socket::CreateSocket (sensors.Get (i), tid);
+      sensorSocket->Bind ();
+      sensorSocket->Connect (socket);
+      Simulator::Schedule (Seconds (1.0 + i * interval / nodes), &SendPacket,
+                           sensorSocket, packetSize, Seconds (interval));
+    }
+
+  Ptr<Socket> sinkSocket = Socket::CreateSocket (sink.Get (0), tid);
+  sinkSocket->Bind (socket);
+  sinkSocket->SetRecvCallback (MakeCallback (&ReceivePacket));
+
+  std::cout << "Running bench-uan with nodes=" << nodes << " spacing=" << spacing
+            << "m stop=" << stop << "s propagationCache=" << propagationCache
+            << " maxRange=" << maxRange << "m" << std::endl;
+
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Stop (Seconds (stop));
+  Simulator::Run ();
+  uint64_t deltaMs = time.End ();
+  Simulator::Destroy ();
+
+  double pps = g_received;
+  pps *= 1000;
+  pps /= deltaMs > 0 ? deltaMs : 1;
+  std::cout << "received=" << g_received << " packets" << std::endl;
+  std::cout << "time=" << deltaMs << " ms" << std::endl;
+  std::cout << "rate=" << pps << " packets/s" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,148 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure how many frames per second of wall clock time a wifi
+// infrastructure network made of one AP and n associated stations
+// can simulate. Every interval, the AP sends one frame to the next
+// station (in round-robin order) and that station sends one frame
+// back to the AP, so that the per-station state of the AP is looked
+// up for every frame.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include <iostream>
+#include <cmath>
+
+using namespace ns3;
+
+static uint32_t g_received = 0;
+static NetDeviceContainer g_apDevice;
+static NetDeviceContainer g_staDevices;
+
+static bool
+Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from)
+{
+  g_received++;
+  return true;
+}
+
+static void
+SendRound (uint32_t index, uint32_t rounds, uint32_t size, Time interval)
+{
+  Ptr<NetDevice> ap = g_apDevice.Get (0);
+  Ptr<NetDevice> sta = g_staDevices.Get (index);
+  ap->Send (Create<Packet> (size), sta->GetAddress (), 0x88b5);
+  sta->Send (Create<Packet> (size), ap->GetAddress (), 0x88b5);
+  if (rounds > 1)
+    {
+      Simulator::Schedule (interval, &SendRound, (index + 1) % g_staDevices.GetN (),
+                           rounds - 1, size, interval);
+    }
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 100;
+  uint32_t frames = 20000;
+  uint32_t size = 100;
+  double warmup = 5.0;
+  double interval = 0.0005;
+  std::string manager = "ns3::ArfWifiManager";
+
+  CommandLine cmd;
+  cmd.AddValue ("n", "Number of stations associated to the AP", n);
+  cmd.AddValue ("frames", "Number of data frames sent", frames);
+  cmd.AddValue ("size", "Size of the data frames (bytes)", size);
+  cmd.AddValue ("warmup", "Time given to the stations to associate (s)", warmup);
+  cmd.AddValue ("interval", "Time between two AP/station frame exchanges (s)", interval);
+  cmd.AddValue ("manager", "TypeId of the remote station manager", manager);
+  cmd.Parse (argc, argv);
+
+  NodeContainer apNode;
+  apNode.Create (1);
+  NodeContainer staNodes;
+  staNodes.Create (n);
+
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel.Create ());
+
+  WifiHelper wifi = WifiHelper::Default ();
+  wifi.SetRemoteStationManager (manager);
+
+  Ssid ssid = Ssid ("bench");
+  NqosWifiMacHelper mac = NqosWifiMacHelper::Default ();
+  mac.SetType ("ns3::StaWifiMac",
+               "Ssid", SsidValue (ssid),
+               "ActiveProbing", BooleanValue (false));
+  NetDeviceContainer staDevices = wifi.Install (phy, mac, staNodes);
+  mac.SetType ("ns3::ApWifiMac",
+               "Ssid", SsidValue (ssid));
+  NetDeviceContainer apDevice = wifi.Install (phy, mac, apNode);
+
+  // the stations are spread on a circle around the AP.
+  Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator> ();
+  positions->Add (Vector (0.0, 0.0, 0.0));
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double angle = 2 * M_PI * i / n;
+      positions->Add (Vector (10.0 * std::cos (angle), 10.0 * std::sin (angle), 0.0));
+    }
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator (positions);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (apNode);
+  mobility.Install (staNodes);
+
+  apDevice.Get (0)->SetReceiveCallback (MakeCallback (&Receive));
+  for (uint32_t i = 0; i < n; i++)
+    {
+      staDevices.Get (i)->SetReceiveCallback (MakeCallback (&Receive));
+    }
+
+  std::cout << "Running bench-wifi-ap with n=" << n << " frames=" << frames
+            << " manager=" << manager << std::endl;
+
+  Simulator::Stop (Seconds (warmup));
+  Simulator::Run ();
+
+  g_received = 0;
+  uint32_t rounds = (frames + 1) / 2;
+  g_apDevice = apDevice;
+  g_staDevices = staDevices;
+  Simulator::Schedule (Seconds (0.0), &SendRound, 0, rounds, size, Seconds (interval));
+  Simulator::Stop (Seconds (rounds * interval + 1.0));
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Run ();
+  uint64_t deltaMs = time.End ();
+  g_apDevice = NetDeviceContainer ();
+  g_staDevices = NetDeviceContainer ();
+  Simulator::Destroy ();
+
+  double fps = g_received;
+  fps *= 1000;
+  fps /= deltaMs > 0 ? deltaMs : 1;
+  std::cout << "received=" << g_received << " frames" << std::endl;
+  std::cout << "time=" << deltaMs << " ms" << std::endl;
+  std::cout << "rate=" << fps << " frames/s" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,143 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure how many packets per second of wall clock time a WiMAX cell
+// with the simple OFDM PHY can deliver. The subscriber stations are
+// placed on a circle around the base station, and each station of the
+// first half sends UDP packets to a station of the second half, through
+// the base station.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/wimax-module.h"
+#include <iostream>
+#include <cmath>
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  uint32_t nbSS = 20;
+  double duration = 10;
+  double interval = 0.01;
+  uint32_t packetSize = 800;
+  double radius = 100;
+
+  CommandLine cmd;
+  cmd.AddValue ("nbSS", "Number of subscriber stations", nbSS);
+  cmd.AddValue ("duration", "Simulated duration in seconds", duration);
+  cmd.AddValue ("interval", "Interval between the packets of a flow in seconds", interval);
+  cmd.AddValue ("packetSize", "Size of the UDP packets", packetSize);
+  cmd.AddValue ("radius", "Distance between the base station and the subscriber stations", radius);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_UNLESS (nbSS >= 2, "Need at least 2 subscriber stations");
+
+  NodeContainer ssNodes;
+  NodeContainer bsNodes;
+  ssNodes.Create (nbSS);
+  bsNodes.Create (1);
+
+  WimaxHelper wimax;
+  NetDeviceContainer ssDevs = wimax.Install (ssNodes, WimaxHelper::DEVICE_TYPE_SUBSCRIBER_STATION,
+                                             WimaxHelper::SIMPLE_PHY_TYPE_OFDM, WimaxHelper::SCHED_TYPE_SIMPLE);
+  NetDeviceContainer bsDevs = wimax.Install (bsNodes, WimaxHelper::DEVICE_TYPE_BASE_STATION,
+                                             WimaxHelper::SIMPLE_PHY_TYPE_OFDM, WimaxHelper::SCHED_TYPE_SIMPLE);
+  for (uint32_t i = 0; i < nbSS; i++)
+    {
+      ssDevs.Get (i)->GetObject<SubscriberStationNetDevice> ()->SetModulationType (WimaxPhy::MODULATION_TYPE_QAM16_12);
+    }
+
+  Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator> ();
+  for (uint32_t i = 0; i < nbSS; i++)
+    {
+      double angle = 2 * M_PI * i / nbSS;
+      positions->Add (Vector (radius * std::cos (angle), radius * std::sin (angle), 0));
+    }
+  MobilityHelper mobility;
+  mobility.Install (bsNodes);
+  mobility.SetPositionAllocator (positions);
+  mobility.Install (ssNodes);
+
+  InternetStackHelper stack;
+  stack.Install (bsNodes);
+  stack.Install (ssNodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.0.0", "255.255.0.0");
+  Ipv4InterfaceContainer ssInterfaces = address.Assign (ssDevs);
+  address.Assign (bsDevs);
+
+  uint32_t flows = nbSS / 2;
+  ApplicationContainer servers;
+  for (uint32_t i = 0; i < flows; i++)
+    {
+      uint16_t port = 100 + i;
+      UdpServerHelper server (port);
+      ApplicationContainer serverApps = server.Install (ssNodes.Get (i));
+      serverApps.Start (Seconds (0.5));
+      servers.Add (serverApps);
+
+      UdpClientHelper client (ssInterfaces.GetAddress (i), port);
+      client.SetAttribute ("MaxPackets", UintegerValue (0xffffffff));
+      client.SetAttribute ("Interval", TimeValue (Seconds (interval)));
+      client.SetAttribute ("PacketSize", UintegerValue (packetSize));
+      ApplicationContainer clientApps = client.Install (ssNodes.Get (i + flows));
+      clientApps.Start (Seconds (1));
+      clientApps.Stop (Seconds (duration));
+
+      IpcsClassifierRecord dlClassifier (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"),
+                                         ssInterfaces.GetAddress (i), Ipv4Mask ("255.255.255.255"),
+                                         0, 65000, port, port, 17, 1);
+      ServiceFlow dlServiceFlow = wimax.CreateServiceFlow (ServiceFlow::SF_DIRECTION_DOWN,
+                                                           ServiceFlow::SF_TYPE_BE, dlClassifier);
+      ssDevs.Get (i)->GetObject<SubscriberStationNetDevice> ()->AddServiceFlow (dlServiceFlow);
+      IpcsClassifierRecord ulClassifier (ssInterfaces.GetAddress (i + flows), Ipv4Mask ("255.255.255.255"),
+                                         Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"),
+                                         0, 65000, port, port, 17, 1);
+      ServiceFlow ulServiceFlow = wimax.CreateServiceFlow (ServiceFlow::SF_DIRECTION_UP,
+                                                           ServiceFlow::SF_TYPE_BE, ulClassifier);
+      ssDevs.Get (i + flows)->GetObject<SubscriberStationNetDevice> ()->AddServiceFlow (ulServiceFlow);
+    }
+
+  std::cout << "Running bench-wimax with nbSS=" << nbSS << " duration=" << duration
+            << "s interval=" << interval << "s packetSize=" << packetSize << std::endl;
+
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Stop (Seconds (duration + 0.1));
+  Simulator::Run ();
+  uint64_t deltaMs = time.End ();
+  uint64_t received = 0;
+  for (uint32_t i = 0; i < servers.GetN (); i++)
+    {
+      received += DynamicCast<UdpServer> (servers.Get (i))->GetReceived ();
+    }
+  Simulator::Destroy ();
+
+  double pps = received;
+  pps *= 1000;
+  pps /= deltaMs > 0 ? deltaMs : 1;
+  std::cout << "received=" << received << " packets" << std::endl;
+  std::cout << "time=" << deltaMs << " ms" << std::endl;
+  std::cout << "rate=" << pps << " packets/s" << std::endl;
+
+  return 0;
+}